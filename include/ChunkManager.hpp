@@ -0,0 +1,141 @@
+#ifndef CHUNK_MANAGER_HPP
+#define CHUNK_MANAGER_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "MapGenerator.hpp"
+
+struct SnapshotChunk;
+
+// The world as fixed-size chunks streamed on demand. A chunk is generated from the world seed
+// the first time something touches it (an NPC, a query, the camera) and stored compactly:
+// terrain as run-length runs over its tiles (variants are rehashed from the seed on lookup),
+// objects as a sparse sorted list. Past the resident budget the least recently used chunks
+// are evicted: unmodified ones are simply dropped and regenerated later, modified ones are
+// written to the chunk cache (one small file per chunk, or an in-memory blob when no cache
+// directory is set) and read back on the next touch. Memory follows the touched area, not the
+// world size. Not thread-safe: used from the simulation thread.
+class ChunkManager {
+public:
+    static constexpr int kChunkSize = 32; // tiles per side
+
+    struct TileInfo {
+        Terrain terrain = Terrain::Flower;
+        uint8_t variant = 0;
+        ObjectType object = ObjectType::None;
+        uint8_t objectVariant = 0;
+    };
+
+    struct Stats {
+        size_t resident = 0;  // chunks in memory
+        size_t generated = 0; // built from the seed
+        size_t loaded = 0;    // read back from the cache
+        size_t evicted = 0;
+        size_t written = 0;   // evictions that had to be cached
+    };
+
+    // Told when a chunk becomes resident (generated or loaded) and just before it is evicted;
+    // reset() and clear() drop everything without telling
+    using ResidencyListener = std::function<void(int cx, int cy, bool resident)>;
+
+    ChunkManager() = default;
+    ~ChunkManager(); // removes the cache files it wrote
+    ChunkManager(const ChunkManager&) = delete;
+    ChunkManager& operator=(const ChunkManager&) = delete;
+
+    // Forget every chunk and start over on `world` (width, height, seed, frequency and variant
+    // counts; building counts are ignored)
+    void reset(const MapGenerator::Settings& world, size_t maxResidentChunks, std::string cacheDirectory = "");
+    void clear(); // drops resident and cached chunks, keeps the settings
+    // Exchange whole worlds (chunks, cache and settings), e.g. with one built in the background;
+    // the residency listeners stay where they are
+    void swap(ChunkManager& other) noexcept;
+    void setResidencyListener(ResidencyListener listener) { residencyListener = std::move(listener); }
+
+    int getWidth() const { return settings.width; }
+    int getHeight() const { return settings.height; }
+    bool contains(int x, int y) const { return x >= 0 && y >= 0 && x < settings.width && y < settings.height; }
+    const MapGenerator::Settings& getSettings() const { return settings; }
+    const std::string& getCacheDirectory() const { return cacheDirectory; }
+
+    // Keep the chunk(s) under these tiles resident this tick, generating or loading them
+    void touch(int x, int y);
+    void touchArea(int x0, int y0, int x1, int y1); // inclusive tile rectangle
+    // Keep the chunk under this tile resident for good, e.g. when its tiles carry state the
+    // chunk does not record
+    void pin(int x, int y);
+    std::vector<std::pair<int, int>> residentChunks() const; // (cx, cy), in no particular order
+
+    TileInfo tileAt(int x, int y);
+    ObjectType objectAt(int x, int y);
+    void setObject(int x, int y, ObjectType type, uint8_t variant = 0); // ObjectType::None removes
+    void removeObject(int x, int y) { setObject(x, y, ObjectType::None); }
+    // Normalized noise of row y, columns [x, x + count), recomputed from the seed
+    void noiseRow(int y, int x, int count, float* out) const;
+
+    // Closest `type` to the point (fromX, fromY), in tile units, within maxRadius tiles. Scans
+    // rings of chunks outwards through their object lists and stops once no closer chunk can
+    // exist; ties go to the first tile in row-major order.
+    bool findNearest(ObjectType type, float fromX, float fromY, float maxRadius, int& foundX, int& foundY);
+
+    // Ends a tick: evicts least recently touched chunks beyond the budget (never ones touched
+    // in the tick just ended, nor pinned ones). Returns how many were evicted.
+    size_t endTick();
+
+    // Snapshots: the resident chunks and the cached ones (edited, then evicted) in the cache
+    // encoding; the rest regenerates from the seed. Restoring after reset() puts each one back
+    // where it was and returns false if any was corrupt (that one regenerates instead).
+    void saveSnapshot(std::vector<SnapshotChunk>& saved) const;
+    bool restoreSnapshot(const std::vector<SnapshotChunk>& saved);
+
+    const Stats& getStats() const { return stats; }
+    size_t residentBytes() const; // approximate heap held by resident chunks
+
+private:
+    struct ObjectEntry {
+        uint16_t tile; // ly * kChunkSize + lx
+        ObjectType type;
+        uint8_t variant;
+    };
+
+    struct Chunk {
+        std::vector<uint16_t> runEnds;  // exclusive end tile of each terrain run, ascending
+        std::vector<Terrain> runTerrain;
+        std::vector<ObjectEntry> objects; // sorted by tile
+        uint64_t lastTouch = 0;
+        bool dirty = false; // objects changed since generated or loaded
+    };
+
+    MapGenerator::Settings settings;
+    std::string cacheDirectory;
+    size_t maxResident = 0;
+    uint64_t tick = 1;
+    std::unordered_map<uint64_t, Chunk> chunks;
+    std::unordered_map<uint64_t, std::vector<uint8_t>> cachedInMemory; // when cacheDirectory is empty
+    std::unordered_set<uint64_t> cachedOnDisk;
+    std::unordered_set<uint64_t> pinned;
+    ResidencyListener residencyListener;
+    Stats stats;
+
+    static uint64_t key(int cx, int cy) { return static_cast<uint64_t>(static_cast<uint32_t>(cy)) << 32 | static_cast<uint32_t>(cx); }
+    int chunksX() const { return (settings.width + kChunkSize - 1) / kChunkSize; }
+    int chunksY() const { return (settings.height + kChunkSize - 1) / kChunkSize; }
+    std::string chunkPath(int cx, int cy) const;
+
+    Chunk& chunkAt(int cx, int cy); // resident chunk, generated or loaded on a miss
+    Chunk generate(int cx, int cy) const;
+    bool load(int cx, int cy, Chunk& chunk);
+    void store(int cx, int cy, const Chunk& chunk);
+    void cacheBytes(int cx, int cy, std::vector<uint8_t> bytes); // to disk, or memory without a directory
+    std::vector<uint8_t> cachedBytes(uint64_t id) const;
+    static std::vector<uint8_t> encode(const Chunk& chunk);
+    static bool decode(const std::vector<uint8_t>& bytes, Chunk& chunk);
+    static Terrain terrainOf(const Chunk& chunk, int tile);
+};
+
+#endif
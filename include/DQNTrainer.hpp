@@ -0,0 +1,153 @@
+#ifndef DQN_TRAINER_HPP
+#define DQN_TRAINER_HPP
+
+#include "PolicyNetwork.hpp"
+#include "QuantizedPolicyNetwork.hpp"
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <condition_variable>
+#include <string>
+
+// Hyperparameters mirror MicroSocietyDQN in models/prototype/train_npc.py
+struct DQNTrainerConfig {
+    int stateSize = 7;
+    int actionCount = 11;
+    std::vector<int> hiddenLayers = {128, 128, 64};
+
+    float learningRate = 0.001f;     // Adam step size
+    float gamma = 0.99f;             // discount factor
+    int batchSize = 64;
+    size_t replayCapacity = 10000;   // replay memory size
+    int targetSyncInterval = 500;    // gradient steps between target network copies
+    int publishInterval = 50;        // gradient steps between policy snapshots for inference
+    float trainStepsPerExperience = 1.0f;
+
+    float epsilonStart = 1.0f;       // exploration schedule (linear decay over gradient steps)
+    float epsilonMin = 0.01f;
+    int epsilonDecaySteps = 20000;
+
+    unsigned seed = 0;               // 0 = seed from std::random_device
+};
+
+// In-process DQN training: online network + target network, experience replay and Adam.
+// Experiences can be added from the simulation thread while a background worker trains;
+// the worker periodically publishes an immutable PolicyNetwork snapshot for inference.
+class DQNTrainer {
+private:
+    struct Transition {
+        std::vector<float> state;
+        std::vector<float> nextState;
+        int action;
+        float reward;
+        bool done;
+    };
+
+    // Trainable parameters with Adam moments (same [inputs][outputs] layout as DenseLayer)
+    struct TrainableLayer {
+        DenseLayer params;
+        std::vector<float> gradWeights, gradBias;
+        std::vector<float> mWeights, vWeights, mBias, vBias;
+    };
+
+    DQNTrainerConfig config;
+    std::vector<float> scalerMean, scalerScale;
+
+    // owned by whichever thread trains (worker, or the caller of trainStep when not started)
+    std::vector<TrainableLayer> online;
+    PolicyNetwork target;
+    PolicyNetwork::Workspace targetWorkspace;
+    std::vector<std::vector<float>> activations; // per layer [batch][outputs], activations[0] = input
+    std::vector<float> deltaA, deltaB;
+    std::vector<Transition> batch;
+    std::vector<float> targetQ;
+    std::vector<float> nextStates;
+    std::mt19937 trainRng;
+    uint64_t adamStep = 0;
+
+    // replay memory (ring buffer) shared with producers
+    mutable std::mutex replayMutex;
+    std::condition_variable replayCondition;
+    std::vector<Transition> replay;
+    size_t replayHead = 0;
+    float pendingSteps = 0.0f;
+    std::mt19937 sampleRng;
+
+    // published snapshot for inference
+    mutable std::mutex publishMutex;
+    std::shared_ptr<const PolicyNetwork> published;
+    std::shared_ptr<const QuantizedPolicyNetwork> publishedQuantized;
+    QuantizedPolicyNetwork::AccuracyReport publishedReport;
+    std::shared_ptr<const std::vector<float>> calibrationFeatures; // [n][stateSize], guarded by publishMutex
+    float minQuantizedAgreement = 0.98f;
+    std::atomic<uint64_t> publishedVersion{0};
+
+    std::atomic<uint64_t> stepCount{0};
+    std::atomic<float> lastLoss{0.0f};
+    std::atomic<bool> running{false};
+    std::thread worker;
+
+    void initializeWeights(std::mt19937& rng);
+    void allocateBuffers();
+    bool sampleBatch();
+    float optimizeBatch();
+    void syncTarget();
+    void publish();
+    PolicyNetwork toPolicyNetwork() const;
+    void workerLoop();
+
+public:
+    explicit DQNTrainer(const DQNTrainerConfig& trainerConfig = DQNTrainerConfig());
+    ~DQNTrainer();
+
+    DQNTrainer(const DQNTrainer&) = delete;
+    DQNTrainer& operator=(const DQNTrainer&) = delete;
+
+    // Feature scaler applied before the network (defaults map map/levels ranges to [-1, 1])
+    void setScaler(std::vector<float> mean, std::vector<float> scale);
+
+    // Warm start from MSPN weights (shape must match the config)
+    bool loadWeights(const std::string& path);
+    // Write the latest published snapshot; loadable by PolicyNetwork/TensorFlowWrapper
+    bool saveCheckpoint(const std::string& path) const;
+
+    // Raw (unnormalized) feature vectors of length stateSize; actionIndex in [0, actionCount).
+    // scheduleTraining = false only fills replay (warm start from recorded data).
+    void addExperience(const float* state, int actionIndex, float reward, const float* nextState, bool done,
+                       bool scheduleTraining = true);
+
+    // Run one synchronous gradient step; returns the loss or -1 if replay is too small
+    float trainStep();
+
+    // Background training driven by incoming experiences
+    void start();
+    void stop();
+    bool isRunning() const { return running; }
+
+    uint64_t getPublishedVersion() const { return publishedVersion.load(); }
+    std::shared_ptr<const PolicyNetwork> getPublishedPolicy() const;
+
+    // Int8 copies: once calibration rows ([n][stateSize] raw features) are set, every publish also
+    // quantizes the snapshot on the publishing thread and keeps the copy if it agrees with fp32
+    // on at least minAgreement of the rows, so inference only has to swap it in
+    struct PublishedPolicy {
+        std::shared_ptr<const PolicyNetwork> policy;
+        std::shared_ptr<const QuantizedPolicyNetwork> quantized; // null without calibration or when rejected
+        QuantizedPolicyNetwork::AccuracyReport report;
+    };
+    void setQuantizationCalibration(std::vector<float> features, float minAgreement = 0.98f);
+    PublishedPolicy getPublished() const; // policy and its int8 copy from the same publish
+
+    float getEpsilon() const;
+    size_t getReplaySize() const;
+    float getPendingSteps() const; // gradient steps owed to the background worker
+    uint64_t getStepCount() const { return stepCount.load(); }
+    float getLastLoss() const { return lastLoss.load(); }
+    const DQNTrainerConfig& getConfig() const { return config; }
+};
+
+#endif
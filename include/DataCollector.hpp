@@ -3,6 +3,10 @@
 
 #include "State.hpp"
 #include "ActionType.hpp"
+#include "ExperienceRecord.hpp"
+#include "ExperienceIngestion.hpp"
+#include "ExperienceStatistics.hpp"
+#include <atomic>
 #include <vector>
 #include <string>
 #include <fstream>
@@ -12,6 +16,10 @@
 #include <nlohmann/json.hpp>
 
 class DataCollector;
+class ExperienceWriter;
+class ExperienceRecorder;
+struct ObservationBatch;
+struct ObservationLog;
 DataCollector &getDataCollector();
 
 // structure for storing experience tuples
@@ -24,11 +32,20 @@ struct ExperienceData
     bool done;
     std::string npcName;
     float timestamp;
+    uint32_t tick;
 
     ExperienceData(const State &s, ActionType a, float r, const State &ns,
-                   bool d, const std::string &name, float time)
+                   bool d, const std::string &name, float time, uint32_t t = 0)
         : state(s), action(a), reward(r), nextState(ns), done(d),
-          npcName(name), timestamp(time) {}
+          npcName(name), timestamp(time), tick(t) {}
+
+    // expand a compact record; the name comes from the collector's id table
+    static ExperienceData fromRecord(const ExperienceRecord &record, const std::string &name, float time)
+    {
+        return ExperienceData(unpackExperienceState(record.state), static_cast<ActionType>(record.action),
+                              record.reward, unpackExperienceState(record.nextState), record.done != 0,
+                              name, time, record.tick);
+    }
 
     // Convert to JSON (here i will probably add more stats)
     nlohmann::json toJson() const
@@ -40,68 +57,211 @@ struct ExperienceData
             {"nextState", {{"posX", nextState.posX}, {"posY", nextState.posY}, {"nearbyTrees", nextState.nearbyTrees}, {"nearbyRocks", nextState.nearbyRocks}, {"nearbyBushes", nextState.nearbyBushes}, {"energyLevel", nextState.energyLevel}, {"inventoryLevel", nextState.inventoryLevel}}},
             {"done", done},
             {"npcName", npcName},
-            {"timestamp", timestamp}};
+            {"timestamp", timestamp},
+            {"tick", tick}};
+    }
+};
+
+// read-only, zero-copy view of the current batch as it was when taken;
+// keeps the buffer alive, later records are not part of it
+class ExperienceBatchView
+{
+private:
+    std::shared_ptr<const std::vector<ExperienceRecord>> owner;
+    std::shared_ptr<const std::vector<std::string>> names;
+    const ExperienceRecord *records = nullptr;
+    size_t count = 0;
+
+public:
+    ExperienceBatchView() = default;
+    ExperienceBatchView(std::shared_ptr<const std::vector<ExperienceRecord>> batch,
+                        std::shared_ptr<const std::vector<std::string>> npcNames)
+        : owner(std::move(batch)), names(std::move(npcNames)),
+          records(owner->data()), count(owner->size()) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const ExperienceRecord &operator[](size_t index) const { return records[index]; }
+    const ExperienceRecord *begin() const { return records; }
+    const ExperienceRecord *end() const { return records + count; }
+
+    const std::string &getNpcName(size_t index) const
+    {
+        static const std::string unknown = "unknown";
+        const uint16_t id = records[index].npcId;
+        return names && id < names->size() ? (*names)[id] : unknown;
+    }
+    ExperienceData expand(size_t index, float timestamp = 0.0f) const
+    {
+        return ExperienceData::fromRecord(records[index], getNpcName(index), timestamp);
     }
 };
 
+// files written for each saved batch next to the compact .msx segment (ExperienceCodec),
+// which is always written and is enough for every export
+struct BatchFormats
+{
+    bool json = false; // legacy JSON batch (models/prototype/session_data_processor.py)
+    bool npz = true;   // .npz segment: exportToNumpyFormat, calibration and ExperienceDataset map it instead of decoding
+    bool csv = false;  // header-less CSV segment, copied instead of formatted the first time a batch is exported
+                       // (later CSV exports to the same file keep the rows they already hold either way)
+};
+
 // manages collection, storage and export of experience data
 class DataCollector
 {
 private:
-    bool isCollecting = false;
+    std::atomic<bool> isCollecting{false};
+    std::atomic<uint32_t> currentTick{0};
     size_t maxExperiencesPerFile = 5000;
     size_t currentFileIndex = 0;
 
-    std::vector<ExperienceData> experiences;
+    std::unique_ptr<ExperienceRecorder> recorder; // lock-free per-thread buffers NPCs record into
+    std::shared_ptr<std::vector<ExperienceRecord>> experiences; // current batch, shared with views (copy on write)
+    std::vector<ExperienceRecord> pending;        // drained from the recorder, then ingested
+    ExperienceIngestion ingestion;                // dedup / per-action sampling / memory budget
+    BatchFormats batchFormats;
+    size_t spilledBatches = 0;
     std::string outputDirectory;
     std::string currentSessionFile;
     mutable std::mutex dataMutex;
+    std::unique_ptr<ExperienceWriter> writer; // serializes flushed batches off the simulation thread
+
+    // CSV exports are append-only per file: the next export to the same path truncates the
+    // in-memory rows written last time and appends only batches saved since
+    struct CsvExport
+    {
+        std::string segmentPrefix;  // session the file was built from
+        size_t segments = 0;        // saved batches it holds
+        uint64_t segmentBytes = 0;  // file size up to the end of those batches
+        size_t segmentRows = 0;
+    };
+    std::mutex exportMutex; // one CSV export at a time (simulation and iteration builder)
+    std::unordered_map<std::string, CsvExport> csvExports;
+
+    // egocentric observation rows (ObservationBuilder layout): staged per NPC at decision time,
+    // stored when that NPC's next experience is ingested (lock order: dataMutex, then this)
+    mutable std::mutex observationMutex;
+    std::unique_ptr<ObservationLog> observations;
+    size_t maxObservationRows = 20000;
+    void attachObservation(const ExperienceRecord &record); // observationMutex held
 
     // statistics
     size_t totalExperiences = 0;
     size_t experiencesThisSession = 0;
-    std::unordered_map<int, size_t> actionCounts; // count actions for balance analysis
+    static constexpr size_t kProgressInterval = 10000; // experiences between "Session progress" lines
+    size_t progressReported = 0;                       // experiencesThisSession at the last one
+    bool progressDue = false;                          // logged by advanceTick once dataMutex is released
+    std::unordered_map<int, size_t> actionCounts; // count kept actions for balance analysis
+    ExperienceStatistics statistics;              // running stats over every recorded experience
+    mutable std::mutex statsMutex;
+    std::shared_ptr<const ExperienceStatsSnapshot> statsSnapshot; // republished after each collection pass
+
+    // npc id -> name; copied on write so writer jobs can hold a snapshot
+    mutable std::mutex npcMutex;
+    std::unordered_map<std::string, uint16_t> npcIds;
+    std::shared_ptr<const std::vector<std::string>> npcNames;
 
     // helpers
     void createOutputDirectory();
     void saveCurrentBatch();
+    void collectPendingExperiences(); // drain the recorder into the current batch (dataMutex held)
+    void updateStatistics(const ExperienceRecord &record);
+    void publishStatistics();
+    size_t batchCapacity() const;
+    void makeBatchWritable(bool overwriting);
+    void resetBatchBuffer(std::shared_ptr<std::vector<ExperienceRecord>> spare);
     std::string generateFilename();
-    void updateStatistics(const ExperienceData &exp);
+    std::string segmentPath(size_t batchIndex, const std::string &extension) const;
+    std::shared_ptr<const std::vector<std::string>> getNpcNames() const;
+    static std::unordered_map<int, float> actionDistribution(const ExperienceStatsSnapshot &stats);
 
 public:
+    // what an export reads, taken under dataMutex so flushing, decoding and writing run unlocked
+    struct ExportSnapshot
+    {
+        std::string segmentPrefix; // sessions/<session>_batch_
+        size_t segmentCount = 0;   // saved batches [0, segmentCount) of that session
+        ExperienceBatchView batch; // current batch as it was
+        std::shared_ptr<const ExperienceStatsSnapshot> statistics;
+
+        std::string segmentPath(size_t batchIndex, const std::string &extension) const
+        {
+            return segmentPrefix + std::to_string(batchIndex) + extension;
+        }
+    };
+    // O(1): later collection (a new session included) doesn't change what it exports
+    ExportSnapshot takeExportSnapshot();
+
     DataCollector(const std::string &outputDir = "training_data");
     ~DataCollector();
 
-    std::vector<ExperienceData> getCurrentBatch() const;
+    ExperienceBatchView getCurrentBatch();
 
     // main interface
     void startCollection();
     void stopCollection();
+
+    // hot path: lock-free, callable from any thread; npcId comes from registerNpc()
+    void recordExperience(const State &state, ActionType action, float reward,
+                          const State &nextState, bool done, uint16_t npcId);
+    void recordExperience(PackedState state, ActionType action, float reward,
+                          PackedState nextState, bool done, uint16_t npcId);
     void recordExperience(const State &state, ActionType action, float reward,
                           const State &nextState, bool done, const std::string &npcName);
+    uint16_t registerNpc(const std::string &name); // same name -> same id
+
+    // once per simulation tick: stamps new records and moves them into the current batch
+    void advanceTick();
+    uint32_t getCurrentTick() const { return currentTick.load(std::memory_order_relaxed); }
 
     // batch operations
     void saveDataToFile(const std::string &filename = "");
-    void loadDataFromFile(const std::string &filename);
+    void loadDataFromFile(const std::string &filename); // .json (streamed), .npz (memory-mapped) or .msx
     void clearCurrentData();
     void forceSaveCurrentBatch();
+    void flushPendingWrites(); // wait until every flushed batch is on disk
 
     // data export for Python
     void exportToCSV(const std::string &filename);
     void exportToJSON(const std::string &filename);
-    void exportToNumpyFormat(const std::string &baseFilename); // creates .npz files
+    void exportToCSV(const std::string &filename, const ExportSnapshot &snapshot);  // any thread
+    void exportToJSON(const std::string &filename, const ExportSnapshot &snapshot); // any thread
+    void exportToNumpyFormat(const std::string &baseFilename); // creates <base>.npz (states, actions, rewards, next_states, dones)
+
+    // observation rows: row i of the builder's batch is what NPC npcIds[i] sees before deciding.
+    // It is kept once that NPC's next experience passes ingestion, keyed by the experience's
+    // (npc_ids, ticks) with its actions and rewards, and dropped past the row limit. Exported as
+    // <base>.npz with patches uint8 [n, K, K], features float32 [n, F] and those four columns.
+    void recordObservations(const ObservationBatch &batch, const uint16_t *npcIds);
+    size_t getObservationCount() const;
+    bool exportObservations(const std::string &baseFilename);
+    void setMaxObservationRows(size_t rows);
 
     // statistics and monitoring
     size_t getTotalExperiences() const { return totalExperiences; }
-    size_t getCurrentBatchSize() const { return experiences.size(); }
+    size_t getCurrentBatchSize();
+    size_t getDuplicatesDropped() const;
+    size_t getSampledOut() const;
+    size_t getSpilledBatches() const;
     
     bool isCollectingData() const { return isCollecting; }
     void printStatistics() const;
+    std::shared_ptr<const ExperienceStatsSnapshot> getStatistics() const; // O(1), safe from any thread
     void saveStatistics(const std::string &filename) const;
 
     // configuration
-    void setMaxExperiencesPerFile(size_t max) { maxExperiencesPerFile = max; }
+    void setMaxExperiencesPerFile(size_t max);
+    void setIngestionPolicy(const IngestionPolicy &policy);
+    IngestionPolicy getIngestionPolicy() const;
+    void setBatchFormats(const BatchFormats &formats);
+    BatchFormats getBatchFormats() const;
     void setOutputDirectory(const std::string &dir);
+    const std::string &getOutputDirectory() const { return outputDirectory; }
+
+    // recorded states (current batch first, then this session's saved batches, newest first)
+    // used to calibrate the int8 policy and check it against fp32
+    std::vector<State> getCalibrationStates(size_t maxStates);
 
     // data quality analysis
     std::unordered_map<int, float> getActionDistribution() const;
@@ -0,0 +1,52 @@
+#ifndef EXPERIENCE_CODEC_HPP
+#define EXPERIENCE_CODEC_HPP
+
+#include "ExperienceRecord.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Compact encoding of recorded experiences (.msx session segments and spill files),
+// typically 6-8 bytes per experience against 65 in .npz and ~250 in JSON.
+//
+// A file is one or more blocks:
+//   "MSXC" | version u8 | count varint | timestamp f32 | name dictionary | payload bytes varint | payload
+// The dictionary lists the NPCs used by the block as (npcId varint, name). Each record is
+//   tag u8       bit0 state delta follows, bit1 nextState delta follows, bit2 done,
+//                bit3 reward literal follows, bits4-7 action (15 = action byte follows)
+//   npcId        varint
+//   tick         zigzag varint, difference to the previous record
+//   reward       f32 literal (appended to the block's reward table) or varint table index
+//   state        delta against that NPC's previous nextState (all zero for its first record)
+//   nextState    delta against state
+// A delta is a byte mask of changed fields followed by one zigzag varint per changed field
+// (the seven State fields, then the three density levels packed into one value).
+// In a running simulation state equals the NPC's last nextState and only one or two fields
+// change per step, so most records need neither a state nor more than two delta bytes.
+namespace ExperienceCodec {
+
+    constexpr char kMagic[4] = {'M', 'S', 'X', 'C'};
+    constexpr uint8_t kVersion = 1;
+
+    // Decoded contents; records keep their npcId, npcNames[npcId] is the name stored with it
+    struct Block {
+        std::vector<ExperienceRecord> records;
+        std::vector<std::string> npcNames;
+        float timestamp = 0.0f; // of the last block read
+    };
+
+    // Appends one block to `out`; names are taken from npcNames[npcId] (nullptr = ids only)
+    void encode(const ExperienceRecord* records, size_t count, const std::vector<std::string>* npcNames,
+                float timestamp, std::string& out);
+
+    // Decodes every block in the buffer, appending to `out`; false on truncated or corrupt input
+    // (records of the blocks before the damaged one are kept)
+    bool decode(const char* data, size_t size, Block& out);
+
+    bool writeFile(const std::string& path, const std::vector<ExperienceRecord>& records,
+                   const std::vector<std::string>* npcNames, float timestamp);
+    bool readFile(const std::string& path, Block& out);
+}
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef EXPERIENCE_CSV_HPP
+#define EXPERIENCE_CSV_HPP
+
+#include "ExperienceRecord.hpp"
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// CSV rows for recorded experiences. Exports are append-only: rows already in an export file
+// are kept (Writer's resume constructor), and optional header-less segment files written when a
+// batch is flushed are concatenated byte-for-byte instead of formatted again.
+namespace ExperienceCsv {
+
+    constexpr const char* kHeader =
+        "state_posX,state_posY,state_nearbyTrees,state_nearbyRocks,state_nearbyBushes,"
+        "state_energyLevel,state_inventoryLevel,action,reward,"
+        "nextState_posX,nextState_posY,nextState_nearbyTrees,nextState_nearbyRocks,"
+        "nextState_nearbyBushes,nextState_energyLevel,nextState_inventoryLevel,"
+        "done,npcName,timestamp\n";
+
+    // Appends one formatted row (std::to_chars, no locale or stream state involved)
+    void appendRow(std::string& out, const ExperienceRecord& record, const std::string& npcName, float timestamp);
+
+    // Buffered output file; rows are formatted into memory and written in large blocks
+    class Writer {
+    private:
+        static constexpr size_t kBufferSize = 1 << 20;
+        std::ofstream file;
+        std::string buffer;
+        size_t rows = 0;
+        uint64_t bytes = 0; // file size once the buffer is written
+
+        void flushBuffer();
+
+    public:
+        explicit Writer(const std::string& path);
+        Writer(const std::string& path, uint64_t keepBytes); // truncate to keepBytes and append (not open on failure)
+        ~Writer();
+
+        bool isOpen() const { return file.is_open(); }
+        size_t getRowCount() const { return rows; } // rows written through this writer
+        uint64_t getByteCount() const { return bytes + buffer.size(); }
+
+        void writeHeader();
+        void write(const ExperienceRecord& record, const std::string& npcName, float timestamp);
+        void write(const std::vector<ExperienceRecord>& records,
+                   const std::shared_ptr<const std::vector<std::string>>& npcNames, float timestamp);
+
+        // Copy a segment written earlier; returns the number of rows it held (0 if unreadable)
+        size_t appendSegment(const std::string& path);
+
+        bool close(); // false if any write failed
+    };
+
+    bool writeSegment(const std::string& path, const std::vector<ExperienceRecord>& records,
+                      const std::shared_ptr<const std::vector<std::string>>& npcNames, float timestamp);
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef EXPERIENCE_DATASET_HPP
+#define EXPERIENCE_DATASET_HPP
+
+#include "DataCollector.hpp"
+#include "NumpyIO.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+// Read-only memory mapping of a whole file (mmap / MapViewOfFile)
+class MappedFile {
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const std::string& path);
+    void close();
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+    bool isOpen() const { return bytes != nullptr; }
+};
+
+// Indexed view over experience archives (.npz written by DataCollector/NumpyIO or np.savez
+// without compression). Files are memory-mapped, so opening a multi-GB session directory
+// costs only its index; rows are copied out on demand in any order.
+class ExperienceDataset {
+private:
+    struct Segment {
+        std::string path;
+        MappedFile file;
+        const char* states = nullptr;     // int32 [count][7], possibly unaligned inside the zip
+        const char* actions = nullptr;    // int32 [count]
+        const char* rewards = nullptr;    // float32 [count]
+        const char* nextStates = nullptr; // int32 [count][7]
+        const char* dones = nullptr;      // bool [count]
+        size_t count = 0;
+        size_t first = 0;                 // global index of row 0
+    };
+
+    std::vector<Segment> segments;
+    size_t totalCount = 0;
+
+    const Segment& segmentFor(size_t index) const;
+    static State readState(const char* base, size_t row);
+
+public:
+    // Map one archive; false if it is missing, compressed or not an experience archive
+    bool addFile(const std::string& path);
+    // Map every .npz in a directory (sorted by name); returns how many were added
+    size_t addDirectory(const std::string& directory);
+    void clear();
+
+    size_t size() const { return totalCount; }
+    bool empty() const { return totalCount == 0; }
+    size_t getSegmentCount() const { return segments.size(); }
+
+    State getState(size_t index) const;
+    State getNextState(size_t index) const;
+    ActionType getAction(size_t index) const;
+    float getReward(size_t index) const;
+    bool isDone(size_t index) const;
+
+    // Append rows [first, first + count) / the given rows to `out`
+    void fetch(size_t first, size_t count, NumpyIO::ExperienceColumns& out) const;
+    void fetch(const size_t* indices, size_t count, NumpyIO::ExperienceColumns& out) const;
+
+    // A permutation of all row indices (one epoch), and uniform sampling with replacement
+    std::vector<size_t> shuffledIndices(std::mt19937& rng) const;
+    void sample(std::mt19937& rng, size_t count, NumpyIO::ExperienceColumns& out) const;
+};
+
+// Streams the experiences of a legacy JSON batch/export ("experiences" or "data" array)
+// through nlohmann's SAX parser; memory stays at one experience whatever the file size.
+// Returns false if the file is missing or malformed (experiences before the error are delivered).
+bool streamExperienceJson(const std::string& path, const std::function<void(const ExperienceData&)>& onExperience);
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef EXPERIENCE_INGESTION_HPP
+#define EXPERIENCE_INGESTION_HPP
+
+#include "ExperienceRecord.hpp"
+
+#include <array>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+// What DataCollector keeps of the recorded stream
+struct IngestionPolicy {
+    bool dedup = false;                      // drop repeats of a recently seen (state, action) pair
+    size_t dedupCacheSize = 1 << 16;         // remembered pairs (direct-mapped, fixed memory)
+    float maxActionShare = 1.0f;             // per-action quota of a batch; above it, reservoir-sample
+    size_t memoryBudgetBytes = size_t{256} << 20; // current batch + queued writes; beyond it batches spill to disk
+};
+
+// Dedup + per-action stratified reservoir sampling over one batch window.
+// A window covers `capacity` offered (non-duplicate) records; each action keeps at most
+// maxActionShare * capacity of them, uniformly sampled among that action's records.
+class ExperienceIngestion {
+public:
+    enum class Decision { Append, Replace, DropDuplicate, DropSampled };
+    struct Result {
+        Decision decision;
+        size_t slot; // batch index to overwrite for Replace
+    };
+
+private:
+    static constexpr size_t kActionSlots = 256; // ExperienceRecord::action is a uint8_t
+
+    IngestionPolicy policy;
+    std::vector<uint64_t> recentPairs;          // hash per slot, 0 = empty
+    std::array<size_t, kActionSlots> seenInWindow{};
+    std::array<std::vector<uint32_t>, kActionSlots> slotsByAction; // batch indices per action
+    size_t offeredInWindow = 0;
+    std::mt19937_64 rng{0x5eed};
+
+    size_t duplicatesDropped = 0;
+    size_t sampledOut = 0;          // records discarded by sampling (dropped or evicted)
+
+public:
+    explicit ExperienceIngestion(const IngestionPolicy& initialPolicy = IngestionPolicy());
+
+    void setPolicy(const IngestionPolicy& newPolicy);
+    const IngestionPolicy& getPolicy() const { return policy; }
+
+    // Decide what happens to `record` for a batch currently holding batchSize of capacity records
+    Result offer(const ExperienceRecord& record, size_t batchSize, size_t capacity);
+
+    // True once the window has seen a full batch worth of records
+    bool isWindowComplete(size_t batchSize, size_t capacity) const;
+    void startWindow();
+
+    size_t getDuplicatesDropped() const { return duplicatesDropped; }
+    size_t getSampledOut() const { return sampledOut; }
+
+    static uint64_t pairHash(const ExperienceRecord& record);
+};
+
+#endif
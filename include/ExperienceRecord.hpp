@@ -0,0 +1,31 @@
+#ifndef EXPERIENCE_RECORD_HPP
+#define EXPERIENCE_RECORD_HPP
+
+#include "State.hpp"
+#include "ActionType.hpp"
+
+#include <cstdint>
+
+// Fixed-size experience tuple used on the recording hot path (32 bytes, no heap data).
+// The NPC name lives once in DataCollector's id table instead of in every record.
+struct ExperienceRecord {
+    uint64_t state;      // packExperienceState()
+    uint64_t nextState;
+    float reward;
+    uint32_t tick;       // DataCollector tick when the experience was recorded
+    uint16_t npcId;
+    uint8_t action;      // ActionType
+    uint8_t done;
+};
+static_assert(sizeof(ExperienceRecord) == 32, "ExperienceRecord should stay one half cache line");
+
+// Records store states in the PackedState layout (see State.hpp)
+inline uint64_t packExperienceState(const State& state) {
+    return PackedState::pack(state).bits;
+}
+
+inline State unpackExperienceState(uint64_t packed) {
+    return PackedState{packed}.unpack();
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef EXPERIENCE_RECORDER_HPP
+#define EXPERIENCE_RECORDER_HPP
+
+#include "ExperienceRecord.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Lock-free multi-producer recording buffer.
+// Every recording thread appends into its own chain of chunks (no shared cache lines,
+// no locks). A single consumer (DataCollector) walks each chain in order, frees the
+// chunks it has finished and copies whatever the newest chunk holds so far.
+class ExperienceRecorder {
+public:
+    static constexpr uint32_t kChunkCapacity = 4096; // 128KB of records per chunk
+
+private:
+    struct Chunk {
+        std::atomic<uint32_t> count{0};     // published with release by the owning thread
+        std::atomic<Chunk*> next{nullptr};  // set once the chunk is full; count is final from then on
+        uint32_t consumed = 0;              // consumer-only read cursor
+        ExperienceRecord records[kChunkCapacity];
+    };
+
+    struct ThreadBuffer {
+        Chunk* tail = nullptr; // producer-only: chunk being filled
+        Chunk* head = nullptr; // consumer-only: oldest chunk not yet freed
+    };
+
+    const uint64_t recorderId; // distinguishes recorders in the thread-local cache
+    std::mutex registryMutex;  // guards threadBuffers (registration is once per thread)
+    std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+
+    ThreadBuffer& localBuffer();
+    static size_t consume(Chunk& chunk, uint32_t available, std::vector<ExperienceRecord>& out);
+
+public:
+    ExperienceRecorder();
+    ~ExperienceRecorder();
+
+    ExperienceRecorder(const ExperienceRecorder&) = delete;
+    ExperienceRecorder& operator=(const ExperienceRecorder&) = delete;
+
+    // Producer side: safe from any number of threads concurrently
+    void append(const ExperienceRecord& record);
+
+    // Consumer side: one thread at a time. Appends everything recorded so far; returns the count.
+    size_t drain(std::vector<ExperienceRecord>& out);
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef EXPERIENCE_STATISTICS_HPP
+#define EXPERIENCE_STATISTICS_HPP
+
+#include "ExperienceRecord.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Count-min sketch: approximate visit counts in fixed memory (never underestimates)
+class CountMinSketch {
+public:
+    static constexpr size_t kDepth = 4;
+    static constexpr size_t kWidth = 2048; // error <= total * e / kWidth with high probability
+
+private:
+    std::vector<uint32_t> counters = std::vector<uint32_t>(kDepth * kWidth, 0);
+
+    static size_t column(uint64_t key, size_t row);
+
+public:
+    void add(uint64_t key);
+    uint32_t estimate(uint64_t key) const;
+    void clear();
+};
+
+// Immutable copy of the statistics, published once per collection pass
+struct ExperienceStatsSnapshot {
+    static constexpr size_t kActionSlots = 256;
+    static constexpr size_t kRewardBins = 40;
+    static constexpr float kRewardLow = -100.0f;  // death penalty
+    static constexpr float kRewardHigh = 100.0f;  // rewards beyond the range land in the edge bins
+
+    uint64_t count = 0;
+    uint64_t terminalCount = 0;
+    double rewardMean = 0.0;
+    double rewardVariance = 0.0; // population variance
+    float rewardMin = 0.0f;
+    float rewardMax = 0.0f;
+    std::array<uint64_t, kRewardBins> rewardHistogram{};
+    std::array<uint64_t, kActionSlots> actionCounts{};     // every recorded experience
+    std::array<uint64_t, kActionSlots> keptActionCounts{}; // what ingestion kept for the batch files
+    std::vector<uint64_t> npcCounts;     // indexed by DataCollector npc id
+    CountMinSketch stateVisits;          // full packed state
+    CountMinSketch positionVisits;       // (posX, posY) only
+
+    static size_t rewardBin(float reward);
+    uint32_t estimateStateVisits(const State& state) const;
+    uint32_t estimatePositionVisits(int posX, int posY) const;
+};
+
+// Running statistics over every recorded experience of a session: Welford mean/variance,
+// min/max, a fixed-bin reward histogram, per-action/per-NPC counts and visitation sketches.
+// Each update is O(1); nothing is ever rescanned.
+class ExperienceStatistics {
+private:
+    ExperienceStatsSnapshot current;
+    double rewardM2 = 0.0;
+
+public:
+    void update(const ExperienceRecord& record);
+    void reset();
+    const ExperienceStatsSnapshot& get() const { return current; }
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef EXPERIENCE_WRITER_HPP
+#define EXPERIENCE_WRITER_HPP
+
+#include "DataCollector.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Background writer for DataCollector batches. The collector hands over its filled
+// buffer (a pointer move) and immediately gets a recycled empty one back, so recording
+// never waits on serialization or disk I/O. Batches over the memory budget arrive as
+// compact spill files instead and are read back here one at a time.
+class ExperienceWriter {
+public:
+    struct Job {
+        std::shared_ptr<std::vector<ExperienceRecord>> records; // shared with live batch views
+        std::string spillPath;         // records were spilled here instead (ExperienceCodec block)
+        std::shared_ptr<const std::vector<std::string>> npcNames; // id -> name when the job was queued
+        std::string msxPath;           // compact ExperienceCodec segment ("" to skip)
+        std::string jsonPath;          // legacy JSON batch/export ("" to skip)
+        std::string jsonArrayKey = "experiences";
+        nlohmann::json metadata;
+        std::string npzPath;           // columnar .npz ("" to skip)
+        std::string csvPath;           // header-less CSV segment for exportToCSV ("" to skip)
+    };
+
+private:
+    std::deque<Job> queue;
+    std::vector<std::shared_ptr<std::vector<ExperienceRecord>>> recycled; // drained buffers keep their capacity
+    size_t pendingBytes = 0; // record memory held by queued jobs
+    std::mutex queueMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable queueDrained;
+    bool stopping = false;
+    bool busy = false;
+    std::thread worker;
+
+    void workerLoop();
+    static void writeJob(Job& job);
+
+public:
+    ExperienceWriter();
+    ~ExperienceWriter();
+
+    ExperienceWriter(const ExperienceWriter&) = delete;
+    ExperienceWriter& operator=(const ExperienceWriter&) = delete;
+
+    // Queue a job; returns an empty buffer with capacity to keep recording into (null when none is free)
+    std::shared_ptr<std::vector<ExperienceRecord>> submit(Job job);
+
+    // Block until every queued job is on disk
+    void flush();
+
+    size_t getPendingJobs();
+    size_t getPendingBytes();
+
+    static bool writeSpill(const std::string& path, const std::vector<ExperienceRecord>& records);
+    static bool readSpill(const std::string& path, std::vector<ExperienceRecord>& records);
+};
+
+#endif
@@ -5,6 +5,8 @@
 #include <vector>
 #include <memory>
 #include <unordered_map>
+#include <random>
+#include <thread>
 #include "Tile.hpp"
 #include "Actions.hpp"
 #include "House.hpp"
@@ -15,8 +17,28 @@
 #include "ClockGUI.hpp"
 #include "Configuration.hpp"
 #include "TextureManager.hpp"
+#include "State.hpp"
+#include "ObservationBuilder.hpp"
+#include "SpatialHash.hpp"
+#include "TimerWheel.hpp"
+#include "ChunkManager.hpp"
+#include "SimulationSnapshot.hpp"
+#include "DataCollector.hpp"
 
 class NPCEntity;
+class TensorFlowWrapper;
+class DQNTrainer;
+
+// What a wake-up on the simulation timers is for; the event subject is an NPC recorder id for
+// ActionReady and a ResourceRegrowth tile/kind code for ResourceRegrowth. Values are stored
+// in snapshots, so new channels go at the end.
+enum class TimerChannel : uint32_t {
+    MarketDynamics,
+    SocietalGrowth,
+    ResourceRegrowth,
+    ActionReady,
+    Checkpoint
+};
 
 class Game {
 private:
@@ -33,11 +55,91 @@ private:
     bool showTileBorders = false;
     bool isClockVisible = true;
     float simulationSpeed = 1.0f;
-    float resourceRegenerationTimer = 0.0f;
-    const float regenerationInterval = 7.0f; // regenerate resources every 7 seconds
+    const float societalGrowthInterval = 30.0f;
+
+    // periodic systems and NPC cooldowns wake up from the shared simulation timers
+    std::vector<TimerWheel::Event> dueTimers;
+    void scheduleSystemTimers();
+    void dispatchTimers(float simulatedSeconds);
+    void parkOnCooldown(NPCEntity& npc);
+
+    // The per-tick NPC loop visits only awake NPCs (npcs indices, ascending); a wake-up adds
+    // its NPC back. Wake-ups name NPCs by handle, so deaths never retarget them.
+    static constexpr uint32_t kNoNpc = UINT32_MAX;
+    std::vector<uint32_t> activeNpcs;
+    std::vector<uint32_t> nextActiveNpcs;
+    std::vector<uint32_t> dyingNpcs;     // this tick's deaths, removed in one pass
+    std::unordered_map<uint32_t, uint32_t> npcIndexByHandle; // NPC handle -> npcs index, rebuilt when it goes stale
+    std::vector<uint32_t> npcRemap;      // old -> new index while removing the dead
+    bool activeNpcsSorted = true;
+    float vitalsClock = 0.0f;            // simulation time awake NPCs' vitals are current to
+    void resetActiveNpcs();              // after npcs is replaced or every NPC is woken
+    uint32_t findNpc(uint32_t handle);
+    void catchUpVitals(NPCEntity& npc);  // vitals a sleeper skipped since it was parked
+    void removeDyingNpcs();
 
-    // map and tiles
+    // map and tiles (layers first: tiles point into them until destroyed)
+    ObjectLayers objectLayers; // per-ObjectType presence bitboards, attached in generateMap()
     std::vector<std::vector<std::unique_ptr<Tile>>> tileMap;
+
+    // the world as streamed chunks, the only full copy of the map: tileMap has tiles for the
+    // resident chunks only (nullptr elsewhere), built when a chunk arrives and dropped when it
+    // is evicted; edits flow back through the object layers
+    ChunkManager world;
+    static constexpr size_t residentChunkBudget = 64;
+    static constexpr float targetSearchRadius = 64.0f; // tiles
+    bool streamingTiles = false; // tiles being built from a chunk that already holds their objects
+    sf::IntRect viewTiles() const; // tiles under the camera
+    void streamWorld();
+    void onChunkResidency(int cx, int cy, bool resident);
+    Tile* tileAt(int x, int y); // builds the tile's chunk first when it is not resident
+    Tile* findNearestTarget(const NPCEntity& npc, ObjectType type);
+
+    // tile and object sprites for every variant, looked up once on the simulation thread
+    struct MapTextures {
+        std::vector<const sf::Texture*> grass, stone, flower, tree, rock, bush, house, market;
+    } mapTextures;
+    void loadMapTextures();
+    // Record the houses and markets MapGenerator places in `source`'s chunks, then fill `tiles`
+    // for the chunks resident in `source` (other entries are left empty). With `previous` (the
+    // terrain the tiles were built from) tiles of the same terrain are kept and re-skinned
+    // instead of reallocated. Touches nothing else of the Game, so it can run off the
+    // simulation thread.
+    void materializeTiles(ChunkManager& source, TileGrid& tiles, std::vector<float>& spawnChances,
+                          int houseCount, int marketCount, std::mt19937& rng,
+                          const std::vector<ChunkManager::TileInfo>* previous) const;
+    // The tiles of one resident chunk; chunks holding houses or markets are pinned, since those
+    // tiles keep stores and order books the chunk does not record
+    void materializeChunk(ChunkManager& source, TileGrid& tiles, int cx, int cy, std::mt19937& rng,
+                          const std::vector<ChunkManager::TileInfo>* previous) const;
+    void attachTileMap(std::vector<float> spawnChances); // object layers, observations, regrowth
+    void buildTileMap(int houseCount, int marketCount);
+
+    // The next iteration's world, map and population, built on a background thread while the
+    // current one runs. resetSimulation swaps them in and hands the retired ones back, so a reset
+    // only exchanges pointers and the next build recycles the old tiles and buffers.
+    struct Iteration {
+        ChunkManager world;
+        TileGrid tileMap;
+        std::vector<float> spawnChances;
+        std::vector<NPCEntity> npcs;
+        std::vector<ChunkManager::TileInfo> previousTiles; // terrain of the retired map's built tiles
+    };
+    Iteration nextIteration;
+    std::thread iterationBuilder;
+    // exports of the finished iteration: the data is snapshotted when they are asked for and
+    // written by the builder
+    struct DataExport {
+        std::string filename;
+        bool csv = false; // else JSON
+        DataCollector::ExportSnapshot data;
+    };
+    std::vector<DataExport> retiredDataExports;
+    void exportRetiredData(std::string filename, bool csv);
+    void prepareNextIteration();
+    void waitForNextIteration();
+    void buildNextIteration(MapGenerator::Settings settings, int marketCount, uint32_t seed,
+                            std::vector<DataExport> exports, sf::IntRect view);
     int mapWidth;
     int mapHeight;
     int tileSize;
@@ -48,21 +150,54 @@ private:
 
     // NPC management
     std::vector<NPCEntity> npcs;
+
+    // batched policy decisions (buffers reused every tick)
+    std::vector<std::pair<TensorFlowWrapper*, size_t>> decisionRequests; // model, npc index
+    std::vector<State> decisionStates;
+    std::vector<ActionType> decisionActions;
+    ObservationBuilder observationBuilder;        // for policies that take egocentric observations
+    ObservationBatch observationBatch;
+    std::vector<const NPCEntity*> observationNpcs;
+    std::vector<uint16_t> observationIds;
+    bool observationsFresh = false; // builder refreshed this tick
+
+    // NPC positions hashed once per tick for neighbour queries and separation steering
+    SpatialHash npcHash{GameConfig::tileSize * 2.0f, static_cast<float>(GameConfig::mapWidth * GameConfig::tileSize),
+                        static_cast<float>(GameConfig::mapHeight * GameConfig::tileSize)};
+    std::vector<sf::Vector2f> npcPositions;
+    void updateCrowding();
+    void batchPolicyDecisions();
+    void recordDecisionObservations(); // data collection: what every deciding NPC sees
+
+    // market tiles clear their order books once per tick; traders maps NPC handles to the living NPCs
+    std::vector<Market*> marketTiles;
+    Market::TraderTable traders;
+    void runMarketAuctions();
     
     // AI Settings
     bool reinforcementLearningEnabled = true;
     bool tensorFlowEnabled = false;
 
-    // generate NPCs
-    std::vector<NPCEntity> generateNPCEntities() const;  
+    // generate NPCs into `population` on a world of these dimensions, reusing its storage
+    void generateNPCEntities(std::vector<NPCEntity>& population, const MapGenerator::Settings& settings) const;
 
     // render
     void render();
     void drawTileBorders();
-    void regenerateResources();
 
     // TensorFlow initialization
     void initializeNPCTensorFlow();
+
+    // in-process training: the trainer publishes weights into the model shared by all NPCs
+    std::shared_ptr<DQNTrainer> trainer;
+    std::shared_ptr<TensorFlowWrapper> policyModel;
+    uint64_t trainerPolicyVersion = 0;
+    float checkpointTimer = 0.0f;
+    void startOnlineTraining();
+    void warmStartReplay();
+    void updateOnlineTraining(float deltaTime);
+    void saveTrainingCheckpoint();
+    void calibrateQuantizedPolicy(TensorFlowWrapper& model);
     
     // data collection
     void checkDataCollectionProgress();
@@ -79,6 +214,9 @@ private:
     // Update persistent stats
     void updatePersistentStats();
 
+    // snapshots are captured here and encoded/written on the writer's thread
+    SnapshotWriter snapshotWriter;
+
 public:
     Game();
     ~Game();
@@ -94,15 +232,24 @@ public:
     void toggleTileBorders();
     const std::vector<std::vector<std::unique_ptr<Tile>>>& getTileMap() const;
 
+    // save/restore the whole running society (see SimulationSnapshot)
+    SimulationSnapshot captureSnapshot();
+    bool restoreSnapshot(const SimulationSnapshot& snapshot);
+    void saveSnapshot(const std::string& path); // returns once captured; the write happens in the background
+    bool loadSnapshot(const std::string& path);
+    void flushSnapshots() { snapshotWriter.flush(); }
+
     int getTotalItemsGathered() const;
     int getTotalItemsMined() const; 
     
     void storeItems(NPCEntity& npc, Tile& tile);
     bool detectCollision(Entity& entity);
+    const SpatialHash& getNpcHash() const { return npcHash; } // indices follow npcs as of the last tick
     void simulateNPCEntityBehavior(float deltaTime);
-    void simulateSocietalGrowth(float deltaTime);
+    void simulateSocietalGrowth(); // one step, every societalGrowthInterval seconds
     void evaluateNPCEntityState(NPCEntity& NPCEntity);
     void performPathfinding(NPCEntity& NPCEntity);
+    void stepWalking(NPCEntity& npc, float deltaTime);
     void moveToResource(NPCEntity& npc, ActionType actionType);
     void handleMarketActions(NPCEntity& npc, Tile& targetTile, ActionType actionType);
 
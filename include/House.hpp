@@ -8,6 +8,7 @@
 #include "TextureManager.hpp"
 
 class NPCEntity;
+struct HouseSnapshot;
 
 class House : public Object {
 private:
@@ -18,6 +19,8 @@ private:
     int strengthBonus;
     int speedBonus;
     std::unordered_map<std::string, int> storage; // storage for items
+    std::unordered_map<const Entity*, float> lastRegenTime; // simulation time of each entity's last regeneration
+    std::unordered_map<const Entity*, int> regenCount;      // regenerations since the last daily reset
 
     void logUpgradeDetails() const; // upgrade debug logs
 
@@ -43,6 +46,10 @@ public:
     void displayStorage() const; // Display storage details
     void displayStats() const;   // Display house stats
     void resetDailyLimits();     // Reset any daily limits (if applicable)
+
+    // Snapshots; per-entity regeneration limits are stored by index into `entities`
+    void saveSnapshot(HouseSnapshot& out, const std::vector<const Entity*>& entities) const;
+    void restoreSnapshot(const HouseSnapshot& in, const std::vector<const Entity*>& entities);
     
     // AI Integration
     bool isStorageFull() const;  // Check if storage is full
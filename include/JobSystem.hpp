@@ -0,0 +1,133 @@
+#ifndef JOB_SYSTEM_HPP
+#define JOB_SYSTEM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Per-thread bump allocator for short-lived scratch memory inside jobs. Every thread (workers
+// and the main thread) has its own; the job system rewinds it after each job, so memory
+// taken inside a job is valid until that job returns. Only trivially destructible data.
+class ScratchArena {
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+    std::vector<Block> blocks;
+    size_t block = 0;  // current block
+    size_t offset = 0; // bytes used in it
+
+public:
+    struct Mark {
+        size_t block;
+        size_t offset;
+    };
+
+    static ScratchArena& local(); // the calling thread's arena
+
+    void* allocateBytes(size_t bytes, size_t alignment);
+    template <typename T>
+    T* allocate(size_t count) { return static_cast<T*>(allocateBytes(sizeof(T) * count, alignof(T))); }
+
+    Mark mark() const { return {block, offset}; }
+    void rewind(Mark to) { block = to.block; offset = to.offset; }
+    size_t capacity() const;
+};
+
+// Work-stealing scheduler shared by the simulation stages. Each worker owns a deque: it pops
+// its own newest job, and idle workers steal the oldest jobs of others. Threads outside the
+// pool submit through an injection queue and help run jobs while they wait, so waiting never
+// blocks a core. Jobs can depend on other jobs (task graphs) and parallelFor splits an index
+// range into chunks.
+class JobSystem {
+public:
+    struct Job;
+    using JobHandle = std::shared_ptr<Job>;
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<JobHandle> jobs;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Queue>> queues; // one per worker, then the injection queue
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<int> queuedJobs{0};
+    std::atomic<bool> stopping{false};
+
+    void workerLoop(size_t index);
+    void enqueue(JobHandle job);
+    JobHandle takeJob(size_t home); // own queue first, then steal
+    void execute(const JobHandle& job);
+    size_t currentQueue() const;    // the calling worker's queue, or the injection queue
+
+public:
+    struct Job {
+        std::function<void()> work;
+        std::atomic<int> pending{1}; // unfinished dependencies + the submit guard
+        std::atomic<bool> done{false};
+        std::mutex mutex;            // guards continuations / done transition
+        std::vector<JobHandle> continuations;
+    };
+
+    // workerCount 0 = one worker per hardware thread beyond the caller's
+    explicit JobSystem(unsigned workerCount = 0);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    unsigned getWorkerCount() const { return static_cast<unsigned>(workers.size()); }
+    unsigned getConcurrency() const { return getWorkerCount() + 1; } // workers + the waiting caller
+
+    // Runs `work` once every job in `dependencies` has finished
+    JobHandle submit(std::function<void()> work, std::initializer_list<JobHandle> dependencies = {});
+    JobHandle submit(std::function<void()> work, const std::vector<JobHandle>& dependencies);
+    void wait(const JobHandle& job);         // runs other jobs until `job` is done
+    void waitAll(const std::vector<JobHandle>& jobs);
+
+    // body(first, last) over [begin, end) in chunks of at least `grain` indices; returns when
+    // all chunks are done. Small ranges run inline.
+    template <typename Body>
+    void parallelFor(size_t begin, size_t end, size_t grain, Body&& body);
+};
+
+// Shared scheduler used by Game and the tools
+JobSystem& getJobSystem();
+
+template <typename Body>
+void JobSystem::parallelFor(size_t begin, size_t end, size_t grain, Body&& body) {
+    if (end <= begin) return;
+    const size_t count = end - begin;
+    grain = std::max<size_t>(grain, 1);
+    // a few chunks per thread so stealing can even out uneven chunks
+    const size_t chunk = std::max(grain, (count + getConcurrency() * 4 - 1) / (getConcurrency() * 4));
+    if (workers.empty() || count <= chunk) {
+        body(begin, end);
+        return;
+    }
+
+    std::vector<JobHandle> chunks;
+    chunks.reserve((count + chunk - 1) / chunk);
+    for (size_t first = begin + chunk; first < end; first += chunk) {
+        const size_t last = std::min(end, first + chunk);
+        chunks.push_back(submit([&body, first, last] { body(first, last); }));
+    }
+    // the caller takes the first chunk itself
+    const ScratchArena::Mark mark = ScratchArena::local().mark();
+    body(begin, std::min(end, begin + chunk));
+    ScratchArena::local().rewind(mark);
+    waitAll(chunks);
+}
+
+#endif
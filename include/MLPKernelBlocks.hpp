@@ -0,0 +1,124 @@
+#ifndef MLP_KERNEL_BLOCKS_HPP
+#define MLP_KERNEL_BLOCKS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Cache and register blocking shared by the kernel translation units (MLPKernels.cpp for the
+// baseline instruction set, MLPKernelsAVX2.cpp built with AVX2 flags). Each unit instantiates
+// the templates with vector operations declared in its own unnamed namespace, so the
+// instantiations never leave the unit that was compiled for them. For the same reason nothing
+// here may pull in out-of-line library code.
+namespace MLPKernels::blocks {
+
+    constexpr int kPanelWidth = 16; // output columns per weight panel
+    constexpr int kRowTile = 4;     // batch rows sharing one pass over a panel
+    constexpr int kInt8Group = 8;   // int8 outputs per weight load (16 bytes = 8 outputs x 2 inputs)
+
+    // Two adjacent int8 activations as the 32-bit pattern a 16-bit multiply-add expects
+    static inline uint32_t activationPair(const int8_t* x) {
+        return static_cast<uint16_t>(static_cast<int16_t>(x[0])) |
+               (static_cast<uint32_t>(static_cast<uint16_t>(static_cast<int16_t>(x[1]))) << 16);
+    }
+
+    // Register-blocked ROWS x COLS tile: accumulators stay in registers for the whole K loop
+    template <class Ops, int ROWS, int COLS>
+    inline void microKernel(const float* w, int wStride, const float* bias,
+                            const float* x, int xStride, float* y, int yStride,
+                            int inputs, bool applyRelu) {
+        using Vec = typename Ops::Vec;
+        constexpr int VECS = COLS / Ops::kLanes;
+        Vec acc[ROWS][VECS];
+
+        for (int v = 0; v < VECS; ++v) {
+            Vec b = Ops::load(bias + v * Ops::kLanes);
+            for (int r = 0; r < ROWS; ++r) acc[r][v] = b;
+        }
+
+        for (int k = 0; k < inputs; ++k) {
+            const float* wRow = w + static_cast<size_t>(k) * wStride;
+            Vec wv[VECS];
+            for (int v = 0; v < VECS; ++v) wv[v] = Ops::load(wRow + v * Ops::kLanes);
+
+            for (int r = 0; r < ROWS; ++r) {
+                Vec xv = Ops::broadcast(x + static_cast<size_t>(r) * xStride + k);
+                for (int v = 0; v < VECS; ++v) acc[r][v] = Ops::fma(xv, wv[v], acc[r][v]);
+            }
+        }
+
+        for (int r = 0; r < ROWS; ++r) {
+            float* out = y + static_cast<size_t>(r) * yStride;
+            for (int v = 0; v < VECS; ++v) {
+                Ops::store(out + v * Ops::kLanes, applyRelu ? Ops::relu(acc[r][v]) : acc[r][v]);
+            }
+        }
+    }
+
+    template <class Ops, int COLS>
+    inline void panel(const float* w, int wStride, const float* bias,
+                      const float* x, int xStride, float* y, int yStride,
+                      int batch, int inputs, bool applyRelu) {
+        int row = 0;
+        for (; row + kRowTile <= batch; row += kRowTile) {
+            microKernel<Ops, kRowTile, COLS>(w, wStride, bias, x + static_cast<size_t>(row) * xStride, xStride,
+                                             y + static_cast<size_t>(row) * yStride, yStride, inputs, applyRelu);
+        }
+        for (; row < batch; ++row) {
+            microKernel<Ops, 1, COLS>(w, wStride, bias, x + static_cast<size_t>(row) * xStride, xStride,
+                                      y + static_cast<size_t>(row) * yStride, yStride, inputs, applyRelu);
+        }
+    }
+
+    // Column panels outermost: a 16-wide panel of a 128-input layer is 8KB and stays hot in L1
+    // while every batch row streams through it
+    template <class Ops>
+    void denseForward(const float* packedWeights, const float* bias,
+                      const float* x, int xStride, float* y, int yStride,
+                      int batch, int inputs, int paddedOutputs, bool relu) {
+        int col = 0;
+        for (; col + kPanelWidth <= paddedOutputs; col += kPanelWidth) {
+            panel<Ops, kPanelWidth>(packedWeights + col, paddedOutputs, bias + col,
+                                    x, xStride, y + col, yStride, batch, inputs, relu);
+        }
+        if (col < paddedOutputs) { // remaining 8 columns (outputs are padded to multiples of 8)
+            panel<Ops, 8>(packedWeights + col, paddedOutputs, bias + col,
+                          x, xStride, y + col, yStride, batch, inputs, relu);
+        }
+    }
+
+    // Int8 outer loops; Int8::run<ROWS> computes ROWS batch rows x kInt8Group outputs
+    template <class Int8>
+    void denseForwardInt8(const int8_t* packedWeights, const float* outputScales, const float* bias,
+                          const int8_t* x, int xStride, float* y, int yStride,
+                          int batch, int paddedInputs, int paddedOutputs, bool relu) {
+        const int pairs = paddedInputs / 2;
+        const int wStride = paddedOutputs * 2; // bytes per input pair row
+
+        for (int col = 0; col < paddedOutputs; col += kInt8Group) {
+            const int8_t* w = packedWeights + static_cast<size_t>(col) * 2;
+            int row = 0;
+            for (; row + kRowTile <= batch; row += kRowTile) {
+                Int8::template run<kRowTile>(w, wStride, outputScales + col, bias + col,
+                                             x + static_cast<size_t>(row) * xStride, xStride,
+                                             y + static_cast<size_t>(row) * yStride + col, yStride, pairs, relu);
+            }
+            for (; row < batch; ++row) {
+                Int8::template run<1>(w, wStride, outputScales + col, bias + col,
+                                      x + static_cast<size_t>(row) * xStride, xStride,
+                                      y + static_cast<size_t>(row) * yStride + col, yStride, pairs, relu);
+            }
+        }
+    }
+}
+
+// AVX2 + FMA kernels (MLPKernelsAVX2.cpp); only called after MLPKernels has checked the CPU
+namespace MLPKernels::avx2 {
+    void denseForward(const float* packedWeights, const float* bias,
+                      const float* x, int xStride, float* y, int yStride,
+                      int batch, int inputs, int paddedOutputs, bool relu);
+    void denseForwardInt8(const int8_t* packedWeights, const float* outputScales, const float* bias,
+                          const int8_t* x, int xStride, float* y, int yStride,
+                          int batch, int paddedInputs, int paddedOutputs, bool relu);
+}
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef MLP_KERNELS_HPP
+#define MLP_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Dense-layer kernels used by the native policy network.
+// Weights are packed as [inputs][paddedOutputs] (the Keras kernel layout with every
+// row padded to a multiple of kOutputAlignment floats), activations are row-major
+// [batch][stride]. The kernel walks the weight matrix in column panels so one panel
+// stays in L1 while every batch row is pushed through it.
+namespace MLPKernels {
+
+    constexpr int kOutputAlignment = 8;  // floats per SIMD lane group (AVX2 width)
+
+    // Round an output count up to the packed width
+    constexpr int paddedSize(int outputs) {
+        return (outputs + kOutputAlignment - 1) / kOutputAlignment * kOutputAlignment;
+    }
+
+    // Y[b][0..paddedOutputs) = act(X[b][0..inputs) * W + bias) for every row b < batch.
+    // xStride/yStride are in floats; yStride must be >= paddedOutputs.
+    void denseForward(const float* packedWeights, const float* bias,
+                      const float* x, int xStride,
+                      float* y, int yStride,
+                      int batch, int inputs, int paddedOutputs, bool relu);
+
+    // Int8 variant for the quantized policy. Weights are packed in input pairs,
+    // [paddedInputs / 2][paddedOutputs][2], so one 16-byte load feeds 8 outputs x 2 inputs
+    // to a 16-bit multiply-add. x holds symmetric int8 activations [batch][xStride];
+    // paddedInputs must be even. Output is dequantized in the epilogue:
+    //   Y[b][o] = act(sum_k x[b][k] * W[k][o] * outputScales[o] + bias[o])
+    void denseForwardInt8(const int8_t* packedWeights, const float* outputScales, const float* bias,
+                          const int8_t* x, int xStride,
+                          float* y, int yStride,
+                          int batch, int paddedInputs, int paddedOutputs, bool relu);
+
+    // q = clamp(round(x * invScale), -127, 127) for the first `count` columns of every row
+    void quantizeRows(const float* x, int xStride, int8_t* q, int qStride,
+                      int batch, int count, float invScale);
+
+    // Name of the instruction set the kernels run on ("AVX2", "NEON" or "Scalar"); AVX2 is
+    // chosen at runtime, so one x86 binary runs on CPUs with or without it
+    const char* instructionSet();
+}
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef MAP_GENERATOR_HPP
+#define MAP_GENERATOR_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "Object.hpp"
+
+class JobSystem;
+
+enum class Terrain : uint8_t { Flower, Grass, Stone };
+
+// A generated map as flat row-major arrays; Game turns it into Tiles and Objects
+struct MapLayout {
+    int width = 0;
+    int height = 0;
+    std::vector<float> noise;            // normalized [0, 1]
+    std::vector<Terrain> terrain;
+    std::vector<uint8_t> terrainVariant; // texture variant of the tile
+    std::vector<ObjectType> objects;     // ObjectType::None when empty
+    std::vector<uint8_t> objectVariant;
+    std::vector<uint32_t> houses;        // tile indices, in placement order
+    std::vector<uint32_t> markets;
+
+    size_t index(int x, int y) const { return static_cast<size_t>(y) * width + x; }
+};
+
+// Perlin noise for whole rows at a time, bit-compatible with FastNoiseLite's 2D Perlin (no
+// fractal) for GetNoise(row, column). Column lattice terms are computed once per map; per
+// row, the four corner gradients are hashed once per lattice cell and the columns inside the
+// cell run as a branch-free multiply-add loop the compiler vectorizes.
+class PerlinRows {
+private:
+    int seed;
+    float frequency;
+    int width;
+    int firstColumn;
+    std::vector<int> columnCell;     // lattice cell of each column, cells are contiguous runs
+    std::vector<float> columnOffset; // yd0: offset inside the cell
+    std::vector<float> columnBlend;  // quintic blend of yd0
+
+public:
+    PerlinRows(int seed, float frequency, int width, int firstColumn = 0);
+    void row(int y, float* out) const; // raw noise in [-1, 1] for columns [firstColumn, firstColumn + width)
+};
+
+// Builds the terrain, resources, houses and markets of a map. Rows are generated in parallel
+// blocks on the job system; randomness comes from a hash of (seed, tile), so the result only
+// depends on the settings, not on how the blocks were scheduled.
+class MapGenerator {
+public:
+    struct Settings {
+        int width = 0;
+        int height = 0;
+        int seed = 0;
+        float frequency = 0.1f;
+        int houseCount = 0;
+        int marketCount = 0;
+        uint8_t grassVariants = 3, stoneVariants = 3, flowerVariants = 5;
+        uint8_t treeVariants = 3, bushVariants = 2, rockVariants = 3;
+        uint8_t houseVariants = 3, marketVariants = 3;
+    };
+
+    struct Building {
+        uint32_t tile; // row-major index
+        ObjectType type;
+        uint8_t variant;
+    };
+
+    static Terrain terrainFor(float noiseValue); // the biome bands
+    // Texture variant of world tile (x, y), the same value generate() stores in terrainVariant
+    static uint8_t terrainVariantAt(const Settings& settings, Terrain terrain, int x, int y);
+
+    MapLayout generate(const Settings& settings) const;
+    MapLayout generate(const Settings& settings, JobSystem& jobs) const;
+    // Terrain and resources of the world rectangle [x, x + width) x [y, y + height), clipped to
+    // the map, on the calling thread and without buildings; tiles match generate()'s exactly
+    MapLayout generateRegion(const Settings& settings, int x, int y, int width, int height) const;
+    // The houses and markets generate() places, in the same order (houses first), without
+    // keeping the map: free tiles are counted per row in parallel and only rows holding a
+    // pick are filled again
+    std::vector<Building> placeBuildings(const Settings& settings, JobSystem& jobs) const;
+};
+
+#endif
@@ -10,12 +10,18 @@
 
 #include "Entity.hpp"  
 #include "Object.hpp"
+#include "OrderBook.hpp"
 #include "debug.hpp"
 
 class NPCEntity;
+struct MarketSnapshot;
+struct NpcSnapshot;
 
 // Represents a dynamic in-game trading system
 class Market : public Object {
+public:
+    using TraderTable = std::unordered_map<uint32_t, NPCEntity*>; // Trader id (NPCEntity::getHandle) -> NPC
+
 private:
     std::unordered_map<std::string, float> prices;          // Stores the current market price for each item
     std::unordered_map<std::string, int> demand;           // Tracks the demand level for each item
@@ -32,6 +38,22 @@ private:
     float sellMargin = 0.9f;                               // Selling price multiplier (lower than buy price)
     float buyMargin = 1.1f;                                // Buying price multiplier (higher than sell price)
 
+    // Order book trading (see postBid/runAuctions)
+    std::unordered_map<std::string, OrderBook> orderBooks; // One limit order book per item
+    std::vector<OrderBook::Settlement> settlements;        // Reused by every auction
+    std::unordered_map<std::string, int> auctionVolume;    // Units auctioned per item since the last dynamics step
+    static constexpr int32_t makerDepth = 20;              // Units the market quotes on each side of an auction
+    struct TraderSettlement {                              // One trader's fills in an auction, summed
+        NPCEntity* npc = nullptr;                          // Null when the trader is gone
+        int room = 0;                                      // Inventory space left for incoming units
+        int units = 0;
+        float money = 0.0f;
+        int reward = 0;
+    };
+    std::vector<TraderSettlement> traderSettlements;       // Reused by every auction
+    std::unordered_map<uint32_t, uint32_t> traderSlots;    // Trader id -> index into traderSettlements, this auction
+    size_t settle(const std::string& item, int32_t price, const TraderTable& traders); // returns traders settled
+
 public:
     Market();
     Market(const sf::Texture& tex);
@@ -46,6 +68,18 @@ public:
     bool buyItem(Entity& entity, const std::string& item, int quantity); // Handles entity purchasing an item
     bool sellItem(Entity& entity, const std::string& item, int quantity); // Handles entity selling an item
 
+    // Order book: a bid escrows limit * quantity money and an ask the items when posted; they
+    // settle at the following auctions (a limit of 0 takes the market's current quote). Every
+    // auction the market also quotes its own stock on both sides, so a lone order still finds a
+    // counterparty, and the price moves toward each clearing price. Trader ids are looked up in
+    // the table given to runAuctions; a trader missing from it forfeits its escrow.
+    static constexpr uint32_t marketMakerId = UINT32_MAX;
+    bool postBid(NPCEntity& npc, uint32_t trader, const std::string& item, int quantity, float limitPrice = 0.0f);
+    bool postAsk(NPCEntity& npc, uint32_t trader, const std::string& item, int quantity, float limitPrice = 0.0f);
+    void cancelOrders(uint32_t trader, NPCEntity* npc = nullptr); // refunds the escrow to `npc` when given
+    int runAuctions(const TraderTable& traders);                  // one call auction per book; returns units traded
+    size_t getOpenOrderCount() const;
+
     // Adjust Prices Dynamically
     float adjustPriceOnBuy(float currentPrice, int demand, int supply, float buyFactor); // Modify price on purchase
     float adjustPriceOnSell(float currentPrice, int demand, int supply, float sellFactor); // Modify price on sale
@@ -72,10 +106,18 @@ public:
 
     // Dynamic Market Adjustments
     void stabilizePrices(float deltaTime);        // Slowly stabilizes market prices over time
-    void simulateMarketDynamics(float deltaTime); // Simulates price variations due to economic forces
+    static constexpr float dynamicsInterval = 2.0f; // Seconds between simulateMarketDynamics() steps
+    void simulateMarketDynamics(); // One step of price variation due to economic forces (scheduled by Game)
     void resetTransactions(); // Resets all transaction history
     void randomizePrices();   // Introduces random fluctuations in prices
     void debugTransactionState() const; // Logs current market state for debugging
+
+    // Snapshots: prices, supply/demand, statistics and history per item. The books are not kept:
+    // returnEscrow hands what each open order escrowed back to its owner's NpcSnapshot (keyed by
+    // trader id), and a restored market starts with empty books
+    void saveSnapshot(MarketSnapshot& out) const;
+    void returnEscrow(MarketSnapshot& out, const std::unordered_map<uint32_t, NpcSnapshot*>& owners) const;
+    void restoreSnapshot(const MarketSnapshot& in);
     
     // UI and Rendering
     void renderPriceGraph(sf::RenderWindow& window, const std::string& item, sf::Vector2f position, sf::Vector2f size) const; // Renders price trends
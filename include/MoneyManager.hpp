@@ -22,6 +22,10 @@ public:
     // get total money spent and earned
     static int getTotalMoneySpent() { return totalMoneySpent; }
     static int getTotalMoneyEarned() { return totalMoneyEarned; }
+    static void restoreTotals(int spent, int earned) { // from a snapshot
+        totalMoneySpent = spent;
+        totalMoneyEarned = earned;
+    }
 
 private:
     static inline int totalMoneySpent = 0;  // Define inside the class with `inline`
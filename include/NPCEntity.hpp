@@ -16,9 +16,11 @@
 #include "Configuration.hpp"
 #include "TFWrapper.hpp"
 #include "House.hpp"
+#include "TimerWheel.hpp"
 
 class Action; 
 class Market;
+struct NpcSnapshot;
 
 // ???? why is it here 
 enum class NPCState {
@@ -40,6 +42,8 @@ private:
     std::unordered_map<std::string, int> inventory; // Map for items and their quantities
     int inventoryCapacity = 10;                     // Max inventory capacity
     std::string name;                               // NPC's name
+    uint16_t recorderId = 0;                        // DataCollector id, so recording never passes the name
+    uint32_t handle = 0;                            // Unique per NPC for the whole run (see getHandle)
     float baseSpeed = 150.0f;                       // Default base speed
     float currentSpeed = baseSpeed;                 // Current movement speed
     int deathPenalty = -100;                        // Penalty for NPC death
@@ -53,6 +57,10 @@ private:
     std::shared_ptr<TensorFlowWrapper> tfModel; 
     int totalItemsGathered = 0;
     std::unordered_map<std::string, int> itemsGatheredByType;
+    ActionType pendingAction = ActionType::None;    // Action precomputed by the per-tick batched policy pass
+    sf::Vector2f avoidance{0.0f, 0.0f};             // Separation from nearby NPCs, set each tick by Game
+    TimerWheel::TimerId wakeTimer = 0;              // Cooldown wake-up on the simulation timers (0 = counts down in update)
+    float sleepStart = 0.0f;                        // simulation time its vitals are current to while asleep
 
 public:
     // Constructor
@@ -69,6 +77,8 @@ public:
 
     // Getters
     const std::string& getName() const;
+    uint16_t getRecorderId() const { return recorderId; } // stable per name, shared past 65,536 names
+    uint32_t getHandle() const { return handle; } // never reused in a run: wake-ups and market orders name NPCs by it
     float getMaxEnergy() const;
     float getBaseSpeed() const;
     float getEnergyPercentage() const;
@@ -99,6 +109,8 @@ public:
     // Inventory Management
     bool addToInventory(const std::string& item, int quantity);
     bool removeFromInventory(const std::string& item, int quantity);
+    // One market settlement at once, without logging; the market has already checked the room
+    void settleTrade(const std::string& item, int units, float money, int reward);
     int getInventoryItemCount(const std::string& item) const;
 
     // Reward and Penalty Management
@@ -111,11 +123,11 @@ public:
 
     // Health Management
     void restoreHealth(float amount);
-    void reduceHealth(float amount);
+    void reduceHealth(float amount, bool logChange = true); // per-step callers on workers pass false
 
     // AI Decision Making
     ActionType decideNextAction(const std::vector<std::vector<std::unique_ptr<Tile>>>& tileMap, const House& house, Market& market);
-    std::vector<ObjectType> scanNearbyTiles(const std::vector<std::vector<std::unique_ptr<Tile>>>& tileMap) const;
+    NeighborhoodCounts scanNearbyTiles(const std::vector<std::vector<std::unique_ptr<Tile>>>& tileMap) const;
     Tile* findNearestTile(const std::vector<std::vector<std::unique_ptr<Tile>>>& tileMap, ObjectType type) const;
     Tile* getTarget() const; 
 
@@ -131,6 +143,31 @@ public:
     void enableTensorFlow(bool enable);
     void setTensorFlowModel(std::shared_ptr<TensorFlowWrapper> model);
     bool isTensorFlowEnabled() const { return useTensorFlow; }
+    bool usesPolicyNetwork() const { return useTensorFlow && tfModel && tfModel->isModelLoaded(); }
+    TensorFlowWrapper* getTensorFlowModel() const { return tfModel.get(); }
+
+    // Batched decisions: Game extracts states for all idle NPCs, runs one forward pass
+    // and hands each NPC its action; decideNextAction then consumes it instead of running the model.
+    void setPendingDecision(const State& state, ActionType action);
+
+    // Steering away from crowding neighbours (length <= 1), blended into movement by Game
+    void setAvoidance(sf::Vector2f steer) { avoidance = steer; }
+    sf::Vector2f getAvoidance() const { return avoidance; }
+
+    // Cooldowns driven by the simulation timers: Game parks a cooling-down NPC on a wake-up
+    // and skips it until the timer fires, instead of re-polling it every frame. Its vitals
+    // are caught up from sleepStart when it wakes (see Game::catchUpVitals).
+    float getActionCooldown() const { return currentActionCooldown; }
+    TimerWheel::TimerId getWakeTimer() const { return wakeTimer; }
+    bool isSleeping() const { return wakeTimer != 0; }
+    void sleepUntil(TimerWheel::TimerId timer, float since = 0.0f) { wakeTimer = timer; sleepStart = since; }
+    float getSleepStart() const { return sleepStart; }
+    void wakeUp() { wakeTimer = 0; currentActionCooldown = 0.0f; }
+
+    // Simulation snapshots: vitals, inventory, behaviour state and the Q-learning agent. Target,
+    // house, policy model and wake-up timer are relinked by Game, which owns what they point to.
+    void saveSnapshot(NpcSnapshot& out) const;
+    void restoreSnapshot(const NpcSnapshot& in);
 
     // Inventory Capacity Upgrades
     void upgradeInventoryCapacity(int extraSlots);
@@ -0,0 +1,83 @@
+#ifndef NUMPY_IO_HPP
+#define NUMPY_IO_HPP
+
+#include "State.hpp"
+#include "ActionType.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Minimal writer/reader for NumPy's .npy arrays and uncompressed .npz archives,
+// so exported experiences load with np.load() without any parsing step.
+//
+// Experience archives hold five arrays (little-endian):
+//   states      int32 [n, 7]   (posX, posY, nearbyTrees, nearbyRocks, nearbyBushes, energyLevel, inventoryLevel)
+//   actions     int32 [n]      (ActionType values)
+//   rewards     float32 [n]
+//   next_states int32 [n, 7]
+//   dones       bool [n]
+namespace NumpyIO {
+
+    constexpr int kStateColumns = 7;
+
+    // Column-major copy of a batch of experiences, ready to be written as arrays
+    struct ExperienceColumns {
+        std::vector<int32_t> states;
+        std::vector<int32_t> actions;
+        std::vector<float> rewards;
+        std::vector<int32_t> nextStates;
+        std::vector<uint8_t> dones;
+
+        size_t size() const { return actions.size(); }
+        void reserve(size_t count);
+        void clear();
+        void append(const State& state, ActionType action, float reward, const State& nextState, bool done);
+        void append(const ExperienceColumns& other);
+        void appendRow(const ExperienceColumns& other, size_t row);
+    };
+
+    // CRC-32 (zip polynomial); pass the previous value to continue a running checksum
+    uint32_t crc32(const void* data, size_t size, uint32_t crc = 0);
+
+    // .npy v1.0 header for a C-order array, padded to a 64-byte boundary
+    std::string npyHeader(const std::string& descr, const std::vector<size_t>& shape);
+
+    // Parse a v1/v2 .npy header (C order only); returns the data offset or 0 on failure
+    size_t parseNpyHeader(const char* data, size_t size, std::string& descr, std::vector<size_t>& shape);
+
+    bool writeNpy(const std::string& path, const std::string& descr, const std::vector<size_t>& shape,
+                  const void* data, size_t bytes);
+
+    // Streams arrays into a stored (uncompressed) zip, the layout np.savez produces
+    class NpzWriter {
+    private:
+        struct Entry {
+            std::string name;
+            uint32_t crc;
+            uint32_t size;
+            uint32_t offset;
+        };
+        std::ofstream file;
+        std::vector<Entry> entries;
+        bool failed = false;
+
+    public:
+        explicit NpzWriter(const std::string& path);
+        ~NpzWriter();
+
+        // name without the ".npy" suffix, e.g. "rewards"
+        bool add(const std::string& name, const std::string& descr, const std::vector<size_t>& shape,
+                 const void* data, size_t bytes);
+        bool close();
+    };
+
+    bool writeExperienceNpz(const std::string& path, const ExperienceColumns& columns);
+
+    // Appends the arrays of an archive written by writeExperienceNpz to `columns`
+    bool readExperienceNpz(const std::string& path, ExperienceColumns& columns);
+}
+
+#endif
@@ -3,6 +3,8 @@
 
 #include <SFML/Graphics.hpp>
 
+#include <cstdint>
+
 // Enum representing different types of objects that can exist in the game world
 enum class ObjectType {
     None,   // No object
@@ -20,6 +22,7 @@ class Object {
 protected:
     sf::Sprite sprite;  // Sprite representing the object
     sf::Texture texture; // Texture applied to the sprite
+    uint8_t variant = 0; // which of its kind's textures, as the world chunks record it
 
 public:
     virtual ~Object() = default; // Virtual destructor for polymorphism
@@ -53,6 +56,9 @@ public:
         sprite.setScale(scaleX, scaleY);  
     }
 
+    uint8_t getVariant() const { return variant; }
+    void setVariant(uint8_t textureVariant) { variant = textureVariant; }
+
     // Set the texture for the object (defined in the base class)
     void setTexture(const sf::Texture& tex) {
         texture = tex;
@@ -0,0 +1,86 @@
+#ifndef OBJECT_LAYERS_HPP
+#define OBJECT_LAYERS_HPP
+
+#include "Object.hpp"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class Tile;
+using TileGrid = std::vector<std::vector<std::unique_ptr<Tile>>>;
+
+constexpr int kObjectTypeCount = static_cast<int>(ObjectType::Food) + 1;
+
+// Objects of each type in a 3x3 neighbourhood (fixed size, no allocation)
+struct NeighborhoodCounts {
+    std::array<uint8_t, kObjectTypeCount> counts{};
+
+    int operator[](ObjectType type) const { return counts[static_cast<int>(type)]; }
+    int total() const;
+};
+
+// One bitboard per ObjectType over the tile grid (a row of 64-bit words per map row).
+// Tiles attached to the layers keep them current from placeObject/removeObject, so
+// neighbourhood counts are a shift, a mask and a popcount per row instead of nine tile lookups.
+class ObjectLayers {
+private:
+    int width = 0;
+    int height = 0;
+    int wordsPerRow = 0;
+    std::array<std::vector<uint64_t>, kObjectTypeCount> layers;
+
+    uint64_t* row(ObjectType type, int y) { return layers[static_cast<int>(type)].data() + y * wordsPerRow; }
+    const uint64_t* row(ObjectType type, int y) const { return layers[static_cast<int>(type)].data() + y * wordsPerRow; }
+    uint64_t columns(const uint64_t* bits, int first, int count) const; // bits [first, first + count) of a row
+
+    // Optional 2D Fenwick trees, (width + 1) x (height + 1) per type (1-based). Kept current by
+    // set/reset in O(log W * log H), and any window is four prefix sums of the same cost.
+    std::array<std::vector<int32_t>, kObjectTypeCount> areaSums;
+    bool areaSumsEnabled = false;
+    void addToAreaSums(ObjectType type, int x, int y, int delta);
+    int areaPrefix(ObjectType type, int x, int y) const; // objects in [0, x) x [0, y)
+
+public:
+    // Told about every bit that actually flips (placed = set, otherwise reset)
+    using ChangeListener = std::function<void(ObjectType type, int x, int y, bool placed)>;
+
+private:
+    ChangeListener changeListener;
+
+public:
+    void resize(int mapWidth, int mapHeight); // clears every layer
+    void clear();
+
+    // Attach every tile of the grid and load the objects already on it
+    void attach(TileGrid& tileMap);
+
+    void set(ObjectType type, int x, int y);
+    void reset(ObjectType type, int x, int y);
+    bool test(ObjectType type, int x, int y) const;
+    void setChangeListener(ChangeListener listener) { changeListener = std::move(listener); }
+
+    // Build the Fenwick trees from the bitboards in O(W * H); afterwards every edit updates them
+    // and wide counts cost O(log W * log H) instead of a popcount per row
+    void enableAreaSums();
+    bool hasAreaSums() const { return areaSumsEnabled; }
+
+    // Objects of `type` in the (2 * radius + 1)^2 square around (x, y), clipped to the map
+    int countAround(ObjectType type, int x, int y, int radius = 1) const;
+    NeighborhoodCounts neighborhood(int x, int y) const;
+
+    // 0 none, 1 sparse (under 1/16 of the window), 2 some (under 1/4), 3 dense
+    static int densityLevel(int count, int radius);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // 3x3 counts around tile (x, y): bitboards when the grid is attached, tile walk otherwise
+    static NeighborhoodCounts neighborhood(const TileGrid& tileMap, int x, int y);
+    // Density level of `type` within `radius` of tile (x, y), same fallback
+    static int densityLevel(const TileGrid& tileMap, ObjectType type, int x, int y, int radius);
+};
+
+#endif
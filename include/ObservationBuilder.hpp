@@ -0,0 +1,74 @@
+#ifndef OBSERVATION_BUILDER_HPP
+#define OBSERVATION_BUILDER_HPP
+
+#include "ObjectLayers.hpp"
+
+#include <cstdint>
+#include <vector>
+
+class NPCEntity;
+class Market;
+
+enum class TileKind : uint8_t { None = 0, Grass, Stone, Flower, Water };
+constexpr int kTileKindCount = static_cast<int>(TileKind::Water) + 1;
+
+// Egocentric observations for a batch of NPCs, one contiguous row per NPC. The buffers
+// are kept between ticks, so building a batch allocates only when it grows.
+struct ObservationBatch {
+    int count = 0;
+    int side = 0;         // K, the patch is K x K tiles centred on the NPC
+    int featureCount = 0; // floats per row
+
+    std::vector<uint8_t> patches; // [count][K * K] cell codes: tile kind << 4 | object type
+    std::vector<float> features;  // [count][featureCount] network input, see ObservationBuilder
+
+    const uint8_t* patch(int i) const { return patches.data() + static_cast<size_t>(i) * side * side; }
+    const float* row(int i) const { return features.data() + static_cast<size_t>(i) * featureCount; }
+};
+
+// Builds ObservationBatch rows from the tile grid. attach() records every tile's kind once
+// (classifyArea() those built later, when their chunk arrives); refresh() re-reads the
+// objects into a byte grid padded by the patch radius, so a patch is K row copies with no
+// bounds checks. Feature row layout:
+//   kScalarCount scalars  posX, posY (0-1 of the map), health, energy, hunger, money (/100),
+//                         inventory fill, wood, stone, bush (of max inventory),
+//                         wood, stone, bush market prices (/100)
+//   K * K cells           kCellChannels each: one-hot object type (Tree..Food), one-hot tile kind
+class ObservationBuilder {
+private:
+    int radius;
+    int side;
+    int mapWidth = 0;
+    int mapHeight = 0;
+    int paddedWidth = 0;
+    const TileGrid* tileMap = nullptr;
+    std::vector<uint8_t> kinds; // [mapHeight][mapWidth] TileKind, set once a tile exists
+    std::vector<uint8_t> cells; // [mapHeight + 2r][mapWidth + 2r] cell codes, border 0
+
+public:
+    static constexpr int kScalarCount = 13;
+    static constexpr int kObjectChannels = kObjectTypeCount - 1; // ObjectType::None has no channel
+    static constexpr int kCellChannels = kObjectChannels + kTileKindCount - 1;
+
+    explicit ObservationBuilder(int patchRadius = 2);
+
+    void attach(const TileGrid& grid); // classify tiles and refresh
+    void classifyArea(int x0, int y0, int x1, int y1); // inclusive rectangle whose tiles were just built
+    void refresh();                    // re-read objects, once per tick before build()
+
+    // One pass over `count` NPCs; rows are written in the given order
+    void build(const NPCEntity* const* npcs, int count, const Market& market, ObservationBatch& batch) const;
+
+    int getRadius() const { return radius; }
+    int getFeatureCount() const { return featureCountFor(radius); }
+    static int featureCountFor(int patchRadius) {
+        return kScalarCount + (2 * patchRadius + 1) * (2 * patchRadius + 1) * kCellChannels;
+    }
+    static int radiusForFeatureCount(int featureCount); // -1 if no radius produces that many features
+
+    static uint8_t cellCode(TileKind kind, ObjectType object) {
+        return static_cast<uint8_t>(static_cast<int>(kind) << 4 | static_cast<int>(object));
+    }
+};
+
+#endif
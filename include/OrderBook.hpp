@@ -0,0 +1,71 @@
+#ifndef ORDER_BOOK_HPP
+#define ORDER_BOOK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Limit order book for one item, cleared by a call auction. Orders collect between auctions;
+// an auction picks the single price that executes the most units (then the smallest
+// imbalance, then the price closest to the reference), fills bids from the highest limit and
+// asks from the lowest, earlier orders first at equal limits, and leaves the rest resting
+// until they expire. Prices are integer ticks so priority and the clearing price are exact.
+// Buffers are kept between auctions: once warmed up, posting and clearing do not allocate.
+class OrderBook {
+public:
+    enum class Side : uint8_t { Bid, Ask };
+
+    // What happened to one order: units filled at the clearing price and units released
+    // (expired or cancelled). The caller settles its escrow from these.
+    struct Settlement {
+        uint32_t trader;
+        Side side;
+        int32_t filled;
+        int32_t released;
+        int32_t limit; // ticks; a bid escrowed limit * quantity
+    };
+
+    struct AuctionResult {
+        int32_t price = 0;  // clearing price in ticks, 0 when nothing traded
+        int32_t volume = 0; // units traded
+    };
+
+    explicit OrderBook(uint32_t maxAge = 600); // auctions an order takes part in before it is released
+
+    bool post(Side side, uint32_t trader, int32_t limit, int32_t quantity); // false for a non-positive limit or quantity
+    // Releases every order of `trader` right away (appended to `released`)
+    void cancel(uint32_t trader, std::vector<Settlement>& released);
+    void clear(); // drops every order without settlements
+    // Every resting order as `cancel` would release it, leaving the book as it is
+    void collectOpen(std::vector<Settlement>& open) const;
+
+    // Clears the book once; fills and expiries are appended to `settlements`
+    AuctionResult auction(int32_t referencePrice, std::vector<Settlement>& settlements);
+
+    size_t getBidCount() const { return bids.size(); }
+    size_t getAskCount() const { return asks.size(); }
+    bool empty() const { return bids.empty() && asks.empty(); }
+    int32_t bestBid() const; // 0 when there are no bids
+    int32_t bestAsk() const; // 0 when there are no asks
+
+private:
+    struct Order {
+        int32_t limit;
+        int32_t quantity;
+        uint32_t trader;
+        uint32_t expires;  // last auction round it takes part in
+        uint64_t sequence; // arrival order, for time priority
+    };
+
+    std::vector<Order> bids;
+    std::vector<Order> asks;
+    std::vector<int32_t> candidates; // scratch: limits inside the crossed range
+    uint64_t nextSequence = 0;
+    uint32_t round = 0;
+    uint32_t maxAge;
+
+    static void fill(std::vector<Order>& orders, Side side, int32_t volume, std::vector<Settlement>& settlements);
+    void expire(std::vector<Order>& orders, Side side, std::vector<Settlement>& settlements);
+};
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef POLICY_NETWORK_HPP
+#define POLICY_NETWORK_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// One fully connected layer. Weights use the Keras kernel layout [inputs][outputs].
+struct DenseLayer {
+    int inputs = 0;
+    int outputs = 0;
+    bool relu = false;
+    std::vector<float> weights; // inputs * outputs, row-major
+    std::vector<float> bias;    // outputs
+};
+
+// Dependency-free DQN inference engine (replaces the TensorFlow runtime for the
+// Dense 7->128->128->64->11 model trained by models/prototype/train_npc.py).
+//
+// Binary format (little-endian), written by export_native_policy() in train_npc.py:
+//   char[4] "MSPN" | u32 version | u32 inputSize | u32 layerCount
+//   f32 mean[inputSize] | f32 scale[inputSize]            (StandardScaler)
+//   per layer: u32 inputs | u32 outputs | u32 activation (0 = linear, 1 = relu)
+//              f32 kernel[inputs][outputs] | f32 bias[outputs]
+class PolicyNetwork {
+private:
+    std::vector<DenseLayer> layers;
+    std::vector<float> featureMean;   // scaler mean per input feature
+    std::vector<float> featureScale;  // scaler std per input feature
+
+    // Packed copies consumed by the SIMD kernels (outputs padded to MLPKernels::paddedSize)
+    std::vector<std::vector<float>> packedWeights;
+    std::vector<std::vector<float>> packedBias;
+    int maxPaddedWidth = 0;
+
+    void packLayers();
+
+public:
+    static constexpr uint32_t kFileVersion = 1;
+
+    // Scratch buffers for a forward pass; reuse one per calling thread to avoid allocations
+    struct Workspace {
+        std::vector<float> input;
+        std::vector<float> bufferA;
+        std::vector<float> bufferB;
+    };
+
+    PolicyNetwork() = default;
+
+    // Load/save the MSPN binary format
+    bool loadFromFile(const std::string& path);
+    bool saveToFile(const std::string& path) const;
+
+    // Replace the network (used by tests and the native trainer)
+    void setLayers(std::vector<DenseLayer> newLayers);
+    void setScaler(std::vector<float> mean, std::vector<float> scale);
+
+    const std::vector<DenseLayer>& getLayers() const { return layers; }
+    const std::vector<float>& getFeatureMean() const { return featureMean; }
+    const std::vector<float>& getFeatureScale() const { return featureScale; }
+    bool isLoaded() const { return !layers.empty(); }
+    int getInputSize() const { return layers.empty() ? 0 : layers.front().inputs; }
+    int getOutputSize() const { return layers.empty() ? 0 : layers.back().outputs; }
+
+    // Apply the scaler to raw features: out = (in - mean) / scale
+    void normalize(const float* rawFeatures, float* out, int count) const;
+
+    // Q-values for `batch` raw (unnormalized) feature rows laid out [batch][inputSize].
+    // qValues receives [batch][outputSize].
+    void forwardBatch(const float* rawFeatures, int batch, float* qValues, Workspace& workspace) const;
+    void forward(const float* rawFeatures, float* qValues, Workspace& workspace) const;
+
+    // Index of the best output for each row
+    static int argmax(const float* values, int count);
+};
+
+#endif
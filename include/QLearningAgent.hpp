@@ -4,18 +4,35 @@
 #include "State.hpp"
 #include "Tile.hpp"
 
+#include <array>
+#include <cstdint>
 #include <vector>
 #include <random>
 #include <unordered_map>
 #include <memory>
 #include <ActionType.hpp>
 
+struct AgentSnapshot;
+
 class QLearningAgent {
+public:
+    static constexpr int kActionCount = static_cast<int>(ActionType::InvestMoney) + 1;
+
+    // Q-values of one state; only actions that were updated take part in the argmax
+    struct ActionValues {
+        std::array<float, kActionCount> q{};
+        uint32_t known = 0; // bit per ActionType
+
+        bool empty() const { return known == 0; }
+        ActionType best() const; // highest Q among known actions (lowest ActionType on ties)
+        float bestValue() const;
+    };
+
 private:
     float learningRate;    // Learning rate (alpha)
     float discountFactor;  // Discount factor (gamma)
     float epsilon;         // Exploration rate
-    std::unordered_map<State, std::unordered_map<ActionType, float>, StateHasher> QTable;
+    std::unordered_map<PackedState, ActionValues, PackedStateHasher> QTable; // 8-byte keys, one probe per lookup
     std::mt19937 rng;
     std::uniform_int_distribution<int> actionDist;
 
@@ -24,7 +41,16 @@ public:
     QLearningAgent(float learningRate, float discountFactor, float epsilon);
 
     ActionType decideAction(const State& state); // Choose an action based on Q-table
+    ActionType decideAction(PackedState state);
     void updateQValue(const State& state, ActionType action, float reward, const State& nextState);
+    void updateQValue(PackedState state, ActionType action, float reward, PackedState nextState);
+
+    size_t getStateCount() const { return QTable.size(); }
+    float getQValue(const State& state, ActionType action) const; // 0 for unseen pairs
+
+    // Q-table, learning parameters and RNG state for simulation snapshots
+    void saveSnapshot(AgentSnapshot& out) const;
+    bool restoreSnapshot(const AgentSnapshot& in); // false (and unchanged) on a shape mismatch
 
     // Helpers for state extraction
     State extractState(const std::vector<std::vector<std::unique_ptr<Tile>>>& tileMap,
@@ -0,0 +1,63 @@
+#ifndef QUANTIZED_POLICY_NETWORK_HPP
+#define QUANTIZED_POLICY_NETWORK_HPP
+
+#include "PolicyNetwork.hpp"
+
+#include <vector>
+#include <cstdint>
+
+// Post-training int8 copy of a PolicyNetwork.
+// Weights: symmetric int8 with one scale per output channel (max |w| / 127).
+// Activations: symmetric int8 with one static scale per layer input, calibrated by
+// running the fp32 network over recorded states. Biases and the epilogue stay fp32.
+class QuantizedPolicyNetwork {
+private:
+    struct QuantizedLayer {
+        int inputs = 0;
+        int outputs = 0;
+        int paddedInputs = 0;       // even, matches the previous layer's padded width
+        int paddedOutputs = 0;
+        bool relu = false;
+        float inputScale = 1.0f;    // activation scale (real = int8 * inputScale)
+        std::vector<int8_t> weights;     // [paddedInputs / 2][paddedOutputs][2]
+        std::vector<float> outputScales; // weightScale[o] * inputScale, padded
+        std::vector<float> bias;         // padded
+    };
+
+    std::vector<QuantizedLayer> layers;
+    std::vector<float> featureMean;
+    std::vector<float> featureScale;
+    int maxPaddedWidth = 0;
+
+public:
+    struct Workspace {
+        std::vector<float> activations;
+        std::vector<int8_t> quantized;
+    };
+
+    // Agreement between the quantized and fp32 networks on a set of states
+    struct AccuracyReport {
+        int samples = 0;
+        float actionAgreement = 0.0f; // fraction of states with the same argmax
+        float maxAbsError = 0.0f;     // worst Q-value difference
+        float meanAbsError = 0.0f;
+    };
+
+    QuantizedPolicyNetwork() = default;
+
+    // Quantize `network`; calibrationFeatures holds `count` raw feature rows [count][inputSize]
+    bool quantize(const PolicyNetwork& network, const float* calibrationFeatures, int count);
+
+    bool isLoaded() const { return !layers.empty(); }
+    int getInputSize() const { return layers.empty() ? 0 : layers.front().inputs; }
+    int getOutputSize() const { return layers.empty() ? 0 : layers.back().outputs; }
+    size_t getWeightBytes() const;
+
+    // Same contract as PolicyNetwork::forwardBatch
+    void forwardBatch(const float* rawFeatures, int batch, float* qValues, Workspace& workspace) const;
+
+    static AccuracyReport compare(const PolicyNetwork& reference, const QuantizedPolicyNetwork& quantized,
+                                  const float* features, int count);
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef RESOURCE_REGROWTH_HPP
+#define RESOURCE_REGROWTH_HPP
+
+#include <SFML/Graphics.hpp>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ObjectLayers.hpp"
+
+// Event-driven resource regrowth. Harvesting a tree, rock or bush schedules one regrowth
+// timer on the simulation timers; when it fires the resource grows back on a free tile of
+// its biome, picked from a maintained free-tile index and accepted by a per-tile spawn
+// probability precomputed from the map noise. The cost is per harvest and spawn, not per
+// map tile, and nothing runs while nothing was harvested.
+class ResourceRegrowth {
+public:
+    enum class Biome : uint8_t { None, Grass, Stone, Count };
+
+private:
+    TileGrid* tileMap = nullptr;
+    int width = 0;
+    int height = 0;
+    uint32_t timerChannel = 0;
+    std::vector<uint8_t> biomes;      // Biome per tile
+    std::vector<float> spawnChance;   // per tile, from the noise map
+    std::vector<uint32_t> freeTiles[static_cast<int>(Biome::Count)]; // empty tiles per biome
+    std::vector<uint32_t> freeSlot;   // position of each tile in its free list, or kNotFree
+    std::vector<const sf::Texture*> treeTextures, bushTextures, rockTextures;
+    std::mt19937 rng{std::random_device{}()};
+    size_t pending = 0;
+    size_t spawned = 0;
+
+    static constexpr uint32_t kNotFree = UINT32_MAX;
+    static constexpr int kSpawnTries = 4; // free tiles tried per event before it is rescheduled
+
+    void markFree(uint32_t tile);
+    void markTaken(uint32_t tile);
+    bool spawn(uint32_t tile, ObjectType type);
+    float regrowthDelay(ObjectType type);
+
+public:
+    // Spawn probability of a tile from its normalized [0, 1] noise value (the biome bands of
+    // Game::generateMap: grass in the middle of its band, rocks deep in the stone band)
+    static float spawnChanceFor(float noiseValue);
+    static Biome biomeFor(ObjectType type);
+
+    // Indexes the map's empty tiles; spawnChances has one entry per tile (row-major).
+    // Regrowth wake-ups are scheduled on the simulation timers under `channel`. Null grid
+    // entries (chunks that are not resident) are skipped until indexArea() sees them built.
+    void attach(TileGrid& grid, std::vector<float> spawnChances, uint32_t channel);
+    void indexArea(int x0, int y0, int x1, int y1); // inclusive tile rectangle, after its tiles were built
+    void detach();
+    bool isAttached() const { return tileMap != nullptr; }
+
+    // A resource of `type` was taken from `tile` (which is now empty)
+    void harvested(const Tile& tile, ObjectType type);
+    // The regrowth timer with this subject fired; returns whether something grew
+    bool regrow(uint32_t subject);
+
+    size_t getFreeTileCount(Biome biome) const { return freeTiles[static_cast<int>(biome)].size(); }
+    size_t getPendingCount() const { return pending; }
+    size_t getSpawnedCount() const { return spawned; }
+
+    // Snapshots: the RNG, and the count of regrowth timers the caller re-created
+    std::string getRngState() const;
+    void setRngState(const std::string& state);
+    void setPendingCount(size_t count) { pending = count; }
+};
+
+// Regrowth of the current map (attached by Game::generateMap; harvest actions report to it)
+ResourceRegrowth& getResourceRegrowth();
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef SESSION_PROCESSOR_HPP
+#define SESSION_PROCESSOR_HPP
+
+#include "NumpyIO.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Settings for merging DataCollector session batches into one training set
+struct SessionProcessorOptions {
+    std::vector<std::string> inputs = {"training_data/sessions"}; // directories and/or batch files
+    std::string outputPrefix = "training_data/exports/merged";    // writes <prefix>_train.npz etc.
+    float minReward = -std::numeric_limits<float>::infinity();
+    float maxReward = std::numeric_limits<float>::infinity();
+    std::vector<int> actions;     // ActionType values to keep (empty = all)
+    bool dedup = true;            // drop exact repeats of a transition (first occurrence wins)
+    bool shuffle = true;
+    unsigned seed = 42;
+    float validationFraction = 0.1f;
+    float testFraction = 0.0f;
+    unsigned threads = 0;         // 0 = hardware concurrency
+};
+
+struct SessionProcessorReport {
+    size_t files = 0;
+    size_t failedFiles = 0;
+    size_t read = 0;
+    size_t filtered = 0;          // rejected by reward/action filters
+    size_t duplicates = 0;
+    size_t train = 0;
+    size_t validation = 0;
+    size_t test = 0;
+    double rewardMean = 0.0;      // over kept experiences
+};
+
+// Native replacement for models/prototype/session_data_processor.py.
+// Batch files are read in parallel (.msx segments decoded, .npz memory-mapped, legacy .json streamed),
+// then merged in file order, deduplicated, shuffled, split and written as .npz arrays.
+class SessionProcessor {
+private:
+    SessionProcessorOptions options;
+    SessionProcessorReport report;
+
+    bool accepts(int action, float reward) const;
+    bool loadFile(const std::string& path, NumpyIO::ExperienceColumns& out, size_t& read) const;
+    bool writeSplit(const std::string& suffix, const NumpyIO::ExperienceColumns& merged,
+                    const std::vector<size_t>& order, size_t first, size_t count) const;
+
+public:
+    explicit SessionProcessor(const SessionProcessorOptions& processorOptions = SessionProcessorOptions());
+
+    // Batch files behind the configured inputs, sorted; per batch the .msx segment is preferred
+    // over the .npz one, and both over the legacy .json
+    std::vector<std::string> listInputFiles() const;
+
+    // Load + filter + dedup every input into `merged` (file order preserved)
+    bool merge(NumpyIO::ExperienceColumns& merged);
+
+    // merge() followed by shuffle, split and writing the output archives
+    bool run();
+
+    const SessionProcessorReport& getReport() const { return report; }
+};
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef SIMULATION_CONFIG_HPP
 #define SIMULATION_CONFIG_HPP
 
+#include <string>
+
 // SimulationConfig holds tunable behaviour parameters for the simulation.
 // These values will eventually be loaded from external config (JSON/YAML).
 struct SimulationConfig {
@@ -16,6 +18,23 @@ struct SimulationConfig {
     float actionEnergyCost     = 10.0f; // Baseline energy cost per heavy action
     float restEnergyRecovery   = 25.0f; // Energy recovered when resting
     float minEnergyToAct       = 10.0f; // Minimum energy required to perform heavy actions
+
+    // In-process DQN training (TensorFlow mode)
+    bool  onlineTraining       = true;   // Train the native policy while the simulation runs
+    float checkpointInterval   = 120.0f; // Seconds of simulation between weight checkpoints
+    bool  quantizedInference   = false;  // Run the policy with int8 weights once calibration data exists
+
+    // Wide-radius resource density in the state (0 = off; 2, 4, 8 look at 5x5, 9x9, 17x17 windows).
+    // Adds three density levels to the Q-learning state and grows the DQN input to 10 features.
+    int   densityRadius        = 0;
+
+    // Market trading: NPCs post limit orders cleared by one call auction per tick instead of
+    // trading instantly at the posted price
+    bool  orderBookTrading     = true;
+
+    // Periodic snapshots of the whole society for long runs and crash recovery (0 = off)
+    float snapshotInterval     = 600.0f;                     // Seconds of simulation between autosaves
+    std::string snapshotPath   = "snapshots/autosave.mss";   // Overwritten on each autosave
 };
 
 // Accessor for global simulation config
@@ -0,0 +1,168 @@
+#ifndef SIMULATION_SNAPSHOT_HPP
+#define SIMULATION_SNAPSHOT_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Plain copies of the simulation's state, captured on the simulation thread and written or
+// read without touching the live objects. Each class fills and restores its own part
+// (saveSnapshot/restoreSnapshot); Game stitches them together.
+
+using SnapshotCounts = std::vector<std::pair<std::string, int32_t>>;
+
+struct AgentSnapshot {
+    float learningRate = 0.0f;
+    float discountFactor = 0.0f;
+    float epsilon = 0.0f;
+    std::string rngState;          // std::mt19937 textual state
+    uint32_t actionCount = 0;      // Q-values per entry
+    std::vector<uint64_t> states;  // PackedState bits
+    std::vector<uint32_t> known;   // known-action mask per state
+    std::vector<float> values;     // states.size() * actionCount
+};
+
+struct NpcSnapshot {
+    std::string name;
+    float health = 0.0f, hunger = 0.0f, energy = 0.0f, speed = 0.0f, strength = 0.0f, money = 0.0f;
+    bool dead = false;
+    float x = 0.0f, y = 0.0f;
+    uint8_t state = 0;         // NPCState
+    uint8_t currentAction = 0; // ActionType
+    uint8_t lastAction = 0;
+    int32_t targetX = -1, targetY = -1; // target tile, -1 when none
+    int32_t inventoryCapacity = 0;
+    float baseSpeed = 0.0f, currentSpeed = 0.0f;
+    int32_t currentReward = 0, currentPenalty = 0;
+    float actionCooldown = 0.0f;
+    uint64_t wakeTimer = 0;    // id in SimulationSnapshot::timers, 0 when awake
+    int32_t totalItemsGathered = 0;
+    SnapshotCounts inventory;
+    SnapshotCounts itemsGatheredByType;
+    bool useQLearning = false;
+    bool useTensorFlow = false;
+    AgentSnapshot agent;
+};
+
+struct HouseSnapshot {
+    int32_t x = -1, y = -1; // tile of a placed house, -1 for the shared house
+    int32_t level = 1, maxStorageCapacity = 0;
+    float energyRegenRate = 0.0f;
+    int32_t healthBonus = 0, strengthBonus = 0, speedBonus = 0;
+    SnapshotCounts storage;
+    std::vector<std::pair<int32_t, float>> lastRegenTime; // NPC index -> simulation time
+    std::vector<std::pair<int32_t, int32_t>> regenCount;  // NPC index -> regenerations today
+};
+
+struct MarketItemSnapshot {
+    std::string item;
+    float price = 0.0f;
+    int32_t demand = 0, supply = 0;
+    int32_t buyTransactions = 0, sellTransactions = 0;
+    float revenue = 0.0f, expenditure = 0.0f;
+    std::vector<float> history;
+};
+
+struct MarketSnapshot {
+    int32_t x = -1, y = -1; // tile of a placed market, -1 for the panel market
+    float buyMargin = 1.0f, sellMargin = 1.0f;
+    std::vector<MarketItemSnapshot> items;
+};
+
+// A world chunk in ChunkManager's cache encoding (terrain runs and the object list)
+struct SnapshotChunk {
+    int32_t cx = 0, cy = 0;
+    bool resident = false; // in memory when captured, rather than only in the chunk cache
+    std::vector<uint8_t> bytes;
+};
+
+struct TimerSnapshot {
+    uint64_t due = 0; // absolute tick
+    uint32_t channel = 0;
+    uint32_t subject = 0;
+    uint64_t id = 0;  // as scheduled when captured, so NPC wake-ups can be relinked
+};
+
+// A complete running society. Binary format (little-endian), versioned per file and per section:
+//   char[4] "MSSS" | u32 version
+//   sections: u32 tag | u64 byte length | payload   (unknown tags are skipped)
+// Files are written to a temporary name and renamed, so a crash mid-write leaves the previous
+// snapshot intact; loading maps the file and decodes in place.
+struct SimulationSnapshot {
+    static constexpr uint32_t kVersion = 3; // 1 stored the world as a list of every object, 2 only the panel market
+
+    // world: chunks nobody touched regenerate from the seed; the resident and cached ones (all
+    // edits live there) are stored as they are
+    int32_t worldWidth = 0, worldHeight = 0, worldSeed = 0;
+    float worldFrequency = 0.1f;
+    std::vector<SnapshotChunk> chunks;
+    std::vector<HouseSnapshot> houses; // shared house first, then placed houses
+
+    std::vector<NpcSnapshot> npcs;
+    std::vector<MarketSnapshot> markets; // panel market first, then placed markets
+
+    // clocks
+    float elapsedTime = 0.0f;
+    int32_t day = 1, societyIteration = 0;
+    float simulationSpeed = 1.0f;
+    uint64_t timerTick = 0;
+    float timerCarry = 0.0f;
+    std::vector<TimerSnapshot> timers;
+
+    // random number generators
+    uint32_t randSeed = 0;        // std::rand is reseeded with this on capture and restore
+    std::string regrowthRngState;
+
+    // statistics
+    int32_t moneySpent = 0, moneyEarned = 0;
+    std::vector<int32_t> persistentStats;
+
+    std::vector<uint8_t> encode() const;
+    bool decode(const char* bytes, size_t length);
+
+    bool saveToFile(const std::string& path) const;
+    bool loadFromFile(const std::string& path); // memory-mapped
+};
+
+// Background serializer: Game hands over a captured snapshot and keeps simulating while it is
+// encoded and written. A newer snapshot for the same path replaces one still queued.
+class SnapshotWriter {
+private:
+    struct Job {
+        std::shared_ptr<const SimulationSnapshot> snapshot;
+        std::string path;
+    };
+
+    std::deque<Job> queue;
+    std::mutex queueMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable queueDrained;
+    bool stopping = false;
+    bool busy = false;
+    size_t written = 0;
+    size_t failed = 0;
+    std::thread worker;
+
+    void workerLoop();
+
+public:
+    SnapshotWriter();
+    ~SnapshotWriter(); // writes what is queued, then stops
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    void submit(std::shared_ptr<const SimulationSnapshot> snapshot, const std::string& path);
+    void flush(); // block until everything queued is on disk
+
+    size_t getWrittenCount();
+    size_t getFailedCount();
+};
+
+#endif
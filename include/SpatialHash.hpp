@@ -0,0 +1,75 @@
+#ifndef SPATIAL_HASH_HPP
+#define SPATIAL_HASH_HPP
+
+#include <SFML/System.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// Uniform grid over the world for point queries between NPCs. rebuild() is a counting sort
+// of the points into cells (O(n)), so it is cheap enough to redo every tick; queries only
+// look at the cells overlapping the search circle. Points outside the world go to the
+// nearest edge cell.
+class SpatialHash {
+private:
+    float cellSize = 64.0f;
+    float invCellSize = 1.0f / 64.0f;
+    int columns = 1;
+    int rows = 1;
+    std::vector<uint32_t> cellStart;     // columns * rows + 1 offsets into entries
+    std::vector<uint32_t> entries;       // point indices grouped by cell
+    std::vector<sf::Vector2f> points;    // copy of the last rebuild, by index
+    std::vector<uint32_t> pointCell;     // scratch for the counting sort
+
+    int cellX(float x) const;
+    int cellY(float y) const;
+
+public:
+    static constexpr uint32_t kNoIndex = UINT32_MAX;
+
+    SpatialHash() = default;
+    SpatialHash(float cellSize, float worldWidth, float worldHeight);
+    void resize(float newCellSize, float worldWidth, float worldHeight); // forgets the points
+
+    void rebuild(const sf::Vector2f* positions, size_t count);
+    size_t size() const { return points.size(); }
+    const sf::Vector2f& position(uint32_t index) const { return points[index]; }
+
+    // Calls visit(index, squaredDistance) for every point within `radius` of `center`
+    template <typename Visitor>
+    void forEachInRadius(sf::Vector2f center, float radius, Visitor&& visit) const;
+
+    // Indices within `radius` (unordered), `exclude` left out; returns out.size()
+    size_t queryRadius(sf::Vector2f center, float radius, std::vector<uint32_t>& out, uint32_t exclude = kNoIndex) const;
+
+    // Up to k nearest indices within maxRadius, closest first (candidates live in the calling
+    // thread's ScratchArena, so concurrent queries from jobs are safe)
+    size_t kNearest(sf::Vector2f center, size_t k, float maxRadius, std::vector<uint32_t>& out,
+                    uint32_t exclude = kNoIndex) const;
+
+    // Steering away from the closest neighbours of point `index` (at most maxNeighbors within
+    // radius), each weighted by how far it has pushed in; length is at most 1
+    sf::Vector2f separation(uint32_t index, float radius, size_t maxNeighbors) const;
+};
+
+template <typename Visitor>
+void SpatialHash::forEachInRadius(sf::Vector2f center, float radius, Visitor&& visit) const {
+    if (points.empty() || radius < 0.0f) return;
+    const float radiusSquared = radius * radius;
+    const int x0 = cellX(center.x - radius), x1 = cellX(center.x + radius);
+    const int y0 = cellY(center.y - radius), y1 = cellY(center.y + radius);
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            const int cell = cy * columns + cx;
+            for (uint32_t e = cellStart[cell]; e < cellStart[cell + 1]; ++e) {
+                const uint32_t index = entries[e];
+                const float dx = points[index].x - center.x;
+                const float dy = points[index].y - center.y;
+                const float distanceSquared = dx * dx + dy * dy;
+                if (distanceSquared <= radiusSquared) visit(index, distanceSquared);
+            }
+        }
+    }
+}
+
+#endif
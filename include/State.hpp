@@ -1,6 +1,8 @@
 #ifndef STATE_HPP
 #define STATE_HPP
 
+#include <algorithm>
+#include <cstdint>
 #include <functional> 
 
 // State structure representing the environment for Q-learning
@@ -12,6 +14,11 @@ struct State {
     int energyLevel;        // NPC's energy level (e.g., low, medium, high)
     int inventoryLevel;     // Inventory status (e.g., empty, partial, full)
 
+    // Optional wide-radius resource density levels (0 none .. 3 dense), see SimulationConfig::densityRadius
+    int treeDensity = 0;
+    int rockDensity = 0;
+    int bushDensity = 0;
+
     // Operator Overloading: Allows direct comparison of State objects
     bool operator==(const State& other) const {
         return posX == other.posX &&
@@ -20,25 +27,91 @@ struct State {
                nearbyRocks == other.nearbyRocks &&
                nearbyBushes == other.nearbyBushes &&
                energyLevel == other.energyLevel &&
-               inventoryLevel == other.inventoryLevel;
+               inventoryLevel == other.inventoryLevel &&
+               treeDensity == other.treeDensity &&
+               rockDensity == other.rockDensity &&
+               bushDensity == other.bushDensity;
+    }
+};
+
+// 64-bit packed State, used as the key wherever states are hashed, compared or stored
+// (Q-table, recorded experiences, statistics). Bit layout, LSB first:
+//   posX 16 | posY 16 | trees 6 | rocks 6 | bushes 6 | energy 3 | tree density 2 | rock density 2 |
+//   inventory 3 | bush density 2 | spare 2
+// Values are clamped to their field width, which is far above anything the map produces. The
+// density fields sit in bits the older 7-bit energy/inventory fields never used, so keys
+// recorded before they existed unpack unchanged.
+struct PackedState {
+    uint64_t bits = 0;
+
+    static constexpr int kFeatureCount = 7;          // network inputs without density features
+    static constexpr int kExtendedFeatureCount = 10; // ... and with them
+
+    static PackedState pack(const State& state) {
+        auto field = [](int value, int width) {
+            return static_cast<uint64_t>(std::clamp(value, 0, (1 << width) - 1));
+        };
+        return {field(state.posX, 16) |
+                field(state.posY, 16) << 16 |
+                field(state.nearbyTrees, 6) << 32 |
+                field(state.nearbyRocks, 6) << 38 |
+                field(state.nearbyBushes, 6) << 44 |
+                field(state.energyLevel, 3) << 50 |
+                field(state.treeDensity, 2) << 53 |
+                field(state.rockDensity, 2) << 55 |
+                field(state.inventoryLevel, 3) << 57 |
+                field(state.bushDensity, 2) << 60};
+    }
+
+    int field(int shift, int width) const {
+        return static_cast<int>((bits >> shift) & ((uint64_t{1} << width) - 1));
+    }
+
+    State unpack() const {
+        State state{field(0, 16), field(16, 16), field(32, 6), field(38, 6), field(44, 6), field(50, 3), field(57, 3)};
+        state.treeDensity = field(53, 2);
+        state.rockDensity = field(55, 2);
+        state.bushDensity = field(60, 2);
+        return state;
+    }
+
+    // Network input features (same order as the State fields), written without allocating.
+    // `count` is kFeatureCount or kExtendedFeatureCount.
+    void writeFeatures(float* out, int count = kFeatureCount) const {
+        out[0] = static_cast<float>(field(0, 16));
+        out[1] = static_cast<float>(field(16, 16));
+        out[2] = static_cast<float>(field(32, 6));
+        out[3] = static_cast<float>(field(38, 6));
+        out[4] = static_cast<float>(field(44, 6));
+        out[5] = static_cast<float>(field(50, 3));
+        out[6] = static_cast<float>(field(57, 3));
+        if (count < kExtendedFeatureCount) return;
+        out[7] = static_cast<float>(field(53, 2));
+        out[8] = static_cast<float>(field(55, 2));
+        out[9] = static_cast<float>(field(60, 2));
+    }
+
+    bool operator==(PackedState other) const { return bits == other.bits; }
+    bool operator!=(PackedState other) const { return bits != other.bits; }
+};
+
+// splitmix64 finalizer: every input bit affects every output bit, two multiplies
+inline uint64_t mixStateBits(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+struct PackedStateHasher {
+    std::size_t operator()(PackedState state) const {
+        return static_cast<std::size_t>(mixStateBits(state.bits));
     }
 };
 
-// Custom hashing function for unordered_map
+// Custom hashing function for unordered_map (hashes the packed form)
 struct StateHasher {
     std::size_t operator()(const State& state) const {
-        std::size_t seed = 0; // Initialize seed for hash calculation
-
-        // Hash each field of the state and combine them using bitwise XOR (^)
-        seed ^= std::hash<int>()(state.posX) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-        seed ^= std::hash<int>()(state.posY) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-        seed ^= std::hash<int>()(state.nearbyTrees) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-        seed ^= std::hash<int>()(state.nearbyRocks) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-        seed ^= std::hash<int>()(state.nearbyBushes) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-        seed ^= std::hash<int>()(state.energyLevel) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-        seed ^= std::hash<int>()(state.inventoryLevel) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-
-        return seed; // Return the unique hash value for the state
+        return PackedStateHasher()(PackedState::pack(state));
     }
 };
 
@@ -1,12 +1,18 @@
 #ifndef TENSORFLOW_WRAPPER_HPP
 #define TENSORFLOW_WRAPPER_HPP
 
+#include <array>
 #include <string>
 #include <vector>
 #include <memory>
 
 #include "ActionType.hpp"
 #include "State.hpp"
+#include "PolicyNetwork.hpp"
+#include "QuantizedPolicyNetwork.hpp"
+#include "ObservationBuilder.hpp"
+
+class DQNTrainer;
 
 // Only include TensorFlow headers if actually using TensorFlow
 #ifdef USE_TENSORFLOW
@@ -34,7 +40,34 @@ private:
 #endif
     
     bool isInitialized = false;
+    int featureCount = kStateFeatureCount;
+    bool acceptPolicy(const PolicyNetwork& policy); // checks the input size and adopts it as featureCount
     std::string modelPath;
+
+    // Native (TensorFlow-free) inference path
+    PolicyNetwork nativePolicy;
+    bool usingNativePolicy = false;
+    PolicyNetwork::Workspace workspace;
+    std::vector<float> qValues;
+    std::vector<float> batchFeatures;  // [batch][featureCount], reused across ticks
+    std::vector<float> batchQValues;   // [batch][outputs]
+
+    // Optional int8 path: re-quantized when new weights arrive through setNativePolicy(policy),
+    // or handed over ready-made by the trainer
+    std::shared_ptr<const QuantizedPolicyNetwork> quantizedPolicy;
+    QuantizedPolicyNetwork::Workspace quantizedWorkspace;
+    QuantizedPolicyNetwork::AccuracyReport quantizationReport;
+    std::vector<PackedState> calibrationStates; // re-expanded into features whenever the policy changes
+    std::vector<float> calibrationFeatures;     // [n][featureCount]
+    float minQuantizedAgreement = 0.98f;
+    bool usingQuantizedPolicy = false;
+    bool requantize();
+    void runNativePolicy(const float* features, int count, float* actionValues);
+
+    // Online training: transitions go to the trainer, epsilon-greedy exploration on top of argmax
+    std::shared_ptr<DQNTrainer> trainer;
+    float explorationRate = 0.0f;
+    int chooseAction(const float* actionValues, int outputs);
     
     // Input and output tensor information
     std::string inputOpName;
@@ -44,10 +77,10 @@ private:
     void cleanupTensorFlow();
     
 #ifdef USE_TENSORFLOW
-    TF_Tensor* createInputTensor(const std::vector<float>& stateVector) const;
+    TF_Tensor* createInputTensor(const float* features, int count) const;
     ActionType interpretOutput(TF_Tensor* outputTensor) const;
 #else
-    void* createInputTensor(const std::vector<float>& stateVector) const { return nullptr; }
+    void* createInputTensor(const float* features, int count) const { return nullptr; }
     ActionType interpretOutput(void* outputTensor) const { 
         return static_cast<ActionType>(1 + rand() % static_cast<int>(ActionType::Rest)); 
     }
@@ -57,17 +90,61 @@ public:
     TensorFlowWrapper();
     ~TensorFlowWrapper();
     
-    // Initialize TF model
+    static constexpr const char* kNativeModelPath = "models/npc_policy.bin";
+    static constexpr int kStateFeatureCount = PackedState::kFeatureCount;
+    static constexpr int kMaxStateFeatureCount = PackedState::kExtendedFeatureCount; // with density levels
+    static int featureCountFor(int densityRadius) { return densityRadius > 0 ? kMaxStateFeatureCount : kStateFeatureCount; }
+
+    // Initialize TF model (".bin" paths load the native policy and need no TensorFlow runtime)
     bool initialize(const std::string& modelPath);
+    bool loadNativePolicy(const std::string& path);
+    bool setNativePolicy(const PolicyNetwork& policy); // adopt new weights (re-quantized if calibrated)
+    // Adopt a DQNTrainer publish: the int8 copy was already built on the trainer thread (null keeps fp32)
+    bool setNativePolicy(const PolicyNetwork& policy, std::shared_ptr<const QuantizedPolicyNetwork> quantized,
+                         const QuantizedPolicyNetwork::AccuracyReport& report);
     
     // Predict action using TF model
     ActionType predictAction(const State& state);
+
+    // One forward pass for a whole batch of states (falls back to per-state calls without the native policy)
+    void predictActions(const State* states, int count, ActionType* actions);
+
+    // Policies whose input is an ObservationBuilder row run straight on the batch buffer
+    bool usesObservations() const { return usingNativePolicy && featureCount > kMaxStateFeatureCount; }
+    int getObservationRadius() const { return ObservationBuilder::radiusForFeatureCount(featureCount); }
+    bool predictActions(const ObservationBatch& batch, ActionType* actions); // false if the row size doesn't match
+    
+    // Switch inference to int8 weights calibrated on recorded states. Stays on fp32 (returns false)
+    // if the quantized policy picks a different action than fp32 on too many of those states.
+    bool enableQuantization(const std::vector<State>& calibrationStates, float minAgreement = 0.98f);
+    void disableQuantization();
+    bool isQuantized() const { return usingQuantizedPolicy; }
+    const QuantizedPolicyNetwork::AccuracyReport& getQuantizationReport() const { return quantizationReport; }
+
+    // Forward (state, action, reward, next state) to the attached trainer, if any
+    void attachTrainer(std::shared_ptr<DQNTrainer> onlineTrainer) { trainer = std::move(onlineTrainer); }
+    void recordTransition(const State& state, ActionType action, float reward, const State& nextState, bool done);
+    void recordTransition(PackedState state, ActionType action, float reward, PackedState nextState, bool done);
+    void setExplorationRate(float epsilon) { explorationRate = epsilon; }
+    float getExplorationRate() const { return explorationRate; }
     
-    // Convert state to vector for TF input
-    std::vector<float> stateToVector(const State& state) const;
+    // Convert state to TF input features (fixed size, no heap allocation)
+    std::array<float, kStateFeatureCount> stateToVector(const State& state) const;
+    static void writeFeatures(const State& state, float* out, int count = kStateFeatureCount);
+    static void writeFeatures(PackedState state, float* out, int count = kStateFeatureCount) { state.writeFeatures(out, count); }
+
+    // Inputs of the loaded policy: kStateFeatureCount, kMaxStateFeatureCount with density levels,
+    // or an observation row size
+    int getFeatureCount() const { return featureCount; }
+
+    // Network output index i corresponds to ActionType(i + 1) (see action_mapping in train_npc.py)
+    static ActionType actionFromIndex(int index);
+    static int indexFromAction(ActionType action); // -1 for actions outside the network's range
     
     // Check if TF is properly initialized
     bool isModelLoaded() const { return isInitialized; }
+    bool isNativePolicy() const { return usingNativePolicy; }
+    const PolicyNetwork& getNativePolicy() const { return nativePolicy; }
 };
 
 #endif
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <SFML/Graphics.hpp>
 #include "Object.hpp"
+#include "ObjectLayers.hpp"
 #include "debug.hpp"
 #include <memory>
 
@@ -12,6 +13,8 @@ protected:
     sf::Sprite sprite; // The visual representation of the tile
     sf::Texture texture; // Texture used for rendering
     std::unique_ptr<Object> object; // Unique pointer to an object placed on the tile
+    ObjectLayers* objectLayers = nullptr; // presence bitboards kept in sync with `object` (optional)
+    int gridX = 0, gridY = 0;
 
 public:
     Tile() = default; // Default constructor
@@ -39,9 +42,27 @@ public:
         }
     }
 
+    // Register the tile's grid cell in the map's object bitboards
+    void attachObjectLayers(ObjectLayers* layers, int x, int y) {
+        objectLayers = layers;
+        gridX = x;
+        gridY = y;
+        if (objectLayers && object) objectLayers->set(object->getType(), gridX, gridY);
+    }
+
+    ObjectLayers* getObjectLayers() const {
+        return objectLayers;
+    }
+
+    // Grid cell, valid once attached to the object layers
+    int getGridX() const { return gridX; }
+    int getGridY() const { return gridY; }
+
     // Places an object on the tile
     void placeObject(std::unique_ptr<Object> obj) {
+        if (objectLayers && object) objectLayers->reset(object->getType(), gridX, gridY);
         object = std::move(obj); // Transfer ownership to unique_ptr
+        if (objectLayers && object) objectLayers->set(object->getType(), gridX, gridY);
         if (object) {
             object->setPosition(sprite.getPosition().x, sprite.getPosition().y); // Align object position
         }
@@ -65,6 +86,7 @@ public:
     // Removes an object from the tile
     void removeObject() {
         if (object) {
+            if (objectLayers) objectLayers->reset(object->getType(), gridX, gridY);
             object.reset(); // Releases the unique_ptr, deleting the object
             getDebugConsole().log("Tile", "Object removed from tile.");
         }
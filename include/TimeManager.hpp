@@ -33,6 +33,13 @@ public:
     float getElapsedTime() const { return elapsedTime; }
     void incrementSocietyIteration() { societyIteration++; }
 
+    // Restores a snapshot's clock
+    void restore(float elapsed, int day, int iteration) {
+        elapsedTime = elapsed;
+        currentDay = day;
+        societyIteration = iteration;
+    }
+
     mutable std::string cachedFormattedTime;
     mutable float lastCachedElapsedTime = -1.0f;
 
@@ -0,0 +1,90 @@
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hierarchical timer wheel keyed on simulation time. Systems and entities schedule wake-ups
+// instead of polling countdowns every frame; advance() hands back only the events that came
+// due. Four levels of 64 slots cover 2^24 ticks (about 3 days of simulation at 60 ticks/s);
+// later deadlines wait in the last level and are re-filed when it comes round. Scheduling
+// and cancelling are O(1), and a tick with nothing due costs one empty-slot check.
+class TimerWheel {
+public:
+    using TimerId = uint64_t; // 0 = no timer
+
+    struct Event {
+        uint32_t channel; // what kind of wake-up (meaning is up to the caller)
+        uint32_t subject; // who it is for, e.g. an NPC index or a tile index
+        TimerId id;
+    };
+
+    struct Pending {
+        uint64_t due; // absolute tick
+        uint32_t channel;
+        uint32_t subject;
+        TimerId id;
+    };
+
+private:
+    static constexpr int kLevelBits = 6;
+    static constexpr int kLevels = 4;
+    static constexpr uint32_t kSlots = 1u << kLevelBits;
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    struct Node {
+        uint64_t due = 0;
+        uint32_t next = kNone;
+        uint32_t generation = 0; // bumped on reuse, so stale ids miss
+        uint32_t channel = 0;
+        uint32_t subject = 0;
+        bool live = false;
+    };
+
+    float tickSeconds;
+    float carry = 0.0f;   // time not yet worth a whole tick
+    uint64_t tick = 0;
+    size_t live = 0;      // scheduled and not cancelled
+    size_t linked = 0;    // nodes sitting in slots (cancelled ones too, until their slot is reached)
+    std::vector<Node> nodes;
+    std::vector<uint32_t> freeNodes;
+    uint32_t slots[kLevels][kSlots];
+
+    void file(uint32_t node);              // puts a node in the slot for its deadline
+    void cascade(int level, uint32_t slot); // re-files one slot of a higher level
+    void expire(uint32_t slot, std::vector<Event>& due);
+    Node* find(TimerId id);
+    const Node* find(TimerId id) const;
+
+public:
+    explicit TimerWheel(float tickSeconds = 1.0f / 60.0f);
+
+    // Wake-up after `delay` seconds (at least one tick)
+    TimerId schedule(float delay, uint32_t channel, uint32_t subject = 0);
+    // Wake-up at an absolute tick (the next tick if that has passed)
+    TimerId scheduleAt(uint64_t dueTick, uint32_t channel, uint32_t subject = 0);
+    bool cancel(TimerId id);                     // false if it already fired or was cancelled
+    bool retarget(TimerId id, uint32_t subject); // e.g. when the subject moved to a new index
+    bool isPending(TimerId id) const { return find(id) != nullptr; }
+    float remaining(TimerId id) const;           // seconds until it fires, 0 if not pending
+
+    // Moves the clock forward and appends what came due, earliest tick first; returns how many
+    size_t advance(float seconds, std::vector<Event>& due);
+
+    float now() const { return static_cast<float>(static_cast<double>(tick) * tickSeconds); }
+    uint64_t getTick() const { return tick; }
+    float getTickSeconds() const { return tickSeconds; }
+    size_t pendingCount() const { return live; }
+    void clear(); // drops every timer and restarts the clock at 0
+
+    // Snapshots: every live timer in deadline order, and a clock restart to rebuild from them
+    void collectPending(std::vector<Pending>& out) const;
+    float getCarry() const { return carry; }
+    void restart(uint64_t atTick, float carrySeconds); // clear(), then the clock reads atTick
+};
+
+// Simulation clock shared by Game and the objects it drives
+TimerWheel& getSimulationTimers();
+
+#endif
@@ -10,6 +10,8 @@
 #include <chrono>
 #include <fstream>
 #include <mutex>
+#include <atomic>
+#include <ctime>
 
 class Game;
 class NPCEntity;
@@ -29,18 +31,21 @@ private:
     sf::Font consoleFont;  // Font used for rendering debug text
     sf::RectangleShape background; // UI background for the debug console
     sf::Text text;  // SFML text object to display log messages
-    std::mutex debugMutex; // Ensures thread safety for logging
+    std::mutex debugMutex; // Ensures thread safety for logging (the stored logs and the log file)
+    std::ofstream logFile; // Today's log file, kept open between entries
+    std::string logFileName;
 
     const int maxLogs = 10; // Maximum number of logs stored at a time
     const sf::Color backgroundColor = sf::Color(0, 0, 0, 200); // Semi-transparent UI background
     bool enabled = false; // Flag to toggle debug console visibility
 
-    LogLevel filterLevel = LogLevel::Info; // Current logging level filter
+    std::atomic<LogLevel> filterLevel{LogLevel::Info}; // Current logging level filter
+    std::mutex trackerMutex; // Guards the two maps below (log() takes debugMutex afterwards)
     std::unordered_map<std::string, std::chrono::high_resolution_clock::time_point> throttleTimers; // Stores timestamps for throttled logs
     std::unordered_map<std::string, bool> logOnceTracker; // Tracks messages that should be logged only once
 
     void trimLogs(); // Removes old logs when reaching maxLogs limit
-    std::string getLogFilename() const; // Generates a timestamped filename for log storage
+    std::string getLogFilename(const std::tm& localTime) const; // Generates a dated filename for log storage
 
 public:
     DebugConsole(float windowWidth, float windowHeight);
@@ -53,7 +58,7 @@ public:
 
     // Logging Methods
     void setLogLevel(LogLevel level); // Set the minimum log level for filtering
-    void log(const std::string& category, const std::string& message, LogLevel level = LogLevel::Info); // Log a message with a category
+    void log(const std::string& category, const std::string& message, LogLevel level = LogLevel::Info); // Log a message with a category (any thread)
     void logThrottled(const std::string& category, const std::string& message, int throttleMs); // Log a message but prevent spam by setting a time threshold
     void logOnce(const std::string& category, const std::string& message); // Log a message only once to prevent duplicates
 
@@ -73,6 +78,8 @@ public:
 
 DebugConsole& getDebugConsole();
 
+std::tm toLocalTime(std::time_t time); // std::localtime without its shared buffer, safe from any thread
+
 // Debug helper functions for various in-game events
 void debugTileInfo(int tileX, int tileY, const Game& game); // Logs tile information
 void debugMarketPrices(const std::unordered_map<std::string, float>& marketPrices); // Logs market price changes
@@ -150,6 +150,24 @@ class DataProcessor:
         
         return states, actions, rewards, next_states, dones
     
+    def load_data_from_npz(self, filename):
+        """Load training data from the .npz archive exported by C++ game (no parsing needed)"""
+        print(f"Loading data from {filename}...")
+        data = np.load(filename)
+        
+        states = data['states'].astype(np.float32)
+        next_states = data['next_states'].astype(np.float32)
+        actions = np.array([self.action_mapping.get(int(a), 0) for a in data['actions']])
+        rewards = data['rewards']
+        dones = data['dones']
+        print(f"Loaded {len(actions)} experiences")
+        
+        # Normalize states
+        states = self.scaler.fit_transform(states)
+        next_states = self.scaler.transform(next_states)
+        
+        return states, actions, rewards, next_states, dones
+    
     def load_data_from_json(self, filename):
         """Load training data from JSON file exported by C++ game"""
         print(f"Loading data from {filename}...")
@@ -247,6 +265,26 @@ def plot_training_progress(losses, rewards_per_episode=None):
     plt.savefig('training_progress.png', dpi=150, bbox_inches='tight')
     plt.show()
 
+def export_native_policy(model, scaler, path):
+    """Write Dense weights + scaler in the MSPN format loaded by PolicyNetwork (C++)"""
+    dense_layers = [layer for layer in model.layers if isinstance(layer, keras.layers.Dense)]
+    input_size = dense_layers[0].get_weights()[0].shape[0]
+
+    with open(path, 'wb') as f:
+        f.write(b'MSPN')
+        np.array([1, input_size, len(dense_layers)], dtype='<u4').tofile(f)
+        np.asarray(scaler.mean_, dtype='<f4').tofile(f)
+        np.asarray(scaler.scale_, dtype='<f4').tofile(f)
+
+        for layer in dense_layers:
+            kernel, bias = layer.get_weights()
+            activation = 1 if layer.get_config()['activation'] == 'relu' else 0
+            np.array([kernel.shape[0], kernel.shape[1], activation], dtype='<u4').tofile(f)
+            np.ascontiguousarray(kernel, dtype='<f4').tofile(f)
+            np.asarray(bias, dtype='<f4').tofile(f)
+
+    print(f"Saved native policy weights to {path}")
+
 def train_model(data_file, epochs=50, save_path='models'):
     """Main training function"""
     print("=== MicroSociety Deep Q-Learning Training ===")
@@ -261,8 +299,10 @@ def train_model(data_file, epochs=50, save_path='models'):
         states, actions, rewards, next_states, dones = processor.load_data_from_csv(data_file)
     elif data_file.endswith('.json'):
         states, actions, rewards, next_states, dones = processor.load_data_from_json(data_file)
+    elif data_file.endswith('.npz'):
+        states, actions, rewards, next_states, dones = processor.load_data_from_npz(data_file)
     else:
-        raise ValueError("Data file must be .csv or .json")
+        raise ValueError("Data file must be .csv, .json or .npz")
     
     # Analyze data quality
     analyze_data(states, actions, rewards, next_states, dones)
@@ -337,6 +377,9 @@ def train_model(data_file, epochs=50, save_path='models'):
     with open(latest_tflite_path, 'wb') as f:
         f.write(tflite_model)
     print(f"Saved latest model as {latest_tflite_path}")
+
+    # Native weights for the C++ inference engine (no TensorFlow runtime needed)
+    export_native_policy(dqn.q_network, processor.scaler, os.path.join(save_path, 'npc_policy.bin'))
     
     # Plot training progress
     if losses:
@@ -378,6 +421,8 @@ def test_model(model_path, data_file, num_samples=1000):
     processor = DataProcessor()
     if data_file.endswith('.csv'):
         states, actions, rewards, next_states, dones = processor.load_data_from_csv(data_file)
+    elif data_file.endswith('.npz'):
+        states, actions, rewards, next_states, dones = processor.load_data_from_npz(data_file)
     else:
         states, actions, rewards, next_states, dones = processor.load_data_from_json(data_file)
     
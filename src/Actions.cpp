@@ -2,6 +2,7 @@
 #include "NPCEntity.hpp"
 #include "House.hpp"
 #include "Market.hpp"
+#include "ResourceRegrowth.hpp"
 
 // Base class method is overridden by each action type
 void TreeAction::perform(Entity& entity, Tile& tile, const std::vector<std::vector<std::unique_ptr<Tile>>>& tileMap) {
@@ -17,7 +18,9 @@ void TreeAction::perform(Entity& entity, Tile& tile, const std::vector<std::vect
     if (!npc) return;
 
     if (npc->addToInventory("wood", 1)) {
+        const ObjectType harvestedType = tile.getObject()->getType();
         tile.removeObject();
+        getResourceRegrowth().harvested(tile, harvestedType); // grows back later
         npc->consumeEnergy(1.0f); // Reduced from 5.0f
         npc->receiveFeedback(10.0f, tileMap);
         
@@ -47,6 +50,7 @@ void StoneAction::perform(Entity& entity, Tile& tile, const std::vector<std::vec
 
     if (npc->addToInventory("stone", 1)) {
         tile.removeObject();
+        getResourceRegrowth().harvested(tile, ObjectType::Rock);
         npc->consumeEnergy(5.0f);
         npc->receiveFeedback(10.0f, tileMap);
         
@@ -75,6 +79,7 @@ void BushAction::perform(Entity& entity, Tile& tile, const std::vector<std::vect
 
     if (npc->addToInventory("bush", 1)) {
         tile.removeObject();
+        getResourceRegrowth().harvested(tile, ObjectType::Bush);
         npc->consumeEnergy(5.0f);
         npc->receiveFeedback(10.0f, tileMap);
         
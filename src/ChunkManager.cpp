@@ -0,0 +1,432 @@
+#include "ChunkManager.hpp"
+#include "JobSystem.hpp"
+#include "SimulationSnapshot.hpp"
+#include "debug.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+namespace {
+    constexpr int kTiles = ChunkManager::kChunkSize * ChunkManager::kChunkSize;
+    constexpr uint32_t kChunkMagic = 0x314b4843; // "CHK1"
+
+    void put16(std::vector<uint8_t>& out, uint16_t value) {
+        out.push_back(static_cast<uint8_t>(value));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    uint16_t get16(const uint8_t* in) { return static_cast<uint16_t>(in[0] | in[1] << 8); }
+}
+
+ChunkManager::~ChunkManager() {
+    clear();
+}
+
+void ChunkManager::reset(const MapGenerator::Settings& world, size_t maxResidentChunks, std::string directory) {
+    clear();
+    settings = world;
+    maxResident = std::max<size_t>(maxResidentChunks, 1);
+    cacheDirectory = std::move(directory);
+    if (!cacheDirectory.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(cacheDirectory, error);
+        if (error) {
+            getDebugConsole().log("ChunkManager", "Cannot create chunk cache " + cacheDirectory + ", caching in memory", LogLevel::Error);
+            cacheDirectory.clear();
+        }
+    }
+}
+
+void ChunkManager::clear() {
+    for (uint64_t cached : cachedOnDisk) {
+        std::error_code error;
+        std::filesystem::remove(chunkPath(static_cast<int>(static_cast<uint32_t>(cached)), static_cast<int>(cached >> 32)), error);
+    }
+    cachedOnDisk.clear();
+    cachedInMemory.clear();
+    chunks.clear();
+    pinned.clear();
+    stats = Stats{};
+    tick = 1;
+}
+
+void ChunkManager::swap(ChunkManager& other) noexcept {
+    std::swap(settings, other.settings);
+    cacheDirectory.swap(other.cacheDirectory);
+    std::swap(maxResident, other.maxResident);
+    std::swap(tick, other.tick);
+    chunks.swap(other.chunks);
+    cachedInMemory.swap(other.cachedInMemory);
+    cachedOnDisk.swap(other.cachedOnDisk);
+    pinned.swap(other.pinned);
+    std::swap(stats, other.stats);
+}
+
+std::string ChunkManager::chunkPath(int cx, int cy) const {
+    return cacheDirectory + "/chunk_" + std::to_string(cx) + "_" + std::to_string(cy) + ".bin";
+}
+
+ChunkManager::Chunk ChunkManager::generate(int cx, int cy) const {
+    const MapLayout region = MapGenerator().generateRegion(settings, cx * kChunkSize, cy * kChunkSize, kChunkSize, kChunkSize);
+    Chunk chunk;
+    for (int ly = 0; ly < region.height; ++ly) {
+        for (int lx = 0; lx < kChunkSize; ++lx) {
+            // columns past the map edge continue the last run
+            const int tile = ly * kChunkSize + lx;
+            const size_t i = region.index(std::min(lx, region.width - 1), ly);
+            if (chunk.runTerrain.empty() || chunk.runTerrain.back() != region.terrain[i]) {
+                if (!chunk.runEnds.empty()) chunk.runEnds.back() = static_cast<uint16_t>(tile);
+                chunk.runEnds.push_back(0);
+                chunk.runTerrain.push_back(region.terrain[i]);
+            }
+            if (lx < region.width && region.objects[i] != ObjectType::None) {
+                chunk.objects.push_back({static_cast<uint16_t>(tile), region.objects[i], region.objectVariant[i]});
+            }
+        }
+    }
+    if (!chunk.runEnds.empty()) chunk.runEnds.back() = kTiles;
+    chunk.runEnds.shrink_to_fit();
+    chunk.runTerrain.shrink_to_fit();
+    chunk.objects.shrink_to_fit();
+    return chunk;
+}
+
+std::vector<uint8_t> ChunkManager::encode(const Chunk& chunk) {
+    std::vector<uint8_t> bytes;
+    bytes.reserve(8 + chunk.runEnds.size() * 3 + chunk.objects.size() * 4);
+    for (int shift = 0; shift < 32; shift += 8) bytes.push_back(static_cast<uint8_t>(kChunkMagic >> shift));
+    put16(bytes, static_cast<uint16_t>(chunk.runEnds.size()));
+    for (size_t r = 0; r < chunk.runEnds.size(); ++r) {
+        put16(bytes, chunk.runEnds[r]);
+        bytes.push_back(static_cast<uint8_t>(chunk.runTerrain[r]));
+    }
+    put16(bytes, static_cast<uint16_t>(chunk.objects.size()));
+    for (const auto& object : chunk.objects) {
+        put16(bytes, object.tile);
+        bytes.push_back(static_cast<uint8_t>(object.type));
+        bytes.push_back(object.variant);
+    }
+    return bytes;
+}
+
+bool ChunkManager::decode(const std::vector<uint8_t>& bytes, Chunk& chunk) {
+    size_t at = 0;
+    auto has = [&](size_t count) { return bytes.size() - at >= count; };
+    if (!has(6)) return false;
+    uint32_t magic = 0;
+    for (int shift = 0; shift < 32; shift += 8) magic |= static_cast<uint32_t>(bytes[at++]) << shift;
+    if (magic != kChunkMagic) return false;
+
+    const uint16_t runs = get16(&bytes[at]);
+    at += 2;
+    if (runs == 0 || !has(runs * size_t{3} + 2)) return false;
+    chunk.runEnds.resize(runs);
+    chunk.runTerrain.resize(runs);
+    for (uint16_t r = 0; r < runs; ++r, at += 3) {
+        chunk.runEnds[r] = get16(&bytes[at]);
+        chunk.runTerrain[r] = static_cast<Terrain>(std::min<uint8_t>(bytes[at + 2], static_cast<uint8_t>(Terrain::Stone)));
+    }
+    if (chunk.runEnds.back() != kTiles) return false;
+
+    const uint16_t objects = get16(&bytes[at]);
+    at += 2;
+    if (!has(objects * size_t{4})) return false;
+    chunk.objects.resize(objects);
+    for (uint16_t o = 0; o < objects; ++o, at += 4) {
+        chunk.objects[o] = {get16(&bytes[at]), static_cast<ObjectType>(bytes[at + 2]), bytes[at + 3]};
+        if (chunk.objects[o].tile >= kTiles || (o > 0 && chunk.objects[o].tile <= chunk.objects[o - 1].tile)) return false;
+    }
+    chunk.dirty = false;
+    return true;
+}
+
+void ChunkManager::store(int cx, int cy, const Chunk& chunk) {
+    ++stats.written;
+    cacheBytes(cx, cy, encode(chunk));
+}
+
+void ChunkManager::cacheBytes(int cx, int cy, std::vector<uint8_t> bytes) {
+    if (!cacheDirectory.empty()) {
+        std::ofstream file(chunkPath(cx, cy), std::ios::binary | std::ios::trunc);
+        if (file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+            cachedOnDisk.insert(key(cx, cy));
+            cachedInMemory.erase(key(cx, cy));
+            return;
+        }
+        getDebugConsole().log("ChunkManager", "Failed to write " + chunkPath(cx, cy) + ", keeping it in memory", LogLevel::Error);
+    }
+    cachedInMemory[key(cx, cy)] = std::move(bytes);
+}
+
+std::vector<uint8_t> ChunkManager::cachedBytes(uint64_t id) const {
+    auto inMemory = cachedInMemory.find(id);
+    if (inMemory != cachedInMemory.end()) return inMemory->second;
+    if (!cachedOnDisk.count(id)) return {};
+    std::ifstream file(chunkPath(static_cast<int>(static_cast<uint32_t>(id)), static_cast<int>(id >> 32)), std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+bool ChunkManager::load(int cx, int cy, Chunk& chunk) {
+    const uint64_t id = key(cx, cy);
+    auto inMemory = cachedInMemory.find(id);
+    if (inMemory != cachedInMemory.end()) {
+        if (!decode(inMemory->second, chunk)) return false;
+        ++stats.loaded;
+        return true;
+    }
+    if (!cachedOnDisk.count(id)) return false;
+
+    if (!decode(cachedBytes(id), chunk)) {
+        getDebugConsole().log("ChunkManager", "Corrupt chunk cache " + chunkPath(cx, cy) + ", regenerating from the seed", LogLevel::Error);
+        cachedOnDisk.erase(id);
+        chunk = Chunk{};
+        return false;
+    }
+    ++stats.loaded;
+    return true;
+}
+
+ChunkManager::Chunk& ChunkManager::chunkAt(int cx, int cy) {
+    auto found = chunks.find(key(cx, cy));
+    if (found == chunks.end()) {
+        Chunk chunk;
+        if (!load(cx, cy, chunk)) {
+            chunk = generate(cx, cy);
+            ++stats.generated;
+        }
+        Chunk& inserted = chunks.emplace(key(cx, cy), std::move(chunk)).first->second;
+        inserted.lastTouch = tick;
+        stats.resident = chunks.size();
+        if (residencyListener) residencyListener(cx, cy, true); // references survive what it inserts
+        return inserted;
+    }
+    found->second.lastTouch = tick;
+    return found->second;
+}
+
+void ChunkManager::touch(int x, int y) {
+    if (contains(x, y)) chunkAt(x / kChunkSize, y / kChunkSize);
+}
+
+void ChunkManager::pin(int x, int y) {
+    if (!contains(x, y)) return;
+    pinned.insert(key(x / kChunkSize, y / kChunkSize));
+    chunkAt(x / kChunkSize, y / kChunkSize);
+}
+
+std::vector<std::pair<int, int>> ChunkManager::residentChunks() const {
+    std::vector<std::pair<int, int>> resident;
+    resident.reserve(chunks.size());
+    for (const auto& entry : chunks) {
+        resident.emplace_back(static_cast<int>(static_cast<uint32_t>(entry.first)), static_cast<int>(entry.first >> 32));
+    }
+    return resident;
+}
+
+void ChunkManager::touchArea(int x0, int y0, int x1, int y1) {
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, settings.width - 1);
+    y1 = std::min(y1, settings.height - 1);
+    if (x0 > x1 || y0 > y1) return;
+
+    // chunks missing from memory and the cache are generated in parallel, then inserted
+    std::vector<std::pair<int, int>> missing;
+    for (int cy = y0 / kChunkSize; cy <= y1 / kChunkSize; ++cy) {
+        for (int cx = x0 / kChunkSize; cx <= x1 / kChunkSize; ++cx) {
+            const uint64_t id = key(cx, cy);
+            if (!chunks.count(id) && !cachedInMemory.count(id) && !cachedOnDisk.count(id)) missing.emplace_back(cx, cy);
+        }
+    }
+    std::vector<Chunk> built(missing.size());
+    getJobSystem().parallelFor(0, missing.size(), 1, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) built[i] = generate(missing[i].first, missing[i].second);
+    });
+    for (size_t i = 0; i < missing.size(); ++i) {
+        chunks.emplace(key(missing[i].first, missing[i].second), std::move(built[i])).first->second.lastTouch = tick;
+        ++stats.generated;
+    }
+    stats.resident = chunks.size();
+    if (residencyListener) {
+        for (const auto& [cx, cy] : missing) residencyListener(cx, cy, true);
+    }
+
+    for (int cy = y0 / kChunkSize; cy <= y1 / kChunkSize; ++cy) {
+        for (int cx = x0 / kChunkSize; cx <= x1 / kChunkSize; ++cx) chunkAt(cx, cy);
+    }
+}
+
+Terrain ChunkManager::terrainOf(const Chunk& chunk, int tile) {
+    const auto run = std::upper_bound(chunk.runEnds.begin(), chunk.runEnds.end(), static_cast<uint16_t>(tile));
+    if (run == chunk.runEnds.end()) return chunk.runTerrain.empty() ? Terrain::Flower : chunk.runTerrain.back();
+    return chunk.runTerrain[run - chunk.runEnds.begin()];
+}
+
+ChunkManager::TileInfo ChunkManager::tileAt(int x, int y) {
+    TileInfo info;
+    if (!contains(x, y)) return info;
+    const Chunk& chunk = chunkAt(x / kChunkSize, y / kChunkSize);
+    const int tile = (y % kChunkSize) * kChunkSize + x % kChunkSize;
+    info.terrain = terrainOf(chunk, tile);
+    info.variant = MapGenerator::terrainVariantAt(settings, info.terrain, x, y);
+    const auto object = std::lower_bound(chunk.objects.begin(), chunk.objects.end(), tile,
+                                         [](const ObjectEntry& entry, int t) { return entry.tile < t; });
+    if (object != chunk.objects.end() && object->tile == tile) {
+        info.object = object->type;
+        info.objectVariant = object->variant;
+    }
+    return info;
+}
+
+ObjectType ChunkManager::objectAt(int x, int y) {
+    return tileAt(x, y).object;
+}
+
+void ChunkManager::setObject(int x, int y, ObjectType type, uint8_t variant) {
+    if (!contains(x, y)) return;
+    Chunk& chunk = chunkAt(x / kChunkSize, y / kChunkSize);
+    const auto tile = static_cast<uint16_t>((y % kChunkSize) * kChunkSize + x % kChunkSize);
+    auto object = std::lower_bound(chunk.objects.begin(), chunk.objects.end(), tile,
+                                   [](const ObjectEntry& entry, uint16_t t) { return entry.tile < t; });
+    const bool present = object != chunk.objects.end() && object->tile == tile;
+
+    if (type == ObjectType::None) {
+        if (!present) return;
+        chunk.objects.erase(object);
+    } else if (!present) {
+        chunk.objects.insert(object, {tile, type, variant});
+    } else if (object->type != type || object->variant != variant) {
+        object->type = type;
+        object->variant = variant;
+    } else {
+        return;
+    }
+    chunk.dirty = true;
+}
+
+void ChunkManager::noiseRow(int y, int x, int count, float* out) const {
+    PerlinRows(settings.seed, settings.frequency, count, x).row(y, out);
+    for (int i = 0; i < count; ++i) out[i] = (out[i] + 1.0f) / 2.0f;
+}
+
+bool ChunkManager::findNearest(ObjectType type, float fromX, float fromY, float maxRadius, int& foundX, int& foundY) {
+    if (settings.width <= 0 || settings.height <= 0 || maxRadius < 0) return false;
+    const int originX = std::clamp(static_cast<int>(std::floor(fromX)), 0, settings.width - 1) / kChunkSize;
+    const int originY = std::clamp(static_cast<int>(std::floor(fromY)), 0, settings.height - 1) / kChunkSize;
+    const float radiusSquared = maxRadius * maxRadius;
+    const int lastRing = std::max({originX, chunksX() - 1 - originX, originY, chunksY() - 1 - originY});
+
+    float best = std::numeric_limits<float>::max();
+    int bestX = -1, bestY = -1;
+    for (int ring = 0; ring <= lastRing; ++ring) {
+        // every tile of ring r is at least (r - 1) chunks away from any point of the origin chunk
+        const float nearestRing = static_cast<float>(std::max(ring - 1, 0) * kChunkSize);
+        if (nearestRing * nearestRing > std::min(best, radiusSquared)) break;
+
+        for (int cy = originY - ring; cy <= originY + ring; ++cy) {
+            if (cy < 0 || cy >= chunksY()) continue;
+            const bool edgeRow = cy == originY - ring || cy == originY + ring;
+            for (int cx = originX - ring; cx <= originX + ring; cx += edgeRow ? 1 : 2 * std::max(ring, 1)) {
+                if (cx < 0 || cx >= chunksX()) continue;
+                // skip chunks that cannot beat the best so far without generating them
+                const float dx = std::max({cx * kChunkSize - fromX, 0.0f, fromX - (cx * kChunkSize + kChunkSize - 1)});
+                const float dy = std::max({cy * kChunkSize - fromY, 0.0f, fromY - (cy * kChunkSize + kChunkSize - 1)});
+                if (dx * dx + dy * dy > std::min(best, radiusSquared)) continue;
+
+                for (const auto& object : chunkAt(cx, cy).objects) {
+                    if (object.type != type) continue;
+                    const int x = cx * kChunkSize + object.tile % kChunkSize;
+                    const int y = cy * kChunkSize + object.tile / kChunkSize;
+                    const float ox = x - fromX, oy = y - fromY;
+                    const float distance = ox * ox + oy * oy;
+                    if (distance > radiusSquared) continue;
+                    if (distance < best || (distance == best && (y < bestY || (y == bestY && x < bestX)))) {
+                        best = distance;
+                        bestX = x;
+                        bestY = y;
+                    }
+                }
+            }
+        }
+    }
+    if (bestX < 0) return false;
+    foundX = bestX;
+    foundY = bestY;
+    return true;
+}
+
+size_t ChunkManager::endTick() {
+    size_t evicted = 0;
+    if (chunks.size() > maxResident) {
+        // least recently touched first; chunks touched this tick stay
+        std::vector<std::pair<uint64_t, uint64_t>> idle; // (last touch, key)
+        for (const auto& [id, chunk] : chunks) {
+            if (chunk.lastTouch < tick && !pinned.count(id)) idle.emplace_back(chunk.lastTouch, id);
+        }
+        std::sort(idle.begin(), idle.end());
+        for (size_t i = 0; i < idle.size() && chunks.size() > maxResident; ++i) {
+            auto found = chunks.find(idle[i].second);
+            const int cx = static_cast<int>(static_cast<uint32_t>(idle[i].second));
+            const int cy = static_cast<int>(idle[i].second >> 32);
+            if (residencyListener) residencyListener(cx, cy, false);
+            if (found->second.dirty) store(cx, cy, found->second); // clean chunks regenerate or reload
+            chunks.erase(found);
+            ++evicted;
+        }
+        stats.evicted += evicted;
+        stats.resident = chunks.size();
+    }
+    ++tick;
+    return evicted;
+}
+
+void ChunkManager::saveSnapshot(std::vector<SnapshotChunk>& saved) const {
+    saved.clear();
+    saved.reserve(chunks.size() + cachedInMemory.size() + cachedOnDisk.size());
+    for (const auto& [id, chunk] : chunks) {
+        saved.push_back({static_cast<int32_t>(static_cast<uint32_t>(id)), static_cast<int32_t>(id >> 32), true, encode(chunk)});
+    }
+    // a cached copy of a resident chunk is older than the chunk
+    auto addCached = [&](uint64_t id) {
+        if (!chunks.count(id)) saved.push_back({static_cast<int32_t>(static_cast<uint32_t>(id)), static_cast<int32_t>(id >> 32), false, cachedBytes(id)});
+    };
+    for (const auto& entry : cachedInMemory) addCached(entry.first);
+    for (uint64_t id : cachedOnDisk) {
+        if (!cachedInMemory.count(id)) addCached(id);
+    }
+}
+
+bool ChunkManager::restoreSnapshot(const std::vector<SnapshotChunk>& saved) {
+    bool intact = true;
+    for (const SnapshotChunk& entry : saved) {
+        Chunk chunk;
+        if (entry.cx < 0 || entry.cy < 0 || entry.cx >= chunksX() || entry.cy >= chunksY() || !decode(entry.bytes, chunk)) {
+            intact = false;
+            continue;
+        }
+        if (!entry.resident) {
+            cacheBytes(entry.cx, entry.cy, entry.bytes);
+            continue;
+        }
+        chunk.dirty = true; // it may hold edits, and nothing else has them now
+        chunk.lastTouch = tick;
+        if (!chunks.insert_or_assign(key(entry.cx, entry.cy), std::move(chunk)).second) continue;
+        if (residencyListener) residencyListener(entry.cx, entry.cy, true);
+    }
+    stats.resident = chunks.size();
+    if (!intact) getDebugConsole().log("ChunkManager", "Snapshot held corrupt chunks, regenerating them from the seed", LogLevel::Error);
+    return intact;
+}
+
+size_t ChunkManager::residentBytes() const {
+    size_t bytes = 0;
+    for (const auto& [id, chunk] : chunks) {
+        bytes += sizeof(id) + sizeof(Chunk) + chunk.runEnds.capacity() * sizeof(uint16_t) +
+                 chunk.runTerrain.capacity() * sizeof(Terrain) + chunk.objects.capacity() * sizeof(ObjectEntry);
+    }
+    return bytes;
+}
@@ -0,0 +1,447 @@
+#include "DQNTrainer.hpp"
+#include "Configuration.hpp"
+#include "debug.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+
+namespace {
+    // Adam constants (Keras defaults, matching the Python trainer)
+    constexpr float kBeta1 = 0.9f;
+    constexpr float kBeta2 = 0.999f;
+    constexpr float kAdamEpsilon = 1e-7f;
+
+    void adamUpdate(std::vector<float>& params, const std::vector<float>& grads,
+                    std::vector<float>& m, std::vector<float>& v,
+                    float stepSize, float beta1Correction, float beta2Correction) {
+        for (size_t i = 0; i < params.size(); ++i) {
+            m[i] = kBeta1 * m[i] + (1.0f - kBeta1) * grads[i];
+            v[i] = kBeta2 * v[i] + (1.0f - kBeta2) * grads[i] * grads[i];
+            const float mHat = m[i] / beta1Correction;
+            const float vHat = v[i] / beta2Correction;
+            params[i] -= stepSize * mHat / (std::sqrt(vHat) + kAdamEpsilon);
+        }
+    }
+}
+
+DQNTrainer::DQNTrainer(const DQNTrainerConfig& trainerConfig)
+    : config(trainerConfig) {
+    const unsigned seed = config.seed != 0 ? config.seed : std::random_device{}();
+    trainRng.seed(seed);
+    sampleRng.seed(seed ^ 0x9E3779B9u);
+
+    // Map raw features to roughly [-1, 1]: tile coordinates, 3x3 neighbour counts (0..9), levels (0..2)
+    std::vector<float> mean = {(GameConfig::mapWidth - 1) * 0.5f, (GameConfig::mapHeight - 1) * 0.5f,
+                               4.5f, 4.5f, 4.5f, 1.0f, 1.0f};
+    std::vector<float> scale = {GameConfig::mapWidth * 0.5f, GameConfig::mapHeight * 0.5f,
+                                4.5f, 4.5f, 4.5f, 1.0f, 1.0f};
+    mean.resize(config.stateSize, 0.0f);
+    scale.resize(config.stateSize, 1.0f);
+    setScaler(std::move(mean), std::move(scale));
+
+    initializeWeights(trainRng);
+    allocateBuffers();
+    replay.reserve(config.replayCapacity);
+    syncTarget();
+    publish();
+}
+
+DQNTrainer::~DQNTrainer() {
+    stop();
+}
+
+void DQNTrainer::setScaler(std::vector<float> mean, std::vector<float> scale) {
+    for (float& s : scale) {
+        if (s == 0.0f) s = 1.0f;
+    }
+    scalerMean = std::move(mean);
+    scalerScale = std::move(scale);
+}
+
+// Glorot-uniform kernels and zero biases (Keras Dense defaults)
+void DQNTrainer::initializeWeights(std::mt19937& rng) {
+    online.clear();
+    int inputs = config.stateSize;
+    std::vector<int> widths = config.hiddenLayers;
+    widths.push_back(config.actionCount);
+
+    for (size_t l = 0; l < widths.size(); ++l) {
+        TrainableLayer layer;
+        layer.params.inputs = inputs;
+        layer.params.outputs = widths[l];
+        layer.params.relu = l + 1 < widths.size();
+
+        const float limit = std::sqrt(6.0f / static_cast<float>(inputs + widths[l]));
+        std::uniform_real_distribution<float> dist(-limit, limit);
+        layer.params.weights.resize(static_cast<size_t>(inputs) * widths[l]);
+        for (float& w : layer.params.weights) w = dist(rng);
+        layer.params.bias.assign(widths[l], 0.0f);
+
+        online.push_back(std::move(layer));
+        inputs = widths[l];
+    }
+}
+
+void DQNTrainer::allocateBuffers() {
+    const size_t batchSize = static_cast<size_t>(config.batchSize);
+    size_t widest = static_cast<size_t>(config.stateSize);
+
+    activations.assign(online.size() + 1, {});
+    activations[0].resize(batchSize * config.stateSize);
+    for (size_t l = 0; l < online.size(); ++l) {
+        TrainableLayer& layer = online[l];
+        const size_t weightCount = layer.params.weights.size();
+        const size_t biasCount = layer.params.bias.size();
+        layer.gradWeights.assign(weightCount, 0.0f);
+        layer.mWeights.assign(weightCount, 0.0f);
+        layer.vWeights.assign(weightCount, 0.0f);
+        layer.gradBias.assign(biasCount, 0.0f);
+        layer.mBias.assign(biasCount, 0.0f);
+        layer.vBias.assign(biasCount, 0.0f);
+
+        activations[l + 1].resize(batchSize * layer.params.outputs);
+        widest = std::max(widest, static_cast<size_t>(layer.params.outputs));
+    }
+
+    deltaA.resize(batchSize * widest);
+    deltaB.resize(batchSize * widest);
+    targetQ.resize(batchSize * config.actionCount);
+    nextStates.resize(batchSize * config.stateSize);
+    batch.resize(batchSize);
+    adamStep = 0;
+}
+
+bool DQNTrainer::loadWeights(const std::string& path) {
+    PolicyNetwork loaded;
+    if (!loaded.loadFromFile(path)) {
+        return false;
+    }
+
+    const auto& layers = loaded.getLayers();
+    bool shapeMatches = layers.size() == online.size();
+    for (size_t l = 0; shapeMatches && l < layers.size(); ++l) {
+        shapeMatches = layers[l].inputs == online[l].params.inputs &&
+                       layers[l].outputs == online[l].params.outputs &&
+                       layers[l].relu == online[l].params.relu;
+    }
+    if (!shapeMatches) {
+        getDebugConsole().log("DQNTrainer", "Checkpoint shape does not match trainer config: " + path, LogLevel::Error);
+        return false;
+    }
+
+    if (running) {
+        getDebugConsole().log("DQNTrainer", "Cannot load weights while training is running", LogLevel::Error);
+        return false;
+    }
+
+    for (size_t l = 0; l < layers.size(); ++l) {
+        online[l].params = layers[l];
+    }
+    setScaler(loaded.getFeatureMean(), loaded.getFeatureScale());
+    allocateBuffers(); // fresh optimizer state for the new weights
+    syncTarget();
+    publish();
+
+    getDebugConsole().log("DQNTrainer", "Warm-started from checkpoint: " + path);
+    return true;
+}
+
+// Write to a temp file first so a crash mid-write never corrupts the last good checkpoint
+bool DQNTrainer::saveCheckpoint(const std::string& path) const {
+    auto snapshot = getPublishedPolicy();
+    if (!snapshot) return false;
+
+    const std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    if (!directory.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+    }
+
+    const std::string tempPath = path + ".tmp";
+    if (!snapshot->saveToFile(tempPath)) {
+        return false;
+    }
+    std::remove(path.c_str());
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        getDebugConsole().log("DQNTrainer", "Failed to move checkpoint into place: " + path, LogLevel::Error);
+        return false;
+    }
+    return true;
+}
+
+void DQNTrainer::addExperience(const float* state, int actionIndex, float reward, const float* nextState, bool done,
+                               bool scheduleTraining) {
+    if (actionIndex < 0 || actionIndex >= config.actionCount) return;
+
+    {
+        std::lock_guard<std::mutex> lock(replayMutex);
+        if (replay.size() < config.replayCapacity) {
+            replay.push_back({std::vector<float>(state, state + config.stateSize),
+                              std::vector<float>(nextState, nextState + config.stateSize),
+                              actionIndex, reward, done});
+        } else {
+            Transition& slot = replay[replayHead];
+            slot.state.assign(state, state + config.stateSize);
+            slot.nextState.assign(nextState, nextState + config.stateSize);
+            slot.action = actionIndex;
+            slot.reward = reward;
+            slot.done = done;
+            replayHead = (replayHead + 1) % config.replayCapacity;
+        }
+        // experiences that arrive before the first full batch only fill replay; counting them
+        // would release a burst of steps on stale data once the batch is complete
+        if (!scheduleTraining || replay.size() < static_cast<size_t>(config.batchSize)) return;
+        pendingSteps += config.trainStepsPerExperience;
+    }
+    replayCondition.notify_one();
+}
+
+// Copy a uniform minibatch out of replay so the gradient step runs without holding the lock
+bool DQNTrainer::sampleBatch() {
+    std::lock_guard<std::mutex> lock(replayMutex);
+    if (replay.size() < static_cast<size_t>(config.batchSize)) return false;
+
+    std::uniform_int_distribution<size_t> pick(0, replay.size() - 1);
+    for (auto& transition : batch) {
+        transition = replay[pick(sampleRng)];
+    }
+    return true;
+}
+
+float DQNTrainer::trainStep() {
+    if (!sampleBatch()) return -1.0f;
+    return optimizeBatch();
+}
+
+float DQNTrainer::optimizeBatch() {
+    const int batchSize = config.batchSize;
+    const int stateSize = config.stateSize;
+    const int actions = config.actionCount;
+
+    // Bellman targets from the frozen target network: r + gamma * max_a' Q_target(s', a')
+    for (int b = 0; b < batchSize; ++b) {
+        std::copy(batch[b].nextState.begin(), batch[b].nextState.end(), nextStates.begin() + static_cast<size_t>(b) * stateSize);
+    }
+    target.forwardBatch(nextStates.data(), batchSize, targetQ.data(), targetWorkspace);
+
+    // Forward pass of the online network, keeping every activation for backprop
+    float* input = activations[0].data();
+    for (int b = 0; b < batchSize; ++b) {
+        for (int i = 0; i < stateSize; ++i) {
+            input[b * stateSize + i] = (batch[b].state[i] - scalerMean[i]) / scalerScale[i];
+        }
+    }
+    for (size_t l = 0; l < online.size(); ++l) {
+        const DenseLayer& layer = online[l].params;
+        const float* x = activations[l].data();
+        float* y = activations[l + 1].data();
+        for (int b = 0; b < batchSize; ++b) {
+            float* row = y + static_cast<size_t>(b) * layer.outputs;
+            std::copy(layer.bias.begin(), layer.bias.end(), row);
+            for (int i = 0; i < layer.inputs; ++i) {
+                const float xi = x[static_cast<size_t>(b) * layer.inputs + i];
+                const float* w = layer.weights.data() + static_cast<size_t>(i) * layer.outputs;
+                for (int o = 0; o < layer.outputs; ++o) row[o] += xi * w[o];
+            }
+            if (layer.relu) {
+                for (int o = 0; o < layer.outputs; ++o) row[o] = std::max(row[o], 0.0f);
+            }
+        }
+    }
+
+    // MSE on the taken action only; other outputs get zero gradient
+    const float* q = activations.back().data();
+    float* delta = deltaA.data();
+    std::fill(delta, delta + static_cast<size_t>(batchSize) * actions, 0.0f);
+    float loss = 0.0f;
+    for (int b = 0; b < batchSize; ++b) {
+        const Transition& t = batch[b];
+        const float* nextQ = targetQ.data() + static_cast<size_t>(b) * actions;
+        const float bootstrap = t.done ? 0.0f : config.gamma * *std::max_element(nextQ, nextQ + actions);
+        const float error = q[b * actions + t.action] - (t.reward + bootstrap);
+        loss += error * error;
+        delta[b * actions + t.action] = 2.0f * error / batchSize;
+    }
+    loss /= batchSize;
+
+    // Backward pass: delta holds dL/dz for the current layer
+    for (size_t l = online.size(); l-- > 0;) {
+        TrainableLayer& layer = online[l];
+        const int inputs = layer.params.inputs;
+        const int outputs = layer.params.outputs;
+        const float* x = activations[l].data();
+
+        std::fill(layer.gradWeights.begin(), layer.gradWeights.end(), 0.0f);
+        std::fill(layer.gradBias.begin(), layer.gradBias.end(), 0.0f);
+        for (int b = 0; b < batchSize; ++b) {
+            const float* d = delta + static_cast<size_t>(b) * outputs;
+            for (int o = 0; o < outputs; ++o) layer.gradBias[o] += d[o];
+            for (int i = 0; i < inputs; ++i) {
+                const float xi = x[static_cast<size_t>(b) * inputs + i];
+                if (xi == 0.0f) continue; // dead ReLU inputs contribute nothing
+                float* g = layer.gradWeights.data() + static_cast<size_t>(i) * outputs;
+                for (int o = 0; o < outputs; ++o) g[o] += xi * d[o];
+            }
+        }
+
+        if (l > 0) {
+            // dL/da_prev = delta * W^T, masked by the previous layer's ReLU
+            float* previous = (delta == deltaA.data()) ? deltaB.data() : deltaA.data();
+            for (int b = 0; b < batchSize; ++b) {
+                const float* d = delta + static_cast<size_t>(b) * outputs;
+                float* p = previous + static_cast<size_t>(b) * inputs;
+                for (int i = 0; i < inputs; ++i) {
+                    if (x[static_cast<size_t>(b) * inputs + i] <= 0.0f) {
+                        p[i] = 0.0f;
+                        continue;
+                    }
+                    const float* w = layer.params.weights.data() + static_cast<size_t>(i) * outputs;
+                    float sum = 0.0f;
+                    for (int o = 0; o < outputs; ++o) sum += w[o] * d[o];
+                    p[i] = sum;
+                }
+            }
+            delta = previous;
+        }
+    }
+
+    ++adamStep;
+    const float beta1Correction = 1.0f - std::pow(kBeta1, static_cast<float>(adamStep));
+    const float beta2Correction = 1.0f - std::pow(kBeta2, static_cast<float>(adamStep));
+    for (auto& layer : online) {
+        adamUpdate(layer.params.weights, layer.gradWeights, layer.mWeights, layer.vWeights,
+                   config.learningRate, beta1Correction, beta2Correction);
+        adamUpdate(layer.params.bias, layer.gradBias, layer.mBias, layer.vBias,
+                   config.learningRate, beta1Correction, beta2Correction);
+    }
+
+    const uint64_t steps = ++stepCount;
+    if (config.targetSyncInterval > 0 && steps % config.targetSyncInterval == 0) {
+        syncTarget();
+    }
+    if (config.publishInterval > 0 && steps % config.publishInterval == 0) {
+        publish();
+    }
+
+    lastLoss = loss;
+    return loss;
+}
+
+PolicyNetwork DQNTrainer::toPolicyNetwork() const {
+    std::vector<DenseLayer> layers;
+    layers.reserve(online.size());
+    for (const auto& layer : online) {
+        layers.push_back(layer.params);
+    }
+    PolicyNetwork network;
+    network.setScaler(scalerMean, scalerScale);
+    network.setLayers(std::move(layers));
+    return network;
+}
+
+void DQNTrainer::syncTarget() {
+    target = toPolicyNetwork();
+}
+
+void DQNTrainer::publish() {
+    auto snapshot = std::make_shared<const PolicyNetwork>(toPolicyNetwork());
+
+    std::shared_ptr<const std::vector<float>> calibration;
+    float minAgreement;
+    {
+        std::lock_guard<std::mutex> lock(publishMutex);
+        calibration = calibrationFeatures;
+        minAgreement = minQuantizedAgreement;
+    }
+
+    // quantize here, on the training thread, rather than where the snapshot is adopted
+    std::shared_ptr<const QuantizedPolicyNetwork> quantized;
+    QuantizedPolicyNetwork::AccuracyReport report;
+    const int rows = calibration ? static_cast<int>(calibration->size() / config.stateSize) : 0;
+    if (rows > 0) {
+        auto candidate = std::make_shared<QuantizedPolicyNetwork>();
+        if (candidate->quantize(*snapshot, calibration->data(), rows)) {
+            report = QuantizedPolicyNetwork::compare(*snapshot, *candidate, calibration->data(), rows);
+            if (report.actionAgreement >= minAgreement) quantized = std::move(candidate);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(publishMutex);
+        published = std::move(snapshot);
+        publishedQuantized = std::move(quantized);
+        publishedReport = report;
+    }
+    ++publishedVersion;
+}
+
+std::shared_ptr<const PolicyNetwork> DQNTrainer::getPublishedPolicy() const {
+    std::lock_guard<std::mutex> lock(publishMutex);
+    return published;
+}
+
+DQNTrainer::PublishedPolicy DQNTrainer::getPublished() const {
+    std::lock_guard<std::mutex> lock(publishMutex);
+    return {published, publishedQuantized, publishedReport};
+}
+
+void DQNTrainer::setQuantizationCalibration(std::vector<float> features, float minAgreement) {
+    auto rows = std::make_shared<const std::vector<float>>(std::move(features));
+    std::lock_guard<std::mutex> lock(publishMutex);
+    calibrationFeatures = rows->empty() ? nullptr : std::move(rows);
+    minQuantizedAgreement = minAgreement;
+}
+
+float DQNTrainer::getEpsilon() const {
+    if (config.epsilonDecaySteps <= 0) return config.epsilonMin;
+    const float progress = std::min(1.0f, static_cast<float>(stepCount.load()) / config.epsilonDecaySteps);
+    return config.epsilonStart + (config.epsilonMin - config.epsilonStart) * progress;
+}
+
+size_t DQNTrainer::getReplaySize() const {
+    std::lock_guard<std::mutex> lock(replayMutex);
+    return replay.size();
+}
+
+float DQNTrainer::getPendingSteps() const {
+    std::lock_guard<std::mutex> lock(replayMutex);
+    return pendingSteps;
+}
+
+void DQNTrainer::start() {
+    if (running) return;
+    running = true;
+    worker = std::thread(&DQNTrainer::workerLoop, this);
+    getDebugConsole().log("DQNTrainer", "Online training started");
+}
+
+void DQNTrainer::stop() {
+    if (!running) return;
+    {
+        std::lock_guard<std::mutex> lock(replayMutex);
+        running = false;
+    }
+    replayCondition.notify_all();
+    if (worker.joinable()) worker.join();
+    publish(); // expose the final weights
+}
+
+// Train only as fast as experiences arrive (trainStepsPerExperience) so an idle simulation idles the thread
+void DQNTrainer::workerLoop() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(replayMutex);
+            replayCondition.wait(lock, [this] {
+                return !running || (pendingSteps >= 1.0f && replay.size() >= static_cast<size_t>(config.batchSize));
+            });
+            if (!running) return;
+            pendingSteps -= 1.0f;
+        }
+
+        if (sampleBatch()) {
+            optimizeBatch();
+        }
+    }
+}
@@ -1,16 +1,44 @@
 #include "DataCollector.hpp"
+#include "ExperienceCodec.hpp"
+#include "ExperienceCsv.hpp"
+#include "ExperienceDataset.hpp"
+#include "ExperienceRecorder.hpp"
+#include "ExperienceWriter.hpp"
+#include "NumpyIO.hpp"
+#include "ObservationBuilder.hpp"
 #include "debug.hpp"
 #include <filesystem>
 #include <algorithm>
 #include <numeric>
+#include <cmath>
 #include <iomanip>
 #include <sstream>
 #include <ctime>
 
+// stored observation rows and one staged row per NPC id
+struct ObservationLog {
+    ObservationBatch rows;
+    std::vector<uint16_t> npcIds;
+    std::vector<uint32_t> ticks;
+    std::vector<uint8_t> actions;
+    std::vector<float> rewards;
+
+    ObservationBatch staged;        // row `id` belongs to NPC id (count unused)
+    std::vector<uint8_t> stagedFor; // 1 while NPC id has a row waiting for its experience
+    bool capWarned = false;
+};
+
 DataCollector::DataCollector(const std::string& outputDir) 
-    : outputDirectory(outputDir) {
+    : recorder(std::make_unique<ExperienceRecorder>()),
+      experiences(std::make_shared<std::vector<ExperienceRecord>>()),
+      outputDirectory(outputDir),
+      writer(std::make_unique<ExperienceWriter>()),
+      observations(std::make_unique<ObservationLog>()),
+      npcNames(std::make_shared<const std::vector<std::string>>()) {
     createOutputDirectory(); 
     currentSessionFile = generateFilename();
+    experiences->reserve(batchCapacity());
+    publishStatistics();
 }
 
 DataCollector::~DataCollector() {
@@ -42,6 +70,9 @@ void DataCollector::startCollection() {
     std::lock_guard<std::mutex> lock(dataMutex);
     isCollecting = true;
     experiencesThisSession = 0;
+    progressReported = 0;
+    statistics.reset();
+    publishStatistics();
     currentSessionFile = generateFilename();
     getDebugConsole().log("DataCollector", "Started data collection session: " + currentSessionFile);
 }
@@ -51,263 +82,658 @@ void DataCollector::startCollection() {
 void DataCollector::stopCollection() {
     std::lock_guard<std::mutex> lock(dataMutex);
     if (isCollecting) {
-        saveCurrentBatch();
         isCollecting = false;
+        collectPendingExperiences();
+        saveCurrentBatch();
         getDebugConsole().log("DataCollector", "Stopped data collection. Total experiences this session: " + 
                             std::to_string(experiencesThisSession));
     }
 }
 
-//  record experience
+// record experience (hot path: no lock, no allocation, no logging)
 void DataCollector::recordExperience(const State& state, ActionType action, float reward, 
-                                    const State& nextState, bool done, const std::string& npcName) {
-    if (!isCollecting) {
+                                    const State& nextState, bool done, uint16_t npcId) {
+    recordExperience(PackedState::pack(state), action, reward, PackedState::pack(nextState), done, npcId);
+}
+
+// hot path for callers that already hold packed states
+void DataCollector::recordExperience(PackedState state, ActionType action, float reward, 
+                                    PackedState nextState, bool done, uint16_t npcId) {
+    if (!isCollecting.load(std::memory_order_relaxed)) {
+#ifdef EXPERIENCE_TRACE
         getDebugConsole().log("DataCollector", "WARNING: Not collecting, ignoring experience", LogLevel::Warning);
+#endif
         return;
     }
     
-    std::lock_guard<std::mutex> lock(dataMutex);
-    
-    float timestamp = static_cast<float>(std::time(nullptr));
-    ExperienceData exp(state, action, reward, nextState, done, npcName, timestamp);
-    experiences.push_back(exp);
-    
-    updateStatistics(exp);
-    
-    // log info for debugging
+    ExperienceRecord record;
+    record.state = state.bits;
+    record.nextState = nextState.bits;
+    record.reward = reward;
+    record.tick = currentTick.load(std::memory_order_relaxed);
+    record.npcId = npcId;
+    record.action = static_cast<uint8_t>(action);
+    record.done = done ? 1 : 0;
+    recorder->append(record);
+    
+#ifdef EXPERIENCE_TRACE
     getDebugConsole().log("DataCollection", 
-        "RECORDED: " + npcName + 
+        "RECORDED: npc#" + std::to_string(npcId) + 
         " | Action=" + std::to_string(static_cast<int>(action)) + 
         " | Reward=" + std::to_string(reward) + 
-        " | State=(" + std::to_string(state.posX) + "," + std::to_string(state.posY) + ")" +
-        " | Energy=" + std::to_string(state.energyLevel) +
-        " | Inventory=" + std::to_string(state.inventoryLevel) +
-        " | Batch Size=" + std::to_string(experiences.size()));
+        " | State=(" + std::to_string(state.unpack().posX) + "," + std::to_string(state.unpack().posY) + ")" +
+        " | Energy=" + std::to_string(state.unpack().energyLevel) +
+        " | Inventory=" + std::to_string(state.unpack().inventoryLevel));
+#endif
+}
+
+// convenience overload for callers without a cached id
+void DataCollector::recordExperience(const State& state, ActionType action, float reward, 
+                                    const State& nextState, bool done, const std::string& npcName) {
+    recordExperience(state, action, reward, nextState, done, registerNpc(npcName));
+}
+
+uint16_t DataCollector::registerNpc(const std::string& name) {
+    std::lock_guard<std::mutex> lock(npcMutex);
+    auto it = npcIds.find(name);
+    if (it != npcIds.end()) return it->second;
+    
+    if (npcNames->size() > UINT16_MAX) {
+        getDebugConsole().log("DataCollector", "NPC id table full, recording " + name + " as id 0", LogLevel::Warning);
+        return 0;
+    }
+    auto names = std::make_shared<std::vector<std::string>>(*npcNames);
+    names->push_back(name);
+    const auto id = static_cast<uint16_t>(names->size() - 1);
+    npcNames = std::move(names);
+    npcIds.emplace(name, id);
+    return id;
+}
+
+std::shared_ptr<const std::vector<std::string>> DataCollector::getNpcNames() const {
+    std::lock_guard<std::mutex> lock(npcMutex);
+    return npcNames;
+}
+
+void DataCollector::advanceTick() {
+    size_t sessionCount = 0, batchSize = 0;
+    {
+        std::lock_guard<std::mutex> lock(dataMutex);
+        collectPendingExperiences();
+        currentTick.fetch_add(1, std::memory_order_relaxed);
+        if (!progressDue) return;
+        progressDue = false;
+        sessionCount = experiencesThisSession;
+        batchSize = experiences->size();
+    }
+    getDebugConsole().log("DataCollector", "Session progress: " + std::to_string(sessionCount) + " experiences, " +
+                        "Current batch: " + std::to_string(batchSize));
+}
+
+// single consumer of the recorder; every record passes the ingestion policy and
+// the batch goes to the writer as soon as its window is complete
+void DataCollector::collectPendingExperiences() {
+    pending.clear();
+    const size_t drained = recorder->drain(pending);
+    if (drained == 0) return;
+    experiencesThisSession += drained;
+    
+    const size_t capacity = batchCapacity();
+    std::lock_guard<std::mutex> observationLock(observationMutex);
+    for (const auto& record : pending) {
+        updateStatistics(record);
+        const auto result = ingestion.offer(record, experiences->size(), capacity);
+        if (result.decision == ExperienceIngestion::Decision::Append) {
+            makeBatchWritable(false);
+            experiences->push_back(record);
+            actionCounts[record.action]++;
+            attachObservation(record);
+        } else if (result.decision == ExperienceIngestion::Decision::Replace) {
+            makeBatchWritable(true); // same action, so actionCounts is unchanged
+            (*experiences)[result.slot] = record;
+            attachObservation(record);
+        }
+        
+        if (ingestion.isWindowComplete(experiences->size(), capacity)) {
+            getDebugConsole().log("DataCollector", "Batch full (" + std::to_string(experiences->size()) + 
+                                "), auto-saving...");
+            saveCurrentBatch();
+        }
+    }
     
-    experiencesThisSession++;
+    publishStatistics();
     
-    // auto-save when batch is full
-    if (experiences.size() >= maxExperiencesPerFile) {
-        getDebugConsole().log("DataCollector", "Batch full (" + std::to_string(experiences.size()) + 
-                            "), auto-saving...");
-        saveCurrentBatch();
+    if (experiencesThisSession - progressReported >= kProgressInterval) {
+        progressReported = experiencesThisSession;
+        progressDue = true;
     }
-    
-    // log every 10 experiences for monitoring
-    if (experiencesThisSession % 10 == 0) {
-        getDebugConsole().log("DataCollector", "Session progress: " + 
-                            std::to_string(experiencesThisSession) + " experiences, " +
-                            "Current batch: " + std::to_string(experiences.size()));
+}
+
+// O(1) per record; see ExperienceStatistics
+void DataCollector::updateStatistics(const ExperienceRecord& record) {
+    statistics.update(record);
+}
+
+void DataCollector::publishStatistics() {
+    auto snapshot = std::make_shared<ExperienceStatsSnapshot>(statistics.get());
+    for (const auto& [action, count] : actionCounts) {
+        snapshot->keptActionCounts[static_cast<size_t>(action) % ExperienceStatsSnapshot::kActionSlots] = count;
+    }
+    std::lock_guard<std::mutex> lock(statsMutex);
+    statsSnapshot = std::move(snapshot);
+}
+
+std::shared_ptr<const ExperienceStatsSnapshot> DataCollector::getStatistics() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return statsSnapshot;
+}
+
+// the filling batch gets half of the memory budget, queued writes the other half
+size_t DataCollector::batchCapacity() const {
+    const size_t budgetRecords = ingestion.getPolicy().memoryBudgetBytes / (2 * sizeof(ExperienceRecord));
+    return std::max<size_t>(1, std::min(maxExperiencesPerFile, budgetRecords));
+}
+
+// views point into the batch buffer: overwriting or reallocating it while one is alive needs a private copy
+void DataCollector::makeBatchWritable(bool overwriting) {
+    const bool reallocating = experiences->size() == experiences->capacity();
+    if (experiences.use_count() > 1 && (overwriting || reallocating)) {
+        auto copy = std::make_shared<std::vector<ExperienceRecord>>();
+        copy->reserve(std::max(batchCapacity(), experiences->size() + 1));
+        copy->assign(experiences->begin(), experiences->end());
+        experiences = std::move(copy);
     }
 }
 
+void DataCollector::resetBatchBuffer(std::shared_ptr<std::vector<ExperienceRecord>> spare) {
+    if (experiences && experiences.use_count() == 1) {
+        experiences->clear(); // spilled batch: the buffer never left
+    } else {
+        experiences = spare ? std::move(spare) : std::make_shared<std::vector<ExperienceRecord>>();
+    }
+    experiences->reserve(batchCapacity());
+}
+
+void DataCollector::setMaxExperiencesPerFile(size_t max) {
+    std::lock_guard<std::mutex> lock(dataMutex);
+    maxExperiencesPerFile = std::max<size_t>(1, max);
+}
+
+void DataCollector::setIngestionPolicy(const IngestionPolicy& policy) {
+    std::lock_guard<std::mutex> lock(dataMutex);
+    collectPendingExperiences();
+    saveCurrentBatch(); // the sampling window restarts under the new policy
+    ingestion.setPolicy(policy);
+}
+
+IngestionPolicy DataCollector::getIngestionPolicy() const {
+    std::lock_guard<std::mutex> lock(dataMutex);
+    return ingestion.getPolicy();
+}
+
+void DataCollector::setBatchFormats(const BatchFormats& formats) {
+    std::lock_guard<std::mutex> lock(dataMutex);
+    batchFormats = formats;
+}
+
+BatchFormats DataCollector::getBatchFormats() const {
+    std::lock_guard<std::mutex> lock(dataMutex);
+    return batchFormats;
+}
+
+size_t DataCollector::getDuplicatesDropped() const {
+    std::lock_guard<std::mutex> lock(dataMutex);
+    return ingestion.getDuplicatesDropped();
+}
+
+size_t DataCollector::getSampledOut() const {
+    std::lock_guard<std::mutex> lock(dataMutex);
+    return ingestion.getSampledOut();
+}
+
+size_t DataCollector::getSpilledBatches() const {
+    std::lock_guard<std::mutex> lock(dataMutex);
+    return spilledBatches;
+}
+
+size_t DataCollector::getCurrentBatchSize() {
+    std::lock_guard<std::mutex> lock(dataMutex);
+    collectPendingExperiences();
+    return experiences->size();
+}
+
 // force save current batch
 void DataCollector::forceSaveCurrentBatch() {
     std::lock_guard<std::mutex> lock(dataMutex);
-    if (!experiences.empty()) {
+    collectPendingExperiences();
+    if (!experiences->empty()) {
         saveCurrentBatch();
     }
 }
 
+// load a JSON batch/export (streamed through SAX), an .npz archive (memory-mapped) or an .msx segment
+// into the current batch; full batches are flushed to the writer as loading goes
+void DataCollector::loadDataFromFile(const std::string& filename) {
+    constexpr size_t kCollectInterval = 1 << 16;
+    size_t loaded = 0;
+    auto load = [&](const State& state, ActionType action, float reward, const State& nextState, bool done, uint16_t npcId) {
+        ExperienceRecord record;
+        record.state = packExperienceState(state);
+        record.nextState = packExperienceState(nextState);
+        record.reward = reward;
+        record.tick = currentTick.load(std::memory_order_relaxed);
+        record.npcId = npcId;
+        record.action = static_cast<uint8_t>(action);
+        record.done = done ? 1 : 0;
+        recorder->append(record);
+        if (++loaded % kCollectInterval == 0) {
+            std::lock_guard<std::mutex> lock(dataMutex);
+            collectPendingExperiences();
+        }
+    };
+    
+    bool ok = true;
+    const auto extension = std::filesystem::path(filename).extension();
+    if (extension == ".msx") {
+        ExperienceCodec::Block block;
+        ok = ExperienceCodec::readFile(filename, block);
+        std::vector<uint16_t> ids(block.npcNames.size());
+        for (size_t i = 0; i < ids.size(); i++) ids[i] = registerNpc(block.npcNames[i]);
+        for (const auto& record : block.records) {
+            load(unpackExperienceState(record.state), static_cast<ActionType>(record.action), record.reward,
+                 unpackExperienceState(record.nextState), record.done != 0,
+                 record.npcId < ids.size() ? ids[record.npcId] : registerNpc("unknown"));
+        }
+    } else if (extension == ".npz") {
+        ExperienceDataset dataset;
+        ok = dataset.addFile(filename);
+        const uint16_t npcId = registerNpc(std::filesystem::path(filename).stem().string());
+        for (size_t i = 0; ok && i < dataset.size(); i++) {
+            load(dataset.getState(i), dataset.getAction(i), dataset.getReward(i),
+                 dataset.getNextState(i), dataset.isDone(i), npcId);
+        }
+    } else {
+        ok = streamExperienceJson(filename, [&](const ExperienceData& exp) {
+            load(exp.state, exp.action, exp.reward, exp.nextState, exp.done, registerNpc(exp.npcName));
+        });
+    }
+    
+    std::lock_guard<std::mutex> lock(dataMutex);
+    collectPendingExperiences();
+    getDebugConsole().log("DataCollector", "Loaded " + std::to_string(loaded) + " experiences from " + filename,
+                        ok ? LogLevel::Info : LogLevel::Warning);
+}
+
 // get current batch
-std::vector<ExperienceData> DataCollector::getCurrentBatch() const {
+ExperienceBatchView DataCollector::getCurrentBatch() {
     std::lock_guard<std::mutex> lock(dataMutex);
-    return experiences;
+    collectPendingExperiences();
+    return ExperienceBatchView(experiences, getNpcNames());
 }
 
-// save current batch to file
+// hand the current batch to the background writer (.msx segment + the configured extra formats)
 void DataCollector::saveCurrentBatch() {
-    if (experiences.empty()) {
+    ingestion.startWindow();
+    if (experiences->empty()) {
         getDebugConsole().log("DataCollector", "saveCurrentBatch called but experiences is empty");
         return;
     }
     
-    size_t batchSize = experiences.size();
+    size_t batchSize = experiences->size();
     
-    std::string filename = outputDirectory + "/sessions/" + currentSessionFile + 
-                          "_batch_" + std::to_string(currentFileIndex) + ".json";
+    std::string batchPath = segmentPath(currentFileIndex, "");
     
-    nlohmann::json jsonData;
-    jsonData["metadata"] = {
+    ExperienceWriter::Job job;
+    job.msxPath = batchPath + ".msx";
+    if (batchFormats.json) job.jsonPath = batchPath + ".json";
+    if (batchFormats.npz) job.npzPath = batchPath + ".npz";
+    if (batchFormats.csv) job.csvPath = batchPath + ".csv";
+    job.metadata = {
         {"total_experiences", batchSize},
         {"session_file", currentSessionFile},
         {"batch_index", currentFileIndex},
         {"timestamp", std::time(nullptr)},
         {"cumulative_total", totalExperiences + batchSize}  
     };
-    
-    jsonData["experiences"] = nlohmann::json::array();
-    for (const auto& exp : experiences) {
-        jsonData["experiences"].push_back(exp.toJson());
+    job.npcNames = getNpcNames();
+    
+    // writer falling behind: park the batch on disk instead of queueing it in RAM
+    const size_t batchBytes = batchSize * sizeof(ExperienceRecord);
+    const bool spill = writer->getPendingBytes() + batchBytes > ingestion.getPolicy().memoryBudgetBytes / 2;
+    if (spill && ExperienceWriter::writeSpill(batchPath + ".spill", *experiences)) {
+        job.spillPath = batchPath + ".spill";
+        spilledBatches++;
+    } else {
+        job.records = std::move(experiences);
     }
+    resetBatchBuffer(writer->submit(std::move(job)));
     
-    std::ofstream file(filename);
-    if (file.is_open()) {
-        file << jsonData.dump(2);
-        file.close();
+    totalExperiences += batchSize;
     
-        totalExperiences += batchSize;
-        
-        getDebugConsole().log("DataCollector", 
-            "SAVED BATCH: " + std::to_string(batchSize) + " experiences to " + filename + 
-            " | Total experiences now: " + std::to_string(totalExperiences));
-        
-        experiences.clear();
-        currentFileIndex++;
-    } else {
-        getDebugConsole().log("DataCollector", "FAILED to save batch to: " + filename, LogLevel::Error);
-    }
+    getDebugConsole().log("DataCollector", 
+        "QUEUED BATCH: " + std::to_string(batchSize) + " experiences to " + batchPath + 
+        " | Total experiences now: " + std::to_string(totalExperiences));
+    
+    currentFileIndex++;
+}
+
+void DataCollector::flushPendingWrites() {
+    writer->flush();
+}
+
+// sessions/<session>_batch_<index><extension>
+std::string DataCollector::segmentPath(size_t batchIndex, const std::string& extension) const {
+    return outputDirectory + "/sessions/" + currentSessionFile + "_batch_" + std::to_string(batchIndex) + extension;
+}
+
+// Every segment below segmentCount was submitted to the writer before this returns, so one
+// writer->flush() afterwards (without dataMutex) puts all of them on disk
+DataCollector::ExportSnapshot DataCollector::takeExportSnapshot() {
+    std::lock_guard<std::mutex> lock(dataMutex);
+    collectPendingExperiences();
+    ExportSnapshot snapshot;
+    snapshot.segmentPrefix = outputDirectory + "/sessions/" + currentSessionFile + "_batch_";
+    snapshot.segmentCount = currentFileIndex;
+    snapshot.batch = ExperienceBatchView(experiences, getNpcNames());
+    snapshot.statistics = getStatistics();
+    return snapshot;
 }
 
 // generate filename based on timestamp
 std::string DataCollector::generateFilename() {
     auto now = std::time(nullptr);
-    auto tm = *std::localtime(&now);
+    auto tm = toLocalTime(now);
     
     std::ostringstream oss;
     oss << "session_" << std::put_time(&tm, "%Y%m%d_%H%M%S");
     return oss.str();
 }
 
-// update statistics based on new experience
-void DataCollector::updateStatistics(const ExperienceData& exp) {
-    actionCounts[static_cast<int>(exp.action)]++;
+// export current experiences to JSON file (written in the background)
+void DataCollector::exportToJSON(const std::string& filename) {
+    exportToJSON(filename, takeExportSnapshot());
 }
 
-// export current experiences to JSON file
-void DataCollector::exportToJSON(const std::string& filename) {
-    std::lock_guard<std::mutex> lock(dataMutex);
-    
+// the batch is copied out of the snapshot, so dataMutex is only held while taking it
+void DataCollector::exportToJSON(const std::string& filename, const ExportSnapshot& snapshot) {
     std::string fullPath = outputDirectory + "/exports/" + 
                           (filename.empty() ? "exported_data.json" : filename);
     
-    nlohmann::json exportData;
-    exportData["metadata"] = {
-        {"total_experiences", experiences.size()},
+    ExperienceWriter::Job job;
+    job.jsonPath = fullPath;
+    job.jsonArrayKey = "data";
+    job.metadata = {
+        {"total_experiences", snapshot.batch.size()},
         {"export_timestamp", std::time(nullptr)},
-        {"action_distribution", getActionDistribution()},
-        {"average_reward", getAverageReward()}
+        {"action_distribution", actionDistribution(*snapshot.statistics)},
+        {"average_reward", static_cast<float>(snapshot.statistics->rewardMean)}
     };
+    job.records = std::make_shared<std::vector<ExperienceRecord>>(snapshot.batch.begin(), snapshot.batch.end());
+    job.npcNames = getNpcNames();
+    writer->submit(std::move(job));
+    
+    getDebugConsole().log("DataCollector", "Exporting " + std::to_string(snapshot.batch.size()) + 
+                        " experiences to JSON: " + fullPath);
+}
+
+// export every experience of this session as one .npz (saved segments + current batch)
+void DataCollector::exportToNumpyFormat(const std::string& baseFilename) {
+    const ExportSnapshot snapshot = takeExportSnapshot();
+    writer->flush();
+    
+    std::string fullPath = outputDirectory + "/exports/" + 
+                          (baseFilename.empty() ? "training_data" : baseFilename) + ".npz";
     
-    exportData["data"] = nlohmann::json::array();
-    for (const auto& exp : experiences) {
-        exportData["data"].push_back(exp.toJson());
+    NumpyIO::ExperienceColumns columns;
+    auto appendRecords = [&columns](const auto& records) {
+        for (const auto& record : records) {
+            columns.append(unpackExperienceState(record.state), static_cast<ActionType>(record.action),
+                           record.reward, unpackExperienceState(record.nextState), record.done != 0);
+        }
+    };
+    for (size_t i = 0; i < snapshot.segmentCount; i++) {
+        // an .npz segment is copied as-is, otherwise the compact segment is decoded
+        const std::string npzSegment = snapshot.segmentPath(i, ".npz");
+        if (std::filesystem::exists(npzSegment) && NumpyIO::readExperienceNpz(npzSegment, columns)) {
+            continue;
+        }
+        ExperienceCodec::Block block;
+        if (ExperienceCodec::readFile(snapshot.segmentPath(i, ".msx"), block)) {
+            appendRecords(block.records);
+        } else {
+            getDebugConsole().log("DataCollector", "Skipping unreadable segment: " + snapshot.segmentPath(i, ".msx"), LogLevel::Warning);
+        }
     }
+    appendRecords(snapshot.batch);
     
-    std::ofstream file(fullPath);
-    if (file.is_open()) {
-        file << exportData.dump(2);
-        getDebugConsole().log("DataCollector", "Exported " + std::to_string(experiences.size()) + 
-                            " experiences to JSON: " + fullPath);
+    if (NumpyIO::writeExperienceNpz(fullPath, columns)) {
+        getDebugConsole().log("DataCollector", "NumPy export complete: " + std::to_string(columns.size()) + 
+                            " experiences to " + fullPath);
+    }
+}
+
+void DataCollector::recordObservations(const ObservationBatch& batch, const uint16_t* npcIds) {
+    if (batch.count <= 0 || !isCollecting.load(std::memory_order_relaxed)) return;
+    std::lock_guard<std::mutex> lock(observationMutex);
+    ObservationLog& log = *observations;
+    if (log.rows.side != batch.side || log.rows.featureCount != batch.featureCount) {
+        if (log.rows.count > 0) {
+            getDebugConsole().log("DataCollector", "Observation layout changed, dropping " +
+                                std::to_string(log.rows.count) + " recorded rows", LogLevel::Warning);
+        }
+        *observations = ObservationLog{};
+        log.rows.side = log.staged.side = batch.side;
+        log.rows.featureCount = log.staged.featureCount = batch.featureCount;
+    }
+
+    const size_t cells = static_cast<size_t>(batch.side) * batch.side;
+    const size_t features = static_cast<size_t>(batch.featureCount);
+    for (int i = 0; i < batch.count; ++i) {
+        const uint16_t id = npcIds[i];
+        if (id >= log.stagedFor.size()) {
+            log.stagedFor.resize(static_cast<size_t>(id) + 1, 0);
+            log.staged.patches.resize(log.stagedFor.size() * cells);
+            log.staged.features.resize(log.stagedFor.size() * features);
+        }
+        std::copy_n(batch.patch(i), cells, log.staged.patches.begin() + id * cells);
+        std::copy_n(batch.row(i), features, log.staged.features.begin() + id * features);
+        log.stagedFor[id] = 1;
+    }
+}
+
+void DataCollector::attachObservation(const ExperienceRecord& record) {
+    ObservationLog& log = *observations;
+    if (record.npcId >= log.stagedFor.size() || !log.stagedFor[record.npcId]) return;
+    log.stagedFor[record.npcId] = 0;
+    if (static_cast<size_t>(log.rows.count) >= maxObservationRows) {
+        if (!log.capWarned) {
+            getDebugConsole().log("DataCollector", "Observation row limit (" + std::to_string(maxObservationRows) +
+                                ") reached, later observations are dropped", LogLevel::Warning);
+            log.capWarned = true;
+        }
+        return;
+    }
+
+    const size_t cells = static_cast<size_t>(log.staged.side) * log.staged.side;
+    const size_t features = static_cast<size_t>(log.staged.featureCount);
+    const auto patch = log.staged.patches.begin() + record.npcId * cells;
+    const auto row = log.staged.features.begin() + record.npcId * features;
+    log.rows.patches.insert(log.rows.patches.end(), patch, patch + cells);
+    log.rows.features.insert(log.rows.features.end(), row, row + features);
+    log.npcIds.push_back(record.npcId);
+    log.ticks.push_back(record.tick);
+    log.actions.push_back(record.action);
+    log.rewards.push_back(record.reward);
+    log.rows.count++;
+}
+
+size_t DataCollector::getObservationCount() const {
+    std::lock_guard<std::mutex> lock(observationMutex);
+    return static_cast<size_t>(observations->rows.count);
+}
+
+void DataCollector::setMaxObservationRows(size_t rows) {
+    std::lock_guard<std::mutex> lock(observationMutex);
+    maxObservationRows = rows;
+    observations->capWarned = false;
+}
+
+bool DataCollector::exportObservations(const std::string& baseFilename) {
+    std::lock_guard<std::mutex> lock(observationMutex);
+    const ObservationLog& log = *observations;
+    const ObservationBatch& stored = log.rows;
+    const std::string fullPath = outputDirectory + "/exports/" +
+                                 (baseFilename.empty() ? "observations" : baseFilename) + ".npz";
+    const size_t rows = static_cast<size_t>(stored.count);
+    const size_t side = static_cast<size_t>(stored.side);
+
+    NumpyIO::NpzWriter npz(fullPath);
+    const bool written =
+        npz.add("patches", "|u1", {rows, side, side}, stored.patches.data(), stored.patches.size()) &&
+        npz.add("features", "<f4", {rows, static_cast<size_t>(stored.featureCount)}, stored.features.data(),
+                stored.features.size() * sizeof(float)) &&
+        npz.add("npc_ids", "<u2", {rows}, log.npcIds.data(), rows * sizeof(uint16_t)) &&
+        npz.add("ticks", "<u4", {rows}, log.ticks.data(), rows * sizeof(uint32_t)) &&
+        npz.add("actions", "|u1", {rows}, log.actions.data(), rows) &&
+        npz.add("rewards", "<f4", {rows}, log.rewards.data(), rows * sizeof(float)) &&
+        npz.close();
+    if (!written) {
+        getDebugConsole().log("DataCollector", "Failed to write observations: " + fullPath, LogLevel::Error);
+        return false;
     }
+    getDebugConsole().log("DataCollector", "Observation export complete: " + std::to_string(rows) + " rows to " + fullPath);
+    return true;
 }
 
-// export current experiences to JSON file
+// export every experience of this session to CSV. Exports are append-only: when the file holds
+// an earlier export of this session, its saved batches stay and only the rows after them are
+// rewritten. New batches are copied from CSV segments when there are any, else decoded from .msx.
 void DataCollector::exportToCSV(const std::string& filename) {
-    std::lock_guard<std::mutex> lock(dataMutex);
-    
+    exportToCSV(filename, takeExportSnapshot());
+}
+
+void DataCollector::exportToCSV(const std::string& filename, const ExportSnapshot& snapshot) {
     std::string fullPath = outputDirectory + "/exports/" + 
                           (filename.empty() ? "training_data.csv" : filename);
     
-    std::ofstream file(fullPath);
-    if (!file.is_open()) {
-        getDebugConsole().log("DataCollector", "Failed to create CSV file: " + fullPath, LogLevel::Error);
-        return;
+    writer->flush(); // batch segments below may still be in flight
+    std::lock_guard<std::mutex> exportLock(exportMutex);
+    CsvExport& exported = csvExports[fullPath];
+    std::error_code sizeError;
+    const bool resume = exported.segmentPrefix == snapshot.segmentPrefix && exported.segmentBytes > 0 &&
+                        exported.segments <= snapshot.segmentCount &&
+                        std::filesystem::file_size(fullPath, sizeError) >= exported.segmentBytes && !sizeError;
+    std::unique_ptr<ExperienceCsv::Writer> file;
+    if (resume) file = std::make_unique<ExperienceCsv::Writer>(fullPath, exported.segmentBytes);
+    if (!file || !file->isOpen()) {
+        exported = CsvExport{snapshot.segmentPrefix};
+        file = std::make_unique<ExperienceCsv::Writer>(fullPath);
+        if (!file->isOpen()) {
+            getDebugConsole().log("DataCollector", "Failed to create CSV file: " + fullPath, LogLevel::Error);
+            csvExports.erase(fullPath);
+            return;
+        }
+        file->writeHeader();
     }
     
-    // CSV Header
-    file << "state_posX,state_posY,state_nearbyTrees,state_nearbyRocks,state_nearbyBushes,"
-         << "state_energyLevel,state_inventoryLevel,action,reward,"
-         << "nextState_posX,nextState_posY,nextState_nearbyTrees,nextState_nearbyRocks,"
-         << "nextState_nearbyBushes,nextState_energyLevel,nextState_inventoryLevel,"
-         << "done,npcName,timestamp\n";
+    for (size_t i = exported.segments; i < snapshot.segmentCount; i++) {
+        if (file->appendSegment(snapshot.segmentPath(i, ".csv")) > 0) continue;
+        ExperienceCodec::Block block;
+        if (ExperienceCodec::readFile(snapshot.segmentPath(i, ".msx"), block)) {
+            file->write(block.records, std::make_shared<const std::vector<std::string>>(std::move(block.npcNames)),
+                        block.timestamp);
+        } else {
+            getDebugConsole().log("DataCollector", "Skipping unreadable segment: " + snapshot.segmentPath(i, ".msx"), LogLevel::Warning);
+        }
+    }
+    const size_t appendedSegments = snapshot.segmentCount - exported.segments;
+    exported.segments = snapshot.segmentCount;
+    exported.segmentBytes = file->getByteCount();
+    exported.segmentRows += file->getRowCount();
     
-    size_t rowsWritten = 0;
+    const float now = static_cast<float>(std::time(nullptr));
+    for (size_t i = 0; i < snapshot.batch.size(); i++) file->write(snapshot.batch[i], snapshot.batch.getNpcName(i), now);
     
-    // export current batch (in-memory experiences)
-    for (const auto& exp : experiences) {
-        file << exp.state.posX << "," << exp.state.posY << ","
-             << exp.state.nearbyTrees << "," << exp.state.nearbyRocks << ","
-             << exp.state.nearbyBushes << "," << exp.state.energyLevel << ","
-             << exp.state.inventoryLevel << "," << static_cast<int>(exp.action) << ","
-             << exp.reward << "," << exp.nextState.posX << "," << exp.nextState.posY << ","
-             << exp.nextState.nearbyTrees << "," << exp.nextState.nearbyRocks << ","
-             << exp.nextState.nearbyBushes << "," << exp.nextState.energyLevel << ","
-             << exp.nextState.inventoryLevel << "," << (exp.done ? 1 : 0) << ","
-             << "\"" << exp.npcName << "\"," << exp.timestamp << "\n";
-        rowsWritten++;
+    if (!file->close()) {
+        getDebugConsole().log("DataCollector", "Failed writing CSV file: " + fullPath, LogLevel::Error);
+        csvExports.erase(fullPath);
+        return;
     }
     
-    // read and append all saved batch files
-    try {
-        for (size_t i = 0; i < currentFileIndex; i++) {
-            std::string batchFile = outputDirectory + "/sessions/" + currentSessionFile + 
-                                  "_batch_" + std::to_string(i) + ".json";
-            
-            std::ifstream jsonFile(batchFile);
-            if (jsonFile.is_open()) {
-                nlohmann::json batchData;
-                jsonFile >> batchData;
-                
-                if (batchData.contains("experiences")) {
-                    for (const auto& expJson : batchData["experiences"]) {
-                        file << expJson["state"]["posX"] << "," << expJson["state"]["posY"] << ","
-                             << expJson["state"]["nearbyTrees"] << "," << expJson["state"]["nearbyRocks"] << ","
-                             << expJson["state"]["nearbyBushes"] << "," << expJson["state"]["energyLevel"] << ","
-                             << expJson["state"]["inventoryLevel"] << "," << expJson["action"] << ","
-                             << expJson["reward"] << "," << expJson["nextState"]["posX"] << ","
-                             << expJson["nextState"]["posY"] << "," << expJson["nextState"]["nearbyTrees"] << ","
-                             << expJson["nextState"]["nearbyRocks"] << "," << expJson["nextState"]["nearbyBushes"] << ","
-                             << expJson["nextState"]["energyLevel"] << "," << expJson["nextState"]["inventoryLevel"] << ","
-                             << (expJson["done"] ? 1 : 0) << "," << "\"" << expJson["npcName"].get<std::string>() << "\","
-                             << expJson["timestamp"] << "\n";
-                        rowsWritten++;
-                    }
-                }
+    getDebugConsole().log("DataCollector", 
+        "CSV Export Complete: " + std::to_string(exported.segmentRows + snapshot.batch.size()) +
+        " total rows written to " + fullPath +
+        " (Current batch: " + std::to_string(snapshot.batch.size()) + 
+        ", Saved batches: " + std::to_string(snapshot.segmentCount) +
+        ", newly appended: " + std::to_string(appendedSegments) + ")");
+}
+
+// collect recorded states for quantization calibration
+std::vector<State> DataCollector::getCalibrationStates(size_t maxStates) {
+    const ExportSnapshot snapshot = takeExportSnapshot();
+    std::vector<State> states;
+    states.reserve(maxStates);
+    writer->flush();
+
+    for (const auto& record : snapshot.batch) {
+        if (states.size() >= maxStates) return states;
+        states.push_back(unpackExperienceState(record.state));
+    }
+
+    // .npz segments are memory-mapped so only the rows needed are touched; compact ones are decoded
+    for (size_t i = snapshot.segmentCount; i-- > 0 && states.size() < maxStates;) {
+        ExperienceDataset segment;
+        const std::string npzSegment = snapshot.segmentPath(i, ".npz");
+        if (std::filesystem::exists(npzSegment) && segment.addFile(npzSegment)) {
+            for (size_t row = 0; row < segment.size() && states.size() < maxStates; row++) {
+                states.push_back(segment.getState(row));
             }
+            continue;
+        }
+        ExperienceCodec::Block block;
+        if (!ExperienceCodec::readFile(snapshot.segmentPath(i, ".msx"), block)) continue;
+        for (const auto& record : block.records) {
+            if (states.size() >= maxStates) break;
+            states.push_back(unpackExperienceState(record.state));
         }
-    } catch (const std::exception& e) {
-        getDebugConsole().log("DataCollector", "Error reading batch files for CSV export: " + std::string(e.what()), LogLevel::Error);
     }
-    
-    file.close();
-    
-    getDebugConsole().log("DataCollector", 
-        "CSV Export Complete: " + std::to_string(rowsWritten) + " total rows written to " + fullPath +
-        " (Current batch: " + std::to_string(experiences.size()) + 
-        ", Saved batches: " + std::to_string(currentFileIndex) + ")");
+
+    return states;
 }
 
-// get action distribution
+// get action distribution (of the kept data)
 std::unordered_map<int, float> DataCollector::getActionDistribution() const {
+    return actionDistribution(*getStatistics());
+}
+
+std::unordered_map<int, float> DataCollector::actionDistribution(const ExperienceStatsSnapshot& stats) {
     std::unordered_map<int, float> distribution;
-    size_t total = std::accumulate(actionCounts.begin(), actionCounts.end(), 0,
-                                  [](size_t sum, const auto& pair) { return sum + pair.second; });
+    size_t total = std::accumulate(stats.keptActionCounts.begin(), stats.keptActionCounts.end(), size_t{0});
     
     if (total == 0) return distribution;
     
-    for (const auto& [action, count] : actionCounts) {
-        distribution[action] = static_cast<float>(count) / total;
+    for (size_t action = 0; action < stats.keptActionCounts.size(); action++) {
+        if (stats.keptActionCounts[action] == 0) continue;
+        distribution[static_cast<int>(action)] = static_cast<float>(stats.keptActionCounts[action]) / total;
     }
     
     return distribution;
 }
 
-// get average reward
+// get average reward (whole session)
 float DataCollector::getAverageReward() const {
-    if (experiences.empty()) return 0.0f;
-    
-    float sum = std::accumulate(experiences.begin(), experiences.end(), 0.0f,
-                               [](float sum, const ExperienceData& exp) { return sum + exp.reward; });
-    return sum / experiences.size();
+    return static_cast<float>(getStatistics()->rewardMean);
 }
 
 // print statistics
 void DataCollector::printStatistics() const {
+    auto stats = getStatistics();
     getDebugConsole().log("DataCollector", "=== Data Collection Statistics ===");
     getDebugConsole().log("DataCollector", "Total experiences: " + std::to_string(totalExperiences));
-    getDebugConsole().log("DataCollector", "Current batch size: " + std::to_string(experiences.size()));
-    getDebugConsole().log("DataCollector", "Average reward: " + std::to_string(getAverageReward()));
+    getDebugConsole().log("DataCollector", "Recorded this session: " + std::to_string(stats->count) +
+                        " (terminal: " + std::to_string(stats->terminalCount) + ")");
+    getDebugConsole().log("DataCollector", "Average reward: " + std::to_string(stats->rewardMean) +
+                        " (std " + std::to_string(std::sqrt(stats->rewardVariance)) + ")");
     
     auto distribution = getActionDistribution();
     getDebugConsole().log("DataCollector", "Action distribution:");
@@ -320,6 +746,7 @@ void DataCollector::printStatistics() const {
 
 // analyze data quality
 void DataCollector::analyzeDataQuality() const {
+    auto stats = getStatistics();
     getDebugConsole().log("DataCollector", "=== Data Quality Analysis ===");
     
     // check action balance
@@ -341,16 +768,22 @@ void DataCollector::analyzeDataQuality() const {
     auto [minReward, maxReward] = getRewardRange();
     getDebugConsole().log("DataCollector", "Reward range: [" + std::to_string(minReward) + 
                         ", " + std::to_string(maxReward) + "]");
+    
+    const auto peak = std::max_element(stats->rewardHistogram.begin(), stats->rewardHistogram.end());
+    if (stats->count > 0 && *peak > stats->count * 9 / 10) {
+        getDebugConsole().log("DataCollector", "WARNING: Over 90% of rewards fall in one histogram bin", LogLevel::Warning);
+    }
+    
+    // check that no NPC dominates the data
+    if (!stats->npcCounts.empty() && stats->count > 0) {
+        const uint64_t busiest = *std::max_element(stats->npcCounts.begin(), stats->npcCounts.end());
+        getDebugConsole().log("DataCollector", "Busiest NPC share: " +
+                            std::to_string(100.0 * busiest / stats->count) + "%");
+    }
 }
 
-// get reward range
+// get reward range (whole session)
 std::pair<float, float> DataCollector::getRewardRange() const {
-    if (experiences.empty()) return {0.0f, 0.0f};
-    
-    auto minMaxReward = std::minmax_element(experiences.begin(), experiences.end(),
-        [](const ExperienceData& a, const ExperienceData& b) {
-            return a.reward < b.reward;
-        });
-    
-    return {minMaxReward.first->reward, minMaxReward.second->reward};
-}
\ No newline at end of file
+    auto stats = getStatistics();
+    return {stats->rewardMin, stats->rewardMax};
+}
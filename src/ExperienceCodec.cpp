@@ -0,0 +1,282 @@
+#include "ExperienceCodec.hpp"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace {
+    using Fields = std::array<int32_t, 8>; // State fields, density levels folded into the last one
+
+    constexpr size_t kMaxRewardTable = 1 << 14; // distinct rewards remembered per block
+    constexpr uint8_t kStateDelta = 1 << 0;
+    constexpr uint8_t kNextDelta = 1 << 1;
+    constexpr uint8_t kDone = 1 << 2;
+    constexpr uint8_t kRewardLiteral = 1 << 3;
+    constexpr uint8_t kActionEscape = 15;
+
+    Fields toFields(uint64_t packed) {
+        const State s = unpackExperienceState(packed);
+        return {s.posX, s.posY, s.nearbyTrees, s.nearbyRocks, s.nearbyBushes, s.energyLevel, s.inventoryLevel,
+                s.treeDensity | s.rockDensity << 2 | s.bushDensity << 4};
+    }
+
+    uint64_t fromFields(const Fields& f) {
+        State state{f[0], f[1], f[2], f[3], f[4], f[5], f[6]};
+        state.treeDensity = f[7] & 3;
+        state.rockDensity = (f[7] >> 2) & 3;
+        state.bushDensity = (f[7] >> 4) & 3;
+        return packExperienceState(state);
+    }
+
+    void putVarint(std::string& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    uint32_t zigzag(int32_t value) {
+        return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+    }
+
+    int32_t unzigzag(uint32_t value) {
+        return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+    }
+
+    void putFloat(std::string& out, float value) {
+        char bytes[sizeof(float)];
+        std::memcpy(bytes, &value, sizeof(float)); // little-endian hosts only, like NumpyIO
+        out.append(bytes, sizeof(float));
+    }
+
+    // mask of changed fields + zigzag differences; returns false (nothing written) when equal
+    bool putDelta(std::string& out, const Fields& from, const Fields& to) {
+        uint8_t mask = 0;
+        for (int i = 0; i < 8; ++i) {
+            if (from[i] != to[i]) mask |= static_cast<uint8_t>(1 << i);
+        }
+        if (mask == 0) return false;
+        out.push_back(static_cast<char>(mask));
+        for (int i = 0; i < 8; ++i) {
+            if (mask & (1 << i)) putVarint(out, zigzag(to[i] - from[i]));
+        }
+        return true;
+    }
+
+    // Bounds-checked cursor; any overrun sets `failed` and yields zeros
+    struct Reader {
+        const unsigned char* cursor;
+        const unsigned char* end;
+        bool failed = false;
+
+        uint8_t byte() {
+            if (cursor == end) { failed = true; return 0; }
+            return *cursor++;
+        }
+
+        uint64_t varint() {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                if (cursor == end) break;
+                const uint8_t b = *cursor++;
+                value |= static_cast<uint64_t>(b & 0x7F) << shift;
+                if (!(b & 0x80)) return value;
+            }
+            failed = true;
+            return 0;
+        }
+
+        float f32() {
+            float value = 0.0f;
+            if (end - cursor < static_cast<ptrdiff_t>(sizeof(float))) { failed = true; return value; }
+            std::memcpy(&value, cursor, sizeof(float));
+            cursor += sizeof(float);
+            return value;
+        }
+
+        void delta(Fields& fields) {
+            const uint8_t mask = byte();
+            for (int i = 0; i < 8; ++i) {
+                if (mask & (1 << i)) fields[i] += unzigzag(static_cast<uint32_t>(varint()));
+            }
+        }
+    };
+}
+
+void ExperienceCodec::encode(const ExperienceRecord* records, size_t count, const std::vector<std::string>* npcNames,
+                             float timestamp, std::string& out) {
+    std::string payload;
+    payload.reserve(count * 8);
+
+    std::vector<Fields> lastNext;        // per npcId
+    std::vector<uint8_t> named;          // per npcId: already in the dictionary
+    std::vector<uint16_t> dictionary;    // npc ids in first-use order
+    std::unordered_map<uint32_t, uint32_t> rewardIndex;
+    uint32_t previousTick = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        const ExperienceRecord& record = records[i];
+        if (record.npcId >= lastNext.size()) {
+            lastNext.resize(record.npcId + 1, Fields{});
+            named.resize(record.npcId + 1, 0);
+        }
+        Fields& reference = lastNext[record.npcId];
+        if (!named[record.npcId]) {
+            named[record.npcId] = 1;
+            dictionary.push_back(record.npcId);
+        }
+
+        uint32_t rewardBits;
+        std::memcpy(&rewardBits, &record.reward, sizeof(rewardBits));
+        auto known = rewardIndex.find(rewardBits);
+
+        const Fields state = toFields(record.state);
+        const Fields next = toFields(record.nextState);
+
+        const size_t tagPosition = payload.size();
+        payload.push_back(0);
+        uint8_t tag = record.done ? kDone : 0;
+        if (record.action < kActionEscape) {
+            tag |= static_cast<uint8_t>(record.action << 4);
+        } else {
+            tag |= static_cast<uint8_t>(kActionEscape << 4);
+            payload.push_back(static_cast<char>(record.action));
+        }
+
+        putVarint(payload, record.npcId);
+        putVarint(payload, zigzag(static_cast<int32_t>(record.tick - previousTick)));
+        previousTick = record.tick;
+
+        if (known != rewardIndex.end()) {
+            putVarint(payload, known->second);
+        } else {
+            tag |= kRewardLiteral;
+            putFloat(payload, record.reward);
+            if (rewardIndex.size() < kMaxRewardTable) {
+                const auto index = static_cast<uint32_t>(rewardIndex.size());
+                rewardIndex.emplace(rewardBits, index);
+            }
+        }
+
+        if (putDelta(payload, reference, state)) tag |= kStateDelta;
+        if (putDelta(payload, state, next)) tag |= kNextDelta;
+        payload[tagPosition] = static_cast<char>(tag);
+        reference = next;
+    }
+
+    out.append(kMagic, sizeof(kMagic));
+    out.push_back(static_cast<char>(kVersion));
+    putVarint(out, count);
+    putFloat(out, timestamp);
+    putVarint(out, dictionary.size());
+    for (uint16_t id : dictionary) {
+        const std::string empty;
+        const std::string& name = npcNames && id < npcNames->size() ? (*npcNames)[id] : empty;
+        putVarint(out, id);
+        putVarint(out, name.size());
+        out.append(name);
+    }
+    putVarint(out, payload.size());
+    out.append(payload);
+}
+
+bool ExperienceCodec::decode(const char* data, size_t size, Block& out) {
+    Reader in{reinterpret_cast<const unsigned char*>(data), reinterpret_cast<const unsigned char*>(data) + size};
+
+    while (in.cursor != in.end) {
+        if (in.end - in.cursor < static_cast<ptrdiff_t>(sizeof(kMagic)) ||
+            std::memcmp(in.cursor, kMagic, sizeof(kMagic)) != 0) {
+            return false;
+        }
+        in.cursor += sizeof(kMagic);
+        if (in.byte() != kVersion) return false;
+
+        const uint64_t count = in.varint();
+        const float timestamp = in.f32();
+        const uint64_t names = in.varint();
+        for (uint64_t n = 0; n < names && !in.failed; ++n) {
+            const uint64_t id = in.varint();
+            const uint64_t length = in.varint();
+            if (in.failed || id > UINT16_MAX || length > static_cast<uint64_t>(in.end - in.cursor)) return false;
+            if (id >= out.npcNames.size()) out.npcNames.resize(id + 1);
+            out.npcNames[id].assign(reinterpret_cast<const char*>(in.cursor), length);
+            in.cursor += length;
+        }
+        const uint64_t payloadBytes = in.varint();
+        // every record takes at least 4 bytes, which also bounds the reserve below
+        if (in.failed || payloadBytes > static_cast<uint64_t>(in.end - in.cursor) || count > payloadBytes / 4) {
+            return false;
+        }
+
+        Reader block{in.cursor, in.cursor + payloadBytes};
+        const size_t first = out.records.size();
+        out.records.reserve(first + count);
+        std::vector<Fields> lastNext;
+        std::vector<float> rewards;
+        uint32_t tick = 0;
+
+        for (uint64_t i = 0; i < count; ++i) {
+            ExperienceRecord record{};
+            const uint8_t tag = block.byte();
+            const uint8_t action = tag >> 4;
+            record.action = action == kActionEscape ? block.byte() : action;
+            record.done = (tag & kDone) ? 1 : 0;
+
+            const uint64_t npcId = block.varint();
+            if (npcId > UINT16_MAX) block.failed = true;
+            record.npcId = static_cast<uint16_t>(npcId);
+            tick += static_cast<uint32_t>(unzigzag(static_cast<uint32_t>(block.varint())));
+            record.tick = tick;
+
+            if (tag & kRewardLiteral) {
+                record.reward = block.f32();
+                if (rewards.size() < kMaxRewardTable) rewards.push_back(record.reward);
+            } else {
+                const uint64_t index = block.varint();
+                if (index >= rewards.size()) { block.failed = true; break; }
+                record.reward = rewards[index];
+            }
+
+            if (record.npcId >= lastNext.size()) lastNext.resize(record.npcId + 1, Fields{});
+            Fields state = lastNext[record.npcId];
+            if (tag & kStateDelta) block.delta(state);
+            Fields next = state;
+            if (tag & kNextDelta) block.delta(next);
+            if (block.failed) break;
+
+            record.state = fromFields(state);
+            record.nextState = fromFields(next);
+            lastNext[record.npcId] = next;
+            out.records.push_back(record);
+        }
+
+        if (block.failed || block.cursor != block.end) {
+            out.records.resize(first);
+            return false;
+        }
+        out.timestamp = timestamp;
+        in.cursor = block.end;
+    }
+    return !in.failed;
+}
+
+bool ExperienceCodec::writeFile(const std::string& path, const std::vector<ExperienceRecord>& records,
+                                const std::vector<std::string>* npcNames, float timestamp) {
+    std::string bytes;
+    encode(records.data(), records.size(), npcNames, timestamp, bytes);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    file.close();
+    return !file.fail();
+}
+
+bool ExperienceCodec::readFile(const std::string& path, Block& out) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    std::string bytes(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return file && decode(bytes.data(), bytes.size(), out);
+}
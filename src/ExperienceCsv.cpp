@@ -0,0 +1,126 @@
+#include "ExperienceCsv.hpp"
+#include "debug.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+
+namespace ExperienceCsv {
+
+    namespace {
+        template <typename T>
+        void appendNumber(std::string& out, T value) {
+            char digits[32];
+            auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            out.append(digits, result.ptr);
+            out.push_back(',');
+        }
+
+        void appendState(std::string& out, uint64_t packed) {
+            const State state = unpackExperienceState(packed);
+            appendNumber(out, state.posX);
+            appendNumber(out, state.posY);
+            appendNumber(out, state.nearbyTrees);
+            appendNumber(out, state.nearbyRocks);
+            appendNumber(out, state.nearbyBushes);
+            appendNumber(out, state.energyLevel);
+            appendNumber(out, state.inventoryLevel);
+        }
+
+        const std::string& nameFor(const std::shared_ptr<const std::vector<std::string>>& names, uint16_t id) {
+            static const std::string unknown = "unknown";
+            return names && id < names->size() ? (*names)[id] : unknown;
+        }
+    }
+
+    void appendRow(std::string& out, const ExperienceRecord& record, const std::string& npcName, float timestamp) {
+        appendState(out, record.state);
+        appendNumber(out, static_cast<int>(record.action));
+        appendNumber(out, record.reward);
+        appendState(out, record.nextState);
+        appendNumber(out, static_cast<int>(record.done));
+        out.push_back('"');
+        out.append(npcName);
+        out.append("\",");
+        appendNumber(out, timestamp);
+        out.back() = '\n'; // replace the trailing separator
+    }
+
+    Writer::Writer(const std::string& path)
+        : file(path, std::ios::binary | std::ios::trunc) {
+        buffer.reserve(kBufferSize + 1024);
+    }
+
+    Writer::Writer(const std::string& path, uint64_t keepBytes) {
+        buffer.reserve(kBufferSize + 1024);
+        std::error_code error;
+        std::filesystem::resize_file(path, keepBytes, error);
+        if (error) return;
+        file.open(path, std::ios::binary | std::ios::app);
+        bytes = keepBytes;
+    }
+
+    Writer::~Writer() {
+        close();
+    }
+
+    void Writer::flushBuffer() {
+        if (buffer.empty()) return;
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        bytes += buffer.size();
+        buffer.clear();
+    }
+
+    void Writer::writeHeader() {
+        buffer.append(kHeader);
+    }
+
+    void Writer::write(const ExperienceRecord& record, const std::string& npcName, float timestamp) {
+        appendRow(buffer, record, npcName, timestamp);
+        rows++;
+        if (buffer.size() >= kBufferSize) flushBuffer();
+    }
+
+    void Writer::write(const std::vector<ExperienceRecord>& records,
+                       const std::shared_ptr<const std::vector<std::string>>& npcNames, float timestamp) {
+        for (const auto& record : records) {
+            write(record, nameFor(npcNames, record.npcId), timestamp);
+        }
+    }
+
+    size_t Writer::appendSegment(const std::string& path) {
+        std::ifstream segment(path, std::ios::binary);
+        if (!segment.is_open()) return 0;
+
+        flushBuffer();
+        std::vector<char> block(kBufferSize);
+        size_t segmentRows = 0;
+        while (segment) {
+            segment.read(block.data(), static_cast<std::streamsize>(block.size()));
+            const auto count = static_cast<size_t>(segment.gcount());
+            segmentRows += static_cast<size_t>(std::count(block.data(), block.data() + count, '\n'));
+            file.write(block.data(), static_cast<std::streamsize>(count));
+            bytes += count;
+        }
+        rows += segmentRows;
+        return segmentRows;
+    }
+
+    bool Writer::close() {
+        if (!file.is_open()) return false;
+        flushBuffer();
+        file.close();
+        return !file.fail();
+    }
+
+    bool writeSegment(const std::string& path, const std::vector<ExperienceRecord>& records,
+                      const std::shared_ptr<const std::vector<std::string>>& npcNames, float timestamp) {
+        Writer writer(path);
+        if (!writer.isOpen()) {
+            getDebugConsole().log("DataCollector", "Failed to create CSV segment: " + path, LogLevel::Error);
+            return false;
+        }
+        writer.write(records, npcNames, timestamp);
+        return writer.close();
+    }
+}
@@ -0,0 +1,453 @@
+#include "ExperienceDataset.hpp"
+#include "debug.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        std::swap(bytes, other.bytes);
+        std::swap(length, other.length);
+#ifdef _WIN32
+        std::swap(fileHandle, other.fileHandle);
+        std::swap(mappingHandle, other.mappingHandle);
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    bytes = static_cast<const char*>(view);
+    length = static_cast<size_t>(fileSize.QuadPart);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if (view == MAP_FAILED) return false;
+    madvise(view, static_cast<size_t>(info.st_size), MADV_RANDOM);
+    bytes = static_cast<const char*>(view);
+    length = static_cast<size_t>(info.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::close() {
+    if (!bytes) return;
+#ifdef _WIN32
+    UnmapViewOfFile(bytes);
+    CloseHandle(mappingHandle);
+    CloseHandle(fileHandle);
+    mappingHandle = fileHandle = nullptr;
+#else
+    munmap(const_cast<char*>(bytes), length);
+#endif
+    bytes = nullptr;
+    length = 0;
+}
+
+// Central-directory walk over a mapped zip (np.savez and NpzWriter both store entries uncompressed)
+namespace {
+    constexpr uint32_t kCentralHeaderSignature = 0x02014b50;
+    constexpr uint32_t kLocalHeaderSignature = 0x04034b50;
+    constexpr uint32_t kEndOfDirectorySignature = 0x06054b50;
+    constexpr uint32_t kZip64LocatorSignature = 0x07064b50;
+    constexpr uint32_t kZip64EndSignature = 0x06064b50;
+    constexpr uint32_t kZip64Marker = 0xFFFFFFFF;
+
+    template <typename T>
+    T get(const char* p) {
+        T value = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) value |= static_cast<T>(static_cast<unsigned char>(p[i])) << (8 * i);
+        return value;
+    }
+
+    struct ZipEntry {
+        std::string name;
+        const char* data;
+        uint64_t size;
+    };
+
+    // Stored entries of a zip held in memory; empty on any structural problem or compression
+    std::vector<ZipEntry> listStoredEntries(const char* zip, size_t size) {
+        std::vector<ZipEntry> entries;
+        if (size < 22) return entries;
+
+        size_t end = size - 22;
+        const size_t searchLimit = size > 22 + 65535 ? size - 22 - 65535 : 0;
+        while (get<uint32_t>(zip + end) != kEndOfDirectorySignature) {
+            if (end == searchLimit) return entries;
+            --end;
+        }
+
+        uint64_t entryCount = get<uint16_t>(zip + end + 10);
+        uint64_t directoryOffset = get<uint32_t>(zip + end + 16);
+        if (directoryOffset == kZip64Marker && end >= 20 && get<uint32_t>(zip + end - 20) == kZip64LocatorSignature) {
+            const uint64_t zip64End = get<uint64_t>(zip + end - 20 + 8);
+            if (zip64End + 56 > size || get<uint32_t>(zip + zip64End) != kZip64EndSignature) return entries;
+            entryCount = get<uint64_t>(zip + zip64End + 32);
+            directoryOffset = get<uint64_t>(zip + zip64End + 48);
+        }
+
+        size_t cursor = static_cast<size_t>(directoryOffset);
+        for (uint64_t i = 0; i < entryCount; ++i) {
+            if (cursor + 46 > size || get<uint32_t>(zip + cursor) != kCentralHeaderSignature) return {};
+            const uint16_t method = get<uint16_t>(zip + cursor + 10);
+            uint64_t compressedSize = get<uint32_t>(zip + cursor + 20);
+            uint64_t uncompressedSize = get<uint32_t>(zip + cursor + 24);
+            const uint16_t nameLength = get<uint16_t>(zip + cursor + 28);
+            const uint16_t extraLength = get<uint16_t>(zip + cursor + 30);
+            const uint16_t commentLength = get<uint16_t>(zip + cursor + 32);
+            uint64_t localOffset = get<uint32_t>(zip + cursor + 42);
+            if (cursor + 46 + nameLength + extraLength > size) return {};
+
+            // zip64 extra field: only the values marked 0xFFFFFFFF are present, in this order
+            const char* extra = zip + cursor + 46 + nameLength;
+            for (size_t e = 0; e + 4 <= extraLength;) {
+                const uint16_t id = get<uint16_t>(extra + e);
+                const uint16_t length = get<uint16_t>(extra + e + 2);
+                if (id == 0x0001) {
+                    size_t field = e + 4;
+                    if (uncompressedSize == kZip64Marker) { uncompressedSize = get<uint64_t>(extra + field); field += 8; }
+                    if (compressedSize == kZip64Marker) { compressedSize = get<uint64_t>(extra + field); field += 8; }
+                    if (localOffset == kZip64Marker) { localOffset = get<uint64_t>(extra + field); }
+                }
+                e += 4 + length;
+            }
+
+            if (method != 0 || compressedSize != uncompressedSize || localOffset + 30 > size ||
+                get<uint32_t>(zip + localOffset) != kLocalHeaderSignature) {
+                return {};
+            }
+            const uint64_t dataOffset = localOffset + 30 + get<uint16_t>(zip + localOffset + 26) +
+                                        get<uint16_t>(zip + localOffset + 28);
+            if (dataOffset + compressedSize > size) return {};
+
+            entries.push_back({std::string(zip + cursor + 46, nameLength), zip + dataOffset, compressedSize});
+            cursor += 46 + nameLength + extraLength + commentLength;
+        }
+        return entries;
+    }
+
+    // Locate an array's payload and validate its dtype/shape; returns nullptr on mismatch
+    const char* arrayData(const ZipEntry& entry, const char* expectedDescr, size_t columns, size_t& rows) {
+        std::string descr;
+        std::vector<size_t> shape;
+        const size_t offset = NumpyIO::parseNpyHeader(entry.data, static_cast<size_t>(entry.size), descr, shape);
+        const bool boolAlias = std::strcmp(expectedDescr, "|b1") == 0 && descr == "|u1";
+        if (offset == 0 || (descr != expectedDescr && !boolAlias) || shape.empty()) return nullptr;
+        if ((columns == 1 && shape.size() != 1) || (columns > 1 && (shape.size() != 2 || shape[1] != columns))) {
+            return nullptr;
+        }
+        const size_t elementSize = descr[2] == '1' ? 1 : 4;
+        if (entry.size - offset < shape[0] * columns * elementSize) return nullptr;
+        rows = shape[0];
+        return entry.data + offset;
+    }
+}
+
+bool ExperienceDataset::addFile(const std::string& path) {
+    Segment segment;
+    segment.path = path;
+    if (!segment.file.open(path)) {
+        getDebugConsole().log("ExperienceDataset", "Cannot map " + path, LogLevel::Error);
+        return false;
+    }
+
+    const auto entries = listStoredEntries(segment.file.data(), segment.file.size());
+    size_t rows[5] = {0, 0, 0, 0, 0};
+    for (const auto& entry : entries) {
+        if (entry.name == "states.npy") segment.states = arrayData(entry, "<i4", NumpyIO::kStateColumns, rows[0]);
+        else if (entry.name == "actions.npy") segment.actions = arrayData(entry, "<i4", 1, rows[1]);
+        else if (entry.name == "rewards.npy") segment.rewards = arrayData(entry, "<f4", 1, rows[2]);
+        else if (entry.name == "next_states.npy") segment.nextStates = arrayData(entry, "<i4", NumpyIO::kStateColumns, rows[3]);
+        else if (entry.name == "dones.npy") segment.dones = arrayData(entry, "|b1", 1, rows[4]);
+    }
+
+    if (!segment.states || !segment.actions || !segment.rewards || !segment.nextStates || !segment.dones ||
+        std::any_of(rows + 1, rows + 5, [&](size_t n) { return n != rows[0]; })) {
+        getDebugConsole().log("ExperienceDataset", "Not an uncompressed experience archive: " + path, LogLevel::Error);
+        return false;
+    }
+
+    segment.count = rows[0];
+    segment.first = totalCount;
+    totalCount += segment.count;
+    segments.push_back(std::move(segment));
+    return true;
+}
+
+size_t ExperienceDataset::addDirectory(const std::string& directory) {
+    std::vector<std::string> paths;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".npz") {
+            paths.push_back(entry.path().string());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    size_t added = 0;
+    for (const auto& path : paths) {
+        if (addFile(path)) added++;
+    }
+    return added;
+}
+
+void ExperienceDataset::clear() {
+    segments.clear();
+    totalCount = 0;
+}
+
+const ExperienceDataset::Segment& ExperienceDataset::segmentFor(size_t index) const {
+    auto it = std::upper_bound(segments.begin(), segments.end(), index,
+                               [](size_t value, const Segment& segment) { return value < segment.first; });
+    return *(it - 1);
+}
+
+State ExperienceDataset::readState(const char* base, size_t row) {
+    int32_t values[NumpyIO::kStateColumns];
+    std::memcpy(values, base + row * sizeof(values), sizeof(values));
+    return {values[0], values[1], values[2], values[3], values[4], values[5], values[6]};
+}
+
+State ExperienceDataset::getState(size_t index) const {
+    const Segment& segment = segmentFor(index);
+    return readState(segment.states, index - segment.first);
+}
+
+State ExperienceDataset::getNextState(size_t index) const {
+    const Segment& segment = segmentFor(index);
+    return readState(segment.nextStates, index - segment.first);
+}
+
+ActionType ExperienceDataset::getAction(size_t index) const {
+    const Segment& segment = segmentFor(index);
+    int32_t action;
+    std::memcpy(&action, segment.actions + (index - segment.first) * sizeof(int32_t), sizeof(action));
+    return static_cast<ActionType>(action);
+}
+
+float ExperienceDataset::getReward(size_t index) const {
+    const Segment& segment = segmentFor(index);
+    float reward;
+    std::memcpy(&reward, segment.rewards + (index - segment.first) * sizeof(float), sizeof(reward));
+    return reward;
+}
+
+bool ExperienceDataset::isDone(size_t index) const {
+    const Segment& segment = segmentFor(index);
+    return segment.dones[index - segment.first] != 0;
+}
+
+void ExperienceDataset::fetch(size_t first, size_t count, NumpyIO::ExperienceColumns& out) const {
+    count = first < totalCount ? std::min(count, totalCount - first) : 0;
+    out.reserve(out.size() + count);
+
+    // contiguous rows: one bulk copy per array per segment
+    while (count > 0) {
+        const Segment& segment = segmentFor(first);
+        const size_t row = first - segment.first;
+        const size_t take = std::min(count, segment.count - row);
+        auto copy = [&](auto& column, const char* base, size_t width) {
+            using Value = typename std::decay_t<decltype(column)>::value_type;
+            const size_t start = column.size();
+            column.resize(start + take * width);
+            std::memcpy(column.data() + start, base + row * width * sizeof(Value), take * width * sizeof(Value));
+        };
+        copy(out.states, segment.states, NumpyIO::kStateColumns);
+        copy(out.actions, segment.actions, 1);
+        copy(out.rewards, segment.rewards, 1);
+        copy(out.nextStates, segment.nextStates, NumpyIO::kStateColumns);
+        copy(out.dones, segment.dones, 1);
+        first += take;
+        count -= take;
+    }
+}
+
+void ExperienceDataset::fetch(const size_t* indices, size_t count, NumpyIO::ExperienceColumns& out) const {
+    out.reserve(out.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+        if (indices[i] >= totalCount) continue;
+        const size_t index = indices[i];
+        out.append(getState(index), getAction(index), getReward(index), getNextState(index), isDone(index));
+    }
+}
+
+std::vector<size_t> ExperienceDataset::shuffledIndices(std::mt19937& rng) const {
+    std::vector<size_t> indices(totalCount);
+    std::iota(indices.begin(), indices.end(), size_t{0});
+    std::shuffle(indices.begin(), indices.end(), rng);
+    return indices;
+}
+
+void ExperienceDataset::sample(std::mt19937& rng, size_t count, NumpyIO::ExperienceColumns& out) const {
+    if (totalCount == 0) return;
+    std::uniform_int_distribution<size_t> pick(0, totalCount - 1);
+    std::vector<size_t> indices(count);
+    for (auto& index : indices) index = pick(rng);
+    fetch(indices.data(), indices.size(), out);
+}
+
+namespace {
+    // Tracks just enough structure to rebuild one experience at a time
+    class ExperienceSaxHandler : public nlohmann::json_sax<nlohmann::json> {
+    private:
+        const std::function<void(const ExperienceData&)>& onExperience;
+        int depth = 0;
+        int arrayDepth = -1;        // depth of the experience array once found
+        bool wantArray = false;     // last top-level key named the experience array
+        std::string currentKey;
+        State* target = nullptr;    // state/nextState object being filled
+        State state, nextState;
+        int action = 0;
+        float reward = 0.0f, timestamp = 0.0f;
+        bool done = false;
+        std::string npcName;
+
+        bool inExperience() const { return arrayDepth >= 0 && depth >= arrayDepth + 1; }
+
+        void setNumber(double value) {
+            if (!inExperience()) return;
+            if (target) {
+                const int v = static_cast<int>(value);
+                if (currentKey == "posX") target->posX = v;
+                else if (currentKey == "posY") target->posY = v;
+                else if (currentKey == "nearbyTrees") target->nearbyTrees = v;
+                else if (currentKey == "nearbyRocks") target->nearbyRocks = v;
+                else if (currentKey == "nearbyBushes") target->nearbyBushes = v;
+                else if (currentKey == "energyLevel") target->energyLevel = v;
+                else if (currentKey == "inventoryLevel") target->inventoryLevel = v;
+            } else if (currentKey == "action") {
+                action = static_cast<int>(value);
+            } else if (currentKey == "reward") {
+                reward = static_cast<float>(value);
+            } else if (currentKey == "timestamp") {
+                timestamp = static_cast<float>(value);
+            }
+        }
+
+    public:
+        size_t delivered = 0;
+
+        explicit ExperienceSaxHandler(const std::function<void(const ExperienceData&)>& callback)
+            : onExperience(callback) {}
+
+        bool null() override { return true; }
+        bool boolean(bool value) override {
+            if (inExperience() && !target && currentKey == "done") done = value;
+            return true;
+        }
+        bool number_integer(number_integer_t value) override { setNumber(static_cast<double>(value)); return true; }
+        bool number_unsigned(number_unsigned_t value) override { setNumber(static_cast<double>(value)); return true; }
+        bool number_float(number_float_t value, const string_t&) override { setNumber(value); return true; }
+        bool string(string_t& value) override {
+            if (inExperience() && !target && currentKey == "npcName") npcName = std::move(value);
+            return true;
+        }
+        bool binary(binary_t&) override { return true; }
+
+        bool start_object(std::size_t) override {
+            ++depth;
+            if (arrayDepth >= 0 && depth == arrayDepth + 1) {
+                state = nextState = State();
+                action = 0;
+                reward = timestamp = 0.0f;
+                done = false;
+                npcName.clear();
+            } else if (arrayDepth >= 0 && depth == arrayDepth + 2) {
+                target = currentKey == "state" ? &state : currentKey == "nextState" ? &nextState : nullptr;
+            }
+            return true;
+        }
+        bool end_object() override {
+            if (arrayDepth >= 0 && depth == arrayDepth + 2) {
+                target = nullptr;
+            } else if (arrayDepth >= 0 && depth == arrayDepth + 1) {
+                onExperience(ExperienceData(state, static_cast<ActionType>(action), reward, nextState,
+                                            done, npcName, timestamp));
+                ++delivered;
+            }
+            --depth;
+            return true;
+        }
+        bool start_array(std::size_t) override {
+            // top-level array, or the value of a top-level "experiences"/"data" key
+            if (arrayDepth < 0 && (depth == 0 || (depth == 1 && wantArray))) {
+                arrayDepth = depth + 1;
+            }
+            ++depth;
+            return true;
+        }
+        bool end_array() override {
+            --depth;
+            if (depth + 1 == arrayDepth) arrayDepth = -1;
+            return true;
+        }
+        bool key(string_t& value) override {
+            if (depth == 1) wantArray = value == "experiences" || value == "data";
+            currentKey = value;
+            return true;
+        }
+        bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& error) override {
+            getDebugConsole().log("ExperienceDataset", "JSON error at byte " + std::to_string(position) + ": " +
+                                error.what(), LogLevel::Error);
+            return false;
+        }
+    };
+}
+
+bool streamExperienceJson(const std::string& path, const std::function<void(const ExperienceData&)>& onExperience) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        getDebugConsole().log("ExperienceDataset", "Cannot open " + path, LogLevel::Error);
+        return false;
+    }
+    ExperienceSaxHandler handler(onExperience);
+    return nlohmann::json::sax_parse(file, &handler);
+}
@@ -0,0 +1,65 @@
+#include "ExperienceIngestion.hpp"
+
+#include <algorithm>
+
+ExperienceIngestion::ExperienceIngestion(const IngestionPolicy& initialPolicy) {
+    setPolicy(initialPolicy);
+}
+
+void ExperienceIngestion::setPolicy(const IngestionPolicy& newPolicy) {
+    policy = newPolicy;
+    policy.maxActionShare = std::clamp(policy.maxActionShare, 0.0f, 1.0f);
+
+    size_t cacheSize = 1;
+    while (cacheSize < policy.dedupCacheSize) cacheSize <<= 1; // power of two for masking
+    recentPairs.assign(policy.dedup ? cacheSize : 0, 0);
+}
+
+// splitmix64 finalizer over the packed state and the action
+uint64_t ExperienceIngestion::pairHash(const ExperienceRecord& record) {
+    const uint64_t x = mixStateBits(record.state ^ (static_cast<uint64_t>(record.action) * 0x9E3779B97F4A7C15ull));
+    return x ? x : 1; // 0 marks an empty cache slot
+}
+
+ExperienceIngestion::Result ExperienceIngestion::offer(const ExperienceRecord& record, size_t batchSize, size_t capacity) {
+    if (!recentPairs.empty()) {
+        const uint64_t hash = pairHash(record);
+        uint64_t& slot = recentPairs[hash & (recentPairs.size() - 1)];
+        if (slot == hash) {
+            duplicatesDropped++;
+            return {Decision::DropDuplicate, 0};
+        }
+        slot = hash;
+    }
+
+    offeredInWindow++;
+    if (policy.maxActionShare >= 1.0f) {
+        return {Decision::Append, batchSize};
+    }
+
+    // Algorithm R per action: the k-th record of an action replaces a random kept one with probability quota/k
+    const size_t quota = std::max<size_t>(1, static_cast<size_t>(policy.maxActionShare * capacity));
+    auto& slots = slotsByAction[record.action];
+    const size_t seen = ++seenInWindow[record.action];
+    if (slots.size() < quota) {
+        slots.push_back(static_cast<uint32_t>(batchSize));
+        return {Decision::Append, batchSize};
+    }
+    std::uniform_int_distribution<size_t> pick(0, seen - 1);
+    const size_t j = pick(rng);
+    sampledOut++; // either this record or the one it evicts
+    if (j < quota) {
+        return {Decision::Replace, slots[j]};
+    }
+    return {Decision::DropSampled, 0};
+}
+
+bool ExperienceIngestion::isWindowComplete(size_t batchSize, size_t capacity) const {
+    return batchSize >= capacity || offeredInWindow >= capacity;
+}
+
+void ExperienceIngestion::startWindow() {
+    offeredInWindow = 0;
+    seenInWindow.fill(0);
+    for (auto& slots : slotsByAction) slots.clear();
+}
@@ -0,0 +1,80 @@
+#include "ExperienceRecorder.hpp"
+
+namespace {
+    std::atomic<uint64_t> nextRecorderId{1};
+}
+
+ExperienceRecorder::ExperienceRecorder()
+    : recorderId(nextRecorderId.fetch_add(1)) {
+}
+
+ExperienceRecorder::~ExperienceRecorder() {
+    for (auto& buffer : threadBuffers) {
+        Chunk* chunk = buffer->head;
+        while (chunk) {
+            Chunk* next = chunk->next.load();
+            delete chunk;
+            chunk = next;
+        }
+    }
+}
+
+// Per-thread buffer lookup; the cache is a tiny list because a thread rarely feeds more than one recorder
+ExperienceRecorder::ThreadBuffer& ExperienceRecorder::localBuffer() {
+    thread_local std::vector<std::pair<uint64_t, ThreadBuffer*>> cache;
+    for (const auto& [id, buffer] : cache) {
+        if (id == recorderId) return *buffer;
+    }
+
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->tail = buffer->head = new Chunk;
+    ThreadBuffer* raw = buffer.get();
+    {
+        std::lock_guard<std::mutex> lock(registryMutex); // also publishes head to the consumer
+        threadBuffers.push_back(std::move(buffer));
+    }
+    cache.emplace_back(recorderId, raw);
+    return *raw;
+}
+
+void ExperienceRecorder::append(const ExperienceRecord& record) {
+    ThreadBuffer& buffer = localBuffer();
+    Chunk* chunk = buffer.tail;
+    uint32_t count = chunk->count.load(std::memory_order_relaxed); // only this thread writes it
+
+    if (count == kChunkCapacity) {
+        Chunk* fresh = new Chunk;
+        chunk->next.store(fresh, std::memory_order_release);
+        buffer.tail = chunk = fresh;
+        count = 0;
+    }
+
+    chunk->records[count] = record;
+    chunk->count.store(count + 1, std::memory_order_release);
+}
+
+size_t ExperienceRecorder::consume(Chunk& chunk, uint32_t available, std::vector<ExperienceRecord>& out) {
+    if (available <= chunk.consumed) return 0;
+    out.insert(out.end(), chunk.records + chunk.consumed, chunk.records + available);
+    const size_t taken = available - chunk.consumed;
+    chunk.consumed = available;
+    return taken;
+}
+
+size_t ExperienceRecorder::drain(std::vector<ExperienceRecord>& out) {
+    size_t drained = 0;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto& buffer : threadBuffers) {
+        // Walk the chain oldest first so each thread's records stay in order.
+        // A chunk with a successor is full and never touched again, so it can be freed.
+        while (true) {
+            Chunk* chunk = buffer->head;
+            Chunk* next = chunk->next.load(std::memory_order_acquire);
+            drained += consume(*chunk, chunk->count.load(std::memory_order_acquire), out);
+            if (!next) break;
+            buffer->head = next;
+            delete chunk;
+        }
+    }
+    return drained;
+}
@@ -0,0 +1,78 @@
+#include "ExperienceStatistics.hpp"
+
+#include <algorithm>
+
+namespace {
+    constexpr uint64_t kPositionMask = 0xFFFFFFFFull; // posX | posY in the packed layout
+}
+
+size_t CountMinSketch::column(uint64_t key, size_t row) {
+    return static_cast<size_t>(mixStateBits(key + 0x9E3779B97F4A7C15ull * (row + 1)) % kWidth);
+}
+
+void CountMinSketch::add(uint64_t key) {
+    for (size_t row = 0; row < kDepth; row++) {
+        uint32_t& counter = counters[row * kWidth + column(key, row)];
+        if (counter != UINT32_MAX) counter++;
+    }
+}
+
+uint32_t CountMinSketch::estimate(uint64_t key) const {
+    uint32_t best = UINT32_MAX;
+    for (size_t row = 0; row < kDepth; row++) {
+        best = std::min(best, counters[row * kWidth + column(key, row)]);
+    }
+    return best;
+}
+
+void CountMinSketch::clear() {
+    std::fill(counters.begin(), counters.end(), 0);
+}
+
+size_t ExperienceStatsSnapshot::rewardBin(float reward) {
+    const float position = (reward - kRewardLow) / (kRewardHigh - kRewardLow) * kRewardBins;
+    return static_cast<size_t>(std::clamp(position, 0.0f, static_cast<float>(kRewardBins - 1)));
+}
+
+uint32_t ExperienceStatsSnapshot::estimateStateVisits(const State& state) const {
+    return stateVisits.estimate(packExperienceState(state));
+}
+
+uint32_t ExperienceStatsSnapshot::estimatePositionVisits(int posX, int posY) const {
+    State position;
+    position.posX = posX;
+    position.posY = posY;
+    return positionVisits.estimate(packExperienceState(position) & kPositionMask);
+}
+
+void ExperienceStatistics::update(const ExperienceRecord& record) {
+    auto& s = current;
+    s.count++;
+    if (record.done) s.terminalCount++;
+
+    // Welford's online mean/variance
+    const double delta = record.reward - s.rewardMean;
+    s.rewardMean += delta / static_cast<double>(s.count);
+    rewardM2 += delta * (record.reward - s.rewardMean);
+    s.rewardVariance = rewardM2 / static_cast<double>(s.count);
+
+    if (s.count == 1) {
+        s.rewardMin = s.rewardMax = record.reward;
+    } else {
+        s.rewardMin = std::min(s.rewardMin, record.reward);
+        s.rewardMax = std::max(s.rewardMax, record.reward);
+    }
+    s.rewardHistogram[ExperienceStatsSnapshot::rewardBin(record.reward)]++;
+    s.actionCounts[record.action]++;
+
+    if (record.npcId >= s.npcCounts.size()) s.npcCounts.resize(record.npcId + 1, 0);
+    s.npcCounts[record.npcId]++;
+
+    s.stateVisits.add(record.state);
+    s.positionVisits.add(record.state & kPositionMask);
+}
+
+void ExperienceStatistics::reset() {
+    current = ExperienceStatsSnapshot();
+    rewardM2 = 0.0;
+}
@@ -0,0 +1,153 @@
+#include "ExperienceWriter.hpp"
+#include "ExperienceCodec.hpp"
+#include "ExperienceCsv.hpp"
+#include "NumpyIO.hpp"
+#include "debug.hpp"
+
+#include <cstdio>
+#include <ctime>
+
+ExperienceWriter::ExperienceWriter()
+    : worker(&ExperienceWriter::workerLoop, this) {
+}
+
+ExperienceWriter::~ExperienceWriter() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    if (worker.joinable()) worker.join(); // worker drains the queue before exiting
+}
+
+namespace {
+    size_t recordBytes(const ExperienceWriter::Job& job) {
+        return job.records ? job.records->size() * sizeof(ExperienceRecord) : 0;
+    }
+}
+
+std::shared_ptr<std::vector<ExperienceRecord>> ExperienceWriter::submit(Job job) {
+    std::shared_ptr<std::vector<ExperienceRecord>> spare;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        pendingBytes += recordBytes(job);
+        queue.push_back(std::move(job));
+        if (!recycled.empty()) {
+            spare = std::move(recycled.back());
+            recycled.pop_back();
+        }
+    }
+    workAvailable.notify_one();
+    return spare;
+}
+
+void ExperienceWriter::flush() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueDrained.wait(lock, [this] { return queue.empty() && !busy; });
+}
+
+size_t ExperienceWriter::getPendingJobs() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return queue.size() + (busy ? 1 : 0);
+}
+
+size_t ExperienceWriter::getPendingBytes() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return pendingBytes;
+}
+
+bool ExperienceWriter::writeSpill(const std::string& path, const std::vector<ExperienceRecord>& records) {
+    if (!ExperienceCodec::writeFile(path, records, nullptr, 0.0f)) {
+        getDebugConsole().log("DataCollector", "FAILED to spill batch to: " + path, LogLevel::Error);
+        return false;
+    }
+    return true;
+}
+
+bool ExperienceWriter::readSpill(const std::string& path, std::vector<ExperienceRecord>& records) {
+    ExperienceCodec::Block block;
+    if (!ExperienceCodec::readFile(path, block)) return false;
+    records = std::move(block.records);
+    return true;
+}
+
+void ExperienceWriter::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            workAvailable.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return; // stopping and drained
+            job = std::move(queue.front());
+            queue.pop_front();
+            busy = true;
+        }
+
+        const size_t bytes = recordBytes(job);
+        writeJob(job);
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            busy = false;
+            pendingBytes -= bytes;
+            // a buffer still referenced by a batch view can't be reused
+            constexpr size_t kMaxRecycledBuffers = 2; // double buffering: one filling, one spare
+            if (job.records && job.records.use_count() == 1 && recycled.size() < kMaxRecycledBuffers) {
+                job.records->clear();
+                recycled.push_back(std::move(job.records));
+            }
+        }
+        queueDrained.notify_all();
+    }
+}
+
+void ExperienceWriter::writeJob(Job& job) {
+    const float timestamp = static_cast<float>(std::time(nullptr));
+
+    std::vector<ExperienceRecord> spilled;
+    if (!job.spillPath.empty()) {
+        if (!readSpill(job.spillPath, spilled)) {
+            getDebugConsole().log("DataCollector", "FAILED to read spilled batch: " + job.spillPath, LogLevel::Error);
+            return;
+        }
+        std::remove(job.spillPath.c_str());
+    }
+    const std::vector<ExperienceRecord>& records = job.records ? *job.records : spilled;
+
+    if (!job.msxPath.empty() && !ExperienceCodec::writeFile(job.msxPath, records, job.npcNames.get(), timestamp)) {
+        getDebugConsole().log("DataCollector", "FAILED to write batch to: " + job.msxPath, LogLevel::Error);
+    }
+
+    if (!job.npzPath.empty()) {
+        NumpyIO::ExperienceColumns columns;
+        columns.reserve(records.size());
+        for (const auto& record : records) {
+            columns.append(unpackExperienceState(record.state), static_cast<ActionType>(record.action),
+                           record.reward, unpackExperienceState(record.nextState), record.done != 0);
+        }
+        NumpyIO::writeExperienceNpz(job.npzPath, columns);
+    }
+
+    if (!job.jsonPath.empty()) {
+        nlohmann::json jsonData;
+        jsonData["metadata"] = std::move(job.metadata);
+        jsonData[job.jsonArrayKey] = nlohmann::json::array();
+        static const std::string unknownNpc = "unknown";
+        for (const auto& record : records) {
+            const bool named = job.npcNames && record.npcId < job.npcNames->size();
+            const std::string& name = named ? (*job.npcNames)[record.npcId] : unknownNpc;
+            jsonData[job.jsonArrayKey].push_back(ExperienceData::fromRecord(record, name, timestamp).toJson());
+        }
+
+        std::ofstream file(job.jsonPath);
+        if (file.is_open()) {
+            file << jsonData.dump(); // compact: pretty-printing roughly doubled the file size
+        } else {
+            getDebugConsole().log("DataCollector", "FAILED to write batch to: " + job.jsonPath, LogLevel::Error);
+        }
+    }
+
+    if (!job.csvPath.empty()) {
+        ExperienceCsv::writeSegment(job.csvPath, records, job.npcNames, timestamp);
+    }
+}
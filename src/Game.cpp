@@ -1,5 +1,4 @@
 #include "Game.hpp"
-#include "FastNoiseLite.h"
 #include "debug.hpp"
 
 #include <nlohmann/json.hpp>
@@ -8,11 +7,17 @@
 #include "Market.hpp"
 #include "Actions.hpp"
 #include "DataCollector.hpp"
+#include "DQNTrainer.hpp"
+#include "ExperienceDataset.hpp"
+#include "SimulationConfig.hpp"
+#include "JobSystem.hpp"
+#include "ResourceRegrowth.hpp"
 
 #include <random>
 #include <set>
 #include <unordered_map>
 #include <algorithm>
+#include <cmath>
 #include <thread>
 #ifdef USE_TENSORFLOW
 #include <tensorflow/c/c_api.h>
@@ -36,8 +41,14 @@ Game::Game()
     market.setPrice("stone", 1 + std::rand() % 50);
     market.setPrice("bush", 1 + std::rand() % 50);
 
+    // the live and the next iteration's worlds cache evicted chunks in separate directories
+    world.reset(MapGenerator::Settings(), residentChunkBudget, "chunk_cache");
+    nextIteration.world.reset(MapGenerator::Settings(), residentChunkBudget, "chunk_cache/next");
+    loadMapTextures();
     generateMap();
-    npcs = generateNPCEntities(); 
+    generateNPCEntities(npcs, world.getSettings());
+    scheduleSystemTimers();
+    prepareNextIteration();
 
     ui.updateNPCEntityList(npcs);
 
@@ -47,6 +58,13 @@ Game::Game()
 }
 
 Game::~Game() {
+    waitForNextIteration();
+    getResourceRegrowth().detach(); // the tile map goes away with us
+    if (trainer) {
+        trainer->stop();
+        saveTrainingCheckpoint();
+    }
+
     if (getDataCollector().isCollectingData()) {
         getDebugConsole().log("DataCollector", "Saving collected training data...");
         getDataCollector().stopCollection();
@@ -58,6 +76,10 @@ Game::~Game() {
     if (hasData) {
         getDataCollector().exportToJSON("training_data.json");
         getDataCollector().exportToCSV("training_data.csv");
+        getDataCollector().exportToNumpyFormat("training_data");
+        if (getDataCollector().getObservationCount() > 0) {
+            getDataCollector().exportObservations("observations");
+        }
         
         // print statistics and analysis
         getDataCollector().printStatistics();
@@ -88,6 +110,27 @@ void Game::enableTensorFlow(bool enable) {
 
 // initialize TensorFlow models for NPCs
 void Game::initializeNPCTensorFlow() {
+    if (getSimulationConfig().onlineTraining) {
+        startOnlineTraining();
+        return;
+    }
+
+    // native policy first: exported weights run without any TensorFlow runtime
+    std::ifstream nativeModelFile(TensorFlowWrapper::kNativeModelPath, std::ios::binary);
+    if (nativeModelFile.good()) {
+        auto nativeModel = std::make_shared<TensorFlowWrapper>();
+        if (nativeModel->initialize(TensorFlowWrapper::kNativeModelPath)) {
+            getDebugConsole().log("TensorFlow", "Native policy loaded, NPCs will use it for inference.");
+            calibrateQuantizedPolicy(*nativeModel);
+            for (auto& npc : npcs) {
+                npc.setTensorFlowModel(nativeModel);
+                npc.enableTensorFlow(true);
+            }
+            return;
+        }
+        getDebugConsole().log("TensorFlow", "Failed to load native policy, trying TensorFlow model", LogLevel::Warning);
+    }
+
     #ifdef USE_TENSORFLOW
         getDebugConsole().log("TensorFlow", "TensorFlow C API version: " + std::string(TF_Version()));
         
@@ -134,6 +177,131 @@ void Game::initializeNPCTensorFlow() {
     #endif
 }
 
+// train the native policy in-process, warm-starting from the last checkpoint if there is one
+void Game::startOnlineTraining() {
+    if (!trainer) {
+        DQNTrainerConfig trainerConfig;
+        trainerConfig.stateSize = TensorFlowWrapper::featureCountFor(getSimulationConfig().densityRadius);
+        std::ifstream checkpoint(TensorFlowWrapper::kNativeModelPath, std::ios::binary);
+        const bool resume = checkpoint.good();
+        if (resume) {
+            trainerConfig.epsilonStart = 0.1f; // already-trained weights need little exploration
+        }
+
+        trainer = std::make_shared<DQNTrainer>(trainerConfig);
+        if (resume && !trainer->loadWeights(TensorFlowWrapper::kNativeModelPath)) {
+            getDebugConsole().log("DQNTrainer", "Checkpoint unusable, training from scratch", LogLevel::Warning);
+        }
+        warmStartReplay();
+        trainer->start();
+    }
+
+    if (!policyModel) {
+        policyModel = std::make_shared<TensorFlowWrapper>();
+        policyModel->attachTrainer(trainer);
+    }
+    trainerPolicyVersion = trainer->getPublishedVersion();
+    const DQNTrainer::PublishedPolicy published = trainer->getPublished();
+    policyModel->setNativePolicy(*published.policy, published.quantized, published.report);
+    policyModel->setExplorationRate(trainer->getEpsilon());
+    calibrateQuantizedPolicy(*policyModel); // int8 from the trainer's next publish on
+
+    for (auto& npc : npcs) {
+        npc.setTensorFlowModel(policyModel);
+        npc.enableTensorFlow(true);
+    }
+    getDebugConsole().log("DQNTrainer", "NPCs act with the online-trained native policy.");
+}
+
+// refill replay from the last run's export (memory-mapped, newest rows only)
+void Game::warmStartReplay() {
+    const std::string path = getDataCollector().getOutputDirectory() + "/exports/training_data.npz";
+    std::ifstream exportFile(path, std::ios::binary);
+    ExperienceDataset dataset;
+    if (!exportFile.good() || !dataset.addFile(path)) return;
+
+    const size_t capacity = trainer->getConfig().replayCapacity;
+    const size_t first = dataset.size() > capacity ? dataset.size() - capacity : 0;
+    const int featureCount = trainer->getConfig().stateSize;
+    float features[TensorFlowWrapper::kMaxStateFeatureCount];
+    float nextFeatures[TensorFlowWrapper::kMaxStateFeatureCount];
+    for (size_t i = first; i < dataset.size(); i++) {
+        TensorFlowWrapper::writeFeatures(dataset.getState(i), features, featureCount);
+        TensorFlowWrapper::writeFeatures(dataset.getNextState(i), nextFeatures, featureCount);
+        trainer->addExperience(features, TensorFlowWrapper::indexFromAction(dataset.getAction(i)),
+                               dataset.getReward(i), nextFeatures, dataset.isDone(i), false);
+    }
+    getDebugConsole().log("DQNTrainer", "Replay warm-started with " + std::to_string(trainer->getReplaySize()) +
+                        " experiences from " + path);
+}
+
+// pick up freshly published weights and checkpoint periodically
+void Game::updateOnlineTraining(float deltaTime) {
+    if (!trainer || !policyModel) return;
+
+    const uint64_t version = trainer->getPublishedVersion();
+    if (version != trainerPolicyVersion) {
+        // the int8 copy was quantized by the trainer; adopting it is a pointer swap
+        trainerPolicyVersion = version;
+        const DQNTrainer::PublishedPolicy published = trainer->getPublished();
+        const bool wasQuantized = policyModel->isQuantized();
+        policyModel->setNativePolicy(*published.policy, published.quantized, published.report);
+        policyModel->setExplorationRate(trainer->getEpsilon());
+        if (policyModel->isQuantized() && !wasQuantized) {
+            getDebugConsole().log("TensorFlow", "Int8 policy active: " + std::to_string(published.report.actionAgreement * 100.0f) +
+                                "% action agreement with fp32, max |dQ| " + std::to_string(published.report.maxAbsError));
+        }
+    }
+
+    checkpointTimer += deltaTime;
+    if (checkpointTimer >= getSimulationConfig().checkpointInterval) {
+        checkpointTimer = 0.0f;
+        saveTrainingCheckpoint();
+        calibrateQuantizedPolicy(*policyModel); // refresh activation ranges with newer states (used from the next publish)
+    }
+}
+
+// switch a native policy to int8 weights once enough states have been recorded to calibrate them
+void Game::calibrateQuantizedPolicy(TensorFlowWrapper& model) {
+    constexpr size_t kMinCalibrationStates = 64;
+    constexpr size_t kMaxCalibrationStates = 512;
+    if (!getSimulationConfig().quantizedInference || !model.isNativePolicy()) return;
+
+    std::vector<State> states = getDataCollector().getCalibrationStates(kMaxCalibrationStates);
+    if (states.size() < kMinCalibrationStates) {
+        getDebugConsole().log("TensorFlow", "Not enough recorded states to calibrate int8 policy yet (" +
+                            std::to_string(states.size()) + ")");
+        return;
+    }
+
+    // the trainer quantizes each snapshot before publishing it
+    if (trainer && &model == policyModel.get()) {
+        const int featureCount = trainer->getConfig().stateSize;
+        std::vector<float> features(states.size() * featureCount);
+        for (size_t i = 0; i < states.size(); ++i) {
+            TensorFlowWrapper::writeFeatures(states[i], features.data() + i * featureCount, featureCount);
+        }
+        trainer->setQuantizationCalibration(std::move(features));
+        return;
+    }
+
+    if (model.enableQuantization(states)) {
+        const auto& report = model.getQuantizationReport();
+        getDebugConsole().log("TensorFlow", "Int8 policy active: " + std::to_string(report.actionAgreement * 100.0f) +
+                            "% action agreement with fp32, max |dQ| " + std::to_string(report.maxAbsError));
+    }
+}
+
+void Game::saveTrainingCheckpoint() {
+    if (!trainer) return;
+    if (trainer->saveCheckpoint(TensorFlowWrapper::kNativeModelPath)) {
+        getDebugConsole().log("DQNTrainer", "Checkpoint saved after " + std::to_string(trainer->getStepCount()) +
+                            " steps (loss " + std::to_string(trainer->getLastLoss()) + ")");
+    } else {
+        getDebugConsole().log("DQNTrainer", "Failed to save checkpoint", LogLevel::Error);
+    }
+}
+
 // check data collection progress for TensorFlow training
 void Game::checkDataCollectionProgress() {
     if (tensorFlowEnabled && getDataCollector().isCollectingData()) {
@@ -170,8 +338,8 @@ bool Game::detectCollision(Entity& entity) {
     int tileX = static_cast<int>(entity.getPosition().x / GameConfig::tileSize);
     int tileY = static_cast<int>(entity.getPosition().y / GameConfig::tileSize);
 
-    if (tileX >= 0 && tileX < tileMap[0].size() && tileY >= 0 && tileY < tileMap.size()) {
-        Tile& targetTile = *tileMap[tileY][tileX];
+    if (Tile* tile = tileAt(tileX, tileY)) {
+        Tile& targetTile = *tile;
         
         // Handle collision with tile objects
         if (targetTile.hasObject()) {
@@ -210,21 +378,16 @@ void Game::run() {
         sf::Time dt = clock.restart();
         deltaTime = dt.asSeconds();
 
-        // apply simulation speed to market dynamics
-        market.simulateMarketDynamics(deltaTime * simulationSpeed);
-        
-        // apply simulation speed to resource regeneration
-        resourceRegenerationTimer += deltaTime * simulationSpeed;
-        if (resourceRegenerationTimer >= regenerationInterval) {
-            regenerateResources();
-            resourceRegenerationTimer = 0.0f;
-        }
+        // market dynamics, societal growth, regrowth and cooldowns that came due (simulation time)
+        dispatchTimers(deltaTime * simulationSpeed);
 
         // simulate NPCs with simulation speed
         simulateNPCEntityBehavior(deltaTime * simulationSpeed);
-        simulateSocietalGrowth(deltaTime * simulationSpeed);
+        streamWorld();
 
+        getDataCollector().advanceTick(); // move this tick's recorded experiences into the batch
         checkDataCollectionProgress();
+        updateOnlineTraining(deltaTime * simulationSpeed);
 
         // update UI with total money
         ui.updateMoney(MoneyManager::calculateTotalMoney(npcs));
@@ -255,21 +418,141 @@ void Game::run() {
 }
 
 
+// gather every idle NPC driven by a policy network and run one forward pass per model
+void Game::batchPolicyDecisions() {
+    decisionRequests.clear();
+    for (const uint32_t i : activeNpcs) {
+        const NPCEntity& npc = npcs[i];
+        if (npc.getState() == NPCState::Idle && npc.usesPolicyNetwork()) {
+            decisionRequests.emplace_back(npc.getTensorFlowModel(), i);
+        }
+    }
+    if (decisionRequests.empty()) return;
+
+    // NPCs normally share one model; sorting keeps each model's rows contiguous
+    std::sort(decisionRequests.begin(), decisionRequests.end());
+
+    decisionStates.resize(decisionRequests.size());
+    decisionActions.resize(decisionRequests.size());
+    getJobSystem().parallelFor(0, decisionRequests.size(), 32, [this](size_t first, size_t last) {
+        for (size_t r = first; r < last; ++r) {
+            decisionStates[r] = npcs[decisionRequests[r].second].extractState(tileMap);
+        }
+    });
+
+    size_t groupStart = 0;
+    while (groupStart < decisionRequests.size()) {
+        TensorFlowWrapper* model = decisionRequests[groupStart].first;
+        size_t groupEnd = groupStart;
+        while (groupEnd < decisionRequests.size() && decisionRequests[groupEnd].first == model) ++groupEnd;
+        const int groupSize = static_cast<int>(groupEnd - groupStart);
+
+        if (model->usesObservations()) {
+            // egocentric patches for the whole group in one pass, fed to the policy as-is
+            if (observationBuilder.getRadius() != model->getObservationRadius()) {
+                observationBuilder = ObservationBuilder(model->getObservationRadius());
+                observationBuilder.attach(tileMap);
+            } else if (!observationsFresh) {
+                observationBuilder.refresh();
+            }
+            observationsFresh = true;
+
+            observationNpcs.clear();
+            for (size_t r = groupStart; r < groupEnd; ++r) observationNpcs.push_back(&npcs[decisionRequests[r].second]);
+            observationBuilder.build(observationNpcs.data(), groupSize, market, observationBatch);
+            if (model->predictActions(observationBatch, decisionActions.data() + groupStart)) {
+                groupStart = groupEnd;
+                continue;
+            }
+        }
+
+        model->predictActions(decisionStates.data() + groupStart, groupSize, decisionActions.data() + groupStart);
+        groupStart = groupEnd;
+    }
+
+    for (size_t r = 0; r < decisionRequests.size(); ++r) {
+        npcs[decisionRequests[r].second].setPendingDecision(decisionStates[r], decisionActions[r]);
+    }
+}
+
+// observation rows for every NPC about to decide, whatever drives it; the collector keeps each
+// one with that NPC's next experience
+void Game::recordDecisionObservations() {
+    DataCollector& collector = getDataCollector();
+    if (!collector.isCollectingData()) return;
+
+    observationNpcs.clear();
+    observationIds.clear();
+    for (const uint32_t i : activeNpcs) {
+        const NPCEntity& npc = npcs[i];
+        if (npc.getState() == NPCState::Idle) {
+            observationNpcs.push_back(&npc);
+            observationIds.push_back(npc.getRecorderId());
+        }
+    }
+    if (observationNpcs.empty()) return;
+
+    if (!observationsFresh) observationBuilder.refresh();
+    observationsFresh = true;
+    observationBuilder.build(observationNpcs.data(), static_cast<int>(observationNpcs.size()), market, observationBatch);
+    collector.recordObservations(observationBatch, observationIds.data());
+}
+
+// hash every NPC and store its separation steering: O(n) for bounded crowd density,
+// instead of comparing every pair
+void Game::updateCrowding() {
+    npcPositions.resize(npcs.size());
+    for (size_t i = 0; i < npcs.size(); ++i) npcPositions[i] = npcs[i].getPosition();
+    npcHash.rebuild(npcPositions.data(), npcPositions.size());
+
+    constexpr size_t kMaxNeighbors = 6;
+    getJobSystem().parallelFor(0, npcs.size(), 64, [this](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            npcs[i].setAvoidance(npcHash.separation(static_cast<uint32_t>(i), GameConfig::tileSize, kMaxNeighbors));
+        }
+    });
+}
+
 // simulate NPC behavior with stuck detection and handling
 void Game::simulateNPCEntityBehavior(float deltaTime) {
     static std::unordered_map<std::string, int> stuckCounter;
     static std::unordered_map<std::string, sf::Vector2f> lastPosition;
     static std::unordered_map<std::string, float> stuckTimer;
+
+    // NPCs woken by this tick's timers were appended out of order
+    if (!activeNpcsSorted) {
+        std::sort(activeNpcs.begin(), activeNpcs.end());
+        activeNpcs.erase(std::unique(activeNpcs.begin(), activeNpcs.end()), activeNpcs.end());
+        activeNpcsSorted = true;
+    }
+
+    // decision-batching stage: one batched inference instead of a batch-size-1 pass per NPC
+    observationsFresh = false;
+    batchPolicyDecisions();
+    recordDecisionObservations();
+    updateCrowding();
+
+    // vitals and one movement step per walker only change their own NPC, so they run on the job
+    // system. They log only on rare events (arrival, death; the console is locked) and never per
+    // step. Deaths, stuck handling and decisions/actions (tiles, market, Q-tables) stay below
+    getJobSystem().parallelFor(0, activeNpcs.size(), 64, [this, deltaTime](size_t first, size_t last) {
+        for (size_t a = first; a < last; ++a) {
+            NPCEntity& npc = npcs[activeNpcs[a]];
+            npc.update(deltaTime);
+            if (npc.getState() == NPCState::Walking && !npc.isDead()) stepWalking(npc, deltaTime);
+        }
+    });
     
-    for (auto it = npcs.begin(); it != npcs.end(); ) {
-        NPCEntity& npc = *it;
-        
-        npc.update(deltaTime);
+    // sleepers are skipped until their wake-up fires (dispatchTimers puts them back)
+    nextActiveNpcs.clear();
+    dyingNpcs.clear();
+    for (const uint32_t index : activeNpcs) {
+        NPCEntity& npc = npcs[index];
         
         // check if NPC ded
         if (npc.isDead() || npc.getHealth() <= 0 || npc.getEnergy() <= 0) {
             getDebugConsole().log("DEATH", npc.getName() + " has died.");
-            it = npcs.erase(it);
+            dyingNpcs.push_back(index);
             continue;
         }
         // stuck detection
@@ -293,8 +576,8 @@ void Game::simulateNPCEntityBehavior(float deltaTime) {
                     if (stuckTimer[npc.getName()] > 10.0f) {
                         std::random_device rd;
                         std::mt19937 gen(rd());
-                        std::uniform_int_distribution<> distX(1, GameConfig::mapWidth - 2);
-                        std::uniform_int_distribution<> distY(1, GameConfig::mapHeight - 2);
+                        std::uniform_int_distribution<> distX(1, world.getWidth() - 2);
+                        std::uniform_int_distribution<> distY(1, world.getHeight() - 2);
                         
                         float newX = distX(gen) * GameConfig::tileSize;
                         float newY = distY(gen) * GameConfig::tileSize;
@@ -320,22 +603,22 @@ void Game::simulateNPCEntityBehavior(float deltaTime) {
                 
                 switch (actionType) {
                     case ActionType::ChopTree:
-                        nearestTile = npc.findNearestTile(tileMap, ObjectType::Tree);
+                        nearestTile = findNearestTarget(npc, ObjectType::Tree);
                         break;
                     case ActionType::MineRock:
-                        nearestTile = npc.findNearestTile(tileMap, ObjectType::Rock);
+                        nearestTile = findNearestTarget(npc, ObjectType::Rock);
                         break;
                     case ActionType::GatherBush:
-                        nearestTile = npc.findNearestTile(tileMap, ObjectType::Bush);
+                        nearestTile = findNearestTarget(npc, ObjectType::Bush);
                         break;
                     case ActionType::BuyItem:
                     case ActionType::SellItem:
-                        nearestTile = npc.findNearestTile(tileMap, ObjectType::Market);
+                        nearestTile = findNearestTarget(npc, ObjectType::Market);
                         break;
                     case ActionType::RegenerateEnergy:
                     case ActionType::UpgradeHouse:
                     case ActionType::StoreItem:
-                        nearestTile = npc.findNearestTile(tileMap, ObjectType::House);
+                        nearestTile = findNearestTarget(npc, ObjectType::House);
                         break;
                     case ActionType::Rest:
                         npc.setState(NPCState::PerformingAction);
@@ -356,26 +639,8 @@ void Game::simulateNPCEntityBehavior(float deltaTime) {
                 break;
             }
             
-            case NPCState::Walking: { // i added reduce health and energy while walking because npcs were immortal while moving or when being stuck, might remove later
-                if (npc.getTarget() && !npc.isAtTarget()) {
-                    performPathfinding(npc);
-
-                    npc.reduceHealth(0.001f * deltaTime); 
-                    npc.consumeEnergy(0.1f * deltaTime);  
-                    
-                    // check if reached target
-                    sf::Vector2f targetPos = npc.getTarget()->getPosition();
-                    sf::Vector2f npcPos = npc.getPosition();
-                    float distance = std::hypot(targetPos.x - npcPos.x, targetPos.y - npcPos.y);
-                    
-                    if (distance < GameConfig::tileSize * 1.5f) {
-                        npc.setState(NPCState::PerformingAction);
-                    }
-                } else {
-                    npc.setState(NPCState::PerformingAction);
-                }
+            case NPCState::Walking: // moved by stepWalking above
                 break;
-            }
             
             case NPCState::PerformingAction: {
                 if (npc.getTarget()) {
@@ -385,8 +650,8 @@ void Game::simulateNPCEntityBehavior(float deltaTime) {
                     int tileX = static_cast<int>(npcPos.x / GameConfig::tileSize);
                     int tileY = static_cast<int>(npcPos.y / GameConfig::tileSize);
                     
-                    if (tileX >= 0 && tileX < tileMap[0].size() && tileY >= 0 && tileY < tileMap.size()) {
-                        npc.performAction(npc.getCurrentAction(), *tileMap[tileY][tileX], tileMap, market, house);
+                    if (Tile* tile = tileAt(tileX, tileY)) {
+                        npc.performAction(npc.getCurrentAction(), *tile, tileMap, market, house);
                     }
                 }
                 
@@ -400,9 +665,16 @@ void Game::simulateNPCEntityBehavior(float deltaTime) {
                 break;
             }
         }
-        
-        ++it;
+
+        parkOnCooldown(npc);
+        if (!npc.isSleeping()) nextActiveNpcs.push_back(index);
     }
+    if (!dyingNpcs.empty()) removeDyingNpcs();
+    activeNpcs.swap(nextActiveNpcs);
+    vitalsClock = getSimulationTimers().now();
+
+    // the orders posted this tick trade in one batch
+    runMarketAuctions();
     
     if (npcs.empty()) {
         getDebugConsole().log("SYSTEM", "All NPCs died. Processing final data...");
@@ -421,10 +693,10 @@ void Game::simulateNPCEntityBehavior(float deltaTime) {
                 getDataCollector().forceSaveCurrentBatch();
             }
             
-            // export everything 
+            // export everything; the iteration builder writes both files
             std::string timestamp = std::to_string(std::time(nullptr));
-            getDataCollector().exportToCSV("final_training_data_" + timestamp + ".csv");
-            getDataCollector().exportToJSON("final_training_data_" + timestamp + ".json");
+            exportRetiredData("final_training_data_" + timestamp + ".json", false);
+            exportRetiredData("final_training_data_" + timestamp + ".csv", true);
             
             // print final statistics and analysis
             getDataCollector().printStatistics();
@@ -498,7 +770,7 @@ void Game::moveToResource(NPCEntity& npc, ActionType actionType) {
     float shortestDistance = std::numeric_limits<float>::max();
     for (int y = 0; y < tileMap.size(); ++y) {
         for (int x = 0; x < tileMap[y].size(); ++x) {
-            if (tileMap[y][x]->hasObject() && tileMap[y][x]->getObject()->getType() == targetType) {
+            if (tileMap[y][x] && tileMap[y][x]->hasObject() && tileMap[y][x]->getObject()->getType() == targetType) {
                 float distance = std::hypot(x - currentX, y - currentY);
                 if (distance < shortestDistance) {
                     shortestDistance = distance;
@@ -543,81 +815,141 @@ void Game::evaluateNPCEntityState(NPCEntity& NPCEntity) {
 
 
 // regenerate resources on the map
-void Game::regenerateResources() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> distX(0, GameConfig::mapWidth - 1);
-    std::uniform_int_distribution<int> distY(0, GameConfig::mapHeight - 1);
-    std::uniform_real_distribution<float> resourceChance(0.0f, 1.0f); // for probability-based spawning
+// simulate societal growth affecting market dynamics
+void Game::simulateSocietalGrowth() {
+    // example societal growth logic: increase market prices as demand rises
+    for (const auto& [item, currentPrice] : market.getPrices()) {
+        int demand = market.getBuyTransactions(item);
+        int supply = market.getSellTransactions(item);
+        float buyFactor = 1.05f;
 
-    auto& textureManager = TextureManager::getInstance();
+        float newPrice = market.adjustPriceOnBuy(currentPrice, demand, supply, buyFactor);
+        market.setPrice(item, newPrice); // update the price
+    }
+    getDebugConsole().log("Society", "Market prices adjusted due to societal growth.");
+}
 
-    std::vector<const sf::Texture*> rockTextures = {
-        &textureManager.getTexture("rock1", "../assets/objects/rock1.png"),
-        &textureManager.getTexture("rock2", "../assets/objects/rock2.png"),
-        &textureManager.getTexture("rock3", "../assets/objects/rock3.png")
-    };
+// (re)start the periodic systems on a fresh clock; NPC wake-ups from before are dropped with it
+void Game::scheduleSystemTimers() {
+    TimerWheel& timers = getSimulationTimers();
+    timers.clear();
+    timers.schedule(Market::dynamicsInterval, static_cast<uint32_t>(TimerChannel::MarketDynamics));
+    timers.schedule(societalGrowthInterval, static_cast<uint32_t>(TimerChannel::SocietalGrowth));
+    if (getSimulationConfig().snapshotInterval > 0.0f) {
+        timers.schedule(getSimulationConfig().snapshotInterval, static_cast<uint32_t>(TimerChannel::Checkpoint));
+    }
+    vitalsClock = 0.0f;
+    for (auto& npc : npcs) npc.sleepUntil(0);
+    resetActiveNpcs();
+}
 
-    std::vector<const sf::Texture*> bushTextures = {
-        &textureManager.getTexture("bush1", "../assets/objects/bush1.png"),
-        &textureManager.getTexture("bush2", "../assets/objects/bush2.png")
-    };
+void Game::resetActiveNpcs() {
+    activeNpcs.clear();
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        if (!npcs[i].isSleeping()) activeNpcs.push_back(static_cast<uint32_t>(i));
+    }
+    activeNpcsSorted = true;
+    npcIndexByHandle.clear(); // rebuilt on the next lookup
+}
 
-    std::vector<const sf::Texture*> treeTextures = {
-        &textureManager.getTexture("tree1", "../assets/objects/tree1.png"),
-        &textureManager.getTexture("tree2", "../assets/objects/tree2.png"),
-        &textureManager.getTexture("tree3", "../assets/objects/tree3.png")
+// NPC handle -> index in npcs; the table is rebuilt only when it misses or points at someone else
+uint32_t Game::findNpc(uint32_t handle) {
+    auto lookup = [&]() -> uint32_t {
+        const auto found = npcIndexByHandle.find(handle);
+        if (found == npcIndexByHandle.end()) return kNoNpc;
+        return found->second < npcs.size() && npcs[found->second].getHandle() == handle ? found->second : kNoNpc;
     };
+    if (const uint32_t index = lookup(); index != kNoNpc) return index;
 
-    int numResourcesToRegenerate = GameConfig::mapWidth * GameConfig::mapHeight * 0.05; // increased to 5% of map tiles
+    npcIndexByHandle.clear();
+    npcIndexByHandle.reserve(npcs.size());
+    for (size_t i = 0; i < npcs.size(); ++i) npcIndexByHandle[npcs[i].getHandle()] = static_cast<uint32_t>(i);
+    return lookup();
+}
 
-    for (int i = 0; i < numResourcesToRegenerate; ++i) {
-        int x = distX(gen);
-        int y = distY(gen);
+// NPCEntity::update is linear in time (clamped), so one call covers the whole sleep
+void Game::catchUpVitals(NPCEntity& npc) {
+    const float owed = vitalsClock - npc.getSleepStart();
+    if (owed > 0.0f) npc.update(owed);
+    if (npc.isSleeping()) npc.sleepUntil(npc.getWakeTimer(), vitalsClock);
+}
 
-        if (!tileMap[y][x]->hasObject()) {
-            float chance = resourceChance(gen);
+// one compaction for every death of the tick instead of an erase per death
+void Game::removeDyingNpcs() {
+    npcRemap.resize(npcs.size());
+    size_t kept = 0;
+    size_t dying = 0;
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        if (dying < dyingNpcs.size() && dyingNpcs[dying] == i) {
+            npcRemap[i] = kNoNpc;
+            ++dying;
+            continue;
+        }
+        if (kept != i) npcs[kept] = std::move(npcs[i]);
+        npcRemap[i] = static_cast<uint32_t>(kept++);
+    }
+    npcs.erase(npcs.begin() + static_cast<std::ptrdiff_t>(kept), npcs.end());
+    for (uint32_t& index : nextActiveNpcs) index = npcRemap[index]; // survivors only
+}
 
-            // higher chance for trees/bushes on GrassTile
-            if (auto grassTile = dynamic_cast<GrassTile*>(tileMap[y][x].get())) {
-                if (chance < 0.4f) { // 40% chance for trees
-                    grassTile->placeObject(std::make_unique<Tree>(*treeTextures[rand() % treeTextures.size()]));
-                    getDebugConsole().log("Resource Regen", "Tree spawned at (" + std::to_string(x) + ", " + std::to_string(y) + ")");
-                } else if (chance < 0.7f) { // 30% chance for bushes
-                    grassTile->placeObject(std::make_unique<Bush>(*bushTextures[rand() % bushTextures.size()]));
-                    getDebugConsole().log("Resource Regen", "Bush spawned at (" + std::to_string(x) + ", " + std::to_string(y) + ")");
-                }
-            }
-            
-            // higher chance for rocks on StoneTile
-            else if (auto stoneTile = dynamic_cast<StoneTile*>(tileMap[y][x].get())) {
-                if (chance < 0.8f) { // 80% chance for rocks on StoneTile
-                    stoneTile->placeObject(std::make_unique<Rock>(*rockTextures[rand() % rockTextures.size()]));
-                    getDebugConsole().log("Resource Regen", "Rock spawned at (" + std::to_string(x) + ", " + std::to_string(y) + ")");
+// advance the simulation clock and run only what came due
+void Game::dispatchTimers(float simulatedSeconds) {
+    TimerWheel& timers = getSimulationTimers();
+    dueTimers.clear();
+    timers.advance(simulatedSeconds, dueTimers);
+
+    for (const TimerWheel::Event& event : dueTimers) {
+        switch (static_cast<TimerChannel>(event.channel)) {
+            case TimerChannel::MarketDynamics:
+                market.simulateMarketDynamics();
+                timers.schedule(Market::dynamicsInterval, event.channel);
+                break;
+            case TimerChannel::SocietalGrowth:
+                simulateSocietalGrowth();
+                timers.schedule(societalGrowthInterval, event.channel);
+                break;
+            case TimerChannel::ResourceRegrowth:
+                getResourceRegrowth().regrow(event.subject);
+                break;
+            case TimerChannel::ActionReady: {
+                // the id check drops wake-ups that outlived their NPC
+                const uint32_t index = findNpc(event.subject);
+                if (index != kNoNpc && npcs[index].getWakeTimer() == event.id) {
+                    npcs[index].wakeUp();
+                    catchUpVitals(npcs[index]);
+                    activeNpcs.push_back(index);
+                    activeNpcsSorted = false;
                 }
+                break;
             }
+            case TimerChannel::Checkpoint:
+                saveSnapshot(getSimulationConfig().snapshotPath);
+                timers.schedule(getSimulationConfig().snapshotInterval, event.channel);
+                break;
         }
     }
 }
 
-// simulate societal growth affecting market dynamics
-void Game::simulateSocietalGrowth(float deltaTime) {
-    // example societal growth logic: increase market prices as demand rises
-    static float timeAccumulator = 0.0f;
-    timeAccumulator += deltaTime;
-
-    if (timeAccumulator >= 30.0f) { // adjust market prices every 30 seconds
-        for (const auto& [item, currentPrice] : market.getPrices()) {
-            int demand = market.getBuyTransactions(item);
-            int supply = market.getSellTransactions(item);
-            float buyFactor = 1.05f;
-
-            float newPrice = market.adjustPriceOnBuy(currentPrice, demand, supply, buyFactor);
-            market.setPrice(item, newPrice); // update the price
-        }
-        getDebugConsole().log("Society", "Market prices adjusted due to societal growth.");
-        timeAccumulator = 0.0f;
+// clear every market's order books against the NPCs alive this tick
+void Game::runMarketAuctions() {
+    size_t openOrders = 0;
+    for (const Market* tileMarket : marketTiles) openOrders += tileMarket->getOpenOrderCount();
+    if (openOrders == 0) return; // most ticks: skip building the table
+    traders.clear();
+    traders.reserve(npcs.size());
+    for (auto& npc : npcs) {
+        if (!npc.isDead()) traders.emplace(npc.getHandle(), &npc);
     }
+    for (Market* tileMarket : marketTiles) tileMarket->runAuctions(traders);
+}
+
+// an NPC that just started a cooldown sleeps until its wake-up instead of re-deciding every frame
+void Game::parkOnCooldown(NPCEntity& npc) {
+    if (npc.isSleeping() || npc.getActionCooldown() <= 0.0f) return;
+    TimerWheel& timers = getSimulationTimers();
+    npc.sleepUntil(timers.schedule(npc.getActionCooldown(), static_cast<uint32_t>(TimerChannel::ActionReady),
+                                   npc.getHandle()),
+                   timers.now()); // this tick's vitals are already applied
 }
 
 // perform pathfinding for NPC to reach target tile
@@ -638,22 +970,27 @@ void Game::performPathfinding(NPCEntity& npc) {
         if (distance > 0) {
             direction /= distance;
         }
+
+        // steer around neighbours, fading out near the target so crowds still arrive
+        constexpr float AVOIDANCE_WEIGHT = 0.6f;
+        const float fade = std::min(1.0f, distance / (GameConfig::tileSize * 2.0f));
+        direction += npc.getAvoidance() * (AVOIDANCE_WEIGHT * fade);
+        const float steeredLength = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+        if (steeredLength > 1e-3f) {
+            direction /= steeredLength;
+        }
         
         float moveSpeed = npc.getSpeed() * deltaTime * simulationSpeed;
         sf::Vector2f newPosition = npcPos + direction * moveSpeed;
 
         // boundary checking
-        float mapWidth = GameConfig::mapWidth * GameConfig::tileSize;
-        float mapHeight = GameConfig::mapHeight * GameConfig::tileSize;
+        float mapWidth = world.getWidth() * GameConfig::tileSize;
+        float mapHeight = world.getHeight() * GameConfig::tileSize;
         
         newPosition.x = std::clamp(newPosition.x, 0.0f, mapWidth - GameConfig::tileSize);
         newPosition.y = std::clamp(newPosition.y, 0.0f, mapHeight - GameConfig::tileSize);
         
-        npc.setPosition(newPosition.x, newPosition.y);
-        
-        getDebugConsole().log("Pathfinding", npc.getName() + " moved to (" +
-                            std::to_string(newPosition.x) + ", " + std::to_string(newPosition.y) + 
-                            "), distance to target: " + std::to_string(distance));
+        npc.setPosition(newPosition.x, newPosition.y); // streamWorld keeps its chunk resident
     } else {
         // close enough to target
         npc.setState(NPCState::PerformingAction);
@@ -661,6 +998,75 @@ void Game::performPathfinding(NPCEntity& npc) {
     }
 }
 
+// one tick of walking; runs on worker threads, so it may only change this NPC
+// (i added reduce health and energy while walking because npcs were immortal while moving or when being stuck, might remove later)
+void Game::stepWalking(NPCEntity& npc, float deltaTime) {
+    if (npc.getTarget() && !npc.isAtTarget()) {
+        performPathfinding(npc);
+
+        npc.reduceHealth(0.001f * deltaTime, false); // every step, so not logged
+        npc.consumeEnergy(0.1f * deltaTime);  
+        
+        // check if reached target
+        sf::Vector2f targetPos = npc.getTarget()->getPosition();
+        sf::Vector2f npcPos = npc.getPosition();
+        float distance = std::hypot(targetPos.x - npcPos.x, targetPos.y - npcPos.y);
+        
+        if (distance < GameConfig::tileSize * 1.5f) {
+            npc.setState(NPCState::PerformingAction);
+        }
+    } else {
+        npc.setState(NPCState::PerformingAction);
+    }
+}
+
+// the camera's view and every NPC keep their chunks resident; the rest may be evicted
+sf::IntRect Game::viewTiles() const {
+    const sf::View& view = window.getView();
+    const sf::Vector2f corner = view.getCenter() - view.getSize() / 2.0f;
+    return sf::IntRect(static_cast<int>(std::floor(corner.x / GameConfig::tileSize)),
+                       static_cast<int>(std::floor(corner.y / GameConfig::tileSize)),
+                       static_cast<int>(view.getSize().x / GameConfig::tileSize) + 1,
+                       static_cast<int>(view.getSize().y / GameConfig::tileSize) + 1);
+}
+
+void Game::streamWorld() {
+    const sf::IntRect view = viewTiles();
+    world.touchArea(view.left, view.top, view.left + view.width - 1, view.top + view.height - 1);
+    // what NPCs sense and where they head stays resident, so no tile is dropped under them;
+    // the reach is under a chunk, so the corners of the square cover every chunk it spans
+    const int reach = std::min(std::max({1, getSimulationConfig().densityRadius, observationBuilder.getRadius()}),
+                               ChunkManager::kChunkSize - 1);
+    for (const auto& npc : npcs) {
+        const int x = static_cast<int>(npc.getPosition().x / GameConfig::tileSize);
+        const int y = static_cast<int>(npc.getPosition().y / GameConfig::tileSize);
+        const int left = std::max(x - reach, 0), right = std::min(x + reach, world.getWidth() - 1);
+        const int top = std::max(y - reach, 0), bottom = std::min(y + reach, world.getHeight() - 1);
+        world.touch(left, top);
+        world.touch(right, top);
+        world.touch(left, bottom);
+        world.touch(right, bottom);
+        if (const Tile* target = npc.getTarget()) world.touch(target->getGridX(), target->getGridY());
+    }
+    world.endTick();
+}
+
+// nearest object of a type through the chunk index instead of a scan over every tile
+Tile* Game::findNearestTarget(const NPCEntity& npc, ObjectType type) {
+    const sf::Vector2f position = npc.getPosition();
+    int x = 0, y = 0;
+    if (!world.findNearest(type, position.x / GameConfig::tileSize, position.y / GameConfig::tileSize,
+                           targetSearchRadius, x, y)) {
+        return nullptr;
+    }
+    if (Tile* tile = tileAt(x, y)) {
+        if (tile->hasObject() && tile->getObject()->getType() == type) return tile;
+    }
+    getDebugConsole().log("Pathfinding", "Chunk index out of step with the tiles at (" + std::to_string(x) + ", " +
+                          std::to_string(y) + "), scanning", LogLevel::Warning);
+    return npc.findNearestTile(tileMap, type);
+}
+
 // aggregate resources from all NPC inventories
 std::unordered_map<std::string, int> Game::aggregateResources(const std::vector<NPCEntity>& npcs) const {
     std::unordered_map<std::string, int> allResources;
@@ -677,34 +1083,44 @@ std::unordered_map<std::string, int> Game::aggregateResources(const std::vector<
 
 // generate the game map using Perlin noise
 void Game::generateMap() {
-    FastNoiseLite noise;
-    noise.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
-    noise.SetFrequency(0.1f);
-    noise.SetSeed(static_cast<int>(time(nullptr)));
+    // the world streams in chunks generated from the seed; tiles are built for the chunks under
+    // the camera and the NPCs, the ones that stay resident
+    MapGenerator::Settings settings;
+    settings.width = GameConfig::mapWidth;
+    settings.height = GameConfig::mapHeight;
+    settings.seed = static_cast<int>(time(nullptr));
+    settings.frequency = 0.1f;
+    objectLayers.setChangeListener(nullptr);
+    world.setResidencyListener(nullptr);
+    world.reset(settings, residentChunkBudget, world.getCacheDirectory());
+    const sf::IntRect view = viewTiles();
+    world.touchArea(view.left, view.top, view.left + view.width - 1, view.top + view.height - 1);
+    buildTileMap(GameConfig::NPCEntityCount, 2 + rand() % 2);
+}
 
+void Game::loadMapTextures() {
     auto& textureManager = TextureManager::getInstance();
 
     // Load textures using TextureManager
-    std::vector<const sf::Texture*> grassTextures = {
+    mapTextures.grass = {
         &textureManager.getTexture("grass1", "../assets/tiles/grass/grass1.png"),
         &textureManager.getTexture("grass2", "../assets/tiles/grass/grass2.png"),
         &textureManager.getTexture("grass3", "../assets/tiles/grass/grass3.png")
     };
 
-    std::vector<const sf::Texture*> rockTextures = {
+    mapTextures.rock = {
         &textureManager.getTexture("rock1", "../assets/objects/rock1.png"),
         &textureManager.getTexture("rock2", "../assets/objects/rock2.png"),
         &textureManager.getTexture("rock3", "../assets/objects/rock3.png")
     };
 
-
-    std::vector<const sf::Texture*> stoneTextures = {
+    mapTextures.stone = {
         &textureManager.getTexture("stone1", "../assets/tiles/stone/stone1.png"),
         &textureManager.getTexture("stone2", "../assets/tiles/stone/stone2.png"),
         &textureManager.getTexture("stone3", "../assets/tiles/stone/stone3.png")
     };
 
-    std::vector<const sf::Texture*> flowerTextures = {
+    mapTextures.flower = {
         &textureManager.getTexture("flower1", "../assets/tiles/flower/flower1.png"),
         &textureManager.getTexture("flower2", "../assets/tiles/flower/flower2.png"),
         &textureManager.getTexture("flower3", "../assets/tiles/flower/flower3.png"),
@@ -712,106 +1128,218 @@ void Game::generateMap() {
         &textureManager.getTexture("flower5", "../assets/tiles/flower/flower5.png")
     };
 
-    std::vector<const sf::Texture*> bushTextures = {
+    mapTextures.bush = {
         &textureManager.getTexture("bush1", "../assets/objects/bush1.png"),
         &textureManager.getTexture("bush2", "../assets/objects/bush2.png")
     };
 
-    std::vector<const sf::Texture*> treeTextures = {
+    mapTextures.tree = {
         &textureManager.getTexture("tree1", "../assets/objects/tree1.png"),
         &textureManager.getTexture("tree2", "../assets/objects/tree2.png"),
         &textureManager.getTexture("tree3", "../assets/objects/tree3.png")
     };
 
-    std::vector<const sf::Texture*> houseTextures = {
+    mapTextures.house = {
         &textureManager.getTexture("house1", "../assets/objects/house1.png"),
         &textureManager.getTexture("house2", "../assets/objects/house2.png"),
         &textureManager.getTexture("house3", "../assets/objects/house3.png")
     };
 
-    std::vector<const sf::Texture*> marketTextures = {
+    mapTextures.market = {
         &textureManager.getTexture("market1", "../assets/objects/market1.png"),
         &textureManager.getTexture("market2", "../assets/objects/market2.png"),
         &textureManager.getTexture("market3", "../assets/objects/market3.png")
     };
+}
 
-    tileMap.resize(GameConfig::mapHeight);
-    for (auto& row : tileMap) {
-        row.resize(GameConfig::mapWidth);
-        for (auto& tile : row) {
-            tile = std::make_unique<Tile>();
-        }
+void Game::materializeTiles(ChunkManager& source, TileGrid& tiles, std::vector<float>& spawnChances,
+                            int houseCount, int marketCount, std::mt19937& rng,
+                            const std::vector<ChunkManager::TileInfo>* previous) const {
+    MapGenerator::Settings settings = source.getSettings();
+    const size_t tileCount = static_cast<size_t>(settings.width) * settings.height;
+    if (previous && (previous->size() != tileCount || tiles.size() != static_cast<size_t>(settings.height))) {
+        previous = nullptr; // nothing to recycle from
     }
 
-    for (int i = 0; i < GameConfig::mapHeight; ++i) {
-        for (int j = 0; j < GameConfig::mapWidth; ++j) {
-            float noiseValue = noise.GetNoise(static_cast<float>(i), static_cast<float>(j));
-            noiseValue = (noiseValue + 1.0f) / 2.0f;
+    // houses and markets where MapGenerator's rank walk puts them, recorded in the chunks
+    settings.houseCount = houseCount;
+    settings.marketCount = marketCount;
+    for (const MapGenerator::Building& building : MapGenerator().placeBuildings(settings, getJobSystem())) {
+        source.setObject(static_cast<int>(building.tile % settings.width), static_cast<int>(building.tile / settings.width),
+                         building.type, building.variant);
+    }
 
-            if (noiseValue < 0.1f) {
-                tileMap[i][j] = std::make_unique<FlowerTile>(*flowerTextures[rand() % flowerTextures.size()]);
-            } else if (noiseValue < 0.6f) {
-                tileMap[i][j] = std::make_unique<GrassTile>(*grassTextures[rand() % grassTextures.size()]);
-            } else {
-                tileMap[i][j] = std::make_unique<StoneTile>(*stoneTextures[rand() % stoneTextures.size()]);
+    // regrowth chances come from the noise alone, no chunk needed
+    spawnChances.resize(tileCount);
+    for (int y = 0; y < settings.height; ++y) {
+        float* row = spawnChances.data() + static_cast<size_t>(y) * settings.width;
+        source.noiseRow(y, 0, settings.width, row);
+        for (int x = 0; x < settings.width; ++x) row[x] = ResourceRegrowth::spawnChanceFor(row[x]);
+    }
+
+    // tiles for the resident chunks; the others stay empty until their chunk arrives
+    tiles.resize(settings.height);
+    for (auto& row : tiles) row.resize(settings.width);
+    const int chunksX = (settings.width + ChunkManager::kChunkSize - 1) / ChunkManager::kChunkSize;
+    const int chunksY = (settings.height + ChunkManager::kChunkSize - 1) / ChunkManager::kChunkSize;
+    std::vector<uint8_t> resident(static_cast<size_t>(chunksX) * chunksY, 0);
+    for (const auto& [cx, cy] : source.residentChunks()) resident[static_cast<size_t>(cy) * chunksX + cx] = 1;
+    for (int cy = 0; cy < chunksY; ++cy) {
+        for (int cx = 0; cx < chunksX; ++cx) {
+            if (resident[static_cast<size_t>(cy) * chunksX + cx]) {
+                materializeChunk(source, tiles, cx, cy, rng, previous);
+                continue;
             }
+            for (int y = cy * ChunkManager::kChunkSize; y < std::min((cy + 1) * ChunkManager::kChunkSize, settings.height); ++y) {
+                for (int x = cx * ChunkManager::kChunkSize; x < std::min((cx + 1) * ChunkManager::kChunkSize, settings.width); ++x) {
+                    tiles[y][x].reset();
+                }
+            }
+        }
+    }
+}
 
-            tileMap[i][j]->setPosition(j * GameConfig::tileSize, i * GameConfig::tileSize);
+void Game::materializeChunk(ChunkManager& source, TileGrid& tiles, int cx, int cy, std::mt19937& rng,
+                            const std::vector<ChunkManager::TileInfo>* previous) const {
+    auto makeHouse = [this, &rng](uint8_t variant) {
+        sf::Color houseColor(rng() % 256, rng() % 256, rng() % 256);
+        auto house = std::make_unique<House>(*mapTextures.house[variant % mapTextures.house.size()]);
+        house->getSprite().setColor(houseColor);
+        return house;
+    };
+    // resources are stateless, so one of the same kind and look can stay on a recycled tile
+    auto keepsObject = [](const Tile& tile, const ChunkManager::TileInfo& before, const ChunkManager::TileInfo& now) {
+        if (!tile.hasObject() || tile.getObject()->getType() != now.object || before.object != now.object) return false;
+        if (before.objectVariant != now.objectVariant) return false;
+        return now.object == ObjectType::Tree || now.object == ObjectType::Bush || now.object == ObjectType::Rock;
+    };
 
-            int objectChance = rand() % 100;
-            if (auto grassTile = dynamic_cast<GrassTile*>(tileMap[i][j].get())) {
-                if (objectChance < 10) {
-                    grassTile->placeObject(std::make_unique<Tree>(*treeTextures[rand() % treeTextures.size()]));
-                } else if (objectChance < 20) {
-                    grassTile->placeObject(std::make_unique<Bush>(*bushTextures[rand() % bushTextures.size()]));
+    // the chunks' variant counts (MapGenerator::Settings defaults) match the texture lists
+    const int width = source.getWidth();
+    const int lastY = std::min((cy + 1) * ChunkManager::kChunkSize, source.getHeight());
+    const int lastX = std::min((cx + 1) * ChunkManager::kChunkSize, width);
+    for (int i = cy * ChunkManager::kChunkSize; i < lastY; ++i) {
+        for (int j = cx * ChunkManager::kChunkSize; j < lastX; ++j) {
+            const size_t index = static_cast<size_t>(i) * width + j;
+            const ChunkManager::TileInfo info = source.tileAt(j, i);
+            std::unique_ptr<Tile>& tile = tiles[i][j];
+            const bool sameTerrain = previous && tile && (*previous)[index].terrain == info.terrain;
+            if (!sameTerrain) {
+                switch (info.terrain) {
+                    case Terrain::Flower: tile = std::make_unique<FlowerTile>(*mapTextures.flower[info.variant]); break;
+                    case Terrain::Grass: tile = std::make_unique<GrassTile>(*mapTextures.grass[info.variant]); break;
+                    case Terrain::Stone: tile = std::make_unique<StoneTile>(*mapTextures.stone[info.variant]); break;
                 }
-            } else if (auto stoneTile = dynamic_cast<StoneTile*>(tileMap[i][j].get())) {
-                if (objectChance < 20) { 
-                    stoneTile->placeObject(std::make_unique<Rock>(*rockTextures[rand() % rockTextures.size()]));
+                tile->setPosition(j * GameConfig::tileSize, i * GameConfig::tileSize);
+            } else {
+                if ((*previous)[index].variant != info.variant) {
+                    switch (info.terrain) {
+                        case Terrain::Flower: tile->setTexture(*mapTextures.flower[info.variant]); break;
+                        case Terrain::Grass: tile->setTexture(*mapTextures.grass[info.variant]); break;
+                        case Terrain::Stone: tile->setTexture(*mapTextures.stone[info.variant]); break;
+                    }
                 }
+                if (keepsObject(*tile, (*previous)[index], info)) continue;
+                tile->placeObject(nullptr);
             }
+            std::unique_ptr<Object> object;
+            switch (info.object) {
+                case ObjectType::Tree: object = std::make_unique<Tree>(*mapTextures.tree[info.objectVariant]); break;
+                case ObjectType::Bush: object = std::make_unique<Bush>(*mapTextures.bush[info.objectVariant]); break;
+                case ObjectType::Rock: object = std::make_unique<Rock>(*mapTextures.rock[info.objectVariant]); break;
+                case ObjectType::House: object = makeHouse(info.objectVariant); break;
+                case ObjectType::Market:
+                    object = std::make_unique<Market>(*mapTextures.market[info.objectVariant % mapTextures.market.size()]);
+                    break;
+                default: break;
+            }
+            if (!object) continue;
+            if (info.object == ObjectType::House || info.object == ObjectType::Market) source.pin(j, i);
+            object->setVariant(info.objectVariant);
+            tile->placeObject(std::move(object));
         }
     }
+}
 
-    std::set<std::pair<int, int>> occupiedPositions;
-    for (int i = 0; i < GameConfig::NPCEntityCount; ++i) {
-        int houseX, houseY;
-        do {
-            houseX = rand() % GameConfig::mapWidth;
-            houseY = rand() % GameConfig::mapHeight;
-        } while (occupiedPositions.count({houseX, houseY}) || tileMap[houseY][houseX]->hasObject());
-
-        occupiedPositions.insert({houseX, houseY});
+void Game::attachTileMap(std::vector<float> spawnChances) {
+    // from here on placeObject/removeObject keep the bitboards current
+    objectLayers.attach(tileMap);
+    if (getSimulationConfig().densityRadius > 0) {
+        objectLayers.enableAreaSums();
+    }
+    // ...and harvests, regrowth and new buildings reach the chunks
+    objectLayers.setChangeListener([this](ObjectType type, int x, int y, bool placed) {
+        if (streamingTiles) return;
+        if (placed) {
+            const Object* object = tileMap[y][x] ? tileMap[y][x]->getObject() : nullptr;
+            world.setObject(x, y, type, object ? object->getVariant() : 0);
+        } else if (world.objectAt(x, y) == type) {
+            world.removeObject(x, y);
+        }
+    });
+    observationBuilder.attach(tileMap);
+    // markets are placed with the map and never removed; their chunks are pinned
+    marketTiles.clear();
+    for (const auto& row : tileMap) {
+        for (const auto& tile : row) {
+            if (!tile) continue;
+            if (auto* tileMarket = dynamic_cast<Market*>(tile->getObject())) marketTiles.push_back(tileMarket);
+        }
+    }
+    // harvested resources grow back through per-tile timers
+    getResourceRegrowth().attach(tileMap, std::move(spawnChances), static_cast<uint32_t>(TimerChannel::ResourceRegrowth));
+    // from now on chunks arriving or leaving bring or drop their tiles
+    world.setResidencyListener([this](int cx, int cy, bool resident) { onChunkResidency(cx, cy, resident); });
+}
 
-        sf::Color houseColor(rand() % 256, rand() % 256, rand() % 256);
-        auto house = std::make_unique<House>(*houseTextures[i % houseTextures.size()]);
-        house->getSprite().setColor(houseColor);
+// tiles follow chunk residency: built when a chunk is generated or loaded, dropped on eviction
+void Game::onChunkResidency(int cx, int cy, bool resident) {
+    const int firstX = cx * ChunkManager::kChunkSize, firstY = cy * ChunkManager::kChunkSize;
+    const int lastX = std::min(firstX + ChunkManager::kChunkSize, world.getWidth()) - 1;
+    const int lastY = std::min(firstY + ChunkManager::kChunkSize, world.getHeight()) - 1;
+    if (!resident) {
+        // the layers keep the chunk's objects, which cannot change while it is away
+        for (int y = firstY; y <= lastY; ++y) {
+            for (int x = firstX; x <= lastX; ++x) tileMap[y][x].reset();
+        }
+        return;
+    }
 
-        tileMap[houseY][houseX]->placeObject(std::move(house));
+    std::mt19937 rng(static_cast<uint32_t>(std::rand()));
+    materializeChunk(world, tileMap, cx, cy, rng, nullptr);
+    streamingTiles = true;
+    for (int y = firstY; y <= lastY; ++y) {
+        for (int x = firstX; x <= lastX; ++x) tileMap[y][x]->attachObjectLayers(&objectLayers, x, y);
     }
+    streamingTiles = false;
+    observationBuilder.classifyArea(firstX, firstY, lastX, lastY);
+    getResourceRegrowth().indexArea(firstX, firstY, lastX, lastY);
+}
 
-    int marketCount = 2 + rand() % 2;
-    for (int m = 0; m < marketCount; ++m) {
-        int marketX, marketY;
-        do {
-            marketX = rand() % GameConfig::mapWidth;
-            marketY = rand() % GameConfig::mapHeight;
-        } while (occupiedPositions.count({marketX, marketY}) || tileMap[marketY][marketX]->hasObject());
+Tile* Game::tileAt(int x, int y) {
+    if (!world.contains(x, y)) return nullptr;
+    world.touch(x, y);
+    return tileMap[y][x].get();
+}
 
-        occupiedPositions.insert({marketX, marketY});
-        tileMap[marketY][marketX]->placeObject(std::make_unique<Market>(*marketTextures[m % marketTextures.size()]));
-    }
+// materialize the window's tiles from the world chunks, adding houses and markets on free tiles
+void Game::buildTileMap(int houseCount, int marketCount) {
+    std::mt19937 rng(static_cast<uint32_t>(std::rand()));
+    std::vector<float> spawnChances;
+    materializeTiles(world, tileMap, spawnChances, houseCount, marketCount, rng, nullptr);
+    attachTileMap(std::move(spawnChances));
 }
 
 // generate NPC entities with improved stat distribution and logging
-std::vector<NPCEntity> Game::generateNPCEntities() const {
-    std::vector<NPCEntity> npcs;
+void Game::generateNPCEntities(std::vector<NPCEntity>& population, const MapGenerator::Settings& settings) const {
+    population.clear();
+    population.reserve(GameConfig::NPCEntityCount);
     std::set<std::pair<int, int>> occupiedPositions;
 
     std::random_device rd;
     std::mt19937 gen(rd());
-    std::uniform_int_distribution<> distX(0, GameConfig::mapWidth - 1);
-    std::uniform_int_distribution<> distY(0, GameConfig::mapHeight - 1);
+    std::uniform_int_distribution<> distX(0, settings.width - 1);
+    std::uniform_int_distribution<> distY(0, settings.height - 1);
     // better stat distribution - higher minimums
     std::uniform_int_distribution<> healthDist(80, 120);  
     std::uniform_int_distribution<> energyDist(80, 120);  
@@ -826,7 +1354,7 @@ std::vector<NPCEntity> Game::generateNPCEntities() const {
 
         occupiedPositions.insert({x, y});
 
-        sf::Color NPCEntityColor(rand() % 256, rand() % 256, rand() % 256);
+        sf::Color NPCEntityColor(gen() % 256, gen() % 256, gen() % 256); // may run off the simulation thread
         bool enableQLearning = true; // enable for all NPCs 
 
         try {
@@ -848,12 +1376,11 @@ std::vector<NPCEntity> Game::generateNPCEntities() const {
                                 ", Energy=" + std::to_string(npc.getEnergy()) + 
                                 ", Money=" + std::to_string(npc.getMoney()));
 
-            npcs.emplace_back(std::move(npc));
+            population.emplace_back(std::move(npc));
         } catch (const std::exception& e) {
             getDebugConsole().log("ERROR", "Failed to create NPC " + std::to_string(i + 1) + ": " + std::string(e.what()));
         }
     }
-    return npcs;
 }
 
 // render the game world
@@ -864,7 +1391,7 @@ void Game::render() {
     // render tiles
     for (const auto& row : tileMap) {
         for (const auto& tile : row) {
-            tile->draw(window);
+            if (tile) tile->draw(window);
         }
     }
 
@@ -919,9 +1446,14 @@ void Game::logIterationStats(int iteration) {
     
     // data collection stats
     if (getDataCollector().isCollectingData()) {
+        auto dataStats = getDataCollector().getStatistics();
         statsJson["data_collection"] = {
             {"total_experiences", getDataCollector().getTotalExperiences()},
-            {"current_batch_size", getDataCollector().getCurrentBatchSize()}
+            {"current_batch_size", getDataCollector().getCurrentBatchSize()},
+            {"recorded_this_session", dataStats->count},
+            {"reward_mean", dataStats->rewardMean},
+            {"reward_std", std::sqrt(dataStats->rewardVariance)},
+            {"terminal_experiences", dataStats->terminalCount}
         };
     }
     
@@ -974,7 +1506,7 @@ void Game::resetSimulation() {
 
     if (tensorFlowEnabled) {
         getDataCollector().stopCollection();
-        getDataCollector().exportToJSON("iteration_" + std::to_string(iterationCounter) + "_data.json");
+        exportRetiredData("iteration_" + std::to_string(iterationCounter) + "_data.json", false);
         getDataCollector().startCollection(); // Restart for next iteration
         getDebugConsole().log("DataCollection", "Saved iteration " + std::to_string(iterationCounter) + " training data");
     }
@@ -990,19 +1522,39 @@ void Game::resetSimulation() {
     ui.updateMarketPanel(market);
     getDebugConsole().log("MARKET", "Market reset with new randomized prices.");
 
-    npcs.clear();
-    npcs.shrink_to_fit();
-    npcs = generateNPCEntities();
-    ui.updateNPCEntityList(npcs);
-    getDebugConsole().log("NPC", "NPCs reset with fresh random stats.");
+    // swap in the iteration built in the background; the retired world, tiles and NPCs go back
+    // to the builder, which recycles them into the one after
+    // the retiring NPCs take back what their open orders escrowed, so no book carries them over
+    for (auto& npc : npcs) {
+        market.cancelOrders(npc.getHandle(), &npc);
+        for (Market* placed : marketTiles) placed->cancelOrders(npc.getHandle(), &npc);
+    }
 
-    tileMap.clear();
-    tileMap.shrink_to_fit();
-    generateMap();
+    waitForNextIteration();
+    objectLayers.setChangeListener(nullptr);
+    world.setResidencyListener(nullptr);
+    for (size_t i = 0; i < tileMap.size(); ++i) {
+        for (size_t j = 0; j < tileMap[i].size(); ++j) {
+            if (tileMap[i][j]) tileMap[i][j]->attachObjectLayers(nullptr, static_cast<int>(j), static_cast<int>(i));
+        }
+    }
+    world.swap(nextIteration.world);
+    tileMap.swap(nextIteration.tileMap);
+    npcs.swap(nextIteration.npcs);
+    attachTileMap(std::move(nextIteration.spawnChances));
     getDebugConsole().log("MAP", "Map reset and regenerated.");
 
-    regenerateResources();
-    getDebugConsole().log("RESOURCES", "Resources regenerated.");
+    scheduleSystemTimers();
+    if (tensorFlowEnabled && policyModel) {
+        saveTrainingCheckpoint();
+        for (auto& npc : npcs) { // keep learning across iterations
+            npc.setTensorFlowModel(policyModel);
+            npc.enableTensorFlow(true);
+        }
+    }
+    ui.updateNPCEntityList(npcs);
+    getDebugConsole().log("NPC", "NPCs reset with fresh random stats.");
+    prepareNextIteration();
 
     ui.updateStatus(timeManager.getCurrentDay(), timeManager.getFormattedTime(), timeManager.getSocietyIteration());
 
@@ -1011,6 +1563,264 @@ void Game::resetSimulation() {
     getDebugConsole().log("SYSTEM", "Simulation reset complete.");
 }
 
+// copy the running society; only plain values are taken, so it can be written elsewhere
+SimulationSnapshot Game::captureSnapshot() {
+    SimulationSnapshot snapshot;
+    const MapGenerator::Settings& settings = world.getSettings();
+    snapshot.worldWidth = settings.width;
+    snapshot.worldHeight = settings.height;
+    snapshot.worldSeed = settings.seed;
+    snapshot.worldFrequency = settings.frequency;
+    // the chunks mirror every placement and harvest on the tile map; untouched ones aren't stored
+    world.saveSnapshot(snapshot.chunks);
+
+    std::vector<const Entity*> entities;
+    entities.reserve(npcs.size());
+    for (const auto& npc : npcs) entities.push_back(&npc);
+    snapshot.houses.emplace_back();
+    house.saveSnapshot(snapshot.houses.back(), entities);
+    for (size_t i = 0; i < tileMap.size(); ++i) {
+        for (size_t j = 0; j < tileMap[i].size(); ++j) {
+            const auto* placed = tileMap[i][j] ? dynamic_cast<const House*>(tileMap[i][j]->getObject()) : nullptr;
+            if (!placed) continue;
+            HouseSnapshot saved;
+            placed->saveSnapshot(saved, entities);
+            saved.x = static_cast<int32_t>(j);
+            saved.y = static_cast<int32_t>(i);
+            snapshot.houses.push_back(std::move(saved));
+        }
+    }
+
+    snapshot.npcs.resize(npcs.size());
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        if (npcs[i].isSleeping()) catchUpVitals(npcs[i]);
+        npcs[i].saveSnapshot(snapshot.npcs[i]);
+    }
+    // the order books aren't saved: open orders hand their escrow back to the NPCs that posted them
+    std::unordered_map<uint32_t, NpcSnapshot*> owners;
+    owners.reserve(npcs.size());
+    for (size_t i = 0; i < npcs.size(); ++i) owners[npcs[i].getHandle()] = &snapshot.npcs[i];
+    snapshot.markets.emplace_back();
+    market.saveSnapshot(snapshot.markets.back());
+    market.returnEscrow(snapshot.markets.back(), owners);
+    for (size_t i = 0; i < tileMap.size(); ++i) {
+        for (size_t j = 0; j < tileMap[i].size(); ++j) {
+            const auto* placed = tileMap[i][j] ? dynamic_cast<const Market*>(tileMap[i][j]->getObject()) : nullptr;
+            if (!placed) continue;
+            MarketSnapshot saved;
+            placed->saveSnapshot(saved);
+            placed->returnEscrow(saved, owners);
+            saved.x = static_cast<int32_t>(j);
+            saved.y = static_cast<int32_t>(i);
+            snapshot.markets.push_back(std::move(saved));
+        }
+    }
+
+    snapshot.elapsedTime = timeManager.getElapsedTime();
+    snapshot.day = timeManager.getCurrentDay();
+    snapshot.societyIteration = timeManager.getSocietyIteration();
+    snapshot.simulationSpeed = simulationSpeed;
+    const TimerWheel& timers = getSimulationTimers();
+    std::vector<TimerWheel::Pending> pending;
+    timers.collectPending(pending);
+    snapshot.timers.reserve(pending.size());
+    for (const auto& timer : pending) snapshot.timers.push_back({timer.due, timer.channel, timer.subject, timer.id});
+    snapshot.timerTick = timers.getTick();
+    snapshot.timerCarry = timers.getCarry();
+
+    // std::rand's state can't be read, so it continues from a seed recorded here
+    snapshot.randSeed = static_cast<uint32_t>(std::rand());
+    std::srand(snapshot.randSeed);
+    snapshot.regrowthRngState = getResourceRegrowth().getRngState();
+
+    snapshot.moneySpent = MoneyManager::getTotalMoneySpent();
+    snapshot.moneyEarned = MoneyManager::getTotalMoneyEarned();
+    snapshot.persistentStats = {persistentStats.totalItemsGatheredAllTime, persistentStats.totalItemsSoldAllTime,
+                                persistentStats.totalIterations, persistentStats.totalMoneySpentAllTime,
+                                persistentStats.totalMoneyEarnedAllTime};
+    return snapshot;
+}
+
+// replace the running society with a captured one
+bool Game::restoreSnapshot(const SimulationSnapshot& snapshot) {
+    if (snapshot.worldWidth <= 0 || snapshot.worldHeight <= 0) {
+        getDebugConsole().log("Snapshot", "Snapshot world is " + std::to_string(snapshot.worldWidth) + "x" +
+                              std::to_string(snapshot.worldHeight), LogLevel::Error);
+        return false;
+    }
+
+    // the world takes the snapshot's dimensions; the seed regenerates the chunks that weren't stored
+    MapGenerator::Settings settings;
+    settings.width = snapshot.worldWidth;
+    settings.height = snapshot.worldHeight;
+    settings.seed = snapshot.worldSeed;
+    settings.frequency = snapshot.worldFrequency;
+    objectLayers.setChangeListener(nullptr);
+    world.setResidencyListener(nullptr);
+    world.reset(settings, residentChunkBudget, world.getCacheDirectory());
+    world.restoreSnapshot(snapshot.chunks);
+    npcs.clear(); // they point into the old tiles
+    tileMap.clear();
+    const sf::IntRect view = viewTiles();
+    world.touchArea(view.left, view.top, view.left + view.width - 1, view.top + view.height - 1);
+    buildTileMap(0, 0);
+
+    npcs.reserve(snapshot.npcs.size());
+    for (const NpcSnapshot& saved : snapshot.npcs) {
+        NPCEntity npc(saved.name, saved.health, saved.hunger, saved.energy, saved.speed, saved.strength,
+                      saved.money, saved.useQLearning);
+        npc.restoreSnapshot(saved);
+        npc.setTexture(playerTexture, sf::Color(rand() % 256, rand() % 256, rand() % 256));
+        npc.setHouse(&house);
+        Tile* target = tileAt(saved.targetX, saved.targetY);
+        if (target && target->hasObject()) npc.setTarget(target);
+        npcs.emplace_back(std::move(npc));
+    }
+
+    std::vector<const Entity*> entities;
+    entities.reserve(npcs.size());
+    for (const auto& npc : npcs) entities.push_back(&npc);
+    for (const HouseSnapshot& saved : snapshot.houses) {
+        if (saved.x < 0) {
+            house.restoreSnapshot(saved, entities);
+        } else if (Tile* tile = tileAt(saved.x, saved.y)) {
+            if (auto* placed = dynamic_cast<House*>(tile->getObject())) placed->restoreSnapshot(saved, entities);
+        }
+    }
+
+    for (const MarketSnapshot& saved : snapshot.markets) {
+        if (saved.x < 0) {
+            market.restoreSnapshot(saved);
+        } else if (Tile* tile = tileAt(saved.x, saved.y)) {
+            if (auto* placed = dynamic_cast<Market*>(tile->getObject())) placed->restoreSnapshot(saved);
+        }
+    }
+    timeManager.restore(snapshot.elapsedTime, snapshot.day, snapshot.societyIteration);
+    simulationSpeed = snapshot.simulationSpeed;
+
+    // timers come back at their deadlines under new ids; sleeping NPCs follow their wake-ups
+    TimerWheel& timers = getSimulationTimers();
+    timers.restart(snapshot.timerTick, snapshot.timerCarry);
+    // handles are handed out per process, so wake-ups are re-addressed to their sleeper
+    std::unordered_map<uint64_t, uint32_t> sleeperIds;
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        if (snapshot.npcs[i].wakeTimer != 0) sleeperIds[snapshot.npcs[i].wakeTimer] = npcs[i].getHandle();
+    }
+    std::unordered_map<uint64_t, TimerWheel::TimerId> relinked;
+    size_t regrowthTimers = 0;
+    bool checkpointScheduled = false;
+    for (const TimerSnapshot& saved : snapshot.timers) {
+        uint32_t subject = saved.subject;
+        if (saved.channel == static_cast<uint32_t>(TimerChannel::ActionReady)) {
+            auto sleeper = sleeperIds.find(saved.id);
+            if (sleeper == sleeperIds.end()) continue;
+            subject = sleeper->second;
+        }
+        relinked[saved.id] = timers.scheduleAt(saved.due, saved.channel, subject);
+        regrowthTimers += saved.channel == static_cast<uint32_t>(TimerChannel::ResourceRegrowth);
+        checkpointScheduled |= saved.channel == static_cast<uint32_t>(TimerChannel::Checkpoint);
+    }
+    if (!checkpointScheduled && getSimulationConfig().snapshotInterval > 0.0f) {
+        timers.schedule(getSimulationConfig().snapshotInterval, static_cast<uint32_t>(TimerChannel::Checkpoint));
+    }
+    vitalsClock = timers.now();
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        auto wake = relinked.find(snapshot.npcs[i].wakeTimer);
+        if (snapshot.npcs[i].wakeTimer != 0 && wake != relinked.end()) npcs[i].sleepUntil(wake->second, vitalsClock);
+    }
+    resetActiveNpcs();
+    getResourceRegrowth().setPendingCount(regrowthTimers);
+
+    std::srand(snapshot.randSeed);
+    getResourceRegrowth().setRngState(snapshot.regrowthRngState);
+    MoneyManager::restoreTotals(snapshot.moneySpent, snapshot.moneyEarned);
+    if (snapshot.persistentStats.size() >= 5) {
+        persistentStats.totalItemsGatheredAllTime = snapshot.persistentStats[0];
+        persistentStats.totalItemsSoldAllTime = snapshot.persistentStats[1];
+        persistentStats.totalIterations = snapshot.persistentStats[2];
+        persistentStats.totalMoneySpentAllTime = snapshot.persistentStats[3];
+        persistentStats.totalMoneyEarnedAllTime = snapshot.persistentStats[4];
+    }
+
+    if (tensorFlowEnabled && policyModel) {
+        for (auto& npc : npcs) {
+            npc.setTensorFlowModel(policyModel);
+            npc.enableTensorFlow(true);
+        }
+    }
+
+    ui.updateNPCEntityList(npcs);
+    ui.resetMarketGraph();
+    ui.updateMarketPanel(market);
+    ui.updateStatus(timeManager.getCurrentDay(), timeManager.getFormattedTime(), timeManager.getSocietyIteration());
+    getDebugConsole().log("Snapshot", "Restored day " + std::to_string(snapshot.day) + " with " +
+                          std::to_string(npcs.size()) + " NPCs and " + std::to_string(snapshot.timers.size()) + " timers");
+    return true;
+}
+
+void Game::saveSnapshot(const std::string& path) {
+    snapshotWriter.submit(std::make_shared<const SimulationSnapshot>(captureSnapshot()), path);
+    getDebugConsole().log("Snapshot", "Saving day " + std::to_string(timeManager.getCurrentDay()) + " to " + path);
+}
+
+bool Game::loadSnapshot(const std::string& path) {
+    snapshotWriter.flush(); // an autosave to the same file may still be queued
+    SimulationSnapshot snapshot;
+    return snapshot.loadFromFile(path) && restoreSnapshot(snapshot);
+}
+
+// start building the next iteration into nextIteration on the builder thread
+void Game::prepareNextIteration() {
+    waitForNextIteration();
+    MapGenerator::Settings settings = world.getSettings();
+    settings.seed = static_cast<int>(time(nullptr)) ^ std::rand();
+    const int marketCount = 2 + std::rand() % 2;
+    const uint32_t seed = static_cast<uint32_t>(std::rand());
+    iterationBuilder = std::thread(&Game::buildNextIteration, this, settings, marketCount, seed, std::move(retiredDataExports),
+                                   viewTiles());
+    retiredDataExports.clear();
+}
+
+// queue an export for the next builder run; only the O(1) snapshot is taken here
+void Game::exportRetiredData(std::string filename, bool csv) {
+    retiredDataExports.push_back({std::move(filename), csv, getDataCollector().takeExportSnapshot()});
+}
+
+void Game::waitForNextIteration() {
+    if (iterationBuilder.joinable()) iterationBuilder.join();
+}
+
+// runs on iterationBuilder: touches only nextIteration and data fixed since construction
+void Game::buildNextIteration(MapGenerator::Settings settings, int marketCount, uint32_t seed,
+                              std::vector<DataExport> exports, sf::IntRect view) {
+    for (const DataExport& pending : exports) { // the collector is internally locked
+        if (pending.csv) getDataCollector().exportToCSV(pending.filename, pending.data);
+        else getDataCollector().exportToJSON(pending.filename, pending.data);
+    }
+
+    Iteration& next = nextIteration;
+    // the terrain the retired tiles show, so unchanged ones are kept; tiles exist only where
+    // their chunk is resident, so this loads nothing
+    next.previousTiles.clear();
+    if (next.tileMap.size() == static_cast<size_t>(settings.height) && next.world.getWidth() == settings.width &&
+        next.world.getHeight() == settings.height) {
+        next.previousTiles.resize(static_cast<size_t>(settings.width) * settings.height);
+        for (int y = 0; y < settings.height; ++y) {
+            for (int x = 0; x < settings.width && x < static_cast<int>(next.tileMap[y].size()); ++x) {
+                if (next.tileMap[y][x]) next.previousTiles[static_cast<size_t>(y) * settings.width + x] = next.world.tileAt(x, y);
+            }
+        }
+    }
+
+    next.world.reset(settings, residentChunkBudget, next.world.getCacheDirectory());
+    next.world.touchArea(view.left, view.top, view.left + view.width - 1, view.top + view.height - 1);
+    std::mt19937 rng(seed);
+    materializeTiles(next.world, next.tileMap, next.spawnChances, GameConfig::NPCEntityCount, marketCount, rng,
+                     next.previousTiles.empty() ? nullptr : &next.previousTiles);
+    generateNPCEntities(next.npcs, settings);
+    getDebugConsole().log("MAP", "Next iteration prepared (seed " + std::to_string(settings.seed) + ")");
+}
+
 // toggle tile border visibility
 void Game::toggleTileBorders() {
     showTileBorders = !showTileBorders;
@@ -1,7 +1,11 @@
 #include "House.hpp"
 #include "NPCEntity.hpp"
 #include "debug.hpp"
+#include "SimulationSnapshot.hpp"
+
+#include <algorithm>
 #include "Configuration.hpp"
+#include "TimerWheel.hpp"
 
 #include <sstream>
 #include <numeric>  
@@ -47,16 +51,14 @@ int House::getRequirementForItem(const std::string& item) const {
 
 // FIXED: Changed parameter from NPCEntity& to Entity&
 void House::regenerateEnergy(Entity& entity) {
-    // FIXED: Add cooldown tracking per entity
-    static std::unordered_map<void*, float> lastRegenTime;
-    static std::unordered_map<void*, int> regenCount;
-    
-    void* entityPtr = &entity;
-    float currentTime = static_cast<float>(std::time(nullptr));
+    // FIXED: Add cooldown tracking per entity (simulation time, so it follows the speed setting)
+    const Entity* entityPtr = &entity;
+    const float currentTime = getSimulationTimers().now();
     
     // FIXED: Enforce cooldown between regenerations
-    if (lastRegenTime.find(entityPtr) != lastRegenTime.end()) {
-        float timeSinceLastRegen = currentTime - lastRegenTime[entityPtr];
+    auto last = lastRegenTime.find(entityPtr);
+    if (last != lastRegenTime.end()) {
+        float timeSinceLastRegen = currentTime - last->second;
         if (timeSinceLastRegen < 5.0f) { // 5 second cooldown
             getDebugConsole().log("House", "Entity regeneration on cooldown (" + 
                                 std::to_string(5.0f - timeSinceLastRegen) + "s remaining)");
@@ -253,10 +255,44 @@ int House::getStoredItemCount(const std::string& item) const {
 }
 
 void House::resetDailyLimits() {
-    static std::unordered_map<void*, float> lastRegenTime;
-    static std::unordered_map<void*, int> regenCount;
-    
     lastRegenTime.clear();
     regenCount.clear();
     getDebugConsole().log("House", "Daily regeneration limits reset");
 }
+
+void House::saveSnapshot(HouseSnapshot& out, const std::vector<const Entity*>& entities) const {
+    out.level = level;
+    out.maxStorageCapacity = maxStorageCapacity;
+    out.energyRegenRate = energyRegenRate;
+    out.healthBonus = healthBonus;
+    out.strengthBonus = strengthBonus;
+    out.speedBonus = speedBonus;
+    out.storage.assign(storage.begin(), storage.end());
+    std::sort(out.storage.begin(), out.storage.end());
+    out.lastRegenTime.clear();
+    out.regenCount.clear();
+    for (size_t i = 0; i < entities.size(); ++i) {
+        auto last = lastRegenTime.find(entities[i]);
+        if (last != lastRegenTime.end()) out.lastRegenTime.emplace_back(static_cast<int32_t>(i), last->second);
+        auto count = regenCount.find(entities[i]);
+        if (count != regenCount.end()) out.regenCount.emplace_back(static_cast<int32_t>(i), count->second);
+    }
+}
+
+void House::restoreSnapshot(const HouseSnapshot& in, const std::vector<const Entity*>& entities) {
+    level = in.level;
+    maxStorageCapacity = in.maxStorageCapacity;
+    energyRegenRate = in.energyRegenRate;
+    healthBonus = in.healthBonus;
+    strengthBonus = in.strengthBonus;
+    speedBonus = in.speedBonus;
+    storage = std::unordered_map<std::string, int>(in.storage.begin(), in.storage.end());
+    lastRegenTime.clear();
+    regenCount.clear();
+    for (const auto& [index, time] : in.lastRegenTime) {
+        if (index >= 0 && static_cast<size_t>(index) < entities.size()) lastRegenTime[entities[index]] = time;
+    }
+    for (const auto& [index, count] : in.regenCount) {
+        if (index >= 0 && static_cast<size_t>(index) < entities.size()) regenCount[entities[index]] = count;
+    }
+}
@@ -0,0 +1,177 @@
+#include "JobSystem.hpp"
+
+#include <cstdint>
+
+namespace {
+    constexpr size_t kArenaBlockSize = 64 * 1024;
+    constexpr size_t kNotAWorker = SIZE_MAX;
+
+    // (scheduler, queue index) of the calling worker thread
+    thread_local const JobSystem* workerOwner = nullptr;
+    thread_local size_t workerIndex = kNotAWorker;
+}
+
+ScratchArena& ScratchArena::local() {
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+// Blocks come from new[] (aligned for any fundamental type), so aligning offsets is enough
+void* ScratchArena::allocateBytes(size_t bytes, size_t alignment) {
+    while (block < blocks.size()) {
+        const size_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+        if (aligned + bytes <= blocks[block].size) {
+            offset = aligned + bytes;
+            return blocks[block].data.get() + aligned;
+        }
+        ++block; // blocks kept from earlier jobs are reused before new ones are added
+        offset = 0;
+    }
+    const size_t size = std::max(kArenaBlockSize, bytes);
+    blocks.push_back({std::unique_ptr<char[]>(new char[size]), size});
+    block = blocks.size() - 1;
+    offset = bytes;
+    return blocks.back().data.get();
+}
+
+size_t ScratchArena::capacity() const {
+    size_t total = 0;
+    for (const auto& b : blocks) total += b.size;
+    return total;
+}
+
+JobSystem& getJobSystem() {
+    static JobSystem instance;
+    return instance;
+}
+
+JobSystem::JobSystem(unsigned workerCount) {
+    if (workerCount == 0) {
+        const unsigned hardware = std::thread::hardware_concurrency();
+        workerCount = hardware > 1 ? hardware - 1 : 0;
+    }
+    for (unsigned i = 0; i <= workerCount; ++i) queues.push_back(std::make_unique<Queue>());
+    for (unsigned i = 0; i < workerCount; ++i) workers.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+size_t JobSystem::currentQueue() const {
+    return workerOwner == this ? workerIndex : queues.size() - 1;
+}
+
+JobSystem::JobHandle JobSystem::submit(std::function<void()> work, std::initializer_list<JobHandle> dependencies) {
+    return submit(std::move(work), std::vector<JobHandle>(dependencies));
+}
+
+JobSystem::JobHandle JobSystem::submit(std::function<void()> work, const std::vector<JobHandle>& dependencies) {
+    auto job = std::make_shared<Job>();
+    job->work = std::move(work);
+    for (const JobHandle& dependency : dependencies) {
+        if (!dependency) continue;
+        std::lock_guard<std::mutex> lock(dependency->mutex);
+        if (!dependency->done) {
+            job->pending.fetch_add(1, std::memory_order_relaxed);
+            dependency->continuations.push_back(job);
+        }
+    }
+    // drop the submit guard; the last finished dependency enqueues otherwise
+    if (job->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) enqueue(job);
+    return job;
+}
+
+void JobSystem::enqueue(JobHandle job) {
+    Queue& queue = *queues[currentQueue()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+    queuedJobs.fetch_add(1, std::memory_order_release);
+    if (!workers.empty()) {
+        std::lock_guard<std::mutex> lock(sleepMutex); // pairs with the predicate check in workerLoop
+        wake.notify_one();
+    }
+}
+
+JobSystem::JobHandle JobSystem::takeJob(size_t home) {
+    if (queuedJobs.load(std::memory_order_acquire) == 0) return nullptr;
+
+    // newest job from our own queue (still warm in cache)
+    if (home < queues.size()) {
+        Queue& own = *queues[home];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty()) {
+            JobHandle job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+    // oldest job of anyone else, injection queue included
+    for (size_t step = 1; step <= queues.size(); ++step) {
+        Queue& victim = *queues[(home + step) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            JobHandle job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::execute(const JobHandle& job) {
+    ScratchArena& arena = ScratchArena::local();
+    const ScratchArena::Mark mark = arena.mark();
+    job->work();
+    job->work = nullptr; // release captures early
+    arena.rewind(mark);
+
+    std::vector<JobHandle> ready;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->done.store(true, std::memory_order_release);
+        ready.swap(job->continuations);
+    }
+    for (JobHandle& next : ready) {
+        if (next->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) enqueue(std::move(next));
+    }
+}
+
+void JobSystem::workerLoop(size_t index) {
+    workerOwner = this;
+    workerIndex = index;
+    while (true) {
+        if (JobHandle job = takeJob(index)) {
+            execute(job);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this] { return stopping || queuedJobs.load(std::memory_order_acquire) > 0; });
+        if (stopping && queuedJobs.load(std::memory_order_acquire) == 0) return;
+    }
+}
+
+void JobSystem::wait(const JobHandle& job) {
+    if (!job) return;
+    const size_t home = currentQueue();
+    while (!job->done.load(std::memory_order_acquire)) {
+        if (JobHandle other = takeJob(home)) {
+            execute(other);
+        } else {
+            std::this_thread::yield(); // the job is running elsewhere or waits on dependencies
+        }
+    }
+}
+
+void JobSystem::waitAll(const std::vector<JobHandle>& jobs) {
+    for (const JobHandle& job : jobs) wait(job);
+}
@@ -0,0 +1,161 @@
+#include "MLPKernels.hpp"
+#include "MLPKernelBlocks.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Baseline kernels: NEON is part of every ARM64 target, anything else gets the scalar build.
+// On x86 the AVX2 kernels live in their own translation unit and are picked at runtime.
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MLP_KERNELS_NEON 1
+#endif
+
+namespace {
+
+// Thin per-ISA vector helpers so the blocked kernels in MLPKernelBlocks are written once
+#if defined(MLP_KERNELS_NEON)
+    struct BaselineOps {
+        using Vec = float32x4_t;
+        static constexpr int kLanes = 4;
+        static inline Vec load(const float* p) { return vld1q_f32(p); }
+        static inline void store(float* p, Vec v) { vst1q_f32(p, v); }
+        static inline Vec broadcast(const float* p) { return vld1q_dup_f32(p); }
+        static inline Vec fma(Vec a, Vec b, Vec c) { return vfmaq_f32(c, a, b); }
+        static inline Vec relu(Vec v) { return vmaxq_f32(v, vdupq_n_f32(0.0f)); }
+    };
+
+    // Widening int8 multiply, then pairwise-add the two inputs of each output into int32
+    struct BaselineInt8 {
+        template <int ROWS>
+        static inline void run(const int8_t* w, int wStride, const float* scales, const float* bias,
+                               const int8_t* x, int xStride, float* y, int yStride,
+                               int pairs, bool applyRelu) {
+            int32x4_t accLow[ROWS], accHigh[ROWS];
+            for (int r = 0; r < ROWS; ++r) {
+                accLow[r] = vdupq_n_s32(0);
+                accHigh[r] = vdupq_n_s32(0);
+            }
+
+            for (int p = 0; p < pairs; ++p) {
+                const int8x16_t wv = vld1q_s8(w + static_cast<size_t>(p) * wStride);
+                for (int r = 0; r < ROWS; ++r) {
+                    const int8_t* xp = x + static_cast<size_t>(r) * xStride + 2 * p;
+                    const uint16_t bits = static_cast<uint16_t>(static_cast<uint8_t>(xp[0]) |
+                                                                (static_cast<uint8_t>(xp[1]) << 8));
+                    const int8x16_t xv = vreinterpretq_s8_u16(vdupq_n_u16(bits));
+                    accLow[r] = vpadalq_s16(accLow[r], vmull_s8(vget_low_s8(wv), vget_low_s8(xv)));
+                    accHigh[r] = vpadalq_s16(accHigh[r], vmull_s8(vget_high_s8(wv), vget_high_s8(xv)));
+                }
+            }
+
+            const float32x4_t scaleLow = vld1q_f32(scales), scaleHigh = vld1q_f32(scales + 4);
+            const float32x4_t biasLow = vld1q_f32(bias), biasHigh = vld1q_f32(bias + 4);
+            for (int r = 0; r < ROWS; ++r) {
+                float32x4_t low = vfmaq_f32(biasLow, vcvtq_f32_s32(accLow[r]), scaleLow);
+                float32x4_t high = vfmaq_f32(biasHigh, vcvtq_f32_s32(accHigh[r]), scaleHigh);
+                if (applyRelu) {
+                    low = vmaxq_f32(low, vdupq_n_f32(0.0f));
+                    high = vmaxq_f32(high, vdupq_n_f32(0.0f));
+                }
+                vst1q_f32(y + static_cast<size_t>(r) * yStride, low);
+                vst1q_f32(y + static_cast<size_t>(r) * yStride + 4, high);
+            }
+        }
+    };
+#else
+    struct BaselineOps {
+        using Vec = float;
+        static constexpr int kLanes = 1;
+        static inline Vec load(const float* p) { return *p; }
+        static inline void store(float* p, Vec v) { *p = v; }
+        static inline Vec broadcast(const float* p) { return *p; }
+        static inline Vec fma(Vec a, Vec b, Vec c) { return a * b + c; }
+        static inline Vec relu(Vec v) { return v > 0.0f ? v : 0.0f; }
+    };
+
+    struct BaselineInt8 {
+        template <int ROWS>
+        static inline void run(const int8_t* w, int wStride, const float* scales, const float* bias,
+                               const int8_t* x, int xStride, float* y, int yStride,
+                               int pairs, bool applyRelu) {
+            constexpr int kGroup = MLPKernels::blocks::kInt8Group;
+            for (int r = 0; r < ROWS; ++r) {
+                int32_t acc[kGroup] = {};
+                const int8_t* xr = x + static_cast<size_t>(r) * xStride;
+                for (int p = 0; p < pairs; ++p) {
+                    const int8_t* wp = w + static_cast<size_t>(p) * wStride;
+                    for (int o = 0; o < kGroup; ++o) {
+                        acc[o] += wp[2 * o] * xr[2 * p] + wp[2 * o + 1] * xr[2 * p + 1];
+                    }
+                }
+                float* out = y + static_cast<size_t>(r) * yStride;
+                for (int o = 0; o < kGroup; ++o) {
+                    const float v = static_cast<float>(acc[o]) * scales[o] + bias[o];
+                    out[o] = (applyRelu && v < 0.0f) ? 0.0f : v;
+                }
+            }
+        }
+    };
+#endif
+
+    // AVX2 is only used when this build compiled MLPKernelsAVX2.cpp with the ISA flags
+    // (MLP_KERNELS_RUNTIME_AVX2) and the CPU running it supports them
+    bool useAvx2() {
+#if defined(MLP_KERNELS_RUNTIME_AVX2)
+        static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        return supported;
+#else
+        return false;
+#endif
+    }
+}
+
+void MLPKernels::denseForward(const float* packedWeights, const float* bias,
+                              const float* x, int xStride,
+                              float* y, int yStride,
+                              int batch, int inputs, int paddedOutputs, bool relu) {
+#if defined(MLP_KERNELS_RUNTIME_AVX2)
+    if (useAvx2()) {
+        avx2::denseForward(packedWeights, bias, x, xStride, y, yStride, batch, inputs, paddedOutputs, relu);
+        return;
+    }
+#endif
+    blocks::denseForward<BaselineOps>(packedWeights, bias, x, xStride, y, yStride, batch, inputs, paddedOutputs, relu);
+}
+
+void MLPKernels::denseForwardInt8(const int8_t* packedWeights, const float* outputScales, const float* bias,
+                                  const int8_t* x, int xStride,
+                                  float* y, int yStride,
+                                  int batch, int paddedInputs, int paddedOutputs, bool relu) {
+#if defined(MLP_KERNELS_RUNTIME_AVX2)
+    if (useAvx2()) {
+        avx2::denseForwardInt8(packedWeights, outputScales, bias, x, xStride, y, yStride,
+                               batch, paddedInputs, paddedOutputs, relu);
+        return;
+    }
+#endif
+    blocks::denseForwardInt8<BaselineInt8>(packedWeights, outputScales, bias, x, xStride, y, yStride,
+                                           batch, paddedInputs, paddedOutputs, relu);
+}
+
+void MLPKernels::quantizeRows(const float* x, int xStride, int8_t* q, int qStride,
+                              int batch, int count, float invScale) {
+    for (int b = 0; b < batch; ++b) {
+        const float* in = x + static_cast<size_t>(b) * xStride;
+        int8_t* out = q + static_cast<size_t>(b) * qStride;
+        for (int i = 0; i < count; ++i) {
+            const float v = std::nearbyint(in[i] * invScale);
+            out[i] = static_cast<int8_t>(std::clamp(v, -127.0f, 127.0f));
+        }
+    }
+}
+
+const char* MLPKernels::instructionSet() {
+    if (useAvx2()) return "AVX2";
+#if defined(MLP_KERNELS_NEON)
+    return "NEON";
+#else
+    return "Scalar";
+#endif
+}
@@ -0,0 +1,67 @@
+#include "MLPKernelBlocks.hpp"
+
+// The only translation unit built with AVX2/FMA flags (see CMakeLists.txt). MLPKernels calls
+// into it after checking the CPU, so the rest of the binary stays on the baseline ISA.
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+
+namespace {
+
+    struct Avx2Ops {
+        using Vec = __m256;
+        static constexpr int kLanes = 8;
+        static inline Vec load(const float* p) { return _mm256_loadu_ps(p); }
+        static inline void store(float* p, Vec v) { _mm256_storeu_ps(p, v); }
+        static inline Vec broadcast(const float* p) { return _mm256_broadcast_ss(p); }
+        static inline Vec fma(Vec a, Vec b, Vec c) { return _mm256_fmadd_ps(a, b, c); }
+        static inline Vec relu(Vec v) { return _mm256_max_ps(v, _mm256_setzero_ps()); }
+    };
+
+    // ROWS batch rows x 8 outputs; madd_epi16 (or dpwssd with AVX512-VNNI) does two inputs per lane
+    struct Avx2Int8 {
+        template <int ROWS>
+        static inline void run(const int8_t* w, int wStride, const float* scales, const float* bias,
+                               const int8_t* x, int xStride, float* y, int yStride,
+                               int pairs, bool applyRelu) {
+            __m256i acc[ROWS];
+            for (int r = 0; r < ROWS; ++r) acc[r] = _mm256_setzero_si256();
+
+            for (int p = 0; p < pairs; ++p) {
+                const __m256i wv = _mm256_cvtepi8_epi16(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + static_cast<size_t>(p) * wStride)));
+                for (int r = 0; r < ROWS; ++r) {
+                    const __m256i xv = _mm256_set1_epi32(static_cast<int>(
+                        MLPKernels::blocks::activationPair(x + static_cast<size_t>(r) * xStride + 2 * p)));
+#if defined(__AVX512VNNI__) && defined(__AVX512VL__)
+                    acc[r] = _mm256_dpwssd_epi32(acc[r], wv, xv);
+#else
+                    acc[r] = _mm256_add_epi32(acc[r], _mm256_madd_epi16(wv, xv));
+#endif
+                }
+            }
+
+            const __m256 scale = _mm256_loadu_ps(scales);
+            const __m256 b = _mm256_loadu_ps(bias);
+            for (int r = 0; r < ROWS; ++r) {
+                __m256 out = _mm256_fmadd_ps(_mm256_cvtepi32_ps(acc[r]), scale, b);
+                if (applyRelu) out = _mm256_max_ps(out, _mm256_setzero_ps());
+                _mm256_storeu_ps(y + static_cast<size_t>(r) * yStride, out);
+            }
+        }
+    };
+}
+
+void MLPKernels::avx2::denseForward(const float* packedWeights, const float* bias,
+                                    const float* x, int xStride, float* y, int yStride,
+                                    int batch, int inputs, int paddedOutputs, bool relu) {
+    blocks::denseForward<Avx2Ops>(packedWeights, bias, x, xStride, y, yStride, batch, inputs, paddedOutputs, relu);
+}
+
+void MLPKernels::avx2::denseForwardInt8(const int8_t* packedWeights, const float* outputScales, const float* bias,
+                                        const int8_t* x, int xStride, float* y, int yStride,
+                                        int batch, int paddedInputs, int paddedOutputs, bool relu) {
+    blocks::denseForwardInt8<Avx2Int8>(packedWeights, outputScales, bias, x, xStride, y, yStride,
+                                       batch, paddedInputs, paddedOutputs, relu);
+}
+
+#endif
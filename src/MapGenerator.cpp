@@ -0,0 +1,331 @@
+#include "MapGenerator.hpp"
+#include "JobSystem.hpp"
+#include "ObjectLayers.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+    // FastNoiseLite's hashing constants
+    constexpr int32_t kPrimeX = 501125321;
+    constexpr int32_t kPrimeY = 1136930381;
+    constexpr float kPerlinScale = 1.4247691104677813f;
+    constexpr size_t kRowGrain = 16; // rows per job at least
+
+    // FastNoiseLite's 2D gradient table: 24 directions 15 degrees apart starting at 82.5,
+    // five times over, then 8 directions 45 degrees apart starting at 67.5
+    struct Gradients {
+        float x[128];
+        float y[128];
+        Gradients() {
+            const double degrees = 3.14159265358979323846 / 180.0;
+            for (int k = 0; k < 128; ++k) {
+                const double angle = (k < 120 ? 82.5 - 15.0 * (k % 24) : 67.5 - 45.0 * (k - 120)) * degrees;
+                x[k] = static_cast<float>(std::cos(angle));
+                y[k] = static_cast<float>(std::sin(angle));
+            }
+        }
+    };
+    const Gradients& gradients() {
+        static const Gradients table;
+        return table;
+    }
+
+    int fastFloor(float f) { return f >= 0 ? static_cast<int>(f) : static_cast<int>(f) - 1; }
+    float quintic(float t) { return t * t * t * (t * (t * 6 - 15) + 10); }
+
+    // gradient index of a primed lattice corner (wrapping 32-bit arithmetic, as in FastNoiseLite)
+    int gradientIndex(int seed, uint32_t xPrimed, uint32_t yPrimed) {
+        uint32_t hash = (static_cast<uint32_t>(seed) ^ xPrimed ^ yPrimed) * 0x27d4eb2du;
+        hash ^= hash >> 15;
+        return static_cast<int>((hash & (127u << 1)) >> 1);
+    }
+
+    // per-tile random bits: two multiply-xorshift rounds, enough for variants and spawn rolls
+    uint64_t hashTile(uint64_t seed, uint64_t tile) {
+        uint64_t h = (seed ^ tile) * 0x9E3779B97F4A7C15ull;
+        h = (h ^ (h >> 32)) * 0xD6E8FEB86659FD93ull;
+        return h ^ (h >> 32);
+    }
+
+    uint64_t mix(uint64_t value) { // splitmix64 finalizer
+        value += 0x9E3779B97F4A7C15ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    uint64_t worldSeed(int seed) { return mix(static_cast<uint64_t>(static_cast<uint32_t>(seed))); }
+
+    // low 32 bits of `bits` scaled into [0, count) (a multiply instead of a division)
+    uint8_t variant(uint64_t bits, uint32_t count) {
+        return static_cast<uint8_t>((static_cast<uint64_t>(static_cast<uint32_t>(bits)) * count) >> 32);
+    }
+
+    // per terrain: what spawns below which object roll (Flower, Grass, Stone), as tables so the
+    // tile loop has no unpredictable branches
+    struct TileRules {
+        uint64_t seed;
+        size_t worldWidth;
+        uint32_t tileVariants[3];
+        uint32_t firstLimit[3] = {0, 10, 20}, secondLimit[3] = {0, 20, 20};
+        ObjectType firstObject[3] = {ObjectType::None, ObjectType::Tree, ObjectType::Rock};
+        ObjectType secondObject[3] = {ObjectType::None, ObjectType::Bush, ObjectType::Rock};
+        uint32_t objectVariants[kObjectTypeCount] = {};
+
+        explicit TileRules(const MapGenerator::Settings& settings)
+            : seed(worldSeed(settings.seed)), worldWidth(static_cast<size_t>(std::max(settings.width, 0))),
+              tileVariants{settings.flowerVariants, settings.grassVariants, settings.stoneVariants} {
+            objectVariants[static_cast<int>(ObjectType::Tree)] = settings.treeVariants;
+            objectVariants[static_cast<int>(ObjectType::Bush)] = settings.bushVariants;
+            objectVariants[static_cast<int>(ObjectType::Rock)] = settings.rockVariants;
+        }
+    };
+
+    // world row y, columns [x0, x0 + count): `noise` holds the raw row on entry and the
+    // normalized values on return; returns the number of tiles left empty. Outputs are plain
+    // pointers, not members: byte stores may alias anything, which would force reloads per tile
+    uint32_t fillRow(const TileRules& rules, int y, int x0, int count, float* noise, Terrain* terrainOut,
+                     uint8_t* terrainVariantOut, ObjectType* objectOut, uint8_t* objectVariantOut) {
+        uint32_t empty = 0;
+        const size_t worldRow = static_cast<size_t>(y) * rules.worldWidth + x0;
+        for (int x = 0; x < count; ++x) {
+            const float value = (noise[x] + 1.0f) / 2.0f;
+            noise[x] = value;
+            const Terrain terrain = MapGenerator::terrainFor(value);
+            const int t = static_cast<int>(terrain);
+            const uint64_t bits = hashTile(rules.seed, worldRow + x);
+            const uint32_t roll = variant(bits >> 16, 100);
+            const ObjectType object = roll < rules.firstLimit[t] ? rules.firstObject[t]
+                                    : roll < rules.secondLimit[t] ? rules.secondObject[t] : ObjectType::None;
+            terrainOut[x] = terrain;
+            terrainVariantOut[x] = variant(bits, rules.tileVariants[t]);
+            objectOut[x] = object;
+            objectVariantOut[x] = variant(bits >> 32, rules.objectVariants[static_cast<int>(object)]);
+            empty += object == ObjectType::None;
+        }
+        return empty;
+    }
+
+    void allocate(MapLayout& map, int width, int height) {
+        map.width = std::max(width, 0);
+        map.height = std::max(height, 0);
+        const size_t tiles = static_cast<size_t>(map.width) * map.height;
+        map.noise.resize(tiles);
+        map.terrain.resize(tiles);
+        map.terrainVariant.resize(tiles);
+        map.objects.resize(tiles);
+        map.objectVariant.resize(tiles);
+    }
+
+    size_t buildingCount(const MapGenerator::Settings& settings) {
+        return static_cast<size_t>(std::max(settings.houseCount, 0) + std::max(settings.marketCount, 0));
+    }
+
+    // `picks` distinct ranks among `totalEmpty` free tiles as (rank, pick order), sorted by rank
+    std::vector<std::pair<size_t, size_t>> drawRanks(uint64_t seed, size_t picks, size_t totalEmpty) {
+        std::mt19937_64 rng(seed);
+        std::vector<std::pair<size_t, size_t>> ranks;
+        if (picks * 2 > totalEmpty) {
+            std::vector<size_t> all(totalEmpty);
+            for (size_t r = 0; r < totalEmpty; ++r) all[r] = r;
+            std::shuffle(all.begin(), all.end(), rng);
+            for (size_t p = 0; p < picks; ++p) ranks.emplace_back(all[p], p);
+        } else {
+            std::uniform_int_distribution<size_t> anyRank(0, totalEmpty ? totalEmpty - 1 : 0);
+            while (ranks.size() < picks) {
+                const size_t rank = anyRank(rng);
+                const bool taken = std::any_of(ranks.begin(), ranks.end(), [rank](const auto& r) { return r.first == rank; });
+                if (!taken) ranks.emplace_back(rank, ranks.size());
+            }
+        }
+        std::sort(ranks.begin(), ranks.end());
+        return ranks;
+    }
+
+    // Walks the per-row free counts to the tiles holding the ranks and returns their indices in
+    // pick order; rowObjects(y) gives row y's objects and is only asked for rows holding a pick
+    template <class RowObjects>
+    std::vector<uint32_t> walkRanks(const std::vector<std::pair<size_t, size_t>>& ranks,
+                                    const std::vector<uint32_t>& emptyTiles, int width, RowObjects rowObjects) {
+        std::vector<uint32_t> placed(ranks.size());
+        size_t row = 0, rowStart = 0, next = 0;
+        while (next < ranks.size()) {
+            while (ranks[next].first >= rowStart + emptyTiles[row]) rowStart += emptyTiles[row++];
+            const ObjectType* objects = rowObjects(static_cast<int>(row));
+            size_t rank = rowStart;
+            for (int x = 0; x < width && next < ranks.size(); ++x) {
+                if (objects[x] != ObjectType::None) continue;
+                if (rank == ranks[next].first) placed[ranks[next++].second] = static_cast<uint32_t>(row * width + x);
+                ++rank;
+            }
+            rowStart += emptyTiles[row++];
+        }
+        return placed;
+    }
+
+    // houses first, then markets; variants cycle per kind like the old i % 3
+    std::vector<MapGenerator::Building> buildingsAt(const MapGenerator::Settings& settings, const std::vector<uint32_t>& placed) {
+        std::vector<MapGenerator::Building> buildings;
+        buildings.reserve(placed.size());
+        const size_t houses = static_cast<size_t>(std::max(settings.houseCount, 0));
+        for (size_t p = 0; p < placed.size(); ++p) {
+            const bool isHouse = p < houses;
+            const uint8_t variants = std::max<uint8_t>(isHouse ? settings.houseVariants : settings.marketVariants, 1);
+            const size_t ofKind = isHouse ? p : p - houses;
+            buildings.push_back({placed[p], isHouse ? ObjectType::House : ObjectType::Market,
+                                 static_cast<uint8_t>(ofKind % variants)});
+        }
+        return buildings;
+    }
+}
+
+PerlinRows::PerlinRows(int noiseSeed, float noiseFrequency, int columns, int first)
+    : seed(noiseSeed), frequency(noiseFrequency), width(std::max(columns, 0)), firstColumn(first),
+      columnCell(width), columnOffset(width), columnBlend(width) {
+    for (int c = 0; c < width; ++c) {
+        const float y = static_cast<float>(firstColumn + c) * frequency;
+        columnCell[c] = fastFloor(y);
+        columnOffset[c] = y - static_cast<float>(columnCell[c]);
+        columnBlend[c] = quintic(columnOffset[c]);
+    }
+}
+
+void PerlinRows::row(int r, float* out) const {
+    const Gradients& g = gradients();
+    const float x = static_cast<float>(r) * frequency;
+    const int cellX = fastFloor(x);
+    const float xd0 = x - static_cast<float>(cellX);
+    const float xd1 = xd0 - 1;
+    const float xs = quintic(xd0);
+    const uint32_t x0 = static_cast<uint32_t>(cellX) * static_cast<uint32_t>(kPrimeX);
+    const uint32_t x1 = x0 + static_cast<uint32_t>(kPrimeX);
+
+    for (int begin = 0; begin < width;) {
+        // columns sharing a lattice cell share the four corner gradients
+        int end = begin + 1;
+        while (end < width && columnCell[end] == columnCell[begin]) ++end;
+        const uint32_t y0 = static_cast<uint32_t>(columnCell[begin]) * static_cast<uint32_t>(kPrimeY);
+        const uint32_t y1 = y0 + static_cast<uint32_t>(kPrimeY);
+        const int h00 = gradientIndex(seed, x0, y0), h10 = gradientIndex(seed, x1, y0);
+        const int h01 = gradientIndex(seed, x0, y1), h11 = gradientIndex(seed, x1, y1);
+        const float a00 = xd0 * g.x[h00], b00 = g.y[h00];
+        const float a10 = xd1 * g.x[h10], b10 = g.y[h10];
+        const float a01 = xd0 * g.x[h01], b01 = g.y[h01];
+        const float a11 = xd1 * g.x[h11], b11 = g.y[h11];
+
+        const float* yd = columnOffset.data();
+        const float* ys = columnBlend.data();
+        for (int c = begin; c < end; ++c) {
+            const float yd0 = yd[c], yd1 = yd0 - 1;
+            const float n00 = a00 + yd0 * b00, n10 = a10 + yd0 * b10;
+            const float n01 = a01 + yd1 * b01, n11 = a11 + yd1 * b11;
+            const float xf0 = n00 + xs * (n10 - n00);
+            const float xf1 = n01 + xs * (n11 - n01);
+            out[c] = (xf0 + ys[c] * (xf1 - xf0)) * kPerlinScale;
+        }
+        begin = end;
+    }
+}
+
+Terrain MapGenerator::terrainFor(float noiseValue) {
+    if (noiseValue < 0.1f) return Terrain::Flower;
+    if (noiseValue < 0.6f) return Terrain::Grass;
+    return Terrain::Stone;
+}
+
+MapLayout MapGenerator::generate(const Settings& settings) const {
+    return generate(settings, getJobSystem());
+}
+
+uint8_t MapGenerator::terrainVariantAt(const Settings& settings, Terrain terrain, int x, int y) {
+    const TileRules rules(settings);
+    return variant(hashTile(rules.seed, static_cast<size_t>(y) * rules.worldWidth + x),
+                   rules.tileVariants[static_cast<int>(terrain)]);
+}
+
+MapLayout MapGenerator::generateRegion(const Settings& settings, int x, int y, int width, int height) const {
+    const int x0 = std::max(x, 0), y0 = std::max(y, 0);
+    MapLayout region;
+    allocate(region, std::min(x + width, settings.width) - x0, std::min(y + height, settings.height) - y0);
+    if (region.noise.empty()) return region;
+
+    const PerlinRows perlin(settings.seed, settings.frequency, region.width, x0);
+    const TileRules rules(settings);
+    for (int row = 0; row < region.height; ++row) {
+        const size_t i = region.index(0, row);
+        perlin.row(y0 + row, region.noise.data() + i);
+        fillRow(rules, y0 + row, x0, region.width, region.noise.data() + i, region.terrain.data() + i,
+                region.terrainVariant.data() + i, region.objects.data() + i, region.objectVariant.data() + i);
+    }
+    return region;
+}
+
+MapLayout MapGenerator::generate(const Settings& settings, JobSystem& jobs) const {
+    MapLayout map;
+    allocate(map, settings.width, settings.height);
+    if (map.noise.empty()) return map;
+
+    const PerlinRows perlin(settings.seed, settings.frequency, map.width);
+    const TileRules rules(settings);
+    const uint64_t seed = rules.seed;
+
+    // terrain and resources, rows split across jobs; emptyTiles[y] counts row y's free tiles
+    std::vector<uint32_t> emptyTiles(map.height, 0);
+    jobs.parallelFor(0, static_cast<size_t>(map.height), kRowGrain, [&](size_t first, size_t last) {
+        for (int y = static_cast<int>(first); y < static_cast<int>(last); ++y) {
+            const size_t i = map.index(0, y);
+            perlin.row(y, map.noise.data() + i);
+            emptyTiles[y] = fillRow(rules, y, 0, map.width, map.noise.data() + i, map.terrain.data() + i,
+                                    map.terrainVariant.data() + i, map.objects.data() + i, map.objectVariant.data() + i);
+        }
+    });
+
+    // buildings go on distinct free tiles: draw ranks among the free tiles, then walk the
+    // per-row counts to the rows holding them (no rejection sampling over the map)
+    size_t totalEmpty = 0;
+    for (uint32_t count : emptyTiles) totalEmpty += count;
+    const auto ranks = drawRanks(seed, std::min(buildingCount(settings), totalEmpty), totalEmpty);
+    const auto placed = walkRanks(ranks, emptyTiles, map.width, [&map](int y) { return map.objects.data() + map.index(0, y); });
+
+    for (const Building& building : buildingsAt(settings, placed)) {
+        map.objects[building.tile] = building.type;
+        map.objectVariant[building.tile] = building.variant;
+        (building.type == ObjectType::House ? map.houses : map.markets).push_back(building.tile);
+    }
+    return map;
+}
+
+std::vector<MapGenerator::Building> MapGenerator::placeBuildings(const Settings& settings, JobSystem& jobs) const {
+    const int width = std::max(settings.width, 0);
+    const int height = std::max(settings.height, 0);
+    if (width == 0 || height == 0) return {};
+
+    const PerlinRows perlin(settings.seed, settings.frequency, width);
+    const TileRules rules(settings);
+    auto fill = [&](int y, MapLayout& row) {
+        perlin.row(y, row.noise.data());
+        return fillRow(rules, y, 0, width, row.noise.data(), row.terrain.data(), row.terrainVariant.data(),
+                       row.objects.data(), row.objectVariant.data());
+    };
+
+    // the same counts generate() takes, from one scratch row per job instead of the whole map
+    std::vector<uint32_t> emptyTiles(height, 0);
+    jobs.parallelFor(0, static_cast<size_t>(height), kRowGrain, [&](size_t first, size_t last) {
+        MapLayout row;
+        allocate(row, width, 1);
+        for (int y = static_cast<int>(first); y < static_cast<int>(last); ++y) emptyTiles[y] = fill(y, row);
+    });
+
+    size_t totalEmpty = 0;
+    for (uint32_t count : emptyTiles) totalEmpty += count;
+    const auto ranks = drawRanks(rules.seed, std::min(buildingCount(settings), totalEmpty), totalEmpty);
+    MapLayout row;
+    allocate(row, width, 1);
+    const auto placed = walkRanks(ranks, emptyTiles, width, [&](int y) {
+        fill(y, row);
+        return row.objects.data();
+    });
+    return buildingsAt(settings, placed);
+}
@@ -1,6 +1,7 @@
 #include "Market.hpp"
 #include "NPCEntity.hpp"
 #include "MoneyManager.hpp"
+#include "SimulationSnapshot.hpp"
 
 #include <algorithm>
 #include <cmath>
@@ -195,6 +196,190 @@ bool Market::sellItem(Entity& entity, const std::string& item, int quantity) {
     return true;
 }
 
+namespace {
+    constexpr float kTicksPerUnit = 100.0f; // order book prices are in cents
+
+    int32_t toTicks(float price) {
+        return static_cast<int32_t>(std::lround(price * kTicksPerUnit));
+    }
+}
+
+bool Market::postBid(NPCEntity& npc, uint32_t trader, const std::string& item, int quantity, float limitPrice) {
+    if (item.empty() || quantity <= 0) return false;
+    if (prices.find(item) == prices.end()) setPrice(item, 1 + std::rand() % 50);
+
+    const int32_t limit = toTicks(limitPrice > 0.0f ? limitPrice : calculateBuyPrice(item));
+    const float escrow = limit * quantity / kTicksPerUnit;
+    if (limit <= 0 || npc.getMoney() < escrow) {
+        getDebugConsole().log("MARKET", npc.getName() + " cannot cover a bid for " + std::to_string(quantity) + " " + item);
+        return false;
+    }
+    if (npc.getInventorySize() + quantity > npc.getMaxInventorySize()) {
+        getDebugConsole().log("MARKET", npc.getName() + " has no room for " + std::to_string(quantity) + " " + item);
+        return false;
+    }
+
+    orderBooks[item].post(OrderBook::Side::Bid, trader, limit, quantity);
+    npc.setMoney(npc.getMoney() - escrow);
+    getDebugConsole().log("MARKET", "[BID] " + npc.getName() + " bids for " + std::to_string(quantity) + " " + item +
+                        " at $" + std::to_string(limit / kTicksPerUnit));
+    return true;
+}
+
+bool Market::postAsk(NPCEntity& npc, uint32_t trader, const std::string& item, int quantity, float limitPrice) {
+    if (item.empty() || quantity <= 0) return false;
+    if (prices.find(item) == prices.end()) setPrice(item, 1 + std::rand() % 50);
+
+    const int32_t limit = toTicks(limitPrice > 0.0f ? limitPrice : calculateSellPrice(item));
+    if (limit <= 0 || npc.getInventoryItemCount(item) < quantity || !npc.removeFromInventory(item, quantity)) {
+        getDebugConsole().log("MARKET", npc.getName() + " cannot offer " + std::to_string(quantity) + " " + item);
+        return false;
+    }
+
+    orderBooks[item].post(OrderBook::Side::Ask, trader, limit, quantity);
+    getDebugConsole().log("MARKET", "[ASK] " + npc.getName() + " offers " + std::to_string(quantity) + " " + item +
+                        " at $" + std::to_string(limit / kTicksPerUnit));
+    return true;
+}
+
+void Market::cancelOrders(uint32_t trader, NPCEntity* npc) {
+    for (auto& [item, book] : orderBooks) {
+        settlements.clear();
+        book.cancel(trader, settlements);
+        if (!npc) continue;
+        for (const OrderBook::Settlement& released : settlements) {
+            if (released.side == OrderBook::Side::Bid) {
+                npc->setMoney(npc->getMoney() + released.released * released.limit / kTicksPerUnit);
+            } else if (!npc->addToInventory(item, released.released)) {
+                supply[item] += released.released; // no room: the market keeps them
+            }
+        }
+    }
+    settlements.clear();
+}
+
+int Market::runAuctions(const TraderTable& traders) {
+    int traded = 0;
+    size_t auctions = 0, settled = 0;
+    for (auto& [item, book] : orderBooks) {
+        if (book.empty()) continue;
+
+        // the market's own quotes take part in this auction only
+        book.post(OrderBook::Side::Ask, marketMakerId, toTicks(calculateBuyPrice(item)), std::min(supply[item], makerDepth));
+        book.post(OrderBook::Side::Bid, marketMakerId, toTicks(calculateSellPrice(item)), makerDepth);
+        settlements.clear();
+        const OrderBook::AuctionResult result = book.auction(toTicks(prices[item]), settlements);
+        book.cancel(marketMakerId, settlements);
+        settled += settle(item, result.price, traders);
+        ++auctions;
+
+        if (result.volume > 0) {
+            const float clearingPrice = result.price / kTicksPerUnit;
+            prices[item] = std::clamp(prices[item] + (clearingPrice - prices[item]) * priceAdjustmentFactor,
+                                      minimumPrice, maximumPrice);
+            auctionVolume[item] += result.volume;
+            trackPriceHistory(item);
+            traded += result.volume;
+        }
+    }
+    if (auctions > 0) {
+        getDebugConsole().log("MARKET", "[AUCTION] " + std::to_string(auctions) + " books, " + std::to_string(traded) +
+                            " units traded, " + std::to_string(settled) + " traders settled");
+    }
+    return traded;
+}
+
+// Apply one auction: the item's counters are looked up once, and each trader's settlements
+// (buyers get their units and the unused escrow, sellers the proceeds, released orders their
+// escrow) are summed into a flat slot and applied to the NPC in one quiet call. The market's
+// own fills move its stock.
+size_t Market::settle(const std::string& item, int32_t price, const TraderTable& traders) {
+    const float unitPrice = price / kTicksPerUnit;
+    int& stock = supply[item];
+    int& wanted = demand[item];
+    int& bought = totalBuyTransactions[item];
+    int& sold = totalSellTransactions[item];
+    float& spent = totalExpenditure[item];
+    float& earned = totalRevenue[item];
+    int moneySpent = 0, moneyEarned = 0;
+
+    traderSlots.clear();
+    traderSettlements.clear();
+    for (const OrderBook::Settlement& settlement : settlements) {
+        if (settlement.trader == marketMakerId) {
+            if (settlement.side == OrderBook::Side::Bid) {
+                stock += settlement.filled;
+                wanted = std::max(0, wanted - settlement.filled);
+            } else {
+                stock = std::max(0, stock - settlement.filled);
+                wanted += settlement.filled;
+            }
+            continue;
+        }
+        // each trader is looked up once per auction
+        const auto [slot, added] = traderSlots.try_emplace(settlement.trader, static_cast<uint32_t>(traderSettlements.size()));
+        if (added) {
+            const auto found = traders.find(settlement.trader);
+            NPCEntity* npc = found != traders.end() ? found->second : nullptr;
+            traderSettlements.push_back({npc, npc ? npc->getMaxInventorySize() - npc->getInventorySize() : 0});
+        }
+        TraderSettlement& trader = traderSettlements[slot->second];
+        if (!trader.npc) continue; // the trader is gone; its escrow stays with the market
+
+        if (settlement.side == OrderBook::Side::Bid) {
+            float refund = (settlement.released * settlement.limit + settlement.filled * (settlement.limit - price)) / kTicksPerUnit;
+            if (settlement.filled > 0) {
+                const float cost = unitPrice * settlement.filled;
+                if (settlement.filled <= trader.room) {
+                    trader.room -= settlement.filled;
+                    trader.units += settlement.filled;
+                    trader.reward += 5 * settlement.filled;
+                    moneySpent += static_cast<int>(cost);
+                    bought += settlement.filled;
+                    spent += cost;
+                } else {
+                    refund += cost; // no room any more: the market takes the units back
+                    stock += settlement.filled;
+                }
+            }
+            if (refund > 0.0f) trader.money += refund;
+        } else {
+            if (settlement.released > 0) {
+                if (settlement.released <= trader.room) {
+                    trader.room -= settlement.released;
+                    trader.units += settlement.released;
+                } else {
+                    stock += settlement.released;
+                }
+            }
+            if (settlement.filled > 0) {
+                const float revenue = unitPrice * settlement.filled;
+                trader.money += revenue;
+                trader.reward += 10 * settlement.filled;
+                moneyEarned += static_cast<int>(revenue);
+                sold += settlement.filled;
+                earned += revenue;
+            }
+        }
+    }
+
+    size_t settled = 0;
+    for (const TraderSettlement& trader : traderSettlements) {
+        if (!trader.npc) continue;
+        trader.npc->settleTrade(item, trader.units, trader.money, trader.reward);
+        ++settled;
+    }
+    if (moneySpent > 0) MoneyManager::recordMoneySpent(moneySpent);
+    if (moneyEarned > 0) MoneyManager::recordMoneyEarned(moneyEarned);
+    return settled;
+}
+
+size_t Market::getOpenOrderCount() const {
+    size_t count = 0;
+    for (const auto& [item, book] : orderBooks) count += book.getBidCount() + book.getAskCount();
+    return count;
+}
+
 // Adjust price after a buy
 float Market::adjustPriceOnBuy(float currentPrice, int demand, int supply, float buyFactor) {
     if (supply == 0) supply = 1;
@@ -261,16 +446,16 @@ std::string Market::suggestBestResourceToSell() const {
 
 
 
-// Simulate market dynamics
-void Market::simulateMarketDynamics(float deltaTime) {
-    static float timeAccumulator = 0.0f;
-    timeAccumulator += deltaTime;
-
-    // Only update prices every 10-15 seconds
-    if (timeAccumulator < 2.0f) return;  
-    timeAccumulator = 0.0f;  // Reset timer
-
+// Simulate market dynamics (Game runs this every dynamicsInterval seconds off the simulation timers)
+void Market::simulateMarketDynamics() {
     for (auto& [item, price] : prices) {
+        // items that traded through the order book take their price from the fills instead
+        auto traded = auctionVolume.find(item);
+        if (traded != auctionVolume.end() && traded->second > 0) {
+            traded->second = 0;
+            continue;
+        }
+
         int oldDemand = demand[item];
         int oldSupply = supply[item];
 
@@ -443,3 +628,82 @@ const std::unordered_map<std::string, float>& Market::getPrices() const {
 const std::unordered_map<std::string, std::vector<float>>& Market::getPriceTrendMap() const {
     return priceHistory;
 }
+
+void Market::saveSnapshot(MarketSnapshot& out) const {
+    auto value = [](const auto& map, const std::string& item) {
+        auto it = map.find(item);
+        return it != map.end() ? it->second : typename std::decay_t<decltype(map)>::mapped_type{};
+    };
+    out.buyMargin = buyMargin;
+    out.sellMargin = sellMargin;
+    out.items.clear();
+    for (const auto& [item, price] : prices) {
+        MarketItemSnapshot snapshot;
+        snapshot.item = item;
+        snapshot.price = price;
+        snapshot.demand = value(demand, item);
+        snapshot.supply = value(supply, item);
+        snapshot.buyTransactions = value(totalBuyTransactions, item);
+        snapshot.sellTransactions = value(totalSellTransactions, item);
+        snapshot.revenue = value(totalRevenue, item);
+        snapshot.expenditure = value(totalExpenditure, item);
+        snapshot.history = value(priceHistory, item);
+        out.items.push_back(std::move(snapshot));
+    }
+    std::sort(out.items.begin(), out.items.end(), [](const auto& a, const auto& b) { return a.item < b.item; });
+}
+
+// what the books hold goes back to the traders, as if every order were cancelled at capture
+void Market::returnEscrow(MarketSnapshot& out, const std::unordered_map<uint32_t, NpcSnapshot*>& owners) const {
+    std::vector<OrderBook::Settlement> open;
+    for (const auto& [item, book] : orderBooks) {
+        open.clear();
+        book.collectOpen(open);
+        const std::string& name = item; // structured bindings can't be captured before C++20
+        auto stock = std::find_if(out.items.begin(), out.items.end(), [&name](const MarketItemSnapshot& saved) { return saved.item == name; });
+        for (const OrderBook::Settlement& order : open) {
+            const auto owner = owners.find(order.trader);
+            if (owner == owners.end()) continue; // the market's own quotes, or a trader that is gone
+            NpcSnapshot& npc = *owner->second;
+            if (order.side == OrderBook::Side::Bid) {
+                npc.money += order.released * order.limit / kTicksPerUnit;
+                continue;
+            }
+            int32_t carried = 0;
+            for (const auto& [held, count] : npc.inventory) carried += count;
+            if (carried + order.released <= npc.inventoryCapacity) {
+                auto slot = std::lower_bound(npc.inventory.begin(), npc.inventory.end(), item,
+                                             [](const auto& entry, const std::string& key) { return entry.first < key; });
+                if (slot == npc.inventory.end() || slot->first != item) slot = npc.inventory.insert(slot, {item, 0});
+                slot->second += order.released;
+            } else if (stock != out.items.end()) {
+                stock->supply += order.released; // no room: the market keeps them
+            }
+        }
+    }
+}
+
+void Market::restoreSnapshot(const MarketSnapshot& in) {
+    buyMargin = in.buyMargin;
+    sellMargin = in.sellMargin;
+    prices.clear();
+    demand.clear();
+    supply.clear();
+    priceHistory.clear();
+    totalBuyTransactions.clear();
+    totalSellTransactions.clear();
+    totalRevenue.clear();
+    totalExpenditure.clear();
+    for (const auto& item : in.items) {
+        prices[item.item] = item.price;
+        demand[item.item] = item.demand;
+        supply[item.item] = item.supply;
+        totalBuyTransactions[item.item] = item.buyTransactions;
+        totalSellTransactions[item.item] = item.sellTransactions;
+        totalRevenue[item.item] = item.revenue;
+        totalExpenditure[item.item] = item.expenditure;
+        if (!item.history.empty()) priceHistory[item.item] = item.history;
+    }
+    for (auto& [item, book] : orderBooks) book.clear(); // the snapshot gave their escrow back
+    auctionVolume.clear();
+}
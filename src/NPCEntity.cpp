@@ -3,18 +3,28 @@
 #include "Market.hpp" 
 #include "Actions.hpp"
 #include "DataCollector.hpp"
+#include "SimulationConfig.hpp"
+#include "SimulationSnapshot.hpp"
 
 #include <algorithm>
 #include <numeric>
 #include <cmath>
 #include <random>
+#include <atomic>
+
+namespace {
+    std::atomic<uint32_t> nextNpcHandle{1}; // 0 is never a handle
+}
+
 // Constructor
 NPCEntity::NPCEntity(const std::string& npcName, float initHealth, float initHunger, float initEnergy,
                      float initSpeed, float initStrength, float initMoney, bool enableQLearning)
     : Entity(initHealth, initHunger, initEnergy, initSpeed, initStrength, initMoney),
       agent(0.1f, 0.9f, 0.3f),  // FIXED: Increased epsilon for more exploration
       useQLearning(enableQLearning),
-      name(npcName) {
+      name(npcName),
+      recorderId(getDataCollector().registerNpc(npcName)),
+      handle(nextNpcHandle.fetch_add(1, std::memory_order_relaxed)) {
     
     // FIXED: Ensure NPCs start in a valid state
     currentState = NPCState::Idle;
@@ -37,6 +47,8 @@ NPCEntity::NPCEntity(NPCEntity&& other) noexcept
       inventory(std::move(other.inventory)),
       inventoryCapacity(other.inventoryCapacity),
       name(std::move(other.name)),
+      recorderId(other.recorderId),
+      handle(other.handle),
       baseSpeed(other.baseSpeed),
       currentSpeed(other.currentSpeed),
       deathPenalty(other.deathPenalty),
@@ -45,7 +57,15 @@ NPCEntity::NPCEntity(NPCEntity&& other) noexcept
       currentActionCooldown(other.currentActionCooldown),
       house(other.house),
       lastAction(other.lastAction),
-      currentQLearningState(std::move(other.currentQLearningState)) {}
+      currentQLearningState(std::move(other.currentQLearningState)),
+      useTensorFlow(other.useTensorFlow),
+      tfModel(std::move(other.tfModel)),
+      totalItemsGathered(other.totalItemsGathered),
+      itemsGatheredByType(std::move(other.itemsGatheredByType)),
+      pendingAction(other.pendingAction),
+      avoidance(other.avoidance),
+      wakeTimer(other.wakeTimer),
+      sleepStart(other.sleepStart) {}
 
 // Move Assignment Operator
 NPCEntity& NPCEntity::operator=(NPCEntity&& other) noexcept {
@@ -59,6 +79,8 @@ NPCEntity& NPCEntity::operator=(NPCEntity&& other) noexcept {
         inventory = std::move(other.inventory);
         inventoryCapacity = other.inventoryCapacity;
         name = std::move(other.name);
+        recorderId = other.recorderId;
+        handle = other.handle;
         baseSpeed = other.baseSpeed;
         currentSpeed = other.currentSpeed;
         deathPenalty = other.deathPenalty;
@@ -68,6 +90,14 @@ NPCEntity& NPCEntity::operator=(NPCEntity&& other) noexcept {
         house = other.house;
         lastAction = other.lastAction;
         currentQLearningState = std::move(other.currentQLearningState);
+        useTensorFlow = other.useTensorFlow;
+        tfModel = std::move(other.tfModel); // keep the shared policy when NPCs shift in the vector
+        totalItemsGathered = other.totalItemsGathered;
+        itemsGatheredByType = std::move(other.itemsGatheredByType);
+        pendingAction = other.pendingAction;
+        avoidance = other.avoidance;
+        wakeTimer = other.wakeTimer;
+        sleepStart = other.sleepStart;
     }
     return *this;
 }
@@ -99,6 +129,12 @@ bool NPCEntity::addToInventory(const std::string& item, int quantity) {
     return true;
 }
 
+void NPCEntity::settleTrade(const std::string& item, int units, float money, int reward) {
+    if (units > 0) inventory[item] += units;
+    if (money != 0.0f) setMoney(getMoney() + money);
+    currentReward += reward;
+}
+
 bool NPCEntity::removeFromInventory(const std::string& item, int quantity) {
     if (item.empty()) {
         getDebugConsole().log("ERROR", name + " removeFromInventory() received an EMPTY item name.");
@@ -253,13 +289,15 @@ void NPCEntity::performAction(ActionType action, Tile& tile,
                         float itemPrice = marketObj->calculateBuyPrice(item);
                         if (getMoney() >= itemPrice && getInventorySize() < getMaxInventorySize()) {
                             int quantityToBuy = 1; // FIXED: Buy one at a time
-                            
-                            if (marketObj->buyItem(*this, item, quantityToBuy)) {
+                            // with the order book the bid rests until an auction fills it
+                            const bool orderBook = getSimulationConfig().orderBookTrading;
+                            if (orderBook ? marketObj->postBid(*this, handle, item, quantityToBuy, itemPrice)
+                                          : marketObj->buyItem(*this, item, quantityToBuy)) {
                                 actionReward = 8.0f;
                                 boughtSomething = true;
                                 consumeEnergy(1.0f);
                                 currentActionCooldown = 1.5f;
-                                getDebugConsole().log("MARKET", getName() + " bought " + 
+                                getDebugConsole().log("MARKET", getName() + (orderBook ? " bid for " : " bought ") + 
                                                     std::to_string(quantityToBuy) + " " + item + 
                                                     " for $" + std::to_string(itemPrice));
                                 break;
@@ -307,14 +345,15 @@ void NPCEntity::performAction(ActionType action, Tile& tile,
                         // Validate we still have the item before selling
                         if (getInventoryItemCount(selectedItem) >= sellQuantity) {
                             float expectedRevenue = marketObj->calculateSellPrice(selectedItem) * sellQuantity;
-                            
-                            if (marketObj->sellItem(*this, selectedItem, sellQuantity)) {
+                            const bool orderBook = getSimulationConfig().orderBookTrading;
+                            if (orderBook ? marketObj->postAsk(*this, handle, selectedItem, sellQuantity)
+                                          : marketObj->sellItem(*this, selectedItem, sellQuantity)) {
                                 actionReward = 12.0f;
                                 soldSomething = true;
                                 restoreHealth(1.0f);
                                 consumeEnergy(1.0f);
                                 currentActionCooldown = 1.5f;
-                                getDebugConsole().log("MARKET", getName() + " sold " + 
+                                getDebugConsole().log("MARKET", getName() + (orderBook ? " offered " : " sold ") + 
                                                     std::to_string(sellQuantity) + " " + selectedItem + 
                                                     " for $" + std::to_string(expectedRevenue));
                             }
@@ -448,15 +487,15 @@ bool NPCEntity::isAtTarget() const {
     return position == target->getPosition();
 }
 
-void NPCEntity::reduceHealth(float amount) {
+void NPCEntity::reduceHealth(float amount, bool logChange) {
     if (health > 5.0f) {  // Prevent instant deaths
         health -= amount;
         if (health <= 0.0f) {
             health = 0.0f;
             handleDeath();
         }
-        getDebugConsole().log("HEALTH", getName() + " lost " + std::to_string(amount) + " health. Current: " + std::to_string(health));
-    } else {
+        if (logChange) getDebugConsole().log("HEALTH", getName() + " lost " + std::to_string(amount) + " health. Current: " + std::to_string(health));
+    } else if (logChange) {
         getDebugConsole().log("HEALTH", getName() + " is too weak to take further damage.");
     }
 }
@@ -480,30 +519,38 @@ void NPCEntity::receiveFeedback(float reward, const std::vector<std::vector<std:
         State previousState = currentQLearningState;  
         State nextState = agent.extractState(tileMap, getPosition(), getEnergy(), getInventorySize(), getMaxInventorySize());
 
-        // DEBUG: Log the feedback call
+#ifdef EXPERIENCE_TRACE
         getDebugConsole().log("Feedback", getName() + " receiving feedback: " +
                             "Action=" + std::to_string(static_cast<int>(lastAction)) +
                             ", Reward=" + std::to_string(reward) +
                             ", Collecting=" + (getDataCollector().isCollectingData() ? "YES" : "NO"));
+#endif
+
+        bool isTerminal = (health <= 0.0f) || (energy <= 0.0f) || (getInventorySize() >= getMaxInventorySize());
+
+        // pack once; the collector, trainer and Q-table all take the 64-bit key
+        const PackedState previousKey = PackedState::pack(previousState);
+        const PackedState nextKey = PackedState::pack(nextState);
 
         // Always collect data when data collection is active
         if (getDataCollector().isCollectingData()) {
-            bool isTerminal = (health <= 0.0f) || (energy <= 0.0f) || (getInventorySize() >= getMaxInventorySize());
-            
             getDataCollector().recordExperience(
-                previousState,
+                previousKey,
                 lastAction,
                 reward,
-                nextState,
+                nextKey,
                 isTerminal,
-                getName()
+                recorderId
             );
-        } else {
-            getDebugConsole().log("DataCollection", getName() + " - Data collection not active, skipping experience");
+        }
+
+        // Feed the in-process DQN trainer (no-op unless one is attached to the shared model)
+        if (useTensorFlow && tfModel) {
+            tfModel->recordTransition(previousKey, lastAction, reward, nextKey, isTerminal);
         }
 
         // Continue with Q-learning update
-        agent.updateQValue(previousState, lastAction, reward, nextState);
+        agent.updateQValue(previousKey, lastAction, reward, nextKey);
         currentQLearningState = nextState;
     } else {
         getDebugConsole().log("Feedback", getName() + " - Q-learning disabled, no feedback recorded");
@@ -528,7 +575,8 @@ void NPCEntity::setStrength(float newStrength) { strength = newStrength; }
 void NPCEntity::setSpeed(float newSpeed) { speed = newSpeed; }
 
 void NPCEntity::update(float deltaTime) {
-    if (currentActionCooldown > 0) {
+    // a scheduled wake-up ends the cooldown instead (see sleepUntil)
+    if (currentActionCooldown > 0 && !wakeTimer) {
         currentActionCooldown -= deltaTime;
         currentActionCooldown = std::max(0.0f, currentActionCooldown);
     }
@@ -560,7 +608,7 @@ Tile* NPCEntity::findNearestTile(const std::vector<std::vector<std::unique_ptr<T
     // Collect all valid tiles
     for (int y = 0; y < tileMap.size(); ++y) {
         for (int x = 0; x < tileMap[y].size(); ++x) {
-            if (tileMap[y][x]->hasObject() && tileMap[y][x]->getObject()->getType() == type) {
+            if (tileMap[y][x] && tileMap[y][x]->hasObject() && tileMap[y][x]->getObject()->getType() == type) {
                 float distance = std::hypot(tileMap[y][x]->getPosition().x - getPosition().x,
                                             tileMap[y][x]->getPosition().y - getPosition().y);
                 
@@ -609,6 +657,11 @@ void NPCEntity::setTensorFlowModel(std::shared_ptr<TensorFlowWrapper> model) {
     }
 }
 
+void NPCEntity::setPendingDecision(const State& state, ActionType action) {
+    currentQLearningState = state;
+    pendingAction = action;
+}
+
 // AI Decision Making
 ActionType NPCEntity::decideNextAction(const std::vector<std::vector<std::unique_ptr<Tile>>>& tileMap, 
                                     const House& house, Market& market) {
@@ -618,7 +671,12 @@ ActionType NPCEntity::decideNextAction(const std::vector<std::vector<std::unique
     static std::unordered_map<std::string, int> stuckCounter;
     static std::unordered_map<std::string, ActionType> lastActionMap;
     
-    if (useTensorFlow && tfModel && tfModel->isModelLoaded()) {
+    if (pendingAction != ActionType::None) {
+        // state was already extracted by the batched policy pass this tick
+        action = pendingAction;
+        pendingAction = ActionType::None;
+    }
+    else if (useTensorFlow && tfModel && tfModel->isModelLoaded()) {
         currentQLearningState = extractState(tileMap);
         action = tfModel->predictAction(currentQLearningState);
         getDebugConsole().log("TensorFlow", getName() + " used TF model to choose action: " + 
@@ -726,58 +784,92 @@ House* NPCEntity::getHouse() {
 }
 
 // Extract State for Q-Learning
+// Same features as the agent sees when learning (QLearningAgent::extractState)
 State NPCEntity::extractState(const std::vector<std::vector<std::unique_ptr<Tile>>>& tileMap) const {
-    State state;
-    state.posX = static_cast<int>(getPosition().x / GameConfig::tileSize);
-    state.posY = static_cast<int>(getPosition().y / GameConfig::tileSize);
-    state.nearbyTrees = countNearbyObjects(tileMap, ObjectType::Tree);
-    state.nearbyRocks = countNearbyObjects(tileMap, ObjectType::Rock);
-    state.nearbyBushes = countNearbyObjects(tileMap, ObjectType::Bush);
-    state.energyLevel = agent.quantize(getEnergy(), 0, 100, 3);
-    state.inventoryLevel = agent.quantize(getInventorySize(), 0, getMaxInventorySize(), 3);
-    return state;
+    return agent.extractState(tileMap, getPosition(), getEnergy(), getInventorySize(), getMaxInventorySize());
 }
 
-// Scan Nearby Tiles
-std::vector<ObjectType> NPCEntity::scanNearbyTiles(const std::vector<std::vector<std::unique_ptr<Tile>>>& tileMap) const {
-    std::vector<ObjectType> nearbyObjects;
-
+// Scan Nearby Tiles (object counts per type in the 3x3 neighbourhood)
+NeighborhoodCounts NPCEntity::scanNearbyTiles(const std::vector<std::vector<std::unique_ptr<Tile>>>& tileMap) const {
     int npcX = static_cast<int>(getPosition().x / GameConfig::tileSize);
     int npcY = static_cast<int>(getPosition().y / GameConfig::tileSize);
-
-    for (int y = npcY - 1; y <= npcY + 1; ++y) {
-        for (int x = npcX - 1; x <= npcX + 1; ++x) {
-            if (y >= 0 && y < tileMap.size() && x >= 0 && x < tileMap[0].size()) {
-                if (tileMap[y][x]->hasObject()) {
-                    nearbyObjects.push_back(tileMap[y][x]->getObject()->getType());
-                }
-            }
-        }
-    }
-
-    return nearbyObjects;
+    return ObjectLayers::neighborhood(tileMap, npcX, npcY);
 }
 
 // Count Nearby Objects
 int NPCEntity::countNearbyObjects(const std::vector<std::vector<std::unique_ptr<Tile>>>& tileMap, ObjectType type) const {
-    int count = 0;
-
-    int npcX = static_cast<int>(getPosition().x / GameConfig::tileSize);
-    int npcY = static_cast<int>(getPosition().y / GameConfig::tileSize);
-
-    for (int y = npcY - 1; y <= npcY + 1; ++y) {
-        for (int x = npcX - 1; x <= npcX + 1; ++x) {
-            if (y >= 0 && y < tileMap.size() && x >= 0 && x < tileMap[0].size()) {
-                if (tileMap[y][x]->hasObject() && tileMap[y][x]->getObject()->getType() == type) {
-                    count++;
-                }
-            }
-        }
-    }
-
-    return count;
+    return scanNearbyTiles(tileMap)[type];
 }
 
 void NPCEntity::enableQLearning(bool enable) {
     useQLearning = enable;
-}
\ No newline at end of file
+}
+namespace {
+    SnapshotCounts sortedCounts(const std::unordered_map<std::string, int>& counts) {
+        SnapshotCounts sorted(counts.begin(), counts.end());
+        std::sort(sorted.begin(), sorted.end());
+        return sorted;
+    }
+}
+
+void NPCEntity::saveSnapshot(NpcSnapshot& out) const {
+    out.name = name;
+    out.health = health;
+    out.hunger = hunger;
+    out.energy = energy;
+    out.speed = speed;
+    out.strength = strength;
+    out.money = money;
+    out.dead = dead;
+    out.x = position.x;
+    out.y = position.y;
+    out.state = static_cast<uint8_t>(currentState);
+    out.currentAction = static_cast<uint8_t>(currentAction);
+    out.lastAction = static_cast<uint8_t>(lastAction);
+    out.targetX = target ? target->getGridX() : -1;
+    out.targetY = target ? target->getGridY() : -1;
+    out.inventoryCapacity = inventoryCapacity;
+    out.baseSpeed = baseSpeed;
+    out.currentSpeed = currentSpeed;
+    out.currentReward = currentReward;
+    out.currentPenalty = currentPenalty;
+    out.actionCooldown = currentActionCooldown;
+    out.wakeTimer = wakeTimer;
+    out.totalItemsGathered = totalItemsGathered;
+    out.inventory = sortedCounts(inventory);
+    out.itemsGatheredByType = sortedCounts(itemsGatheredByType);
+    out.useQLearning = useQLearning;
+    out.useTensorFlow = useTensorFlow;
+    agent.saveSnapshot(out.agent);
+}
+
+void NPCEntity::restoreSnapshot(const NpcSnapshot& in) {
+    health = in.health;
+    hunger = in.hunger;
+    energy = in.energy;
+    speed = in.speed;
+    strength = in.strength;
+    money = in.money;
+    dead = in.dead;
+    setPosition(in.x, in.y);
+    currentState = static_cast<NPCState>(std::min<uint8_t>(in.state, static_cast<uint8_t>(NPCState::EvaluatingState)));
+    currentAction = static_cast<ActionType>(in.currentAction);
+    lastAction = static_cast<ActionType>(in.lastAction);
+    target = nullptr;
+    inventoryCapacity = in.inventoryCapacity;
+    baseSpeed = in.baseSpeed;
+    currentSpeed = in.currentSpeed;
+    currentReward = in.currentReward;
+    currentPenalty = in.currentPenalty;
+    currentActionCooldown = in.actionCooldown;
+    wakeTimer = 0;
+    totalItemsGathered = in.totalItemsGathered;
+    inventory = std::unordered_map<std::string, int>(in.inventory.begin(), in.inventory.end());
+    itemsGatheredByType = std::unordered_map<std::string, int>(in.itemsGatheredByType.begin(), in.itemsGatheredByType.end());
+    useQLearning = in.useQLearning;
+    useTensorFlow = false; // Game re-enables it once the policy model is attached
+    pendingAction = ActionType::None;
+    if (!agent.restoreSnapshot(in.agent)) {
+        getDebugConsole().log("Snapshot", name + ": Q-table shape does not match, starting it empty", LogLevel::Warning);
+    }
+}
@@ -0,0 +1,325 @@
+#include "NumpyIO.hpp"
+#include "debug.hpp"
+
+#include <array>
+#include <cstring>
+#include <sstream>
+
+namespace {
+    constexpr char kNpyMagic[] = "\x93NUMPY";
+    constexpr size_t kNpyMagicSize = 6;
+    constexpr size_t kNpyAlignment = 64;
+
+    constexpr uint32_t kLocalHeaderSignature = 0x04034b50;
+    constexpr uint32_t kCentralHeaderSignature = 0x02014b50;
+    constexpr uint32_t kEndOfDirectorySignature = 0x06054b50;
+    constexpr uint16_t kZipVersion = 20;
+    constexpr uint16_t kDosDate1980 = (0 << 9) | (1 << 5) | 1; // 1980-01-01
+
+    std::array<uint32_t, 256> makeCrcTable() {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        return table;
+    }
+
+    template <typename T>
+    void put(std::string& out, T value) {
+        for (size_t i = 0; i < sizeof(T); ++i) out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+
+    template <typename T>
+    T get(const unsigned char* p) {
+        T value = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) value |= static_cast<T>(p[i]) << (8 * i);
+        return value;
+    }
+
+    template <typename T>
+    bool appendArray(const std::string& blob, const char* expectedDescr, size_t columns, std::vector<T>& out) {
+        std::string descr;
+        std::vector<size_t> shape;
+        const size_t offset = NumpyIO::parseNpyHeader(blob.data(), blob.size(), descr, shape);
+        if (offset == 0 || descr != expectedDescr || shape.empty()) return false;
+        if ((columns == 1 && shape.size() != 1) || (columns > 1 && (shape.size() != 2 || shape[1] != columns))) {
+            return false;
+        }
+
+        const size_t count = shape[0] * columns;
+        if (blob.size() - offset < count * sizeof(T)) return false;
+        const size_t start = out.size();
+        out.resize(start + count);
+        std::memcpy(out.data() + start, blob.data() + offset, count * sizeof(T));
+        return true;
+    }
+}
+
+// Parse a v1/v2 .npy header; returns the data offset or 0 on failure
+size_t NumpyIO::parseNpyHeader(const char* data, size_t size, std::string& descr, std::vector<size_t>& shape) {
+    if (size < 10 || std::memcmp(data, kNpyMagic, kNpyMagicSize) != 0) return 0;
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+    const int major = bytes[6];
+    size_t headerLength = 0, prefix = 0;
+    if (major == 1) {
+        headerLength = get<uint16_t>(bytes + 8);
+        prefix = 10;
+    } else if (major == 2 && size >= 12) {
+        headerLength = get<uint32_t>(bytes + 8);
+        prefix = 12;
+    } else {
+        return 0;
+    }
+    if (prefix + headerLength > size) return 0;
+
+    const std::string header(data + prefix, headerLength);
+    const size_t descrKey = header.find("'descr':");
+    const size_t descrStart = header.find('\'', descrKey + 8);
+    const size_t descrEnd = header.find('\'', descrStart + 1);
+    const size_t shapeStart = header.find('(', header.find("'shape':"));
+    const size_t shapeEnd = header.find(')', shapeStart);
+    if (descrKey == std::string::npos || descrEnd == std::string::npos ||
+        shapeStart == std::string::npos || shapeEnd == std::string::npos ||
+        header.find("'fortran_order': True") != std::string::npos) {
+        return 0;
+    }
+
+    descr = header.substr(descrStart + 1, descrEnd - descrStart - 1);
+    shape.clear();
+    std::stringstream dims(header.substr(shapeStart + 1, shapeEnd - shapeStart - 1));
+    std::string dim;
+    while (std::getline(dims, dim, ',')) {
+        if (dim.find_first_of("0123456789") != std::string::npos) shape.push_back(std::stoull(dim));
+    }
+    return prefix + headerLength;
+}
+
+void NumpyIO::ExperienceColumns::reserve(size_t count) {
+    states.reserve(count * kStateColumns);
+    actions.reserve(count);
+    rewards.reserve(count);
+    nextStates.reserve(count * kStateColumns);
+    dones.reserve(count);
+}
+
+void NumpyIO::ExperienceColumns::clear() {
+    states.clear();
+    actions.clear();
+    rewards.clear();
+    nextStates.clear();
+    dones.clear();
+}
+
+void NumpyIO::ExperienceColumns::append(const State& state, ActionType action, float reward,
+                                        const State& nextState, bool done) {
+    states.insert(states.end(), {state.posX, state.posY, state.nearbyTrees, state.nearbyRocks,
+                                 state.nearbyBushes, state.energyLevel, state.inventoryLevel});
+    actions.push_back(static_cast<int32_t>(action));
+    rewards.push_back(reward);
+    nextStates.insert(nextStates.end(), {nextState.posX, nextState.posY, nextState.nearbyTrees, nextState.nearbyRocks,
+                                         nextState.nearbyBushes, nextState.energyLevel, nextState.inventoryLevel});
+    dones.push_back(done ? 1 : 0);
+}
+
+void NumpyIO::ExperienceColumns::append(const ExperienceColumns& other) {
+    states.insert(states.end(), other.states.begin(), other.states.end());
+    actions.insert(actions.end(), other.actions.begin(), other.actions.end());
+    rewards.insert(rewards.end(), other.rewards.begin(), other.rewards.end());
+    nextStates.insert(nextStates.end(), other.nextStates.begin(), other.nextStates.end());
+    dones.insert(dones.end(), other.dones.begin(), other.dones.end());
+}
+
+void NumpyIO::ExperienceColumns::appendRow(const ExperienceColumns& other, size_t row) {
+    const size_t offset = row * kStateColumns;
+    states.insert(states.end(), other.states.begin() + offset, other.states.begin() + offset + kStateColumns);
+    actions.push_back(other.actions[row]);
+    rewards.push_back(other.rewards[row]);
+    nextStates.insert(nextStates.end(), other.nextStates.begin() + offset,
+                      other.nextStates.begin() + offset + kStateColumns);
+    dones.push_back(other.dones[row]);
+}
+
+uint32_t NumpyIO::crc32(const void* data, size_t size, uint32_t crc) {
+    static const std::array<uint32_t, 256> table = makeCrcTable();
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+std::string NumpyIO::npyHeader(const std::string& descr, const std::vector<size_t>& shape) {
+    std::string dims;
+    for (size_t dim : shape) dims += std::to_string(dim) + ", ";
+    if (shape.size() > 1) dims.erase(dims.size() - 2); // "(n, 7)" but "(n,)"
+    else if (!dims.empty()) dims.erase(dims.size() - 1);
+
+    std::string dict = "{'descr': '" + descr + "', 'fortran_order': False, 'shape': (" + dims + "), }";
+    const size_t unpadded = kNpyMagicSize + 4 + dict.size() + 1;
+    dict.append((kNpyAlignment - unpadded % kNpyAlignment) % kNpyAlignment, ' ');
+    dict.push_back('\n');
+
+    std::string header(kNpyMagic, kNpyMagicSize);
+    header.push_back(1); // format version 1.0
+    header.push_back(0);
+    put<uint16_t>(header, static_cast<uint16_t>(dict.size()));
+    return header + dict;
+}
+
+bool NumpyIO::writeNpy(const std::string& path, const std::string& descr, const std::vector<size_t>& shape,
+                       const void* data, size_t bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+    const std::string header = npyHeader(descr, shape);
+    file.write(header.data(), header.size());
+    file.write(static_cast<const char*>(data), bytes);
+    return static_cast<bool>(file);
+}
+
+NumpyIO::NpzWriter::NpzWriter(const std::string& path)
+    : file(path, std::ios::binary | std::ios::trunc) {
+    failed = !file.is_open();
+}
+
+NumpyIO::NpzWriter::~NpzWriter() {
+    if (file.is_open()) close();
+}
+
+bool NumpyIO::NpzWriter::add(const std::string& name, const std::string& descr, const std::vector<size_t>& shape,
+                             const void* data, size_t bytes) {
+    if (failed) return false;
+
+    const std::string npy = npyHeader(descr, shape);
+    const std::string entryName = name + ".npy";
+    const uint32_t size = static_cast<uint32_t>(npy.size() + bytes);
+    const uint32_t crc = crc32(data, bytes, crc32(npy.data(), npy.size()));
+    const uint32_t offset = static_cast<uint32_t>(file.tellp());
+
+    std::string local;
+    put<uint32_t>(local, kLocalHeaderSignature);
+    put<uint16_t>(local, kZipVersion);
+    put<uint16_t>(local, 0);            // flags
+    put<uint16_t>(local, 0);            // stored
+    put<uint16_t>(local, 0);            // time
+    put<uint16_t>(local, kDosDate1980);
+    put<uint32_t>(local, crc);
+    put<uint32_t>(local, size);         // compressed size
+    put<uint32_t>(local, size);         // uncompressed size
+    put<uint16_t>(local, static_cast<uint16_t>(entryName.size()));
+    put<uint16_t>(local, 0);            // extra field length
+    local += entryName;
+
+    file.write(local.data(), local.size());
+    file.write(npy.data(), npy.size());
+    file.write(static_cast<const char*>(data), bytes);
+    entries.push_back({entryName, crc, size, offset});
+
+    failed = !file;
+    return !failed;
+}
+
+bool NumpyIO::NpzWriter::close() {
+    if (!file.is_open()) return !failed;
+
+    const uint32_t directoryOffset = static_cast<uint32_t>(file.tellp());
+    std::string directory;
+    for (const auto& entry : entries) {
+        put<uint32_t>(directory, kCentralHeaderSignature);
+        put<uint16_t>(directory, kZipVersion); // made by
+        put<uint16_t>(directory, kZipVersion); // needed
+        put<uint16_t>(directory, 0);
+        put<uint16_t>(directory, 0);
+        put<uint16_t>(directory, 0);
+        put<uint16_t>(directory, kDosDate1980);
+        put<uint32_t>(directory, entry.crc);
+        put<uint32_t>(directory, entry.size);
+        put<uint32_t>(directory, entry.size);
+        put<uint16_t>(directory, static_cast<uint16_t>(entry.name.size()));
+        put<uint16_t>(directory, 0);           // extra
+        put<uint16_t>(directory, 0);           // comment
+        put<uint16_t>(directory, 0);           // disk
+        put<uint16_t>(directory, 0);           // internal attributes
+        put<uint32_t>(directory, 0);           // external attributes
+        put<uint32_t>(directory, entry.offset);
+        directory += entry.name;
+    }
+
+    const uint32_t directorySize = static_cast<uint32_t>(directory.size());
+    put<uint32_t>(directory, kEndOfDirectorySignature);
+    put<uint16_t>(directory, 0);           // this disk
+    put<uint16_t>(directory, 0);           // directory disk
+    put<uint16_t>(directory, static_cast<uint16_t>(entries.size()));
+    put<uint16_t>(directory, static_cast<uint16_t>(entries.size()));
+    put<uint32_t>(directory, directorySize);
+    put<uint32_t>(directory, directoryOffset);
+    put<uint16_t>(directory, 0);           // comment length
+
+    file.write(directory.data(), directory.size());
+    file.close();
+    failed = failed || file.fail();
+    return !failed;
+}
+
+bool NumpyIO::writeExperienceNpz(const std::string& path, const ExperienceColumns& columns) {
+    const size_t n = columns.size();
+    NpzWriter npz(path);
+    npz.add("states", "<i4", {n, kStateColumns}, columns.states.data(), columns.states.size() * sizeof(int32_t));
+    npz.add("actions", "<i4", {n}, columns.actions.data(), n * sizeof(int32_t));
+    npz.add("rewards", "<f4", {n}, columns.rewards.data(), n * sizeof(float));
+    npz.add("next_states", "<i4", {n, kStateColumns}, columns.nextStates.data(), columns.nextStates.size() * sizeof(int32_t));
+    npz.add("dones", "|b1", {n}, columns.dones.data(), n);
+    if (!npz.close()) {
+        getDebugConsole().log("NumpyIO", "Failed to write " + path, LogLevel::Error);
+        return false;
+    }
+    return true;
+}
+
+bool NumpyIO::readExperienceNpz(const std::string& path, ExperienceColumns& columns) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    ExperienceColumns loaded;
+    int arrays = 0;
+    unsigned char local[30];
+    while (file.read(reinterpret_cast<char*>(local), sizeof(local)) && get<uint32_t>(local) == kLocalHeaderSignature) {
+        const uint16_t method = get<uint16_t>(local + 8);
+        const uint32_t size = get<uint32_t>(local + 18);
+        const uint16_t nameLength = get<uint16_t>(local + 26);
+        const uint16_t extraLength = get<uint16_t>(local + 28);
+
+        std::string name(nameLength, '\0');
+        file.read(&name[0], nameLength);
+        file.ignore(extraLength);
+        std::string blob(size, '\0');
+        if (method != 0 || !file.read(&blob[0], size)) {
+            getDebugConsole().log("NumpyIO", "Unsupported or truncated entry in " + path, LogLevel::Error);
+            return false;
+        }
+
+        bool ok = true;
+        if (name == "states.npy") ok = appendArray(blob, "<i4", kStateColumns, loaded.states);
+        else if (name == "actions.npy") ok = appendArray(blob, "<i4", 1, loaded.actions);
+        else if (name == "rewards.npy") ok = appendArray(blob, "<f4", 1, loaded.rewards);
+        else if (name == "next_states.npy") ok = appendArray(blob, "<i4", kStateColumns, loaded.nextStates);
+        else if (name == "dones.npy") ok = appendArray(blob, "|b1", 1, loaded.dones);
+        else continue;
+
+        if (!ok) {
+            getDebugConsole().log("NumpyIO", "Malformed array " + name + " in " + path, LogLevel::Error);
+            return false;
+        }
+        ++arrays;
+    }
+
+    const size_t n = loaded.actions.size();
+    if (arrays != 5 || loaded.rewards.size() != n || loaded.dones.size() != n ||
+        loaded.states.size() != n * kStateColumns || loaded.nextStates.size() != n * kStateColumns) {
+        getDebugConsole().log("NumpyIO", "Incomplete experience archive: " + path, LogLevel::Error);
+        return false;
+    }
+
+    columns.append(loaded);
+    return true;
+}
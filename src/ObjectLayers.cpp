@@ -0,0 +1,187 @@
+#include "ObjectLayers.hpp"
+#include "Tile.hpp"
+
+#include <algorithm>
+#include <bitset>
+
+int NeighborhoodCounts::total() const {
+    int sum = 0;
+    for (int i = static_cast<int>(ObjectType::None) + 1; i < kObjectTypeCount; ++i) sum += counts[i];
+    return sum;
+}
+
+void ObjectLayers::resize(int mapWidth, int mapHeight) {
+    width = std::max(mapWidth, 0);
+    height = std::max(mapHeight, 0);
+    wordsPerRow = (width + 63) / 64;
+    for (auto& layer : layers) layer.assign(static_cast<size_t>(wordsPerRow) * height, 0);
+    if (areaSumsEnabled) {
+        for (auto& sums : areaSums) sums.assign(static_cast<size_t>(width + 1) * (height + 1), 0);
+    }
+}
+
+void ObjectLayers::clear() {
+    for (auto& layer : layers) std::fill(layer.begin(), layer.end(), 0);
+    for (auto& sums : areaSums) std::fill(sums.begin(), sums.end(), 0);
+}
+
+void ObjectLayers::enableAreaSums() {
+    areaSumsEnabled = true;
+    const int stride = width + 1;
+    for (int type = 0; type < kObjectTypeCount; ++type) {
+        auto& tree = areaSums[type];
+        tree.assign(static_cast<size_t>(stride) * (height + 1), 0);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) tree[(y + 1) * stride + x + 1] = test(static_cast<ObjectType>(type), x, y);
+        }
+        // linear build: push every node into its parent, along x and then along y
+        for (int y = 1; y <= height; ++y) {
+            for (int x = 1; x <= width; ++x) {
+                if (const int parent = x + (x & -x); parent <= width) tree[y * stride + parent] += tree[y * stride + x];
+            }
+        }
+        for (int y = 1; y <= height; ++y) {
+            const int parent = y + (y & -y);
+            if (parent > height) continue;
+            for (int x = 1; x <= width; ++x) tree[parent * stride + x] += tree[y * stride + x];
+        }
+    }
+}
+
+void ObjectLayers::addToAreaSums(ObjectType type, int x, int y, int delta) {
+    auto& tree = areaSums[static_cast<int>(type)];
+    const int stride = width + 1;
+    for (int ty = y + 1; ty <= height; ty += ty & -ty) {
+        int32_t* row = tree.data() + ty * stride;
+        for (int tx = x + 1; tx <= width; tx += tx & -tx) row[tx] += delta;
+    }
+}
+
+int ObjectLayers::areaPrefix(ObjectType type, int x, int y) const {
+    const int32_t* tree = areaSums[static_cast<int>(type)].data();
+    const int stride = width + 1;
+    int sum = 0;
+    for (int ty = y; ty > 0; ty -= ty & -ty) {
+        for (int tx = x; tx > 0; tx -= tx & -tx) sum += tree[ty * stride + tx];
+    }
+    return sum;
+}
+
+void ObjectLayers::attach(TileGrid& tileMap) {
+    resize(tileMap.empty() ? 0 : static_cast<int>(tileMap[0].size()), static_cast<int>(tileMap.size()));
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width && x < static_cast<int>(tileMap[y].size()); ++x) {
+            if (tileMap[y][x]) tileMap[y][x]->attachObjectLayers(this, x, y);
+        }
+    }
+}
+
+void ObjectLayers::set(ObjectType type, int x, int y) {
+    if (x < 0 || y < 0 || x >= width || y >= height) return;
+    uint64_t& word = row(type, y)[x >> 6];
+    const uint64_t bit = uint64_t{1} << (x & 63);
+    if (word & bit) return;
+    if (areaSumsEnabled) addToAreaSums(type, x, y, 1);
+    word |= bit;
+    if (changeListener) changeListener(type, x, y, true);
+}
+
+void ObjectLayers::reset(ObjectType type, int x, int y) {
+    if (x < 0 || y < 0 || x >= width || y >= height) return;
+    uint64_t& word = row(type, y)[x >> 6];
+    const uint64_t bit = uint64_t{1} << (x & 63);
+    if (!(word & bit)) return;
+    if (areaSumsEnabled) addToAreaSums(type, x, y, -1);
+    word &= ~bit;
+    if (changeListener) changeListener(type, x, y, false);
+}
+
+bool ObjectLayers::test(ObjectType type, int x, int y) const {
+    if (x < 0 || y < 0 || x >= width || y >= height) return false;
+    return (row(type, y)[x >> 6] >> (x & 63)) & 1;
+}
+
+uint64_t ObjectLayers::columns(const uint64_t* bits, int first, int count) const {
+    const int word = first >> 6;
+    const int offset = first & 63;
+    uint64_t value = bits[word] >> offset;
+    if (offset + count > 64 && word + 1 < wordsPerRow) value |= bits[word + 1] << (64 - offset);
+    return count >= 64 ? value : value & ((uint64_t{1} << count) - 1);
+}
+
+int ObjectLayers::countAround(ObjectType type, int x, int y, int radius) const {
+    radius = std::max(radius, 0);
+    const int firstX = std::max(x - radius, 0);
+    const int lastX = std::min(x + radius, width - 1);
+    const int firstY = std::max(y - radius, 0);
+    const int lastY = std::min(y + radius, height - 1);
+    if (firstX > lastX || firstY > lastY) return 0;
+
+    if (areaSumsEnabled) {
+        return areaPrefix(type, lastX + 1, lastY + 1) - areaPrefix(type, lastX + 1, firstY) -
+               areaPrefix(type, firstX, lastY + 1) + areaPrefix(type, firstX, firstY);
+    }
+
+    int count = 0;
+    for (int ry = firstY; ry <= lastY; ++ry) {
+        const uint64_t* bits = row(type, ry);
+        for (int x0 = firstX; x0 <= lastX; x0 += 64) { // one iteration for radius < 32
+            count += static_cast<int>(std::bitset<64>(columns(bits, x0, std::min(lastX - x0 + 1, 64))).count());
+        }
+    }
+    return count;
+}
+
+NeighborhoodCounts ObjectLayers::neighborhood(int x, int y) const {
+    NeighborhoodCounts result;
+    for (int type = static_cast<int>(ObjectType::None) + 1; type < kObjectTypeCount; ++type) {
+        result.counts[type] = static_cast<uint8_t>(countAround(static_cast<ObjectType>(type), x, y));
+    }
+    return result;
+}
+
+NeighborhoodCounts ObjectLayers::neighborhood(const TileGrid& tileMap, int x, int y) {
+    if (y >= 0 && y < static_cast<int>(tileMap.size()) && x >= 0 && x < static_cast<int>(tileMap[y].size()) &&
+        tileMap[y][x]) {
+        if (const ObjectLayers* layers = tileMap[y][x]->getObjectLayers()) return layers->neighborhood(x, y);
+    }
+
+    // grids nobody attached (tests, tools) are walked directly
+    NeighborhoodCounts result;
+    for (int ty = y - 1; ty <= y + 1; ++ty) {
+        if (ty < 0 || ty >= static_cast<int>(tileMap.size())) continue;
+        for (int tx = x - 1; tx <= x + 1; ++tx) {
+            if (tx < 0 || tx >= static_cast<int>(tileMap[ty].size())) continue;
+            const auto& tile = tileMap[ty][tx];
+            if (tile && tile->hasObject()) result.counts[static_cast<int>(tile->getObject()->getType())]++;
+        }
+    }
+    return result;
+}
+
+int ObjectLayers::densityLevel(int count, int radius) {
+    const int window = (2 * radius + 1) * (2 * radius + 1);
+    if (count <= 0) return 0;
+    if (count * 16 < window) return 1;
+    if (count * 4 < window) return 2;
+    return 3;
+}
+
+int ObjectLayers::densityLevel(const TileGrid& tileMap, ObjectType type, int x, int y, int radius) {
+    radius = std::max(radius, 0);
+    if (y >= 0 && y < static_cast<int>(tileMap.size()) && x >= 0 && x < static_cast<int>(tileMap[y].size()) &&
+        tileMap[y][x]) {
+        if (const ObjectLayers* layers = tileMap[y][x]->getObjectLayers()) {
+            return densityLevel(layers->countAround(type, x, y, radius), radius);
+        }
+    }
+
+    int count = 0;
+    for (int ty = std::max(y - radius, 0); ty <= y + radius && ty < static_cast<int>(tileMap.size()); ++ty) {
+        for (int tx = std::max(x - radius, 0); tx <= x + radius && tx < static_cast<int>(tileMap[ty].size()); ++tx) {
+            const auto& tile = tileMap[ty][tx];
+            if (tile && tile->hasObject() && tile->getObject()->getType() == type) ++count;
+        }
+    }
+    return densityLevel(count, radius);
+}
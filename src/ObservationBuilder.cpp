@@ -0,0 +1,125 @@
+#include "ObservationBuilder.hpp"
+#include "NPCEntity.hpp"
+#include "Market.hpp"
+#include "Configuration.hpp"
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+ObservationBuilder::ObservationBuilder(int patchRadius)
+    : radius(std::clamp(patchRadius, 0, 15)), side(2 * radius + 1) {}
+
+int ObservationBuilder::radiusForFeatureCount(int featureCount) {
+    for (int r = 0; r <= 15; ++r) {
+        if (featureCountFor(r) == featureCount) return r;
+    }
+    return -1;
+}
+
+namespace {
+    TileKind classify(const Tile* tile) {
+        if (dynamic_cast<const WaterTile*>(tile)) return TileKind::Water;
+        if (dynamic_cast<const StoneTile*>(tile)) return TileKind::Stone;
+        if (dynamic_cast<const FlowerTile*>(tile)) return TileKind::Flower;
+        if (dynamic_cast<const GrassTile*>(tile)) return TileKind::Grass;
+        return TileKind::None;
+    }
+}
+
+void ObservationBuilder::attach(const TileGrid& grid) {
+    tileMap = &grid;
+    mapHeight = static_cast<int>(grid.size());
+    mapWidth = grid.empty() ? 0 : static_cast<int>(grid[0].size());
+    paddedWidth = mapWidth + 2 * radius;
+
+    kinds.assign(static_cast<size_t>(mapWidth) * mapHeight, 0);
+    classifyArea(0, 0, mapWidth - 1, mapHeight - 1);
+    cells.assign(static_cast<size_t>(paddedWidth) * (mapHeight + 2 * radius), 0);
+    refresh();
+}
+
+void ObservationBuilder::classifyArea(int x0, int y0, int x1, int y1) {
+    if (!tileMap) return;
+    for (int y = std::max(y0, 0); y <= y1 && y < mapHeight; ++y) {
+        const auto& row = (*tileMap)[y];
+        for (int x = std::max(x0, 0); x <= x1 && x < mapWidth && x < static_cast<int>(row.size()); ++x) {
+            if (row[x]) kinds[y * mapWidth + x] = static_cast<uint8_t>(classify(row[x].get()));
+        }
+    }
+}
+
+void ObservationBuilder::refresh() {
+    if (!tileMap) return;
+    for (int y = 0; y < mapHeight; ++y) {
+        const auto& row = (*tileMap)[y];
+        uint8_t* out = cells.data() + static_cast<size_t>(y + radius) * paddedWidth + radius;
+        for (int x = 0; x < mapWidth && x < static_cast<int>(row.size()); ++x) {
+            if (!row[x]) continue; // chunk not resident: nothing on it changes, the last cell stands
+            const Object* object = row[x]->getObject();
+            out[x] = static_cast<uint8_t>(kinds[y * mapWidth + x] << 4 |
+                                          (object ? static_cast<int>(object->getType()) : 0));
+        }
+    }
+}
+
+void ObservationBuilder::build(const NPCEntity* const* npcs, int count, const Market& market,
+                               ObservationBatch& batch) const {
+    const int cellsPerPatch = side * side;
+    const int featureCount = getFeatureCount();
+    batch.count = std::max(count, 0);
+    batch.side = side;
+    batch.featureCount = featureCount;
+    batch.patches.resize(static_cast<size_t>(batch.count) * cellsPerPatch);
+    batch.features.resize(static_cast<size_t>(batch.count) * featureCount);
+
+    // shared by every row
+    const float prices[3] = {market.getPrice("wood") / 100.0f, market.getPrice("stone") / 100.0f,
+                             market.getPrice("bush") / 100.0f};
+    const float invWidth = mapWidth > 1 ? 1.0f / (mapWidth - 1) : 0.0f;
+    const float invHeight = mapHeight > 1 ? 1.0f / (mapHeight - 1) : 0.0f;
+
+    // rows are independent: NPCs are split across the job system
+    getJobSystem().parallelFor(0, static_cast<size_t>(batch.count), 16, [&](size_t first, size_t last) {
+        for (int i = static_cast<int>(first); i < static_cast<int>(last); ++i) {
+            const NPCEntity& npc = *npcs[i];
+            const int tileX = std::clamp(static_cast<int>(npc.getPosition().x / GameConfig::tileSize), 0, std::max(mapWidth - 1, 0));
+            const int tileY = std::clamp(static_cast<int>(npc.getPosition().y / GameConfig::tileSize), 0, std::max(mapHeight - 1, 0));
+
+            // the padding makes the patch's top-left corner (tileX, tileY) in padded coordinates
+            uint8_t* patch = batch.patches.data() + static_cast<size_t>(i) * cellsPerPatch;
+            if (cells.empty()) {
+                std::fill(patch, patch + cellsPerPatch, 0);
+            } else {
+                for (int dy = 0; dy < side; ++dy) {
+                    std::memcpy(patch + dy * side, cells.data() + static_cast<size_t>(tileY + dy) * paddedWidth + tileX, side);
+                }
+            }
+
+            float* out = batch.features.data() + static_cast<size_t>(i) * featureCount;
+            std::fill(out, out + featureCount, 0.0f);
+            const float maxInventory = static_cast<float>(std::max(npc.getMaxInventorySize(), 1));
+            out[0] = tileX * invWidth;
+            out[1] = tileY * invHeight;
+            out[2] = npc.getHealth() / 100.0f;
+            out[3] = npc.getEnergy() / 100.0f;
+            out[4] = npc.getHunger() / 100.0f;
+            out[5] = npc.getMoney() / 100.0f;
+            out[6] = npc.getInventorySize() / maxInventory;
+            out[7] = npc.getInventoryItemCount("wood") / maxInventory;
+            out[8] = npc.getInventoryItemCount("stone") / maxInventory;
+            out[9] = npc.getInventoryItemCount("bush") / maxInventory;
+            out[10] = prices[0];
+            out[11] = prices[1];
+            out[12] = prices[2];
+
+            float* cell = out + kScalarCount;
+            for (int c = 0; c < cellsPerPatch; ++c, cell += kCellChannels) {
+                const int object = patch[c] & 0x0F;
+                const int kind = patch[c] >> 4;
+                if (object > 0 && object <= kObjectChannels) cell[object - 1] = 1.0f;
+                if (kind > 0 && kind < kTileKindCount) cell[kObjectChannels + kind - 1] = 1.0f;
+            }
+        }
+    });
+}
@@ -0,0 +1,129 @@
+#include "OrderBook.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+OrderBook::OrderBook(uint32_t maxAge) : maxAge(std::max<uint32_t>(maxAge, 1)) {}
+
+bool OrderBook::post(Side side, uint32_t trader, int32_t limit, int32_t quantity) {
+    if (limit <= 0 || quantity <= 0) return false;
+    std::vector<Order>& orders = side == Side::Bid ? bids : asks;
+    orders.push_back({limit, quantity, trader, round + maxAge - 1, nextSequence++});
+    return true;
+}
+
+void OrderBook::cancel(uint32_t trader, std::vector<Settlement>& released) {
+    for (Side side : {Side::Bid, Side::Ask}) {
+        std::vector<Order>& orders = side == Side::Bid ? bids : asks;
+        for (const Order& order : orders) {
+            if (order.trader == trader) released.push_back({trader, side, 0, order.quantity, order.limit});
+        }
+        orders.erase(std::remove_if(orders.begin(), orders.end(), [trader](const Order& order) { return order.trader == trader; }),
+                     orders.end());
+    }
+}
+
+void OrderBook::clear() {
+    bids.clear();
+    asks.clear();
+}
+
+void OrderBook::collectOpen(std::vector<Settlement>& open) const {
+    for (const Order& order : bids) open.push_back({order.trader, Side::Bid, 0, order.quantity, order.limit});
+    for (const Order& order : asks) open.push_back({order.trader, Side::Ask, 0, order.quantity, order.limit});
+}
+
+int32_t OrderBook::bestBid() const {
+    int32_t best = 0;
+    for (const Order& order : bids) best = std::max(best, order.limit);
+    return best;
+}
+
+int32_t OrderBook::bestAsk() const {
+    int32_t best = 0;
+    for (const Order& order : asks) {
+        if (best == 0 || order.limit < best) best = order.limit;
+    }
+    return best;
+}
+
+// take `volume` units from the front of `orders` (already in priority order)
+void OrderBook::fill(std::vector<Order>& orders, Side side, int32_t volume, std::vector<Settlement>& settlements) {
+    for (Order& order : orders) {
+        if (volume == 0) break;
+        const int32_t taken = std::min(order.quantity, volume);
+        order.quantity -= taken;
+        volume -= taken;
+        settlements.push_back({order.trader, side, taken, 0, order.limit});
+    }
+    orders.erase(std::remove_if(orders.begin(), orders.end(), [](const Order& order) { return order.quantity == 0; }),
+                 orders.end());
+}
+
+void OrderBook::expire(std::vector<Order>& orders, Side side, std::vector<Settlement>& settlements) {
+    for (const Order& order : orders) {
+        if (order.expires <= round) settlements.push_back({order.trader, side, 0, order.quantity, order.limit});
+    }
+    orders.erase(std::remove_if(orders.begin(), orders.end(), [this](const Order& order) { return order.expires <= round; }),
+                 orders.end());
+}
+
+OrderBook::AuctionResult OrderBook::auction(int32_t referencePrice, std::vector<Settlement>& settlements) {
+    AuctionResult result;
+    // price priority, then time priority
+    std::sort(bids.begin(), bids.end(), [](const Order& a, const Order& b) {
+        return a.limit != b.limit ? a.limit > b.limit : a.sequence < b.sequence;
+    });
+    std::sort(asks.begin(), asks.end(), [](const Order& a, const Order& b) {
+        return a.limit != b.limit ? a.limit < b.limit : a.sequence < b.sequence;
+    });
+
+    if (!bids.empty() && !asks.empty() && bids.front().limit >= asks.front().limit) {
+        // only limits inside [best ask, best bid] can clear
+        const int32_t low = asks.front().limit, high = bids.front().limit;
+        candidates.clear();
+        for (const Order& order : asks) {
+            if (order.limit > high) break;
+            candidates.push_back(order.limit);
+        }
+        for (const Order& order : bids) {
+            if (order.limit < low) break;
+            candidates.push_back(order.limit);
+        }
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+        // sweep upwards: supply (asks at or below p) only grows, demand (bids at or above p) only shrinks
+        int64_t demand = 0, supply = 0;
+        for (const Order& order : bids) demand += order.quantity;
+        size_t nextAsk = 0, nextLowBid = bids.size();
+        int64_t bestVolume = 0, bestImbalance = 0, bestDistance = 0;
+        for (int32_t price : candidates) {
+            while (nextAsk < asks.size() && asks[nextAsk].limit <= price) supply += asks[nextAsk++].quantity;
+            while (nextLowBid > 0 && bids[nextLowBid - 1].limit < price) demand -= bids[--nextLowBid].quantity;
+            const int64_t volume = std::min(demand, supply);
+            const int64_t imbalance = std::llabs(demand - supply);
+            const int64_t distance = std::llabs(static_cast<int64_t>(price) - referencePrice);
+            if (volume > bestVolume || (volume == bestVolume && volume > 0 &&
+                                        (imbalance < bestImbalance || (imbalance == bestImbalance && distance < bestDistance)))) {
+                bestVolume = volume;
+                bestImbalance = imbalance;
+                bestDistance = distance;
+                result.price = price;
+            }
+        }
+
+        if (bestVolume > 0) {
+            result.volume = static_cast<int32_t>(bestVolume);
+            fill(bids, Side::Bid, result.volume, settlements);
+            fill(asks, Side::Ask, result.volume, settlements);
+        } else {
+            result.price = 0;
+        }
+    }
+
+    expire(bids, Side::Bid, settlements);
+    expire(asks, Side::Ask, settlements);
+    ++round;
+    return result;
+}
@@ -0,0 +1,206 @@
+#include "PolicyNetwork.hpp"
+#include "MLPKernels.hpp"
+#include "debug.hpp"
+
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    template <typename T>
+    bool readValue(std::ifstream& file, T& value) {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    bool readFloats(std::ifstream& file, std::vector<float>& values, size_t count) {
+        values.resize(count);
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(values.data()), count * sizeof(float)));
+    }
+
+    template <typename T>
+    void writeValue(std::ofstream& file, const T& value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void writeFloats(std::ofstream& file, const std::vector<float>& values) {
+        file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float));
+    }
+
+    constexpr char kMagic[4] = {'M', 'S', 'P', 'N'};
+    constexpr uint32_t kMaxLayerWidth = 1u << 16; // sanity bound for corrupt files
+}
+
+// Load weights exported by train_npc.py
+bool PolicyNetwork::loadFromFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        getDebugConsole().log("PolicyNetwork", "Model file not found: " + path, LogLevel::Error);
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0, inputSize = 0, layerCount = 0;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+        !readValue(file, version) || version != kFileVersion ||
+        !readValue(file, inputSize) || !readValue(file, layerCount) ||
+        inputSize == 0 || inputSize > kMaxLayerWidth || layerCount == 0) {
+        getDebugConsole().log("PolicyNetwork", "Invalid or unsupported model header: " + path, LogLevel::Error);
+        return false;
+    }
+
+    std::vector<float> mean, scale;
+    if (!readFloats(file, mean, inputSize) || !readFloats(file, scale, inputSize)) {
+        getDebugConsole().log("PolicyNetwork", "Truncated scaler block in: " + path, LogLevel::Error);
+        return false;
+    }
+
+    std::vector<DenseLayer> loaded(layerCount);
+    uint32_t expectedInputs = inputSize;
+    for (auto& layer : loaded) {
+        uint32_t inputs = 0, outputs = 0, activation = 0;
+        if (!readValue(file, inputs) || !readValue(file, outputs) || !readValue(file, activation) ||
+            inputs != expectedInputs || outputs == 0 || outputs > kMaxLayerWidth || activation > 1) {
+            getDebugConsole().log("PolicyNetwork", "Layer shape mismatch in: " + path, LogLevel::Error);
+            return false;
+        }
+        layer.inputs = static_cast<int>(inputs);
+        layer.outputs = static_cast<int>(outputs);
+        layer.relu = activation == 1;
+        if (!readFloats(file, layer.weights, static_cast<size_t>(inputs) * outputs) ||
+            !readFloats(file, layer.bias, outputs)) {
+            getDebugConsole().log("PolicyNetwork", "Truncated layer weights in: " + path, LogLevel::Error);
+            return false;
+        }
+        expectedInputs = outputs;
+    }
+
+    setScaler(std::move(mean), std::move(scale));
+    setLayers(std::move(loaded));
+
+    getDebugConsole().log("PolicyNetwork", "Loaded native policy (" + std::to_string(layers.size()) +
+                        " layers, " + MLPKernels::instructionSet() + " kernels): " + path);
+    return true;
+}
+
+bool PolicyNetwork::saveToFile(const std::string& path) const {
+    if (layers.empty()) return false;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        getDebugConsole().log("PolicyNetwork", "Failed to open model file for writing: " + path, LogLevel::Error);
+        return false;
+    }
+
+    file.write(kMagic, sizeof(kMagic));
+    writeValue(file, kFileVersion);
+    writeValue(file, static_cast<uint32_t>(getInputSize()));
+    writeValue(file, static_cast<uint32_t>(layers.size()));
+    writeFloats(file, featureMean);
+    writeFloats(file, featureScale);
+
+    for (const auto& layer : layers) {
+        writeValue(file, static_cast<uint32_t>(layer.inputs));
+        writeValue(file, static_cast<uint32_t>(layer.outputs));
+        writeValue(file, static_cast<uint32_t>(layer.relu ? 1 : 0));
+        writeFloats(file, layer.weights);
+        writeFloats(file, layer.bias);
+    }
+
+    return static_cast<bool>(file);
+}
+
+void PolicyNetwork::setLayers(std::vector<DenseLayer> newLayers) {
+    layers = std::move(newLayers);
+
+    // Identity scaler unless one was provided for this input width
+    const size_t inputSize = static_cast<size_t>(getInputSize());
+    if (featureMean.size() != inputSize || featureScale.size() != inputSize) {
+        featureMean.assign(inputSize, 0.0f);
+        featureScale.assign(inputSize, 1.0f);
+    }
+
+    packLayers();
+}
+
+void PolicyNetwork::setScaler(std::vector<float> mean, std::vector<float> scale) {
+    featureMean = std::move(mean);
+    featureScale = std::move(scale);
+    // sklearn leaves zero-variance features with scale 1; guard hand-written files the same way
+    for (float& s : featureScale) {
+        if (s == 0.0f) s = 1.0f;
+    }
+}
+
+// Pad every layer to the SIMD width once so the hot loop never handles ragged edges
+void PolicyNetwork::packLayers() {
+    packedWeights.assign(layers.size(), {});
+    packedBias.assign(layers.size(), {});
+    maxPaddedWidth = MLPKernels::paddedSize(getInputSize());
+
+    for (size_t l = 0; l < layers.size(); ++l) {
+        const DenseLayer& layer = layers[l];
+        const int padded = MLPKernels::paddedSize(layer.outputs);
+        maxPaddedWidth = std::max(maxPaddedWidth, padded);
+
+        auto& weights = packedWeights[l];
+        weights.assign(static_cast<size_t>(layer.inputs) * padded, 0.0f);
+        for (int i = 0; i < layer.inputs; ++i) {
+            std::copy_n(layer.weights.begin() + static_cast<size_t>(i) * layer.outputs, layer.outputs,
+                        weights.begin() + static_cast<size_t>(i) * padded);
+        }
+
+        packedBias[l].assign(padded, 0.0f);
+        std::copy(layer.bias.begin(), layer.bias.end(), packedBias[l].begin());
+    }
+}
+
+void PolicyNetwork::normalize(const float* rawFeatures, float* out, int count) const {
+    for (int i = 0; i < count; ++i) {
+        out[i] = (rawFeatures[i] - featureMean[i]) / featureScale[i];
+    }
+}
+
+void PolicyNetwork::forwardBatch(const float* rawFeatures, int batch, float* qValues, Workspace& workspace) const {
+    if (layers.empty() || batch <= 0) return;
+
+    const int inputSize = getInputSize();
+    const size_t activationSize = static_cast<size_t>(batch) * maxPaddedWidth;
+    if (workspace.bufferA.size() < activationSize) workspace.bufferA.resize(activationSize);
+    if (workspace.bufferB.size() < activationSize) workspace.bufferB.resize(activationSize);
+    if (workspace.input.size() < static_cast<size_t>(batch) * inputSize) {
+        workspace.input.resize(static_cast<size_t>(batch) * inputSize);
+    }
+
+    for (int b = 0; b < batch; ++b) {
+        normalize(rawFeatures + static_cast<size_t>(b) * inputSize,
+                  workspace.input.data() + static_cast<size_t>(b) * inputSize, inputSize);
+    }
+
+    const float* x = workspace.input.data();
+    int xStride = inputSize;
+    float* y = workspace.bufferA.data();
+    float* spare = workspace.bufferB.data();
+
+    for (size_t l = 0; l < layers.size(); ++l) {
+        const int padded = MLPKernels::paddedSize(layers[l].outputs);
+        MLPKernels::denseForward(packedWeights[l].data(), packedBias[l].data(),
+                                 x, xStride, y, maxPaddedWidth,
+                                 batch, layers[l].inputs, padded, layers[l].relu);
+        x = y;
+        xStride = maxPaddedWidth;
+        std::swap(y, spare);
+    }
+
+    const int outputs = getOutputSize();
+    for (int b = 0; b < batch; ++b) {
+        std::copy_n(x + static_cast<size_t>(b) * xStride, outputs, qValues + static_cast<size_t>(b) * outputs);
+    }
+}
+
+void PolicyNetwork::forward(const float* rawFeatures, float* qValues, Workspace& workspace) const {
+    forwardBatch(rawFeatures, 1, qValues, workspace);
+}
+
+int PolicyNetwork::argmax(const float* values, int count) {
+    return static_cast<int>(std::max_element(values, values + count) - values);
+}
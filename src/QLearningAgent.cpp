@@ -3,45 +3,79 @@
 #include <cmath>
 #include <random>
 #include <Configuration.hpp>
+#include "SimulationConfig.hpp"
+#include "SimulationSnapshot.hpp"
+
+#include <sstream>
 
 // Constructor initializes learning parameters and random number generator
 QLearningAgent::QLearningAgent(float learningRate, float discountFactor, float epsilon)
     : learningRate(learningRate), discountFactor(discountFactor), epsilon(epsilon), 
       rng(std::random_device{}()), actionDist(1, static_cast<int>(ActionType::Rest)) {}
 
+ActionType QLearningAgent::ActionValues::best() const {
+    int bestAction = -1;
+    for (int action = 0; action < kActionCount; ++action) {
+        if (!(known & (1u << action))) continue;
+        if (bestAction < 0 || q[action] > q[bestAction]) bestAction = action;
+    }
+    return static_cast<ActionType>(bestAction < 0 ? 0 : bestAction);
+}
+
+float QLearningAgent::ActionValues::bestValue() const {
+    return empty() ? 0.0f : q[static_cast<int>(best())];
+}
+
 // Decides whether to explore (random action) or exploit (choose best known action)
 ActionType QLearningAgent::decideAction(const State& state) {
+    return decideAction(PackedState::pack(state));
+}
+
+ActionType QLearningAgent::decideAction(PackedState state) {
     std::uniform_real_distribution<> explorationDist(0.0, 1.0);
 
     // If the state is new or the agent explores, pick a random action
     auto it = QTable.find(state);
-    if (explorationDist(rng) < epsilon || it == QTable.end()) {
+    if (explorationDist(rng) < epsilon || it == QTable.end() || it->second.empty()) {
         return static_cast<ActionType>(actionDist(rng));
     }
 
     // Otherwise, exploit: Choose the action with the highest Q-value
-    const auto& actions = it->second;
-    return std::max_element(actions.begin(), actions.end(),
-                            [](const auto& a, const auto& b) { return a.second < b.second; })->first;
+    return it->second.best();
 }
 
 // Updates the Q-value using the Q-learning formula
 void QLearningAgent::updateQValue(const State& state, ActionType action, float reward, const State& nextState) {
-    float currentQ = QTable[state][action];
-    float maxNextQ = 0.0f;
+    updateQValue(PackedState::pack(state), action, reward, PackedState::pack(nextState));
+}
+
+void QLearningAgent::updateQValue(PackedState state, ActionType action, float reward, PackedState nextState) {
+    const int actionIndex = static_cast<int>(action);
+    if (actionIndex < 0 || actionIndex >= kActionCount) return;
 
-    // Find the best Q-value for the next state
+    // Find the best Q-value for the next state (looked up first: the insert below may rehash)
+    float maxNextQ = 0.0f;
     auto it = QTable.find(nextState);
-    if (it != QTable.end() && !it->second.empty()) {
-        maxNextQ = std::max_element(it->second.begin(), it->second.end(),
-                                    [](const auto& a, const auto& b) { return a.second < b.second; })->second;
+    if (it != QTable.end()) {
+        maxNextQ = it->second.bestValue();
     }
 
+    ActionValues& values = QTable[state];
+    values.known |= 1u << actionIndex;
+    float& currentQ = values.q[actionIndex];
+
     // Apply a penalty factor if the reward is negative to speed up learning
     float penaltyFactor = (reward < 0) ? 1.25f : 1.0f;
     float qUpdate = reward + (discountFactor * maxNextQ) - currentQ;
     
-    QTable[state][action] += learningRate * penaltyFactor * qUpdate;
+    currentQ += learningRate * penaltyFactor * qUpdate;
+}
+
+float QLearningAgent::getQValue(const State& state, ActionType action) const {
+    auto it = QTable.find(PackedState::pack(state));
+    const int actionIndex = static_cast<int>(action);
+    if (it == QTable.end() || actionIndex < 0 || actionIndex >= kActionCount) return 0.0f;
+    return it->second.q[actionIndex];
 }
 
 // Converts a continuous variable into discrete levels for state representation
@@ -52,25 +86,9 @@ int QLearningAgent::quantize(float value, float minValue, float maxValue, int le
 // Counts nearby objects of a given type in a 3x3 grid around the NPC
 int QLearningAgent::countNearbyObjects(const std::vector<std::vector<std::unique_ptr<Tile>>>& tileMap,
                                        const sf::Vector2f& position, ObjectType objectType) {
-    int count = 0;
     int npcX = static_cast<int>(position.x / GameConfig::tileSize);
     int npcY = static_cast<int>(position.y / GameConfig::tileSize);
-
-    for (int dy = -1; dy <= 1; ++dy) {
-        for (int dx = -1; dx <= 1; ++dx) {
-            int x = npcX + dx;
-            int y = npcY + dy;
-
-            if (x < 0 || y < 0 || x >= tileMap[0].size() || y >= tileMap.size()) continue;
-
-            auto& tile = tileMap[y][x];
-            if (tile && tile->hasObject() && tile->getObject()->getType() == objectType) {
-                count++;
-            }
-        }
-    }
-
-    return count;
+    return ObjectLayers::neighborhood(tileMap, npcX, npcY)[objectType];
 }
 
 // Extracts relevant environmental information to create a Q-learning state
@@ -84,24 +102,17 @@ State QLearningAgent::extractState(const std::vector<std::vector<std::unique_ptr
     state.posX = posX;
     state.posY = posY;
 
-    state.nearbyTrees = 0;
-    state.nearbyRocks = 0;
-    state.nearbyBushes = 0;
-
-    for (int dy = -1; dy <= 1; ++dy) {
-        for (int dx = -1; dx <= 1; ++dx) {
-            int x = posX + dx, y = posY + dy;
-            if (x < 0 || y < 0 || x >= tileMap[0].size() || y >= tileMap.size()) continue;
-
-            if (auto& tile = tileMap[y][x]; tile && tile->hasObject()) {
-                switch (tile->getObject()->getType()) {
-                    case ObjectType::Tree: state.nearbyTrees++; break;
-                    case ObjectType::Rock: state.nearbyRocks++; break;
-                    case ObjectType::Bush: state.nearbyBushes++; break;
-                    default: break;
-                }
-            }
-        }
+    // popcounts over the map's object bitboards (tile walk for unattached grids)
+    const NeighborhoodCounts nearby = ObjectLayers::neighborhood(tileMap, posX, posY);
+    state.nearbyTrees = nearby[ObjectType::Tree];
+    state.nearbyRocks = nearby[ObjectType::Rock];
+    state.nearbyBushes = nearby[ObjectType::Bush];
+
+    // optional wide-radius density, O(log W * log H) per type from the Fenwick trees
+    if (const int radius = getSimulationConfig().densityRadius; radius > 0) {
+        state.treeDensity = ObjectLayers::densityLevel(tileMap, ObjectType::Tree, posX, posY, radius);
+        state.rockDensity = ObjectLayers::densityLevel(tileMap, ObjectType::Rock, posX, posY, radius);
+        state.bushDensity = ObjectLayers::densityLevel(tileMap, ObjectType::Bush, posX, posY, radius);
     }
 
     constexpr int ENERGY_LEVELS = 3;
@@ -111,3 +122,44 @@ State QLearningAgent::extractState(const std::vector<std::vector<std::unique_ptr
 
     return state;
 }
+
+void QLearningAgent::saveSnapshot(AgentSnapshot& out) const {
+    out.learningRate = learningRate;
+    out.discountFactor = discountFactor;
+    out.epsilon = epsilon;
+    std::ostringstream rngState;
+    rngState << rng;
+    out.rngState = rngState.str();
+    out.actionCount = kActionCount;
+    out.states.clear();
+    out.known.clear();
+    out.values.clear();
+    out.states.reserve(QTable.size());
+    out.known.reserve(QTable.size());
+    out.values.reserve(QTable.size() * kActionCount);
+    for (const auto& [state, values] : QTable) {
+        out.states.push_back(state.bits);
+        out.known.push_back(values.known);
+        out.values.insert(out.values.end(), values.q.begin(), values.q.end());
+    }
+}
+
+bool QLearningAgent::restoreSnapshot(const AgentSnapshot& in) {
+    if (in.actionCount != kActionCount || in.known.size() != in.states.size() ||
+        in.values.size() != in.states.size() * kActionCount) {
+        return false;
+    }
+    learningRate = in.learningRate;
+    discountFactor = in.discountFactor;
+    epsilon = in.epsilon;
+    std::istringstream rngState(in.rngState);
+    rngState >> rng;
+    QTable.clear();
+    QTable.reserve(in.states.size());
+    for (size_t i = 0; i < in.states.size(); ++i) {
+        ActionValues& values = QTable[PackedState{in.states[i]}];
+        values.known = in.known[i];
+        std::copy_n(in.values.begin() + i * kActionCount, kActionCount, values.q.begin());
+    }
+    return true;
+}
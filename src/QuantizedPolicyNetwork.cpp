@@ -0,0 +1,163 @@
+#include "QuantizedPolicyNetwork.hpp"
+#include "MLPKernels.hpp"
+#include "debug.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr float kInt8Max = 127.0f;
+
+    float scaleFor(float maxAbs) {
+        return maxAbs > 0.0f ? maxAbs / kInt8Max : 1.0f;
+    }
+}
+
+bool QuantizedPolicyNetwork::quantize(const PolicyNetwork& network, const float* calibrationFeatures, int count) {
+    if (!network.isLoaded() || count <= 0) {
+        getDebugConsole().log("PolicyNetwork", "Cannot quantize without a network and calibration states", LogLevel::Error);
+        return false;
+    }
+
+    const auto& source = network.getLayers();
+    const int inputSize = network.getInputSize();
+
+    // Calibration: largest |activation| seen at every layer input over the recorded states
+    std::vector<float> inputMaxAbs(source.size(), 0.0f);
+    std::vector<float> x(inputSize), y;
+    for (int s = 0; s < count; ++s) {
+        network.normalize(calibrationFeatures + static_cast<size_t>(s) * inputSize, x.data(), inputSize);
+        for (size_t l = 0; l < source.size(); ++l) {
+            const DenseLayer& layer = source[l];
+            for (float v : x) inputMaxAbs[l] = std::max(inputMaxAbs[l], std::fabs(v));
+
+            y.assign(layer.bias.begin(), layer.bias.end());
+            for (int i = 0; i < layer.inputs; ++i) {
+                const float* w = layer.weights.data() + static_cast<size_t>(i) * layer.outputs;
+                for (int o = 0; o < layer.outputs; ++o) y[o] += x[i] * w[o];
+            }
+            if (layer.relu) {
+                for (float& v : y) v = std::max(v, 0.0f);
+            }
+            x.swap(y);
+        }
+    }
+
+    std::vector<QuantizedLayer> quantized(source.size());
+    maxPaddedWidth = MLPKernels::paddedSize(inputSize);
+    for (size_t l = 0; l < source.size(); ++l) {
+        const DenseLayer& layer = source[l];
+        QuantizedLayer& q = quantized[l];
+        q.inputs = layer.inputs;
+        q.outputs = layer.outputs;
+        q.paddedInputs = MLPKernels::paddedSize(layer.inputs);
+        q.paddedOutputs = MLPKernels::paddedSize(layer.outputs);
+        q.relu = layer.relu;
+        q.inputScale = scaleFor(inputMaxAbs[l]);
+        maxPaddedWidth = std::max(maxPaddedWidth, q.paddedOutputs);
+
+        q.weights.assign(static_cast<size_t>(q.paddedInputs) * q.paddedOutputs, 0);
+        q.outputScales.assign(q.paddedOutputs, 0.0f);
+        q.bias.assign(q.paddedOutputs, 0.0f);
+
+        for (int o = 0; o < layer.outputs; ++o) {
+            float maxAbs = 0.0f;
+            for (int i = 0; i < layer.inputs; ++i) {
+                maxAbs = std::max(maxAbs, std::fabs(layer.weights[static_cast<size_t>(i) * layer.outputs + o]));
+            }
+            const float weightScale = scaleFor(maxAbs);
+            q.outputScales[o] = weightScale * q.inputScale;
+            q.bias[o] = layer.bias[o];
+
+            // input pairs interleaved per output: [i / 2][o][i % 2]
+            for (int i = 0; i < layer.inputs; ++i) {
+                const float v = std::nearbyint(layer.weights[static_cast<size_t>(i) * layer.outputs + o] / weightScale);
+                const size_t index = (static_cast<size_t>(i / 2) * q.paddedOutputs + o) * 2 + (i % 2);
+                q.weights[index] = static_cast<int8_t>(std::clamp(v, -kInt8Max, kInt8Max));
+            }
+        }
+    }
+
+    layers = std::move(quantized);
+    featureMean = network.getFeatureMean();
+    featureScale = network.getFeatureScale();
+
+    getDebugConsole().log("PolicyNetwork", "Quantized policy to int8 (" + std::to_string(getWeightBytes()) +
+                        " weight bytes, calibrated on " + std::to_string(count) + " states)");
+    return true;
+}
+
+size_t QuantizedPolicyNetwork::getWeightBytes() const {
+    size_t bytes = 0;
+    for (const auto& layer : layers) bytes += layer.weights.size();
+    return bytes;
+}
+
+void QuantizedPolicyNetwork::forwardBatch(const float* rawFeatures, int batch, float* qValues, Workspace& workspace) const {
+    if (layers.empty() || batch <= 0) return;
+
+    const int inputSize = getInputSize();
+    const size_t bufferSize = static_cast<size_t>(batch) * maxPaddedWidth;
+    if (workspace.activations.size() < bufferSize) workspace.activations.resize(bufferSize);
+    if (workspace.quantized.size() < bufferSize) workspace.quantized.resize(bufferSize);
+
+    float* activations = workspace.activations.data();
+    int8_t* quantized = workspace.quantized.data();
+
+    // Normalized features, zero-padded to the first layer's packed width
+    const int firstPadded = layers.front().paddedInputs;
+    for (int b = 0; b < batch; ++b) {
+        const float* raw = rawFeatures + static_cast<size_t>(b) * inputSize;
+        float* row = activations + static_cast<size_t>(b) * maxPaddedWidth;
+        for (int i = 0; i < inputSize; ++i) row[i] = (raw[i] - featureMean[i]) / featureScale[i];
+        std::fill(row + inputSize, row + firstPadded, 0.0f);
+    }
+
+    // Each layer re-quantizes its float input, then writes float output back into the same buffer
+    for (const auto& layer : layers) {
+        MLPKernels::quantizeRows(activations, maxPaddedWidth, quantized, maxPaddedWidth,
+                                 batch, layer.paddedInputs, 1.0f / layer.inputScale);
+        MLPKernels::denseForwardInt8(layer.weights.data(), layer.outputScales.data(), layer.bias.data(),
+                                     quantized, maxPaddedWidth, activations, maxPaddedWidth,
+                                     batch, layer.paddedInputs, layer.paddedOutputs, layer.relu);
+    }
+
+    const int outputs = getOutputSize();
+    for (int b = 0; b < batch; ++b) {
+        std::copy_n(activations + static_cast<size_t>(b) * maxPaddedWidth, outputs,
+                    qValues + static_cast<size_t>(b) * outputs);
+    }
+}
+
+QuantizedPolicyNetwork::AccuracyReport QuantizedPolicyNetwork::compare(const PolicyNetwork& reference,
+                                                                       const QuantizedPolicyNetwork& quantized,
+                                                                       const float* features, int count) {
+    AccuracyReport report;
+    const int outputs = reference.getOutputSize();
+    if (count <= 0 || outputs != quantized.getOutputSize()) return report;
+
+    std::vector<float> expected(static_cast<size_t>(count) * outputs);
+    std::vector<float> actual(static_cast<size_t>(count) * outputs);
+    PolicyNetwork::Workspace referenceWorkspace;
+    Workspace workspace;
+    reference.forwardBatch(features, count, expected.data(), referenceWorkspace);
+    quantized.forwardBatch(features, count, actual.data(), workspace);
+
+    int agreements = 0;
+    double errorSum = 0.0;
+    for (int s = 0; s < count; ++s) {
+        const float* e = expected.data() + static_cast<size_t>(s) * outputs;
+        const float* a = actual.data() + static_cast<size_t>(s) * outputs;
+        if (PolicyNetwork::argmax(e, outputs) == PolicyNetwork::argmax(a, outputs)) ++agreements;
+        for (int o = 0; o < outputs; ++o) {
+            const float error = std::fabs(e[o] - a[o]);
+            report.maxAbsError = std::max(report.maxAbsError, error);
+            errorSum += error;
+        }
+    }
+
+    report.samples = count;
+    report.actionAgreement = static_cast<float>(agreements) / count;
+    report.meanAbsError = static_cast<float>(errorSum / (static_cast<double>(count) * outputs));
+    return report;
+}
@@ -0,0 +1,193 @@
+#include "ResourceRegrowth.hpp"
+#include "Tile.hpp"
+#include "TextureManager.hpp"
+#include "TimerWheel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+ResourceRegrowth& getResourceRegrowth() {
+    static ResourceRegrowth instance;
+    return instance;
+}
+
+namespace {
+    // resource kind in the low two bits of a timer subject, tile index above
+    uint32_t kindCode(ObjectType type) {
+        switch (type) {
+            case ObjectType::Bush: return 1;
+            case ObjectType::Rock: return 2;
+            default: return 0;
+        }
+    }
+
+    ObjectType kindType(uint32_t code) {
+        return code == 1 ? ObjectType::Bush : code == 2 ? ObjectType::Rock : ObjectType::Tree;
+    }
+}
+
+float ResourceRegrowth::spawnChanceFor(float noiseValue) {
+    if (noiseValue < 0.1f) return 0.0f;                                       // flowers
+    if (noiseValue < 0.6f) return 1.0f - 0.6f * std::abs(noiseValue - 0.35f) / 0.25f; // 0.4 .. 1
+    return std::clamp(0.5f + 0.5f * (noiseValue - 0.6f) / 0.4f, 0.5f, 1.0f);  // stone
+}
+
+ResourceRegrowth::Biome ResourceRegrowth::biomeFor(ObjectType type) {
+    switch (type) {
+        case ObjectType::Tree:
+        case ObjectType::Bush: return Biome::Grass;
+        case ObjectType::Rock: return Biome::Stone;
+        default: return Biome::None;
+    }
+}
+
+void ResourceRegrowth::attach(TileGrid& grid, std::vector<float> spawnChances, uint32_t channel) {
+    detach();
+    tileMap = &grid;
+    timerChannel = channel;
+    height = static_cast<int>(grid.size());
+    width = grid.empty() ? 0 : static_cast<int>(grid[0].size());
+    const size_t tiles = static_cast<size_t>(width) * height;
+
+    spawnChance = std::move(spawnChances);
+    spawnChance.resize(tiles, 1.0f);
+    biomes.assign(tiles, static_cast<uint8_t>(Biome::None));
+    freeSlot.assign(tiles, kNotFree);
+    indexArea(0, 0, width - 1, height - 1);
+
+    // looked up once per map instead of on every spawn
+    auto& textureManager = TextureManager::getInstance();
+    treeTextures = {&textureManager.getTexture("tree1", "../assets/objects/tree1.png"),
+                    &textureManager.getTexture("tree2", "../assets/objects/tree2.png"),
+                    &textureManager.getTexture("tree3", "../assets/objects/tree3.png")};
+    bushTextures = {&textureManager.getTexture("bush1", "../assets/objects/bush1.png"),
+                    &textureManager.getTexture("bush2", "../assets/objects/bush2.png")};
+    rockTextures = {&textureManager.getTexture("rock1", "../assets/objects/rock1.png"),
+                    &textureManager.getTexture("rock2", "../assets/objects/rock2.png"),
+                    &textureManager.getTexture("rock3", "../assets/objects/rock3.png")};
+}
+
+void ResourceRegrowth::indexArea(int x0, int y0, int x1, int y1) {
+    if (!tileMap) return;
+    for (int y = std::max(y0, 0); y <= y1 && y < height; ++y) {
+        const auto& row = (*tileMap)[y];
+        for (int x = std::max(x0, 0); x <= x1 && x < width && x < static_cast<int>(row.size()); ++x) {
+            const Tile* tile = row[x].get();
+            if (!tile) continue; // indexed once it is built
+            Biome biome = Biome::None;
+            if (dynamic_cast<const GrassTile*>(tile)) biome = Biome::Grass;
+            else if (dynamic_cast<const StoneTile*>(tile)) biome = Biome::Stone;
+            const uint32_t index = static_cast<uint32_t>(y * width + x);
+            biomes[index] = static_cast<uint8_t>(biome);
+            if (tile->hasObject()) markTaken(index);
+            else markFree(index);
+        }
+    }
+}
+
+void ResourceRegrowth::detach() {
+    tileMap = nullptr;
+    width = height = 0;
+    biomes.clear();
+    spawnChance.clear();
+    freeSlot.clear();
+    for (auto& list : freeTiles) list.clear();
+    pending = 0;
+    spawned = 0;
+}
+
+void ResourceRegrowth::markFree(uint32_t tile) {
+    if (freeSlot[tile] != kNotFree || biomes[tile] == static_cast<uint8_t>(Biome::None)) return;
+    auto& list = freeTiles[biomes[tile]];
+    freeSlot[tile] = static_cast<uint32_t>(list.size());
+    list.push_back(tile);
+}
+
+void ResourceRegrowth::markTaken(uint32_t tile) {
+    const uint32_t slot = freeSlot[tile];
+    if (slot == kNotFree) return;
+    auto& list = freeTiles[biomes[tile]];
+    list[slot] = list.back(); // swap-remove keeps the index O(1)
+    freeSlot[list[slot]] = slot;
+    list.pop_back();
+    freeSlot[tile] = kNotFree;
+}
+
+std::string ResourceRegrowth::getRngState() const {
+    std::ostringstream state;
+    state << rng;
+    return state.str();
+}
+
+void ResourceRegrowth::setRngState(const std::string& state) {
+    if (state.empty()) return;
+    std::istringstream in(state);
+    in >> rng;
+}
+
+float ResourceRegrowth::regrowthDelay(ObjectType type) {
+    const float base = type == ObjectType::Rock ? 35.0f : type == ObjectType::Bush ? 12.0f : 20.0f;
+    return base * std::uniform_real_distribution<float>(0.75f, 1.25f)(rng);
+}
+
+void ResourceRegrowth::harvested(const Tile& tile, ObjectType type) {
+    if (!tileMap || biomeFor(type) == Biome::None) return;
+    const int x = tile.getGridX(), y = tile.getGridY();
+    if (x < 0 || x >= width || y < 0 || y >= height) return;
+
+    const uint32_t index = static_cast<uint32_t>(y * width + x);
+    if (!tile.hasObject()) markFree(index);
+    getSimulationTimers().schedule(regrowthDelay(type), timerChannel, index << 2 | kindCode(type));
+    ++pending;
+}
+
+bool ResourceRegrowth::spawn(uint32_t index, ObjectType type) {
+    Tile& tile = *(*tileMap)[index / width][index % width];
+    const auto& textures = type == ObjectType::Rock ? rockTextures : type == ObjectType::Bush ? bushTextures : treeTextures;
+    const uint8_t variant = static_cast<uint8_t>(rng() % textures.size());
+    std::unique_ptr<Object> object;
+    if (type == ObjectType::Rock) object = std::make_unique<Rock>(*textures[variant]);
+    else if (type == ObjectType::Bush) object = std::make_unique<Bush>(*textures[variant]);
+    else object = std::make_unique<Tree>(*textures[variant]);
+    object->setVariant(variant); // before placing: the world chunk records it on placement
+    tile.placeObject(std::move(object));
+    markTaken(index);
+    ++spawned;
+    return true;
+}
+
+bool ResourceRegrowth::regrow(uint32_t subject) {
+    if (!tileMap) return false;
+    if (pending > 0) --pending;
+    const uint32_t origin = subject >> 2;
+    const ObjectType type = kindType(subject & 3u);
+    const auto biome = static_cast<uint8_t>(biomeFor(type));
+    if (origin >= biomes.size()) return false;
+
+    std::uniform_real_distribution<float> roll(0.0f, 1.0f);
+    auto& candidates = freeTiles[biome];
+    for (int attempt = 0; attempt < kSpawnTries; ++attempt) {
+        // the harvested tile first, then random free tiles of the biome
+        uint32_t tile;
+        if (attempt == 0 && biomes[origin] == biome && freeSlot[origin] != kNotFree) {
+            tile = origin;
+        } else if (!candidates.empty()) {
+            tile = candidates[rng() % candidates.size()];
+        } else {
+            break;
+        }
+        const Tile* candidate = (*tileMap)[tile / width][tile % width].get();
+        if (!candidate) continue; // its chunk is not resident; the tile stays indexed
+        if (candidate->hasObject()) { // taken by something else since
+            markTaken(tile);
+            continue;
+        }
+        if (roll(rng) < spawnChance[tile]) return spawn(tile, type);
+    }
+
+    // nothing grew this time; try again later so harvested resources eventually return
+    getSimulationTimers().schedule(regrowthDelay(type), timerChannel, subject);
+    ++pending;
+    return false;
+}
@@ -0,0 +1,238 @@
+#include "SessionProcessor.hpp"
+#include "ExperienceCodec.hpp"
+#include "ExperienceDataset.hpp"
+#include "JobSystem.hpp"
+#include "debug.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <unordered_set>
+
+namespace {
+    uint64_t mix(uint64_t hash, uint64_t value) {
+        hash ^= value + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+        return hash;
+    }
+
+    // Hash of a whole transition row (both states, action, reward bits, done flag)
+    uint64_t rowHash(const NumpyIO::ExperienceColumns& columns, size_t row) {
+        uint64_t hash = 0;
+        const size_t offset = row * NumpyIO::kStateColumns;
+        for (int i = 0; i < NumpyIO::kStateColumns; ++i) {
+            hash = mix(hash, static_cast<uint32_t>(columns.states[offset + i]));
+            hash = mix(hash, static_cast<uint32_t>(columns.nextStates[offset + i]) << 1);
+        }
+        uint32_t rewardBits;
+        std::memcpy(&rewardBits, &columns.rewards[row], sizeof(rewardBits));
+        hash = mix(hash, static_cast<uint32_t>(columns.actions[row]));
+        hash = mix(hash, rewardBits);
+        return mix(hash, columns.dones[row]);
+    }
+
+    bool rowsEqual(const NumpyIO::ExperienceColumns& columns, size_t a, size_t b) {
+        const auto stateA = columns.states.begin() + a * NumpyIO::kStateColumns;
+        const auto stateB = columns.states.begin() + b * NumpyIO::kStateColumns;
+        const auto nextA = columns.nextStates.begin() + a * NumpyIO::kStateColumns;
+        const auto nextB = columns.nextStates.begin() + b * NumpyIO::kStateColumns;
+        return columns.actions[a] == columns.actions[b] &&
+               std::memcmp(&columns.rewards[a], &columns.rewards[b], sizeof(float)) == 0 &&
+               columns.dones[a] == columns.dones[b] &&
+               std::equal(stateA, stateA + NumpyIO::kStateColumns, stateB) &&
+               std::equal(nextA, nextA + NumpyIO::kStateColumns, nextB);
+    }
+}
+
+SessionProcessor::SessionProcessor(const SessionProcessorOptions& processorOptions)
+    : options(processorOptions) {
+}
+
+bool SessionProcessor::accepts(int action, float reward) const {
+    if (reward < options.minReward || reward > options.maxReward) return false;
+    return options.actions.empty() ||
+           std::find(options.actions.begin(), options.actions.end(), action) != options.actions.end();
+}
+
+std::vector<std::string> SessionProcessor::listInputFiles() const {
+    namespace fs = std::filesystem;
+    std::vector<std::string> files;
+    for (const auto& input : options.inputs) {
+        std::error_code error;
+        if (!fs::is_directory(input, error)) {
+            files.push_back(input);
+            continue;
+        }
+        // one file per batch: the compact segment, else the .npz, else the legacy JSON
+        auto hasTwin = [](fs::path path, const char* extension) {
+            return fs::exists(path.replace_extension(extension));
+        };
+        for (const auto& entry : fs::directory_iterator(input, error)) {
+            if (!entry.is_regular_file()) continue;
+            const fs::path& path = entry.path();
+            if (path.extension() == ".msx" ||
+                (path.extension() == ".npz" && !hasTwin(path, ".msx")) ||
+                (path.extension() == ".json" && !hasTwin(path, ".msx") && !hasTwin(path, ".npz"))) {
+                files.push_back(path.string());
+            }
+        }
+    }
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+    return files;
+}
+
+bool SessionProcessor::loadFile(const std::string& path, NumpyIO::ExperienceColumns& out, size_t& read) const {
+    const auto extension = std::filesystem::path(path).extension();
+    if (extension == ".msx") {
+        ExperienceCodec::Block block;
+        const bool ok = ExperienceCodec::readFile(path, block);
+        read = block.records.size();
+        for (const auto& record : block.records) {
+            if (accepts(record.action, record.reward)) {
+                out.append(unpackExperienceState(record.state), static_cast<ActionType>(record.action), record.reward,
+                           unpackExperienceState(record.nextState), record.done != 0);
+            }
+        }
+        return ok;
+    }
+
+    if (extension == ".npz") {
+        ExperienceDataset dataset;
+        if (!dataset.addFile(path)) return false;
+
+        NumpyIO::ExperienceColumns rows;
+        dataset.fetch(size_t{0}, dataset.size(), rows);
+        read = rows.size();
+        out.reserve(rows.size());
+        for (size_t row = 0; row < rows.size(); ++row) {
+            if (accepts(rows.actions[row], rows.rewards[row])) out.appendRow(rows, row);
+        }
+        return true;
+    }
+
+    return streamExperienceJson(path, [&](const ExperienceData& exp) {
+        read++;
+        if (accepts(static_cast<int>(exp.action), exp.reward)) {
+            out.append(exp.state, exp.action, exp.reward, exp.nextState, exp.done);
+        }
+    });
+}
+
+bool SessionProcessor::merge(NumpyIO::ExperienceColumns& merged) {
+    report = SessionProcessorReport();
+    const std::vector<std::string> files = listInputFiles();
+    report.files = files.size();
+    if (files.empty()) {
+        getDebugConsole().log("SessionProcessor", "No session batches found", LogLevel::Error);
+        return false;
+    }
+
+    // one job per file; results are merged in file order so output stays deterministic
+    std::vector<NumpyIO::ExperienceColumns> perFile(files.size());
+    std::vector<size_t> readCounts(files.size(), 0);
+    std::vector<char> loaded(files.size(), 0);
+    auto load = [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) loaded[i] = loadFile(files[i], perFile[i], readCounts[i]);
+    };
+
+    // an explicit thread count gets its own pool (the caller counts as one thread)
+    if (options.threads == 1) {
+        load(0, files.size());
+    } else if (options.threads > 1) {
+        JobSystem pool(options.threads - 1);
+        pool.parallelFor(0, files.size(), 1, load);
+    } else {
+        getJobSystem().parallelFor(0, files.size(), 1, load);
+    }
+
+    size_t kept = 0;
+    for (const auto& columns : perFile) kept += columns.size();
+    merged.clear();
+    merged.reserve(kept);
+
+    auto hash = [&merged](size_t row) { return static_cast<size_t>(rowHash(merged, row)); };
+    auto equal = [&merged](size_t a, size_t b) { return rowsEqual(merged, a, b); };
+    std::unordered_set<size_t, decltype(hash), decltype(equal)> seen(options.dedup ? kept : 0, hash, equal);
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        report.read += readCounts[i];
+        report.filtered += readCounts[i] - perFile[i].size();
+        if (!loaded[i]) {
+            report.failedFiles++;
+            getDebugConsole().log("SessionProcessor", "Failed to read batch: " + files[i], LogLevel::Warning);
+        }
+
+        NumpyIO::ExperienceColumns& columns = perFile[i];
+        for (size_t row = 0; row < columns.size(); ++row) {
+            merged.appendRow(columns, row);
+            if (options.dedup && !seen.insert(merged.size() - 1).second) {
+                report.duplicates++;
+                merged.states.resize(merged.states.size() - NumpyIO::kStateColumns);
+                merged.nextStates.resize(merged.nextStates.size() - NumpyIO::kStateColumns);
+                merged.actions.pop_back();
+                merged.rewards.pop_back();
+                merged.dones.pop_back();
+            }
+        }
+        columns = NumpyIO::ExperienceColumns(); // release as we go
+    }
+
+    if (!merged.rewards.empty()) {
+        report.rewardMean = std::accumulate(merged.rewards.begin(), merged.rewards.end(), 0.0) / merged.size();
+    }
+    return report.failedFiles < report.files;
+}
+
+bool SessionProcessor::writeSplit(const std::string& suffix, const NumpyIO::ExperienceColumns& merged,
+                                  const std::vector<size_t>& order, size_t first, size_t count) const {
+    NumpyIO::ExperienceColumns split;
+    split.reserve(count);
+    for (size_t i = first; i < first + count; ++i) split.appendRow(merged, order[i]);
+
+    const std::string path = options.outputPrefix + suffix;
+    if (!NumpyIO::writeExperienceNpz(path, split)) {
+        getDebugConsole().log("SessionProcessor", "Failed to write " + path, LogLevel::Error);
+        return false;
+    }
+    return true;
+}
+
+bool SessionProcessor::run() {
+    if (options.validationFraction < 0.0f || options.testFraction < 0.0f ||
+        options.validationFraction + options.testFraction > 1.0f) {
+        getDebugConsole().log("SessionProcessor", "Invalid split fractions", LogLevel::Error);
+        return false;
+    }
+
+    NumpyIO::ExperienceColumns merged;
+    if (!merge(merged)) return false;
+
+    std::vector<size_t> order(merged.size());
+    std::iota(order.begin(), order.end(), 0);
+    if (options.shuffle) {
+        std::mt19937 rng(options.seed);
+        std::shuffle(order.begin(), order.end(), rng);
+    }
+
+    const size_t total = merged.size();
+    report.test = static_cast<size_t>(std::llround(total * static_cast<double>(options.testFraction)));
+    report.validation = std::min(total - report.test,
+                                 static_cast<size_t>(std::llround(total * static_cast<double>(options.validationFraction))));
+    report.train = total - report.validation - report.test;
+
+    std::error_code error;
+    const auto parent = std::filesystem::path(options.outputPrefix).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent, error);
+
+    bool ok = writeSplit("_train.npz", merged, order, 0, report.train);
+    if (report.validation > 0) {
+        ok = writeSplit("_val.npz", merged, order, report.train, report.validation) && ok;
+    }
+    if (report.test > 0) {
+        ok = writeSplit("_test.npz", merged, order, report.train + report.validation, report.test) && ok;
+    }
+    return ok;
+}
@@ -0,0 +1,495 @@
+#include "SimulationSnapshot.hpp"
+#include "ExperienceDataset.hpp"
+#include "debug.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+
+namespace {
+    constexpr char kMagic[4] = {'M', 'S', 'S', 'S'};
+
+    constexpr uint32_t tag(const char (&name)[5]) {
+        return static_cast<uint32_t>(name[0]) | static_cast<uint32_t>(name[1]) << 8 |
+               static_cast<uint32_t>(name[2]) << 16 | static_cast<uint32_t>(name[3]) << 24;
+    }
+    constexpr uint32_t kWorldSection = tag("WRLD");
+    constexpr uint32_t kHouseSection = tag("HOUS");
+    constexpr uint32_t kNpcSection = tag("NPCS");
+    constexpr uint32_t kMarketSection = tag("MRKT");
+    constexpr uint32_t kClockSection = tag("CLCK");
+    constexpr uint32_t kRandomSection = tag("RNGS");
+    constexpr uint32_t kStatsSection = tag("STAT");
+
+    constexpr uint32_t kMaxCount = 1u << 28; // sanity bound for corrupt files
+
+    // Appends fixed-width values in host order (the formats in this repo assume little-endian)
+    class ByteWriter {
+    public:
+        std::vector<uint8_t> bytes;
+
+        template <typename T>
+        void put(const T& value) {
+            static_assert(std::is_trivially_copyable<T>::value, "plain values only");
+            const auto* raw = reinterpret_cast<const uint8_t*>(&value);
+            bytes.insert(bytes.end(), raw, raw + sizeof(T));
+        }
+        void putBool(bool value) { put(static_cast<uint8_t>(value ? 1 : 0)); }
+        void putString(const std::string& value) {
+            put(static_cast<uint32_t>(value.size()));
+            bytes.insert(bytes.end(), value.begin(), value.end());
+        }
+        template <typename T>
+        void putArray(const std::vector<T>& values) {
+            put(static_cast<uint32_t>(values.size()));
+            const auto* raw = reinterpret_cast<const uint8_t*>(values.data());
+            bytes.insert(bytes.end(), raw, raw + values.size() * sizeof(T));
+        }
+        void putCounts(const SnapshotCounts& counts) {
+            put(static_cast<uint32_t>(counts.size()));
+            for (const auto& [name, count] : counts) {
+                putString(name);
+                put(count);
+            }
+        }
+        template <typename A, typename B>
+        void putPairs(const std::vector<std::pair<A, B>>& pairs) {
+            put(static_cast<uint32_t>(pairs.size()));
+            for (const auto& [a, b] : pairs) {
+                put(a);
+                put(b);
+            }
+        }
+
+        size_t beginSection(uint32_t sectionTag) {
+            put(sectionTag);
+            put(uint64_t{0});
+            return bytes.size();
+        }
+        void endSection(size_t start) {
+            const uint64_t length = bytes.size() - start;
+            std::memcpy(bytes.data() + start - sizeof(uint64_t), &length, sizeof(length));
+        }
+    };
+
+    // Bounds-checked reads over a mapped buffer; any overrun clears `ok` and yields zeros
+    class ByteReader {
+    public:
+        const char* at;
+        const char* end;
+        bool ok = true;
+
+        ByteReader(const char* begin, size_t length) : at(begin), end(begin + length) {}
+
+        bool has(size_t count) {
+            if (ok && static_cast<size_t>(end - at) >= count) return true;
+            ok = false;
+            return false;
+        }
+        template <typename T>
+        T get() {
+            T value{};
+            if (has(sizeof(T))) {
+                std::memcpy(&value, at, sizeof(T));
+                at += sizeof(T);
+            }
+            return value;
+        }
+        bool getBool() { return get<uint8_t>() != 0; }
+        // element count, rejected when `itemBytes` per element could not fit in what is left
+        uint32_t getCount(size_t itemBytes = 0) {
+            const uint32_t count = get<uint32_t>();
+            if (count > kMaxCount || count * itemBytes > static_cast<size_t>(end - at)) ok = false;
+            return ok ? count : 0;
+        }
+        std::string getString() {
+            const uint32_t length = getCount();
+            if (!has(length)) return {};
+            std::string value(at, length);
+            at += length;
+            return value;
+        }
+        template <typename T>
+        void getArray(std::vector<T>& values) {
+            const uint32_t count = getCount();
+            if (!has(static_cast<size_t>(count) * sizeof(T))) return;
+            values.resize(count);
+            std::memcpy(values.data(), at, static_cast<size_t>(count) * sizeof(T));
+            at += static_cast<size_t>(count) * sizeof(T);
+        }
+        void getCounts(SnapshotCounts& counts) {
+            const uint32_t count = getCount();
+            counts.clear();
+            for (uint32_t i = 0; i < count && ok; ++i) {
+                std::string name = getString();
+                counts.emplace_back(std::move(name), get<int32_t>());
+            }
+        }
+        template <typename A, typename B>
+        void getPairs(std::vector<std::pair<A, B>>& pairs) {
+            const uint32_t count = getCount();
+            pairs.clear();
+            for (uint32_t i = 0; i < count && ok; ++i) {
+                const A a = get<A>();
+                pairs.emplace_back(a, get<B>());
+            }
+        }
+    };
+
+    void putAgent(ByteWriter& out, const AgentSnapshot& agent) {
+        out.put(agent.learningRate);
+        out.put(agent.discountFactor);
+        out.put(agent.epsilon);
+        out.putString(agent.rngState);
+        out.put(agent.actionCount);
+        out.putArray(agent.states);
+        out.putArray(agent.known);
+        out.putArray(agent.values);
+    }
+
+    void getAgent(ByteReader& in, AgentSnapshot& agent) {
+        agent.learningRate = in.get<float>();
+        agent.discountFactor = in.get<float>();
+        agent.epsilon = in.get<float>();
+        agent.rngState = in.getString();
+        agent.actionCount = in.get<uint32_t>();
+        in.getArray(agent.states);
+        in.getArray(agent.known);
+        in.getArray(agent.values);
+        if (agent.known.size() != agent.states.size() ||
+            agent.values.size() != agent.states.size() * static_cast<size_t>(agent.actionCount)) {
+            in.ok = false;
+        }
+    }
+
+    void putMarket(ByteWriter& out, const MarketSnapshot& market) {
+        out.put(market.x);
+        out.put(market.y);
+        out.put(market.buyMargin);
+        out.put(market.sellMargin);
+        out.put(static_cast<uint32_t>(market.items.size()));
+        for (const auto& item : market.items) {
+            out.putString(item.item);
+            out.put(item.price);
+            out.put(item.demand);
+            out.put(item.supply);
+            out.put(item.buyTransactions);
+            out.put(item.sellTransactions);
+            out.put(item.revenue);
+            out.put(item.expenditure);
+            out.putArray(item.history);
+        }
+    }
+
+    void getMarket(ByteReader& in, MarketSnapshot& market) {
+        market.x = in.get<int32_t>();
+        market.y = in.get<int32_t>();
+        market.buyMargin = in.get<float>();
+        market.sellMargin = in.get<float>();
+        market.items.resize(in.getCount(36));
+        for (auto& item : market.items) {
+            item.item = in.getString();
+            item.price = in.get<float>();
+            item.demand = in.get<int32_t>();
+            item.supply = in.get<int32_t>();
+            item.buyTransactions = in.get<int32_t>();
+            item.sellTransactions = in.get<int32_t>();
+            item.revenue = in.get<float>();
+            item.expenditure = in.get<float>();
+            in.getArray(item.history);
+        }
+    }
+}
+
+std::vector<uint8_t> SimulationSnapshot::encode() const {
+    ByteWriter out;
+    out.bytes.insert(out.bytes.end(), kMagic, kMagic + sizeof(kMagic));
+    out.put(kVersion);
+
+    size_t section = out.beginSection(kWorldSection);
+    out.put(worldWidth);
+    out.put(worldHeight);
+    out.put(worldSeed);
+    out.put(worldFrequency);
+    out.put(static_cast<uint32_t>(chunks.size()));
+    for (const auto& chunk : chunks) {
+        out.put(chunk.cx);
+        out.put(chunk.cy);
+        out.putBool(chunk.resident);
+        out.putArray(chunk.bytes);
+    }
+    out.endSection(section);
+
+    section = out.beginSection(kHouseSection);
+    out.put(static_cast<uint32_t>(houses.size()));
+    for (const auto& house : houses) {
+        out.put(house.x);
+        out.put(house.y);
+        out.put(house.level);
+        out.put(house.maxStorageCapacity);
+        out.put(house.energyRegenRate);
+        out.put(house.healthBonus);
+        out.put(house.strengthBonus);
+        out.put(house.speedBonus);
+        out.putCounts(house.storage);
+        out.putPairs(house.lastRegenTime);
+        out.putPairs(house.regenCount);
+    }
+    out.endSection(section);
+
+    section = out.beginSection(kNpcSection);
+    out.put(static_cast<uint32_t>(npcs.size()));
+    for (const auto& npc : npcs) {
+        out.putString(npc.name);
+        for (float value : {npc.health, npc.hunger, npc.energy, npc.speed, npc.strength, npc.money, npc.x, npc.y}) out.put(value);
+        out.putBool(npc.dead);
+        out.put(npc.state);
+        out.put(npc.currentAction);
+        out.put(npc.lastAction);
+        out.put(npc.targetX);
+        out.put(npc.targetY);
+        out.put(npc.inventoryCapacity);
+        out.put(npc.baseSpeed);
+        out.put(npc.currentSpeed);
+        out.put(npc.currentReward);
+        out.put(npc.currentPenalty);
+        out.put(npc.actionCooldown);
+        out.put(npc.wakeTimer);
+        out.put(npc.totalItemsGathered);
+        out.putCounts(npc.inventory);
+        out.putCounts(npc.itemsGatheredByType);
+        out.putBool(npc.useQLearning);
+        out.putBool(npc.useTensorFlow);
+        putAgent(out, npc.agent);
+    }
+    out.endSection(section);
+
+    section = out.beginSection(kMarketSection);
+    out.put(static_cast<uint32_t>(markets.size()));
+    for (const auto& market : markets) putMarket(out, market);
+    out.endSection(section);
+
+    section = out.beginSection(kClockSection);
+    out.put(elapsedTime);
+    out.put(day);
+    out.put(societyIteration);
+    out.put(simulationSpeed);
+    out.put(timerTick);
+    out.put(timerCarry);
+    out.putArray(timers);
+    out.endSection(section);
+
+    section = out.beginSection(kRandomSection);
+    out.put(randSeed);
+    out.putString(regrowthRngState);
+    out.endSection(section);
+
+    section = out.beginSection(kStatsSection);
+    out.put(moneySpent);
+    out.put(moneyEarned);
+    out.putArray(persistentStats);
+    out.endSection(section);
+    return std::move(out.bytes);
+}
+
+bool SimulationSnapshot::decode(const char* bytes, size_t length) {
+    ByteReader header(bytes, length);
+    if (!header.has(sizeof(kMagic)) || std::memcmp(bytes, kMagic, sizeof(kMagic)) != 0) return false;
+    header.at += sizeof(kMagic);
+    const uint32_t version = header.get<uint32_t>();
+    if (!header.ok || version != kVersion) return false; // older layouts are not read
+
+    *this = SimulationSnapshot{};
+    while (header.ok && header.at < header.end) {
+        const uint32_t sectionTag = header.get<uint32_t>();
+        const uint64_t sectionLength = header.get<uint64_t>();
+        if (!header.has(sectionLength)) return false;
+        ByteReader in(header.at, sectionLength);
+        header.at += sectionLength;
+
+        if (sectionTag == kWorldSection) {
+            worldWidth = in.get<int32_t>();
+            worldHeight = in.get<int32_t>();
+            worldSeed = in.get<int32_t>();
+            worldFrequency = in.get<float>();
+            chunks.resize(in.getCount(13));
+            for (auto& chunk : chunks) {
+                chunk.cx = in.get<int32_t>();
+                chunk.cy = in.get<int32_t>();
+                chunk.resident = in.getBool();
+                in.getArray(chunk.bytes);
+            }
+        } else if (sectionTag == kHouseSection) {
+            houses.resize(in.getCount(44));
+            for (auto& house : houses) {
+                house.x = in.get<int32_t>();
+                house.y = in.get<int32_t>();
+                house.level = in.get<int32_t>();
+                house.maxStorageCapacity = in.get<int32_t>();
+                house.energyRegenRate = in.get<float>();
+                house.healthBonus = in.get<int32_t>();
+                house.strengthBonus = in.get<int32_t>();
+                house.speedBonus = in.get<int32_t>();
+                in.getCounts(house.storage);
+                in.getPairs(house.lastRegenTime);
+                in.getPairs(house.regenCount);
+            }
+        } else if (sectionTag == kNpcSection) {
+            npcs.resize(in.getCount(64));
+            for (auto& npc : npcs) {
+                if (!in.ok) break;
+                npc.name = in.getString();
+                for (float* value : {&npc.health, &npc.hunger, &npc.energy, &npc.speed, &npc.strength, &npc.money, &npc.x, &npc.y}) {
+                    *value = in.get<float>();
+                }
+                npc.dead = in.getBool();
+                npc.state = in.get<uint8_t>();
+                npc.currentAction = in.get<uint8_t>();
+                npc.lastAction = in.get<uint8_t>();
+                npc.targetX = in.get<int32_t>();
+                npc.targetY = in.get<int32_t>();
+                npc.inventoryCapacity = in.get<int32_t>();
+                npc.baseSpeed = in.get<float>();
+                npc.currentSpeed = in.get<float>();
+                npc.currentReward = in.get<int32_t>();
+                npc.currentPenalty = in.get<int32_t>();
+                npc.actionCooldown = in.get<float>();
+                npc.wakeTimer = in.get<uint64_t>();
+                npc.totalItemsGathered = in.get<int32_t>();
+                in.getCounts(npc.inventory);
+                in.getCounts(npc.itemsGatheredByType);
+                npc.useQLearning = in.getBool();
+                npc.useTensorFlow = in.getBool();
+                getAgent(in, npc.agent);
+            }
+        } else if (sectionTag == kMarketSection) {
+            markets.resize(in.getCount(20));
+            for (auto& market : markets) {
+                if (!in.ok) break;
+                getMarket(in, market);
+            }
+        } else if (sectionTag == kClockSection) {
+            elapsedTime = in.get<float>();
+            day = in.get<int32_t>();
+            societyIteration = in.get<int32_t>();
+            simulationSpeed = in.get<float>();
+            timerTick = in.get<uint64_t>();
+            timerCarry = in.get<float>();
+            in.getArray(timers);
+        } else if (sectionTag == kRandomSection) {
+            randSeed = in.get<uint32_t>();
+            regrowthRngState = in.getString();
+        } else if (sectionTag == kStatsSection) {
+            moneySpent = in.get<int32_t>();
+            moneyEarned = in.get<int32_t>();
+            in.getArray(persistentStats);
+        } // other tags come from newer writers: skipped
+
+        if (!in.ok) return false;
+    }
+    return header.ok && worldWidth >= 0 && worldHeight >= 0;
+}
+
+bool SimulationSnapshot::saveToFile(const std::string& path) const {
+    const std::vector<uint8_t> bytes = encode();
+    const std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    if (!directory.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+    }
+
+    // write aside and rename, so the last good snapshot survives a crash mid-write
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+            getDebugConsole().log("Snapshot", "Failed to write snapshot: " + temporary, LogLevel::Error);
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        getDebugConsole().log("Snapshot", "Failed to move snapshot into place: " + path, LogLevel::Error);
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool SimulationSnapshot::loadFromFile(const std::string& path) {
+    MappedFile file;
+    if (!file.open(path)) {
+        getDebugConsole().log("Snapshot", "Snapshot not found: " + path, LogLevel::Error);
+        return false;
+    }
+    if (!decode(file.data(), file.size())) {
+        getDebugConsole().log("Snapshot", "Invalid or unsupported snapshot: " + path, LogLevel::Error);
+        return false;
+    }
+    return true;
+}
+
+SnapshotWriter::SnapshotWriter()
+    : worker(&SnapshotWriter::workerLoop, this) {
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    if (worker.joinable()) worker.join(); // worker drains the queue before exiting
+}
+
+void SnapshotWriter::submit(std::shared_ptr<const SimulationSnapshot> snapshot, const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        auto queued = std::find_if(queue.begin(), queue.end(), [&path](const Job& job) { return job.path == path; });
+        if (queued != queue.end()) queued->snapshot = std::move(snapshot); // only the newest matters
+        else queue.push_back({std::move(snapshot), path});
+    }
+    workAvailable.notify_one();
+}
+
+void SnapshotWriter::flush() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueDrained.wait(lock, [this] { return queue.empty() && !busy; });
+}
+
+size_t SnapshotWriter::getWrittenCount() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return written;
+}
+
+size_t SnapshotWriter::getFailedCount() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return failed;
+}
+
+void SnapshotWriter::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            workAvailable.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return; // stopping and drained
+            job = std::move(queue.front());
+            queue.pop_front();
+            busy = true;
+        }
+
+        const bool ok = job.snapshot && job.snapshot->saveToFile(job.path);
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            busy = false;
+            ++(ok ? written : failed);
+        }
+        queueDrained.notify_all();
+    }
+}
@@ -0,0 +1,115 @@
+#include "SpatialHash.hpp"
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+SpatialHash::SpatialHash(float cellSize, float worldWidth, float worldHeight) {
+    resize(cellSize, worldWidth, worldHeight);
+}
+
+void SpatialHash::resize(float newCellSize, float worldWidth, float worldHeight) {
+    cellSize = std::max(newCellSize, 1.0f);
+    invCellSize = 1.0f / cellSize;
+    columns = std::max(1, static_cast<int>(std::ceil(worldWidth * invCellSize)));
+    rows = std::max(1, static_cast<int>(std::ceil(worldHeight * invCellSize)));
+    cellStart.assign(static_cast<size_t>(columns) * rows + 1, 0);
+    entries.clear();
+    points.clear();
+}
+
+int SpatialHash::cellX(float x) const {
+    return std::clamp(static_cast<int>(std::floor(x * invCellSize)), 0, columns - 1);
+}
+
+int SpatialHash::cellY(float y) const {
+    return std::clamp(static_cast<int>(std::floor(y * invCellSize)), 0, rows - 1);
+}
+
+void SpatialHash::rebuild(const sf::Vector2f* positions, size_t count) {
+    points.assign(positions, positions + count);
+    pointCell.resize(count);
+    entries.resize(count);
+    if (cellStart.size() != static_cast<size_t>(columns) * rows + 1) {
+        cellStart.assign(static_cast<size_t>(columns) * rows + 1, 0);
+    } else {
+        std::fill(cellStart.begin(), cellStart.end(), 0);
+    }
+
+    // counting sort: per-cell counts, prefix sums, then scatter
+    for (size_t i = 0; i < count; ++i) {
+        pointCell[i] = static_cast<uint32_t>(cellY(points[i].y) * columns + cellX(points[i].x));
+        ++cellStart[pointCell[i] + 1];
+    }
+    for (size_t c = 1; c < cellStart.size(); ++c) cellStart[c] += cellStart[c - 1];
+    for (size_t i = 0; i < count; ++i) {
+        entries[cellStart[pointCell[i]]++] = static_cast<uint32_t>(i);
+    }
+    // the scatter advanced every start to the next cell's start; shift back
+    for (size_t c = cellStart.size() - 1; c > 0; --c) cellStart[c] = cellStart[c - 1];
+    cellStart[0] = 0;
+}
+
+size_t SpatialHash::queryRadius(sf::Vector2f center, float radius, std::vector<uint32_t>& out, uint32_t exclude) const {
+    out.clear();
+    forEachInRadius(center, radius, [&](uint32_t index, float) {
+        if (index != exclude) out.push_back(index);
+    });
+    return out.size();
+}
+
+size_t SpatialHash::kNearest(sf::Vector2f center, size_t k, float maxRadius, std::vector<uint32_t>& out,
+                             uint32_t exclude) const {
+    out.clear();
+    if (k == 0) return 0;
+
+    struct Candidate {
+        float distanceSquared;
+        uint32_t index;
+    };
+    size_t count = 0;
+    forEachInRadius(center, maxRadius, [&](uint32_t index, float) { count += index != exclude; });
+
+    ScratchArena& arena = ScratchArena::local();
+    const ScratchArena::Mark mark = arena.mark();
+    Candidate* candidates = arena.allocate<Candidate>(count);
+    size_t filled = 0;
+    forEachInRadius(center, maxRadius, [&](uint32_t index, float distanceSquared) {
+        if (index != exclude) candidates[filled++] = {distanceSquared, index};
+    });
+
+    const size_t found = std::min(k, filled);
+    std::partial_sort(candidates, candidates + found, candidates + filled, [](const Candidate& a, const Candidate& b) {
+        return a.distanceSquared < b.distanceSquared || (a.distanceSquared == b.distanceSquared && a.index < b.index);
+    });
+    for (size_t i = 0; i < found; ++i) out.push_back(candidates[i].index);
+    arena.rewind(mark);
+    return out.size();
+}
+
+sf::Vector2f SpatialHash::separation(uint32_t index, float radius, size_t maxNeighbors) const {
+    sf::Vector2f push(0.0f, 0.0f);
+    if (index >= points.size() || radius <= 0.0f) return push;
+
+    thread_local std::vector<uint32_t> neighbors;
+    kNearest(points[index], maxNeighbors, radius, neighbors, index);
+    const sf::Vector2f self = points[index];
+    for (uint32_t other : neighbors) {
+        sf::Vector2f away = self - points[other];
+        float distance = std::sqrt(away.x * away.x + away.y * away.y);
+        if (distance < 1e-3f) {
+            // stacked exactly: split along a direction fixed by the pair, opposite for each side
+            const uint32_t low = std::min(index, other), high = std::max(index, other);
+            const float angle = static_cast<float>((low * 2654435761u ^ high) % 6283u) * 1e-3f;
+            const float side = index < other ? 1.0f : -1.0f;
+            away = {side * std::cos(angle), side * std::sin(angle)};
+            distance = 1e-3f;
+        } else {
+            away /= distance;
+        }
+        push += away * (1.0f - distance / radius);
+    }
+
+    const float length = std::sqrt(push.x * push.x + push.y * push.y);
+    return length > 1.0f ? push / length : push;
+}
@@ -1,4 +1,5 @@
 #include "TFWrapper.hpp"
+#include "DQNTrainer.hpp"
 #include "debug.hpp"
 #include <fstream>
 #include <algorithm>
@@ -31,9 +32,74 @@ void TensorFlowWrapper::cleanupTensorFlow() {
     }
 #endif
     isInitialized = false;
+    usingNativePolicy = false;
+    usingQuantizedPolicy = false;
+}
+
+// Load the exported MSPN weights; works with or without the TensorFlow runtime
+bool TensorFlowWrapper::loadNativePolicy(const std::string& path) {
+    cleanupTensorFlow();
+    modelPath = path;
+
+    if (!nativePolicy.loadFromFile(path) || !acceptPolicy(nativePolicy)) {
+        return false;
+    }
+
+    qValues.resize(nativePolicy.getOutputSize());
+    usingNativePolicy = true;
+    isInitialized = true;
+    if (!calibrationStates.empty()) requantize();
+    return true;
+}
+
+// Policies take the base state features, those plus the three density levels, or observation rows
+bool TensorFlowWrapper::acceptPolicy(const PolicyNetwork& policy) {
+    const int inputs = policy.getInputSize();
+    if (inputs != kStateFeatureCount && inputs != kMaxStateFeatureCount &&
+        ObservationBuilder::radiusForFeatureCount(inputs) < 0) {
+        getDebugConsole().log("TensorFlow", "Native policy expects " + std::to_string(inputs) + " inputs, state has " +
+                            std::to_string(kStateFeatureCount) + " (or " + std::to_string(kMaxStateFeatureCount) +
+                            " with density) and no observation patch matches", LogLevel::Error);
+        return false;
+    }
+    featureCount = inputs;
+    return true;
+}
+
+bool TensorFlowWrapper::setNativePolicy(const PolicyNetwork& policy) {
+    if (!acceptPolicy(policy)) {
+        return false;
+    }
+    if (!usingNativePolicy) {
+        cleanupTensorFlow();
+    }
+
+    nativePolicy = policy;
+    qValues.resize(nativePolicy.getOutputSize());
+    usingNativePolicy = true;
+    isInitialized = true;
+    if (!calibrationStates.empty()) requantize();
+    return true;
+}
+
+bool TensorFlowWrapper::setNativePolicy(const PolicyNetwork& policy, std::shared_ptr<const QuantizedPolicyNetwork> quantized,
+                                        const QuantizedPolicyNetwork::AccuracyReport& report) {
+    calibrationStates.clear(); // the trainer owns calibration now
+    if (!setNativePolicy(policy)) return false;
+    usingQuantizedPolicy = false;
+    if (quantized && quantized->getInputSize() == featureCount && !usesObservations()) {
+        quantizedPolicy = std::move(quantized);
+        quantizationReport = report;
+        usingQuantizedPolicy = true;
+    }
+    return true;
 }
 
 bool TensorFlowWrapper::initialize(const std::string& path) {
+    if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0) {
+        return loadNativePolicy(path);
+    }
+
 #ifdef USE_TENSORFLOW
     // Clean up any previous model
     cleanupTensorFlow();
@@ -77,17 +143,24 @@ bool TensorFlowWrapper::initialize(const std::string& path) {
 }
 
 ActionType TensorFlowWrapper::predictAction(const State& state) {
+    if (usingNativePolicy && !usesObservations()) {
+        float features[kMaxStateFeatureCount];
+        writeFeatures(state, features, featureCount);
+        runNativePolicy(features, 1, qValues.data());
+        return actionFromIndex(chooseAction(qValues.data(), static_cast<int>(qValues.size())));
+    }
+
 #ifdef USE_TENSORFLOW
     if (!isInitialized) {
         getDebugConsole().log("TensorFlow", "Model not initialized, using random action", LogLevel::Warning);
         return static_cast<ActionType>(1 + rand() % (static_cast<int>(ActionType::Rest)));
     }
     
-    // Convert state to input vector
-    std::vector<float> inputVector = stateToVector(state);
+    // Convert state to input features
+    const auto inputFeatures = stateToVector(state);
     
     // Create input tensor
-    TF_Tensor* inputTensor = createInputTensor(inputVector);
+    TF_Tensor* inputTensor = createInputTensor(inputFeatures.data(), kStateFeatureCount);
     if (!inputTensor) {
         getDebugConsole().log("TensorFlow", "Failed to create input tensor", LogLevel::Error);
         return static_cast<ActionType>(1 + rand() % (static_cast<int>(ActionType::Rest)));
@@ -105,18 +178,134 @@ ActionType TensorFlowWrapper::predictAction(const State& state) {
 #endif
 }
 
+void TensorFlowWrapper::predictActions(const State* states, int count, ActionType* actions) {
+    if (count <= 0) return;
+
+    if (!usingNativePolicy || usesObservations()) {
+        for (int i = 0; i < count; ++i) {
+            actions[i] = predictAction(states[i]);
+        }
+        return;
+    }
+
+    const int outputs = nativePolicy.getOutputSize();
+    batchFeatures.resize(static_cast<size_t>(count) * featureCount);
+    batchQValues.resize(static_cast<size_t>(count) * outputs);
+
+    for (int i = 0; i < count; ++i) {
+        writeFeatures(states[i], batchFeatures.data() + static_cast<size_t>(i) * featureCount, featureCount);
+    }
+
+    runNativePolicy(batchFeatures.data(), count, batchQValues.data());
+
+    for (int i = 0; i < count; ++i) {
+        actions[i] = actionFromIndex(chooseAction(batchQValues.data() + static_cast<size_t>(i) * outputs, outputs));
+    }
+}
+
+bool TensorFlowWrapper::predictActions(const ObservationBatch& batch, ActionType* actions) {
+    if (!usingNativePolicy || batch.featureCount != featureCount) {
+        getDebugConsole().log("TensorFlow", "Observation rows of " + std::to_string(batch.featureCount) +
+                            " features do not fit the loaded policy", LogLevel::Error);
+        return false;
+    }
+    if (batch.count <= 0) return true;
+
+    const int outputs = nativePolicy.getOutputSize();
+    batchQValues.resize(static_cast<size_t>(batch.count) * outputs);
+    runNativePolicy(batch.features.data(), batch.count, batchQValues.data());
+    for (int i = 0; i < batch.count; ++i) {
+        actions[i] = actionFromIndex(chooseAction(batchQValues.data() + static_cast<size_t>(i) * outputs, outputs));
+    }
+    return true;
+}
+
+void TensorFlowWrapper::runNativePolicy(const float* features, int count, float* actionValues) {
+    if (usingQuantizedPolicy) {
+        quantizedPolicy->forwardBatch(features, count, actionValues, quantizedWorkspace);
+    } else {
+        nativePolicy.forwardBatch(features, count, actionValues, workspace);
+    }
+}
+
+bool TensorFlowWrapper::enableQuantization(const std::vector<State>& states, float minAgreement) {
+    calibrationStates.clear();
+    for (const State& state : states) calibrationStates.push_back(PackedState::pack(state));
+    minQuantizedAgreement = minAgreement;
+    return requantize();
+}
+
+void TensorFlowWrapper::disableQuantization() {
+    calibrationStates.clear();
+    calibrationFeatures.clear();
+    quantizedPolicy.reset();
+    usingQuantizedPolicy = false;
+}
+
+// Quantize the current fp32 weights and keep them only if they agree with fp32 on the calibration states
+bool TensorFlowWrapper::requantize() {
+    usingQuantizedPolicy = false;
+    const int count = static_cast<int>(calibrationStates.size());
+    if (!usingNativePolicy || usesObservations() || count == 0) return false;
+
+    calibrationFeatures.resize(calibrationStates.size() * featureCount);
+    for (size_t i = 0; i < calibrationStates.size(); ++i) {
+        calibrationStates[i].writeFeatures(calibrationFeatures.data() + i * featureCount, featureCount);
+    }
+
+    auto quantized = std::make_shared<QuantizedPolicyNetwork>();
+    if (!quantized->quantize(nativePolicy, calibrationFeatures.data(), count)) return false;
+
+    quantizationReport = QuantizedPolicyNetwork::compare(nativePolicy, *quantized, calibrationFeatures.data(), count);
+    if (quantizationReport.actionAgreement < minQuantizedAgreement) {
+        getDebugConsole().log("TensorFlow", "Int8 policy agrees with fp32 on only " +
+                            std::to_string(quantizationReport.actionAgreement * 100.0f) + "% of states, keeping fp32",
+                            LogLevel::Warning);
+        return false;
+    }
+
+    quantizedPolicy = std::move(quantized);
+    usingQuantizedPolicy = true;
+    return true;
+}
+
+// Greedy unless exploring for the online trainer
+int TensorFlowWrapper::chooseAction(const float* actionValues, int outputs) {
+    if (explorationRate > 0.0f && static_cast<float>(rand()) / RAND_MAX < explorationRate) {
+        return rand() % outputs;
+    }
+    return PolicyNetwork::argmax(actionValues, outputs);
+}
+
+void TensorFlowWrapper::recordTransition(const State& state, ActionType action, float reward,
+                                         const State& nextState, bool done) {
+    recordTransition(PackedState::pack(state), action, reward, PackedState::pack(nextState), done);
+}
+
+void TensorFlowWrapper::recordTransition(PackedState state, ActionType action, float reward,
+                                         PackedState nextState, bool done) {
+    const int actionIndex = indexFromAction(action);
+    if (!trainer || actionIndex < 0 || featureCount > kMaxStateFeatureCount) return;
+
+    float features[kMaxStateFeatureCount];
+    float nextFeatures[kMaxStateFeatureCount];
+    state.writeFeatures(features, featureCount);
+    nextState.writeFeatures(nextFeatures, featureCount);
+    trainer->addExperience(features, actionIndex, reward, nextFeatures, done);
+}
+
 #ifdef USE_TENSORFLOW
-TF_Tensor* TensorFlowWrapper::createInputTensor(const std::vector<float>& stateVector) const {
+TF_Tensor* TensorFlowWrapper::createInputTensor(const float* features, int count) const {
     // Create tensor for state input (batch_size=1, features=state size)
-    int64_t dims[] = {1, static_cast<int64_t>(stateVector.size())};
-    size_t dataSize = stateVector.size() * sizeof(float);
+    int64_t dims[] = {1, static_cast<int64_t>(count)};
+    size_t dataSize = static_cast<size_t>(count) * sizeof(float);
     
     // Create tensor
     TF_Tensor* tensor = TF_AllocateTensor(TF_FLOAT, dims, 2, dataSize);
     
     // Copy data to tensor
     float* tensorData = static_cast<float*>(TF_TensorData(tensor));
-    std::copy(stateVector.begin(), stateVector.end(), tensorData);
+    std::copy(features, features + count, tensorData);
     
     return tensor;
 }
@@ -145,17 +334,34 @@ ActionType TensorFlowWrapper::interpretOutput(TF_Tensor* outputTensor) const {
 }
 #endif
 
-std::vector<float> TensorFlowWrapper::stateToVector(const State& state) const {
-    // Convert State struct to a flat vector for TF input
-    std::vector<float> stateVector = {
-        static_cast<float>(state.posX),
-        static_cast<float>(state.posY),
-        static_cast<float>(state.nearbyTrees),
-        static_cast<float>(state.nearbyRocks),
-        static_cast<float>(state.nearbyBushes),
-        static_cast<float>(state.energyLevel),
-        static_cast<float>(state.inventoryLevel)
-    };
-    
-    return stateVector;
+std::array<float, TensorFlowWrapper::kStateFeatureCount> TensorFlowWrapper::stateToVector(const State& state) const {
+    // Convert State struct to a flat feature array for TF input
+    std::array<float, kStateFeatureCount> features;
+    writeFeatures(state, features.data());
+    return features;
+}
+
+// Same feature order as the CSV/JSON columns used for training
+void TensorFlowWrapper::writeFeatures(const State& state, float* out, int count) {
+    out[0] = static_cast<float>(state.posX);
+    out[1] = static_cast<float>(state.posY);
+    out[2] = static_cast<float>(state.nearbyTrees);
+    out[3] = static_cast<float>(state.nearbyRocks);
+    out[4] = static_cast<float>(state.nearbyBushes);
+    out[5] = static_cast<float>(state.energyLevel);
+    out[6] = static_cast<float>(state.inventoryLevel);
+    if (count < kMaxStateFeatureCount) return;
+    out[7] = static_cast<float>(state.treeDensity);
+    out[8] = static_cast<float>(state.rockDensity);
+    out[9] = static_cast<float>(state.bushDensity);
+}
+
+ActionType TensorFlowWrapper::actionFromIndex(int index) {
+    const int maxIndex = static_cast<int>(ActionType::Rest) - 1;
+    return static_cast<ActionType>(1 + std::clamp(index, 0, maxIndex));
+}
+
+int TensorFlowWrapper::indexFromAction(ActionType action) {
+    const int index = static_cast<int>(action) - 1;
+    return (index >= 0 && index < static_cast<int>(ActionType::Rest)) ? index : -1;
 }
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include "TimerWheel.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+TimerWheel& getSimulationTimers() {
+    static TimerWheel instance;
+    return instance;
+}
+
+TimerWheel::TimerWheel(float tickLength) : tickSeconds(tickLength > 0.0f ? tickLength : 1.0f / 60.0f) {
+    clear();
+}
+
+void TimerWheel::clear() {
+    for (auto& level : slots) std::fill(std::begin(level), std::end(level), kNone);
+    nodes.clear();
+    freeNodes.clear();
+    tick = 0;
+    carry = 0.0f;
+    live = 0;
+    linked = 0;
+}
+
+TimerWheel::Node* TimerWheel::find(TimerId id) {
+    const uint64_t index = (id & 0xFFFFFFFFu) - 1;
+    if (id == 0 || index >= nodes.size()) return nullptr;
+    Node& node = nodes[index];
+    return node.live && node.generation == static_cast<uint32_t>(id >> 32) ? &node : nullptr;
+}
+
+const TimerWheel::Node* TimerWheel::find(TimerId id) const {
+    return const_cast<TimerWheel*>(this)->find(id);
+}
+
+void TimerWheel::file(uint32_t index) {
+    Node& node = nodes[index];
+    const uint64_t delta = node.due > tick ? node.due - tick : 0;
+    int level = 0;
+    while (level < kLevels && delta >= (uint64_t{1} << (kLevelBits * (level + 1)))) ++level;
+
+    uint32_t slot;
+    if (level < kLevels) {
+        slot = static_cast<uint32_t>(node.due >> (kLevelBits * level)) & (kSlots - 1);
+    } else {
+        // beyond the wheel: park in the last level-3 slot to come round, re-filed from there
+        level = kLevels - 1;
+        slot = static_cast<uint32_t>((tick >> (kLevelBits * level)) + kSlots - 1) & (kSlots - 1);
+    }
+    node.next = slots[level][slot];
+    slots[level][slot] = index;
+}
+
+TimerWheel::TimerId TimerWheel::schedule(float delay, uint32_t channel, uint32_t subject) {
+    const double ticks = std::isfinite(delay) ? std::ceil(delay / tickSeconds - 1e-4) : 1.0;
+    return scheduleAt(tick + static_cast<uint64_t>(std::max(1.0, ticks)), channel, subject);
+}
+
+TimerWheel::TimerId TimerWheel::scheduleAt(uint64_t dueTick, uint32_t channel, uint32_t subject) {
+    uint32_t index;
+    if (!freeNodes.empty()) {
+        index = freeNodes.back();
+        freeNodes.pop_back();
+    } else {
+        index = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+    }
+    Node& node = nodes[index];
+    node.due = std::max(dueTick, tick + 1);
+    node.channel = channel;
+    node.subject = subject;
+    node.live = true;
+    ++live;
+    ++linked;
+    file(index);
+    return (static_cast<uint64_t>(node.generation) << 32) | (index + 1);
+}
+
+void TimerWheel::collectPending(std::vector<Pending>& out) const {
+    out.clear();
+    for (uint32_t index = 0; index < nodes.size(); ++index) {
+        const Node& node = nodes[index];
+        if (node.live) out.push_back({node.due, node.channel, node.subject, (static_cast<uint64_t>(node.generation) << 32) | (index + 1)});
+    }
+    std::stable_sort(out.begin(), out.end(), [](const Pending& a, const Pending& b) { return a.due < b.due; });
+}
+
+void TimerWheel::restart(uint64_t atTick, float carrySeconds) {
+    clear();
+    tick = atTick;
+    carry = std::clamp(carrySeconds, 0.0f, tickSeconds);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    Node* node = find(id);
+    if (!node) return false;
+    node->live = false; // unlinked lazily when its slot is reached
+    --live;
+    return true;
+}
+
+bool TimerWheel::retarget(TimerId id, uint32_t subject) {
+    Node* node = find(id);
+    if (!node) return false;
+    node->subject = subject;
+    return true;
+}
+
+float TimerWheel::remaining(TimerId id) const {
+    const Node* node = find(id);
+    if (!node) return 0.0f;
+    return std::max(0.0f, static_cast<float>(node->due - tick) * tickSeconds - carry);
+}
+
+void TimerWheel::cascade(int level, uint32_t slot) {
+    uint32_t index = slots[level][slot];
+    slots[level][slot] = kNone;
+    while (index != kNone) {
+        const uint32_t next = nodes[index].next;
+        if (nodes[index].live) {
+            file(index);
+        } else {
+            ++nodes[index].generation;
+            freeNodes.push_back(index);
+            --linked;
+        }
+        index = next;
+    }
+}
+
+void TimerWheel::expire(uint32_t slot, std::vector<Event>& due) {
+    uint32_t index = slots[0][slot];
+    slots[0][slot] = kNone;
+    while (index != kNone) {
+        Node& node = nodes[index];
+        const uint32_t next = node.next;
+        if (node.live) {
+            due.push_back({node.channel, node.subject, (static_cast<uint64_t>(node.generation) << 32) | (index + 1)});
+            node.live = false;
+            --live;
+        }
+        ++node.generation;
+        freeNodes.push_back(index);
+        --linked;
+        index = next;
+    }
+}
+
+size_t TimerWheel::advance(float seconds, std::vector<Event>& due) {
+    const size_t before = due.size();
+    if (!(seconds > 0.0f)) return 0;
+    carry += seconds;
+    uint64_t ticks = static_cast<uint64_t>(carry / tickSeconds);
+    carry = std::max(0.0f, carry - static_cast<float>(ticks) * tickSeconds);
+
+    while (ticks > 0) {
+        if (linked == 0) { // nothing filed: the clock can jump
+            tick += ticks;
+            break;
+        }
+        ++tick;
+        --ticks;
+        // when a level wraps, pull the next slot of the level above down into it
+        for (int level = 1; level < kLevels; ++level) {
+            if ((tick & ((uint64_t{1} << (kLevelBits * level)) - 1)) != 0) break;
+            cascade(level, static_cast<uint32_t>(tick >> (kLevelBits * level)) & (kSlots - 1));
+        }
+        expire(static_cast<uint32_t>(tick) & (kSlots - 1), due);
+    }
+    return due.size() - before;
+}
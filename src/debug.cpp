@@ -46,6 +46,7 @@ void DebugConsole::saveAllLogs(const std::string& filename) {
     std::ofstream outFile(filename, std::ios::app);
     if (!outFile.is_open()) return;
 
+    std::lock_guard<std::mutex> lock(debugMutex);
     for (const auto& [category, message] : logs) {
         outFile << message << "\n";
     }
@@ -53,12 +54,18 @@ void DebugConsole::saveAllLogs(const std::string& filename) {
     std::cout << "All logs saved to " << filename << std::endl;
 }
 
-// Generate a log filename based on current date
-std::string DebugConsole::getLogFilename() const {
-    auto now = std::chrono::system_clock::now();
-    auto timeT = std::chrono::system_clock::to_time_t(now);
-    std::tm localTime = *std::localtime(&timeT);
+std::tm toLocalTime(std::time_t time) {
+    std::tm localTime{};
+#ifdef _WIN32
+    localtime_s(&localTime, &time);
+#else
+    localtime_r(&time, &localTime);
+#endif
+    return localTime;
+}
 
+// Generate a log filename based on the given date
+std::string DebugConsole::getLogFilename(const std::tm& localTime) const {
     std::ostringstream filename;
     filename << "logs/" << std::put_time(&localTime, "%Y-%m-%d") << "_log.txt";
     return filename.str();
@@ -70,41 +77,47 @@ void DebugConsole::log(const std::string& category, const std::string& message,
 
     std::ostringstream formattedMessage;
     
-    auto now = std::chrono::system_clock::now();
-    auto timeT = std::chrono::system_clock::to_time_t(now);
-    std::tm localTime = *std::localtime(&timeT);
+    const std::tm localTime = toLocalTime(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
 
     formattedMessage << "[" << std::put_time(&localTime, "%Y-%m-%d %H:%M:%S") << "] ";
     formattedMessage << "[" << category << "] " << message;
+    const std::string filename = getLogFilename(localTime);
 
-    {
-        std::lock_guard<std::mutex> lock(debugMutex); // Thread safety
-        logs.emplace_back(category, formattedMessage.str());
-        trimLogs(); // Remove old logs if necessary
-    }
+    std::lock_guard<std::mutex> lock(debugMutex); // Thread safety
+    logs.emplace_back(category, formattedMessage.str());
+    trimLogs(); // Remove old logs if necessary
 
-    saveLogToFile(getLogFilename(), formattedMessage.str());
+    // the file stays open until the date changes
+    if (filename != logFileName || !logFile.is_open()) {
+        logFile.close();
+        logFile.open(filename, std::ios::app);
+        logFileName = filename;
+    }
+    if (logFile.is_open()) logFile << formattedMessage.str() << "\n";
 }
 
 // Log a message with a throttle to prevent spam
 void DebugConsole::logThrottled(const std::string& category, const std::string& message, int throttleMs) {
     auto now = std::chrono::high_resolution_clock::now();
     std::string key = category + ":" + message;
-    auto& lastLogTime = throttleTimers[key];
-
-    if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastLogTime).count() > throttleMs) {
-        log(category, message);
+    {
+        std::lock_guard<std::mutex> lock(trackerMutex);
+        auto& lastLogTime = throttleTimers[key];
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastLogTime).count() <= throttleMs) return;
         lastLogTime = now;
     }
+    log(category, message);
 }
 
 // Log a message only once
 void DebugConsole::logOnce(const std::string& category, const std::string& message) {
     std::string key = category + ":" + message;
-    if (!logOnceTracker[key]) {
-        log(category, message);
+    {
+        std::lock_guard<std::mutex> lock(trackerMutex);
+        if (logOnceTracker[key]) return;
         logOnceTracker[key] = true;
     }
+    log(category, message);
 }
 
 
@@ -151,6 +164,7 @@ void DebugConsole::render(sf::RenderWindow& window) {
     window.draw(background);
 
     float yOffset = background.getPosition().y + 10;
+    std::lock_guard<std::mutex> lock(debugMutex);
     size_t start = logs.size() > maxLogs ? logs.size() - maxLogs : 0;
     for (size_t i = start; i < logs.size(); ++i) {
         const auto& [category, message] = logs[i];
@@ -163,6 +177,7 @@ void DebugConsole::render(sf::RenderWindow& window) {
 
 // Clear all logs
 void DebugConsole::clearLogs() {
+    std::lock_guard<std::mutex> lock(debugMutex);
     logs.clear();
 }
 
@@ -33,11 +33,17 @@ void handleCrash(int signal) {
 }
 
 
-int main() {
+int main(int argc, char* argv[]) {
     std::signal(SIGSEGV, handleCrash);  // Segmentation fault
     std::signal(SIGABRT, handleCrash);  // Abort signal
     std::signal(SIGFPE, handleCrash);   // Floating point exception
 
+    // --resume <snapshot> continues a saved society instead of generating a new one
+    std::string resumePath;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--resume") resumePath = argv[i + 1];
+    }
+
     // Show startup menu first
     StartupMenu startupMenu;
     SimulationMode selectedMode = startupMenu.run();
@@ -73,6 +79,10 @@ int main() {
             break;
     }
     
+    if (!resumePath.empty() && !game.loadSnapshot(resumePath)) {
+        std::cerr << "Could not resume from " << resumePath << ", starting a new society." << std::endl;
+    }
+
     // Run the game
     game.run();
 
@@ -0,0 +1,31 @@
+#ifndef EXPERIENCE_FIXTURES_HPP
+#define EXPERIENCE_FIXTURES_HPP
+
+#include "State.hpp"
+#include "ActionType.hpp"
+#include "NumpyIO.hpp"
+
+// Deterministic experiences shared by the data pipeline tests: experience i goes from
+// makeState(i) to makeState(i + 1) with fixtureAction(i)
+namespace ExperienceFixtures {
+
+    inline State makeState(int i) {
+        return {i % 25, (i * 3) % 25, i % 4, i % 3, i % 5, i % 3, (i / 2) % 3};
+    }
+
+    inline ActionType fixtureAction(int i) {
+        return static_cast<ActionType>(1 + i % 11);
+    }
+
+    // experiences [first, first + count): reward i * rewardScale, terminal every doneEvery-th (0: never)
+    inline NumpyIO::ExperienceColumns makeColumns(int first, int count, float rewardScale = 1.0f, int doneEvery = 0) {
+        NumpyIO::ExperienceColumns columns;
+        for (int i = first; i < first + count; ++i) {
+            columns.append(makeState(i), fixtureAction(i), i * rewardScale, makeState(i + 1),
+                           doneEvery > 0 && i % doneEvery == 0);
+        }
+        return columns;
+    }
+}
+
+#endif
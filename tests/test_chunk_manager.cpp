@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+#include "ChunkManager.hpp"
+#include "JobSystem.hpp"
+#include "SimulationSnapshot.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+#include <set>
+
+namespace {
+    MapGenerator::Settings worldSettings(int width, int height, int seed) {
+        MapGenerator::Settings settings;
+        settings.width = width;
+        settings.height = height;
+        settings.seed = seed;
+        return settings;
+    }
+}
+
+// Chunks are only built when touched and hold exactly the generator's terrain and resources;
+// nearest-object queries agree with a scan of the whole map
+TEST(ChunkManagerTest, LazyChunksMatchGenerator) {
+    const MapGenerator::Settings settings = worldSettings(100, 70, 5);
+    JobSystem serial(1);
+    const MapLayout layout = MapGenerator().generate(settings, serial);
+
+    ChunkManager world;
+    world.reset(settings, 64);
+    EXPECT_EQ(world.getStats().resident, 0u);
+    world.tileAt(40, 40);
+    EXPECT_EQ(world.getStats().resident, 1u);
+
+    for (int y = 0; y < settings.height; ++y) {
+        for (int x = 0; x < settings.width; ++x) {
+            const ChunkManager::TileInfo tile = world.tileAt(x, y);
+            const size_t i = layout.index(x, y);
+            ASSERT_EQ(tile.terrain, layout.terrain[i]) << x << ", " << y;
+            ASSERT_EQ(tile.variant, layout.terrainVariant[i]) << x << ", " << y;
+            ASSERT_EQ(tile.object, layout.objects[i]) << x << ", " << y;
+            ASSERT_EQ(tile.objectVariant, layout.objectVariant[i]) << x << ", " << y;
+        }
+    }
+    EXPECT_EQ(world.getStats().generated, 12u); // 4 x 3 chunks
+
+    for (ObjectType type : {ObjectType::Tree, ObjectType::Rock, ObjectType::Bush}) {
+        for (auto [fromX, fromY] : {std::pair{3.5f, 2.0f}, {50.0f, 35.25f}, {99.0f, 69.0f}, {70.0f, 8.0f}}) {
+            float best = std::numeric_limits<float>::max();
+            int bestX = -1, bestY = -1;
+            for (int y = 0; y < settings.height; ++y) {
+                for (int x = 0; x < settings.width; ++x) {
+                    if (layout.objects[layout.index(x, y)] != type) continue;
+                    const float distance = (x - fromX) * (x - fromX) + (y - fromY) * (y - fromY);
+                    if (distance < best) {
+                        best = distance;
+                        bestX = x;
+                        bestY = y;
+                    }
+                }
+            }
+            int foundX = -1, foundY = -1;
+            ASSERT_TRUE(world.findNearest(type, fromX, fromY, 500.0f, foundX, foundY));
+            EXPECT_EQ(foundX, bestX);
+            EXPECT_EQ(foundY, bestY);
+        }
+    }
+    int x = 0, y = 0;
+    EXPECT_FALSE(world.findNearest(ObjectType::Market, 10.0f, 10.0f, 500.0f, x, y));
+}
+
+// Past the budget idle chunks are evicted; edited ones go to the cache and come back intact,
+// untouched ones are regenerated, and resident memory stays bounded
+TEST(ChunkManagerTest, EvictionKeepsEdits) {
+    const auto directory = std::filesystem::temp_directory_path() / "microsociety_chunk_test";
+    for (const std::string& cache : {directory.string(), std::string()}) {
+        ChunkManager world;
+        world.reset(worldSettings(4096, 4096, 11), 4, cache);
+
+        world.setObject(5, 5, ObjectType::House, 2);
+        world.removeObject(6, 5);
+        const ChunkManager::TileInfo neighbour = world.tileAt(40, 5); // unedited chunk
+        world.endTick();
+
+        size_t peakBytes = 0;
+        for (int step = 1; step < 60; ++step) { // walk away across the map
+            world.touch(step * 64, step * 64);
+            world.touch(step * 64 + 32, step * 64);
+            world.endTick();
+            EXPECT_LE(world.getStats().resident, 4u);
+            peakBytes = std::max(peakBytes, world.residentBytes());
+        }
+        EXPECT_LT(peakBytes, 16u * 1024u);
+        EXPECT_EQ(world.getStats().written, 1u);
+        if (!cache.empty()) {
+            EXPECT_TRUE(std::filesystem::exists(directory / "chunk_0_0.bin"));
+        }
+
+        const ChunkManager::TileInfo edited = world.tileAt(5, 5);
+        EXPECT_EQ(edited.object, ObjectType::House);
+        EXPECT_EQ(edited.objectVariant, 2);
+        EXPECT_EQ(world.objectAt(6, 5), ObjectType::None);
+        EXPECT_EQ(world.getStats().loaded, 1u);
+        EXPECT_EQ(world.tileAt(40, 5).object, neighbour.object);
+        EXPECT_EQ(world.tileAt(40, 5).terrain, neighbour.terrain);
+
+        world.clear();
+        EXPECT_FALSE(std::filesystem::exists(directory / "chunk_0_0.bin"));
+    }
+}
+
+// Swapping exchanges whole worlds, edits and cache directories included, so a world built in
+// the background can replace the live one without copying
+TEST(ChunkManagerTest, SwapExchangesWorlds) {
+    const auto directory = std::filesystem::temp_directory_path() / "microsociety_chunk_swap";
+    ChunkManager live, next;
+    live.reset(worldSettings(200, 100, 1), 2, (directory / "live").string());
+    next.reset(worldSettings(200, 100, 2), 2, (directory / "next").string());
+    live.setObject(3, 3, ObjectType::Market, 1);
+    const ChunkManager::TileInfo nextTile = next.tileAt(150, 80);
+
+    live.swap(next);
+    EXPECT_EQ(live.getSettings().seed, 2);
+    EXPECT_EQ(live.getCacheDirectory(), (directory / "next").string());
+    EXPECT_EQ(live.tileAt(150, 80).terrain, nextTile.terrain);
+    EXPECT_EQ(live.tileAt(150, 80).object, nextTile.object);
+    EXPECT_EQ(next.objectAt(3, 3), ObjectType::Market);
+
+    for (int x = 40; x < 200; x += 32) { // push the edited chunk out of `next`
+        next.touch(x, 50);
+        next.endTick();
+    }
+    EXPECT_TRUE(std::filesystem::exists(directory / "live" / "chunk_0_0.bin"));
+    EXPECT_EQ(next.tileAt(3, 3).objectVariant, 1);
+    next.clear();
+    std::filesystem::remove_all(directory);
+}
+
+// The residency listener hears every chunk that arrives and every one about to be evicted, so
+// an owner can keep tiles for exactly the resident chunks; pinned chunks are never evicted
+TEST(ChunkManagerTest, ResidencyListenerAndPins) {
+    ChunkManager world;
+    world.reset(worldSettings(512, 512, 5), 2);
+    std::set<std::pair<int, int>> resident;
+    world.setResidencyListener([&](int cx, int cy, bool arrived) {
+        if (arrived) {
+            EXPECT_TRUE(resident.emplace(cx, cy).second);
+        } else {
+            EXPECT_EQ(resident.erase({cx, cy}), 1u);
+        }
+    });
+
+    world.pin(10, 10);
+    world.touchArea(40, 0, 100, 20); // three chunks generated in one batch
+    world.endTick();
+    for (int step = 0; step < 12; ++step) {
+        world.touch(200 + step * 20, 300);
+        world.endTick();
+        const auto chunks = world.residentChunks();
+        const std::set<std::pair<int, int>> listed(chunks.begin(), chunks.end());
+        EXPECT_EQ(listed, resident);
+    }
+    EXPECT_TRUE(resident.count({0, 0}));
+    EXPECT_EQ(resident.size(), 2u); // the pinned chunk and the one touched last
+    EXPECT_GT(world.getStats().evicted, 0u);
+
+    // swapping keeps the listener with its manager
+    ChunkManager other;
+    other.reset(worldSettings(64, 64, 6), 2);
+    world.swap(other);
+    world.touch(40, 40);
+    EXPECT_EQ(resident.size(), 3u);
+    EXPECT_TRUE(resident.count({1, 1}));
+}
+
+// A snapshot holds the resident chunks and the cached (edited, evicted) ones; restoring it into
+// a fresh manager brings back every edit with the same chunks resident, and corrupt chunks are
+// rejected and left to regenerate
+TEST(ChunkManagerTest, SnapshotKeepsCachedAndResidentChunks) {
+    const auto directory = std::filesystem::temp_directory_path() / "microsociety_chunk_snapshot";
+    for (const std::string& cache : {directory.string(), std::string()}) {
+        ChunkManager world;
+        world.reset(worldSettings(512, 512, 8), 2, cache.empty() ? cache : cache + "/saved");
+        world.setObject(5, 5, ObjectType::House, 2);
+        world.endTick();
+        for (int step = 1; step < 4; ++step) { // the edited chunk is evicted to the cache
+            world.touch(step * 64, 300);
+            world.endTick();
+        }
+        world.setObject(200, 300, ObjectType::Market, 1);
+
+        std::vector<SnapshotChunk> saved;
+        world.saveSnapshot(saved);
+        EXPECT_EQ(saved.size(), world.residentChunks().size() + 1);
+        EXPECT_EQ(std::count_if(saved.begin(), saved.end(), [](const SnapshotChunk& c) { return !c.resident; }), 1);
+
+        ChunkManager restored;
+        restored.reset(worldSettings(512, 512, 8), 2, cache.empty() ? cache : cache + "/restored");
+        ASSERT_TRUE(restored.restoreSnapshot(saved));
+        const auto before = world.residentChunks();
+        const auto after = restored.residentChunks();
+        const std::set<std::pair<int, int>> wasResident(before.begin(), before.end());
+        const std::set<std::pair<int, int>> isResident(after.begin(), after.end());
+        EXPECT_EQ(isResident, wasResident);
+        EXPECT_EQ(restored.getStats().generated, 0u);
+        EXPECT_EQ(restored.tileAt(200, 300).object, ObjectType::Market);
+        EXPECT_EQ(restored.tileAt(5, 5).object, ObjectType::House);
+        EXPECT_EQ(restored.tileAt(5, 5).objectVariant, 2);
+        EXPECT_EQ(restored.getStats().loaded, 1u);
+
+        saved.push_back({3, 3, false, {1, 2, 3}});
+        saved.push_back({100, 0, true, saved.front().bytes}); // outside the world
+        ChunkManager damaged;
+        damaged.reset(worldSettings(512, 512, 8), 2);
+        EXPECT_FALSE(damaged.restoreSnapshot(saved));
+        EXPECT_EQ(damaged.tileAt(5, 5).object, ObjectType::House);
+
+        world.clear();
+        restored.clear();
+    }
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+#include "DataCollector.hpp"
+#include "NumpyIO.hpp"
+#include "ExperienceCsv.hpp"
+#include "ExperienceFixtures.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace ExperienceFixtures;
+
+TEST(DataExportTest, Crc32MatchesZipReference) {
+    const char check[] = "123456789";
+    EXPECT_EQ(NumpyIO::crc32(check, 9), 0xCBF43926u);
+}
+
+TEST(DataExportTest, NpyHeaderIsAlignedAndDescribesShape) {
+    const std::string header = NumpyIO::npyHeader("<i4", {12, 7});
+    EXPECT_EQ(header.size() % 64, 0u);
+    EXPECT_NE(header.find("'shape': (12, 7)"), std::string::npos);
+    EXPECT_EQ(header.back(), '\n');
+    EXPECT_NE(NumpyIO::npyHeader("<f4", {5}).find("'shape': (5,)"), std::string::npos);
+}
+
+TEST(DataExportTest, NpzRoundTrip) {
+    const NumpyIO::ExperienceColumns columns = makeColumns(0, 40, 0.5f, 7);
+
+    const std::string path = "test_experiences.npz";
+    ASSERT_TRUE(NumpyIO::writeExperienceNpz(path, columns));
+
+    NumpyIO::ExperienceColumns loaded;
+    ASSERT_TRUE(NumpyIO::readExperienceNpz(path, loaded));
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(loaded.states, columns.states);
+    EXPECT_EQ(loaded.actions, columns.actions);
+    EXPECT_EQ(loaded.rewards, columns.rewards);
+    EXPECT_EQ(loaded.nextStates, columns.nextStates);
+    EXPECT_EQ(loaded.dones, columns.dones);
+}
+
+// Flushed batches are written off-thread (.msx plus the requested formats); the NumPy export merges every segment
+TEST(DataExportTest, CollectorWritesSegmentsAndMergedNpz) {
+    const std::string directory = "test_export_output";
+    {
+        DataCollector collector(directory);
+        collector.setMaxExperiencesPerFile(10);
+        BatchFormats formats;
+        formats.json = true;
+        formats.npz = true;
+        collector.setBatchFormats(formats);
+        collector.startCollection();
+        for (int i = 0; i < 25; ++i) {
+            collector.recordExperience(makeState(i), ActionType::ChopTree, 1.0f, makeState(i + 1), false, "NPC_1");
+        }
+        EXPECT_EQ(collector.getCurrentBatchSize(), 5u);
+
+        collector.exportToNumpyFormat("merged");
+        collector.flushPendingWrites();
+
+        size_t jsonFiles = 0, npzFiles = 0, msxFiles = 0, csvFiles = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(directory + "/sessions")) {
+            if (entry.path().extension() == ".json") ++jsonFiles;
+            if (entry.path().extension() == ".npz") ++npzFiles;
+            if (entry.path().extension() == ".msx") ++msxFiles;
+            if (entry.path().extension() == ".csv") ++csvFiles;
+        }
+        EXPECT_EQ(jsonFiles, 2u);
+        EXPECT_EQ(npzFiles, 2u);
+        EXPECT_EQ(msxFiles, 2u);
+        EXPECT_EQ(csvFiles, 0u);
+
+        NumpyIO::ExperienceColumns merged;
+        ASSERT_TRUE(NumpyIO::readExperienceNpz(directory + "/exports/merged.npz", merged));
+        ASSERT_EQ(merged.size(), 25u);
+        EXPECT_EQ(merged.actions.front(), static_cast<int32_t>(ActionType::ChopTree));
+        EXPECT_EQ(merged.states[7], makeState(1).posX);
+    }
+    std::filesystem::remove_all(directory);
+}
+
+TEST(DataExportTest, CsvRowFormatting) {
+    ExperienceRecord record{};
+    record.state = packExperienceState({3, 4, 1, 0, 2, 1, 0});
+    record.nextState = packExperienceState({4, 4, 1, 0, 2, 0, 1});
+    record.reward = -2.5f;
+    record.action = static_cast<uint8_t>(ActionType::ChopTree);
+    record.done = 1;
+
+    std::string row;
+    ExperienceCsv::appendRow(row, record, "NPC_1", 12.0f);
+    EXPECT_EQ(row, "3,4,1,0,2,1,0," + std::to_string(static_cast<int>(ActionType::ChopTree)) +
+                   ",-2.5,4,4,1,0,2,0,1,1,\"NPC_1\",12\n");
+}
+
+// Saved batches are exported by concatenating their CSV segments, then the in-memory rows
+TEST(DataExportTest, CsvExportConcatenatesSegments) {
+    const std::string directory = "test_csv_output";
+    {
+        DataCollector collector(directory);
+        collector.setMaxExperiencesPerFile(10);
+        collector.startCollection();
+        for (int i = 0; i < 25; ++i) {
+            collector.recordExperience(makeState(i), ActionType::ChopTree, static_cast<float>(i), makeState(i + 1), false, "NPC_1");
+        }
+        collector.exportToCSV("all.csv");
+
+        std::ifstream csv(directory + "/exports/all.csv");
+        ASSERT_TRUE(csv.is_open());
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(csv, line);) lines.push_back(line);
+
+        ASSERT_EQ(lines.size(), 26u);
+        EXPECT_EQ(lines[0] + "\n", ExperienceCsv::kHeader);
+        for (int i = 0; i < 25; ++i) {
+            std::string expected = std::to_string(makeState(i).posX) + "," + std::to_string(makeState(i).posY) + ",";
+            EXPECT_EQ(lines[i + 1].rfind(expected, 0), 0u) << "row " << i;
+        }
+        collector.stopCollection();
+        collector.flushPendingWrites();
+    }
+    std::filesystem::remove_all(directory);
+}
+
+// A later export to the same file keeps the batches it already holds: they are not read again
+// (their segments are gone here), the old in-memory rows are replaced and new batches appended
+TEST(DataExportTest, CsvExportAppendsOnlyNewBatches) {
+    const std::string directory = "test_csv_append_output";
+    {
+        DataCollector collector(directory);
+        collector.setMaxExperiencesPerFile(10);
+        collector.startCollection();
+        for (int i = 0; i < 25; ++i) {
+            collector.recordExperience(makeState(i), ActionType::ChopTree, static_cast<float>(i), makeState(i + 1), false, "NPC_1");
+        }
+        collector.exportToCSV("all.csv");
+        collector.flushPendingWrites();
+        for (const auto& entry : std::filesystem::directory_iterator(directory + "/sessions")) {
+            std::filesystem::remove(entry.path());
+        }
+
+        for (int i = 25; i < 47; ++i) {
+            collector.recordExperience(makeState(i), ActionType::ChopTree, static_cast<float>(i), makeState(i + 1), false, "NPC_1");
+        }
+        collector.exportToCSV("all.csv");
+
+        std::ifstream csv(directory + "/exports/all.csv");
+        ASSERT_TRUE(csv.is_open());
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(csv, line);) lines.push_back(line);
+
+        ASSERT_EQ(lines.size(), 48u);
+        EXPECT_EQ(lines[0] + "\n", ExperienceCsv::kHeader);
+        for (int i = 0; i < 47; ++i) {
+            std::string expected = std::to_string(makeState(i).posX) + "," + std::to_string(makeState(i).posY) + ",";
+            EXPECT_EQ(lines[i + 1].rfind(expected, 0), 0u) << "row " << i;
+        }
+        collector.stopCollection();
+        collector.flushPendingWrites();
+    }
+    std::filesystem::remove_all(directory);
+}
+
+// An export snapshot is written as it was taken, from any thread, even after the collector has
+// moved on to a new session with more records
+TEST(DataExportTest, ExportSnapshotIgnoresLaterCollection) {
+    const std::string directory = "test_export_snapshot_output";
+    {
+        DataCollector collector(directory);
+        collector.setMaxExperiencesPerFile(10);
+        collector.startCollection();
+        for (int i = 0; i < 25; ++i) {
+            collector.recordExperience(makeState(i), ActionType::ChopTree, static_cast<float>(i), makeState(i + 1), false, "NPC_1");
+        }
+        const DataCollector::ExportSnapshot snapshot = collector.takeExportSnapshot();
+        collector.stopCollection();
+        collector.startCollection();
+        for (int i = 25; i < 40; ++i) {
+            collector.recordExperience(makeState(i), ActionType::ChopTree, static_cast<float>(i), makeState(i + 1), false, "NPC_1");
+        }
+
+        std::thread builder([&] {
+            collector.exportToCSV("retired.csv", snapshot);
+            collector.exportToJSON("retired.json", snapshot);
+        });
+        builder.join();
+        collector.flushPendingWrites();
+
+        std::ifstream csv(directory + "/exports/retired.csv");
+        ASSERT_TRUE(csv.is_open());
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(csv, line);) lines.push_back(line);
+        ASSERT_EQ(lines.size(), 26u);
+        for (int i = 0; i < 25; ++i) {
+            std::string expected = std::to_string(makeState(i).posX) + "," + std::to_string(makeState(i).posY) + ",";
+            EXPECT_EQ(lines[i + 1].rfind(expected, 0), 0u) << "row " << i;
+        }
+
+        std::ifstream json(directory + "/exports/retired.json");
+        ASSERT_TRUE(json.is_open());
+        const nlohmann::json exported = nlohmann::json::parse(json);
+        EXPECT_EQ(exported["data"].size(), 5u); // the batch after two saved segments
+        EXPECT_EQ(exported["metadata"]["total_experiences"], 5);
+        collector.stopCollection();
+        collector.flushPendingWrites();
+    }
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include "DQNTrainer.hpp"
+#include "TFWrapper.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+
+namespace {
+    DQNTrainerConfig smallConfig() {
+        DQNTrainerConfig config;
+        config.hiddenLayers = {32, 32};
+        config.batchSize = 32;
+        config.replayCapacity = 4000;
+        config.targetSyncInterval = 100;
+        config.publishInterval = 50;
+        config.learningRate = 0.003f;
+        config.seed = 1234;
+        return config;
+    }
+
+    // Contextual bandit: the rewarded action is encoded in the nearbyTrees feature
+    void fillBandit(DQNTrainer& trainer, std::mt19937& rng, int count) {
+        std::uniform_int_distribution<int> feature(0, 2);
+        std::uniform_int_distribution<int> action(0, 10);
+        for (int i = 0; i < count; ++i) {
+            float state[7] = {static_cast<float>(i % 25), static_cast<float>((i * 3) % 25),
+                              static_cast<float>(feature(rng)), 1, 0, 1, 1};
+            const int chosen = action(rng);
+            const float reward = chosen == static_cast<int>(state[2]) ? 1.0f : 0.0f;
+            trainer.addExperience(state, chosen, reward, state, true);
+        }
+    }
+}
+
+TEST(DQNTrainerTest, LearnsRewardedActions) {
+    DQNTrainer trainer(smallConfig());
+    std::mt19937 rng(5);
+    fillBandit(trainer, rng, 3000);
+
+    float firstLoss = trainer.trainStep();
+    ASSERT_GE(firstLoss, 0.0f);
+    for (int step = 1; step < 1500; ++step) trainer.trainStep();
+    EXPECT_LT(trainer.getLastLoss(), firstLoss);
+
+    auto policy = trainer.getPublishedPolicy();
+    ASSERT_TRUE(policy);
+    PolicyNetwork::Workspace workspace;
+    std::vector<float> q(policy->getOutputSize());
+    for (int best = 0; best < 3; ++best) {
+        float state[7] = {12, 12, static_cast<float>(best), 1, 0, 1, 1};
+        policy->forward(state, q.data(), workspace);
+        EXPECT_EQ(PolicyNetwork::argmax(q.data(), static_cast<int>(q.size())), best);
+    }
+}
+
+TEST(DQNTrainerTest, NeedsFullBatchBeforeTraining) {
+    DQNTrainer trainer(smallConfig());
+    std::mt19937 rng(9);
+    fillBandit(trainer, rng, 10);
+    EXPECT_LT(trainer.trainStep(), 0.0f);
+    EXPECT_EQ(trainer.getStepCount(), 0u);
+
+    // steps are only owed from the first full batch on
+    fillBandit(trainer, rng, smallConfig().batchSize - 11);
+    EXPECT_FLOAT_EQ(trainer.getPendingSteps(), 0.0f);
+    fillBandit(trainer, rng, 3);
+    EXPECT_FLOAT_EQ(trainer.getPendingSteps(), 3.0f); // the 32nd experience completes the batch
+}
+
+// Checkpoints use the MSPN format, so the inference wrapper and a fresh trainer can both load them
+TEST(DQNTrainerTest, CheckpointLoadsIntoWrapperAndTrainer) {
+    DQNTrainer trainer(smallConfig());
+    std::mt19937 rng(11);
+    fillBandit(trainer, rng, 200);
+    for (int step = 0; step < 50; ++step) trainer.trainStep();
+
+    const std::string path = "test_dqn_checkpoint.bin";
+    ASSERT_TRUE(trainer.saveCheckpoint(path));
+
+    TensorFlowWrapper wrapper;
+    ASSERT_TRUE(wrapper.initialize(path));
+    EXPECT_TRUE(wrapper.isNativePolicy());
+
+    DQNTrainer resumed(smallConfig());
+    ASSERT_TRUE(resumed.loadWeights(path));
+    std::remove(path.c_str());
+
+    float state[7] = {3, 4, 1, 0, 2, 1, 0};
+    std::vector<float> a(11), b(11);
+    PolicyNetwork::Workspace workspace;
+    trainer.getPublishedPolicy()->forward(state, a.data(), workspace);
+    resumed.getPublishedPolicy()->forward(state, b.data(), workspace);
+    EXPECT_EQ(a, b);
+}
+
+TEST(DQNTrainerTest, BackgroundWorkerTrainsOnIncomingExperiences) {
+    DQNTrainer trainer(smallConfig());
+    trainer.start();
+    ASSERT_TRUE(trainer.isRunning());
+
+    std::mt19937 rng(13);
+    fillBandit(trainer, rng, 200);
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (trainer.getStepCount() < 100 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    trainer.stop();
+
+    EXPECT_GE(trainer.getStepCount(), 100u);
+    EXPECT_LT(trainer.getEpsilon(), smallConfig().epsilonStart);
+}
+
+// With calibration rows the trainer publishes an int8 copy next to each snapshot, and the
+// wrapper adopts it without quantizing on the inference side
+TEST(DQNTrainerTest, PublishesQuantizedCopyWhenCalibrated) {
+    DQNTrainer trainer(smallConfig());
+    std::mt19937 rng(17);
+    fillBandit(trainer, rng, 200);
+    for (int step = 0; step < 10; ++step) trainer.trainStep();
+    EXPECT_FALSE(trainer.getPublished().quantized); // no calibration yet
+
+    std::vector<float> calibration;
+    for (int i = 0; i < 128; ++i) {
+        const float state[7] = {static_cast<float>(i % 25), static_cast<float>((i * 7) % 25),
+                                static_cast<float>(i % 3), 1, 0, 1, 1};
+        calibration.insert(calibration.end(), state, state + 7);
+    }
+    trainer.setQuantizationCalibration(calibration, 0.0f);
+    for (int step = 0; step < smallConfig().publishInterval; ++step) trainer.trainStep();
+
+    const DQNTrainer::PublishedPolicy published = trainer.getPublished();
+    ASSERT_TRUE(published.policy);
+    ASSERT_TRUE(published.quantized);
+    EXPECT_EQ(published.report.samples, 128);
+
+    TensorFlowWrapper wrapper;
+    ASSERT_TRUE(wrapper.setNativePolicy(*published.policy, published.quantized, published.report));
+    EXPECT_TRUE(wrapper.isQuantized());
+    EXPECT_EQ(wrapper.getQuantizationReport().samples, 128);
+
+    // a publish without an int8 copy drops back to fp32
+    ASSERT_TRUE(wrapper.setNativePolicy(*published.policy, nullptr, {}));
+    EXPECT_FALSE(wrapper.isQuantized());
+}
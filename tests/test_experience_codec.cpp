@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "ExperienceCodec.hpp"
+
+#include <cstring>
+#include <random>
+
+namespace {
+    // NPCs walking around: state follows the previous nextState, one or two fields change per step
+    std::vector<ExperienceRecord> simulate(size_t count, int npcs) {
+        std::mt19937 rng(3);
+        std::vector<State> current(npcs);
+        for (int n = 0; n < npcs; ++n) current[n] = {100 + n * 7, 200 + n, 2, 1, 0, 2, 0};
+
+        const float rewards[] = {-1.0f, 0.5f, 2.0f, 10.0f};
+        std::vector<ExperienceRecord> records;
+        for (size_t i = 0; i < count; ++i) {
+            const int n = static_cast<int>(i % npcs);
+            State next = current[n];
+            next.posX += static_cast<int>(rng() % 3) - 1;
+            if (rng() % 4 == 0) next.nearbyTrees = static_cast<int>(rng() % 10);
+            if (rng() % 8 == 0) next.energyLevel = static_cast<int>(rng() % 3);
+
+            ExperienceRecord record{};
+            record.state = packExperienceState(current[n]);
+            record.nextState = packExperienceState(next);
+            record.reward = rewards[rng() % 4];
+            record.tick = static_cast<uint32_t>(i / npcs);
+            record.npcId = static_cast<uint16_t>(n + 3);
+            record.action = static_cast<uint8_t>(1 + rng() % 17);
+            record.done = rng() % 50 == 0;
+            records.push_back(record);
+            current[n] = next;
+        }
+        return records;
+    }
+
+    void expectSame(const std::vector<ExperienceRecord>& expected, const std::vector<ExperienceRecord>& actual) {
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_EQ(std::memcmp(&expected[i], &actual[i], sizeof(ExperienceRecord)), 0) << "record " << i;
+        }
+    }
+}
+
+TEST(ExperienceCodecTest, RoundTripIsExactAndCompact) {
+    const auto records = simulate(20000, 12);
+    std::vector<std::string> names(20);
+    for (size_t i = 0; i < names.size(); ++i) names[i] = "NPC_" + std::to_string(i);
+
+    std::string bytes;
+    ExperienceCodec::encode(records.data(), records.size(), &names, 123.0f, bytes);
+    // ~10x below .npz (65 bytes per experience)
+    EXPECT_LT(bytes.size(), records.size() * 8);
+
+    ExperienceCodec::Block block;
+    ASSERT_TRUE(ExperienceCodec::decode(bytes.data(), bytes.size(), block));
+    expectSame(records, block.records);
+    EXPECT_FLOAT_EQ(block.timestamp, 123.0f);
+    ASSERT_EQ(block.npcNames.size(), 15u);        // ids 3..14, only used names are stored
+    EXPECT_EQ(block.npcNames[3], "NPC_3");
+    EXPECT_EQ(block.npcNames[14], "NPC_14");
+    EXPECT_TRUE(block.npcNames[2].empty());
+}
+
+// Blocks concatenate; corrupt or truncated input is rejected without partial blocks
+TEST(ExperienceCodecTest, ConcatenatedBlocksAndCorruption) {
+    const auto first = simulate(300, 3);
+    auto second = simulate(200, 5);
+    for (auto& record : second) record.reward = static_cast<float>(record.tick) * 0.37f; // mostly literal rewards
+
+    std::string bytes;
+    ExperienceCodec::encode(first.data(), first.size(), nullptr, 1.0f, bytes);
+    const size_t firstBlockBytes = bytes.size();
+    ExperienceCodec::encode(second.data(), second.size(), nullptr, 2.0f, bytes);
+
+    ExperienceCodec::Block block;
+    ASSERT_TRUE(ExperienceCodec::decode(bytes.data(), bytes.size(), block));
+    auto expected = first;
+    expected.insert(expected.end(), second.begin(), second.end());
+    expectSame(expected, block.records);
+    EXPECT_FLOAT_EQ(block.timestamp, 2.0f);
+
+    ExperienceCodec::Block truncated;
+    EXPECT_FALSE(ExperienceCodec::decode(bytes.data(), bytes.size() - 3, truncated));
+    EXPECT_EQ(truncated.records.size(), first.size()); // the intact first block survives
+
+    std::string garbage = bytes;
+    garbage[firstBlockBytes + 1] = 'X';
+    ExperienceCodec::Block corrupt;
+    EXPECT_FALSE(ExperienceCodec::decode(garbage.data(), garbage.size(), corrupt));
+    EXPECT_EQ(corrupt.records.size(), first.size());
+
+    ExperienceCodec::Block empty;
+    EXPECT_TRUE(ExperienceCodec::decode(bytes.data(), 0, empty));
+    EXPECT_TRUE(empty.records.empty());
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "ExperienceDataset.hpp"
+#include "ExperienceFixtures.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace ExperienceFixtures;
+
+TEST(ExperienceDatasetTest, MapsSegmentsAndFetchesAcrossThem) {
+    const std::string directory = "test_dataset_segments";
+    std::filesystem::create_directories(directory);
+    ASSERT_TRUE(NumpyIO::writeExperienceNpz(directory + "/batch_0.npz", makeColumns(0, 30, 0.25f, 5)));
+    ASSERT_TRUE(NumpyIO::writeExperienceNpz(directory + "/batch_1.npz", makeColumns(30, 7, 0.25f, 5)));
+    ASSERT_TRUE(NumpyIO::writeExperienceNpz(directory + "/batch_2.npz", makeColumns(37, 50, 0.25f, 5)));
+    {
+        ExperienceDataset dataset;
+        EXPECT_EQ(dataset.addDirectory(directory), 3u);
+        ASSERT_EQ(dataset.size(), 87u);
+
+        for (size_t i : {0u, 29u, 30u, 36u, 37u, 86u}) {
+            EXPECT_EQ(dataset.getState(i), makeState(static_cast<int>(i)));
+            EXPECT_EQ(dataset.getNextState(i), makeState(static_cast<int>(i) + 1));
+            EXPECT_EQ(dataset.getAction(i), static_cast<ActionType>(1 + i % 11));
+            EXPECT_FLOAT_EQ(dataset.getReward(i), i * 0.25f);
+            EXPECT_EQ(dataset.isDone(i), i % 5 == 0);
+        }
+
+        // contiguous fetch spanning all three segments
+        NumpyIO::ExperienceColumns range;
+        dataset.fetch(25, 20, range);
+        const auto expected = makeColumns(25, 20, 0.25f, 5);
+        EXPECT_EQ(range.states, expected.states);
+        EXPECT_EQ(range.actions, expected.actions);
+        EXPECT_EQ(range.rewards, expected.rewards);
+        EXPECT_EQ(range.nextStates, expected.nextStates);
+        EXPECT_EQ(range.dones, expected.dones);
+
+        // an epoch permutation visits every row once
+        std::mt19937 rng(7);
+        auto order = dataset.shuffledIndices(rng);
+        NumpyIO::ExperienceColumns shuffled;
+        dataset.fetch(order.data(), 10, shuffled);
+        ASSERT_EQ(shuffled.size(), 10u);
+        EXPECT_EQ(shuffled.actions[3], static_cast<int32_t>(dataset.getAction(order[3])));
+        std::sort(order.begin(), order.end());
+        for (size_t i = 0; i < order.size(); ++i) EXPECT_EQ(order[i], i);
+    }
+    std::filesystem::remove_all(directory);
+}
+
+TEST(ExperienceDatasetTest, RejectsNonArchives) {
+    const std::string path = "test_dataset_bogus.npz";
+    std::ofstream(path) << "not a zip";
+    ExperienceDataset dataset;
+    EXPECT_FALSE(dataset.addFile(path));
+    EXPECT_FALSE(dataset.addFile("missing_file.npz"));
+    EXPECT_TRUE(dataset.empty());
+    std::filesystem::remove(path);
+}
+
+// Legacy JSON batches stream one experience at a time; metadata is skipped
+TEST(ExperienceDatasetTest, StreamsLegacyJson) {
+    const std::string path = "test_dataset_batch.json";
+    nlohmann::json batch;
+    batch["metadata"] = {{"total_experiences", 12}, {"nested", {{"data", {1, 2, 3}}}}};
+    batch["experiences"] = nlohmann::json::array();
+    for (int i = 0; i < 12; ++i) {
+        batch["experiences"].push_back(ExperienceData(makeState(i), ActionType::Rest, -1.5f * i, makeState(i + 1),
+                                                      i == 11, "NPC_" + std::to_string(i % 3), 100.0f + i).toJson());
+    }
+    std::ofstream(path) << batch.dump();
+
+    std::vector<ExperienceData> loaded;
+    EXPECT_TRUE(streamExperienceJson(path, [&](const ExperienceData& exp) { loaded.push_back(exp); }));
+    ASSERT_EQ(loaded.size(), 12u);
+    EXPECT_EQ(loaded[4].state, makeState(4));
+    EXPECT_EQ(loaded[4].nextState, makeState(5));
+    EXPECT_EQ(loaded[4].action, ActionType::Rest);
+    EXPECT_FLOAT_EQ(loaded[4].reward, -6.0f);
+    EXPECT_EQ(loaded[4].npcName, "NPC_1");
+    EXPECT_TRUE(loaded[11].done);
+    EXPECT_FALSE(loaded[10].done);
+
+    // truncated file: earlier experiences arrive, the call reports the error
+    std::string text = batch.dump();
+    std::ofstream(path) << text.substr(0, text.size() / 2);
+    size_t partial = 0;
+    EXPECT_FALSE(streamExperienceJson(path, [&](const ExperienceData&) { ++partial; }));
+    EXPECT_LT(partial, 12u);
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include "DataCollector.hpp"
+#include "ExperienceWriter.hpp"
+#include "NumpyIO.hpp"
+
+#include <filesystem>
+
+namespace {
+    ExperienceRecord makeRecord(int i, ActionType action) {
+        ExperienceRecord record{};
+        record.state = packExperienceState({i % 25, i / 25, 0, 0, 0, 1, 0});
+        record.nextState = record.state;
+        record.reward = static_cast<float>(i);
+        record.action = static_cast<uint8_t>(action);
+        return record;
+    }
+}
+
+TEST(ExperienceIngestionTest, DropsRepeatedStateActionPairs) {
+    IngestionPolicy policy;
+    policy.dedup = true;
+    ExperienceIngestion ingestion(policy);
+
+    const auto rest = makeRecord(3, ActionType::Rest);
+    EXPECT_EQ(ingestion.offer(rest, 0, 100).decision, ExperienceIngestion::Decision::Append);
+    EXPECT_EQ(ingestion.offer(rest, 1, 100).decision, ExperienceIngestion::Decision::DropDuplicate);
+    EXPECT_EQ(ingestion.offer(makeRecord(3, ActionType::ChopTree), 1, 100).decision,
+              ExperienceIngestion::Decision::Append);
+    EXPECT_EQ(ingestion.getDuplicatesDropped(), 1u);
+}
+
+// A dominant action is reservoir-sampled down to its quota; rare actions are all kept
+TEST(ExperienceIngestionTest, StratifiesActionsPerBatch) {
+    const std::string directory = "test_ingestion_output";
+    {
+        DataCollector collector(directory);
+        collector.setMaxExperiencesPerFile(40);
+        IngestionPolicy policy;
+        policy.maxActionShare = 0.25f;
+        collector.setIngestionPolicy(policy);
+        collector.startCollection();
+
+        for (int i = 0; i < 40; ++i) {
+            const ActionType action = i % 4 == 0 ? ActionType::ChopTree : ActionType::Rest;
+            collector.recordExperience({i, 0, 0, 0, 0, 1, 0}, action, 1.0f, {i, 0, 0, 0, 0, 1, 0}, false, "NPC_1");
+        }
+        collector.advanceTick();
+
+        // window of 40 complete: 10 ChopTree + 10 of the 30 Rest were kept
+        EXPECT_EQ(collector.getTotalExperiences(), 20u);
+        EXPECT_EQ(collector.getSampledOut(), 20u);
+        auto distribution = collector.getActionDistribution();
+        EXPECT_FLOAT_EQ(distribution[static_cast<int>(ActionType::Rest)], 0.5f);
+        collector.stopCollection();
+        collector.flushPendingWrites();
+    }
+    std::filesystem::remove_all(directory);
+}
+
+TEST(ExperienceIngestionTest, SpilledJobIsWrittenFromDisk) {
+    std::vector<ExperienceRecord> records;
+    for (int i = 0; i < 50; ++i) records.push_back(makeRecord(i, ActionType::MineRock));
+
+    const std::string spill = "test_ingestion.spill";
+    const std::string npz = "test_ingestion.npz";
+    ASSERT_TRUE(ExperienceWriter::writeSpill(spill, records));
+    {
+        ExperienceWriter writer;
+        ExperienceWriter::Job job;
+        job.spillPath = spill;
+        job.npzPath = npz;
+        writer.submit(std::move(job));
+        writer.flush();
+        EXPECT_EQ(writer.getPendingBytes(), 0u);
+    }
+    EXPECT_FALSE(std::filesystem::exists(spill));
+
+    NumpyIO::ExperienceColumns columns;
+    ASSERT_TRUE(NumpyIO::readExperienceNpz(npz, columns));
+    ASSERT_EQ(columns.size(), 50u);
+    EXPECT_FLOAT_EQ(columns.rewards[49], 49.0f);
+    std::filesystem::remove(npz);
+}
+
+// A tiny budget caps the batch size; nothing recorded is lost
+TEST(ExperienceIngestionTest, MemoryBudgetBoundsBatches) {
+    const std::string directory = "test_budget_output";
+    {
+        DataCollector collector(directory);
+        IngestionPolicy policy;
+        policy.memoryBudgetBytes = 64 * 2 * sizeof(ExperienceRecord); // 64-record batches
+        collector.setIngestionPolicy(policy);
+        collector.startCollection();
+
+        for (int i = 0; i < 1000; ++i) {
+            collector.recordExperience({i % 25, i / 25, 0, 0, 0, 1, 0}, ActionType::Explore, 0.0f,
+                                       {i % 25, i / 25, 0, 0, 0, 1, 0}, false, "NPC_1");
+        }
+        EXPECT_EQ(collector.getCurrentBatchSize(), 1000u % 64);
+        EXPECT_EQ(collector.getTotalExperiences(), 1000u - 1000u % 64);
+
+        collector.exportToNumpyFormat("budget");
+        NumpyIO::ExperienceColumns merged;
+        ASSERT_TRUE(NumpyIO::readExperienceNpz(directory + "/exports/budget.npz", merged));
+        EXPECT_EQ(merged.size(), 1000u);
+        collector.stopCollection();
+        collector.flushPendingWrites();
+    }
+    std::filesystem::remove_all(directory);
+}
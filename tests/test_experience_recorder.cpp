@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "DataCollector.hpp"
+#include "ExperienceRecorder.hpp"
+
+#include <filesystem>
+#include <thread>
+
+TEST(ExperienceRecorderTest, PackedStateRoundTrip) {
+    State state{1234, 77, 12, 3, 40, 2, 1};
+    state.rockDensity = 3;
+    EXPECT_EQ(unpackExperienceState(packExperienceState(state)), state);
+
+    // out-of-range values clamp to the field width instead of bleeding into neighbours
+    State clamped = unpackExperienceState(packExperienceState({-5, 70000, 99, 0, 0, 200, 0}));
+    EXPECT_EQ(clamped.posX, 0);
+    EXPECT_EQ(clamped.posY, 65535);
+    EXPECT_EQ(clamped.nearbyTrees, 63);
+    EXPECT_EQ(clamped.nearbyRocks, 0);
+    EXPECT_EQ(clamped.energyLevel, 7); // quantized levels, 3 bits
+    EXPECT_EQ(clamped.treeDensity, 0);
+}
+
+// Producers append while the consumer drains; nothing is lost or reordered within a thread
+TEST(ExperienceRecorderTest, ConcurrentProducersAndDrain) {
+    constexpr int kThreads = 4;
+    constexpr uint32_t kPerThread = 3 * ExperienceRecorder::kChunkCapacity + 123;
+
+    ExperienceRecorder recorder;
+    std::vector<std::thread> producers;
+    for (int t = 0; t < kThreads; ++t) {
+        producers.emplace_back([&recorder, t] {
+            for (uint32_t i = 0; i < kPerThread; ++i) {
+                ExperienceRecord record{};
+                record.npcId = static_cast<uint16_t>(t);
+                record.tick = i;
+                recorder.append(record);
+            }
+        });
+    }
+
+    std::vector<ExperienceRecord> drained;
+    std::vector<uint32_t> nextTick(kThreads, 0);
+    auto check = [&](size_t from) {
+        for (size_t i = from; i < drained.size(); ++i) {
+            ASSERT_EQ(drained[i].tick, nextTick[drained[i].npcId]++);
+        }
+    };
+    while (drained.size() < kThreads * kPerThread) {
+        const size_t before = drained.size();
+        recorder.drain(drained);
+        check(before);
+    }
+    for (auto& producer : producers) producer.join();
+
+    const size_t before = drained.size();
+    EXPECT_EQ(recorder.drain(drained), 0u);
+    check(before);
+    EXPECT_EQ(drained.size(), static_cast<size_t>(kThreads) * kPerThread);
+}
+
+TEST(ExperienceRecorderTest, CollectorBatchesRecordsPerTick) {
+    const std::string directory = "test_recorder_output";
+    {
+        DataCollector collector(directory);
+        collector.setMaxExperiencesPerFile(8);
+        collector.startCollection();
+
+        const uint16_t alice = collector.registerNpc("Alice");
+        EXPECT_EQ(collector.registerNpc("Bob"), alice + 1);
+        EXPECT_EQ(collector.registerNpc("Alice"), alice);
+
+        State state{3, 4, 1, 0, 2, 1, 0};
+        for (int i = 0; i < 5; ++i) {
+            collector.recordExperience(state, ActionType::Rest, 0.5f, state, false, alice);
+        }
+        collector.advanceTick();
+        collector.recordExperience(state, ActionType::ChopTree, 2.0f, state, true, "Bob");
+
+        auto batch = collector.getCurrentBatch();
+        ASSERT_EQ(batch.size(), 6u);
+        EXPECT_EQ(batch.getNpcName(0), "Alice");
+        EXPECT_EQ(batch[0].tick, 0u);
+        EXPECT_EQ(batch.getNpcName(5), "Bob");
+        EXPECT_EQ(batch[5].tick, 1u);
+        EXPECT_TRUE(batch.expand(5).done);
+        EXPECT_EQ(batch.expand(5).state, state);
+
+        for (int i = 0; i < 4; ++i) {
+            collector.recordExperience(state, ActionType::Rest, 0.5f, state, false, alice);
+        }
+        collector.advanceTick();
+        EXPECT_EQ(collector.getCurrentBatchSize(), 2u); // 8 went to the writer
+        EXPECT_EQ(collector.getTotalExperiences(), 8u);
+
+        // the view still shows the batch as it was, although that buffer went to the writer
+        ASSERT_EQ(batch.size(), 6u);
+        EXPECT_EQ(batch.getNpcName(0), "Alice");
+        collector.stopCollection();
+        collector.flushPendingWrites();
+    }
+    std::filesystem::remove_all(directory);
+}
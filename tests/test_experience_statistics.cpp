@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "DataCollector.hpp"
+
+#include <cmath>
+#include <filesystem>
+
+TEST(ExperienceStatisticsTest, WelfordMatchesTwoPassResult) {
+    ExperienceStatistics statistics;
+    std::vector<float> rewards = {1.5f, -3.0f, 10.0f, 0.25f, 7.0f, -100.0f, 42.0f};
+    for (size_t i = 0; i < rewards.size(); ++i) {
+        ExperienceRecord record{};
+        record.reward = rewards[i];
+        record.action = static_cast<uint8_t>(i % 2 ? ActionType::Rest : ActionType::Explore);
+        record.npcId = static_cast<uint16_t>(i % 3);
+        record.done = i == 5;
+        statistics.update(record);
+    }
+
+    double mean = 0.0;
+    for (float r : rewards) mean += r;
+    mean /= rewards.size();
+    double variance = 0.0;
+    for (float r : rewards) variance += (r - mean) * (r - mean);
+    variance /= rewards.size();
+
+    const auto& s = statistics.get();
+    EXPECT_EQ(s.count, rewards.size());
+    EXPECT_EQ(s.terminalCount, 1u);
+    EXPECT_NEAR(s.rewardMean, mean, 1e-9);
+    EXPECT_NEAR(s.rewardVariance, variance, 1e-6);
+    EXPECT_FLOAT_EQ(s.rewardMin, -100.0f);
+    EXPECT_FLOAT_EQ(s.rewardMax, 42.0f);
+    EXPECT_EQ(s.actionCounts[static_cast<size_t>(ActionType::Rest)], 3u);
+    ASSERT_EQ(s.npcCounts.size(), 3u);
+    EXPECT_EQ(s.npcCounts[0], 3u);
+
+    uint64_t binned = 0;
+    for (auto count : s.rewardHistogram) binned += count;
+    EXPECT_EQ(binned, rewards.size());
+    EXPECT_EQ(s.rewardHistogram.front(), 1u); // -100
+}
+
+TEST(ExperienceStatisticsTest, CountMinNeverUnderestimates) {
+    CountMinSketch sketch;
+    for (uint64_t key = 0; key < 500; ++key) {
+        for (uint64_t n = 0; n <= key % 4; ++n) sketch.add(key);
+    }
+    size_t exact = 0;
+    for (uint64_t key = 0; key < 500; ++key) {
+        const uint32_t estimate = sketch.estimate(key);
+        EXPECT_GE(estimate, key % 4 + 1);
+        if (estimate == key % 4 + 1) ++exact;
+    }
+    EXPECT_GT(exact, 450u); // most keys stay exact at this load
+}
+
+// Stats cover the whole session, not just the in-memory batch
+TEST(ExperienceStatisticsTest, CollectorPublishesSessionSnapshot) {
+    const std::string directory = "test_statistics_output";
+    {
+        DataCollector collector(directory);
+        collector.setMaxExperiencesPerFile(10);
+        collector.startCollection();
+        const State home{5, 6, 0, 0, 0, 1, 0};
+        for (int i = 0; i < 35; ++i) {
+            collector.recordExperience(home, ActionType::Rest, static_cast<float>(i), home, false, "NPC_1");
+        }
+        collector.advanceTick();
+
+        auto stats = collector.getStatistics();
+        EXPECT_EQ(stats->count, 35u);
+        EXPECT_NEAR(stats->rewardMean, 17.0, 1e-9);
+        EXPECT_FLOAT_EQ(collector.getAverageReward(), 17.0f);
+        EXPECT_EQ(collector.getRewardRange(), std::make_pair(0.0f, 34.0f));
+        EXPECT_GE(stats->estimateStateVisits(home), 35u);
+        EXPECT_GE(stats->estimatePositionVisits(5, 6), 35u);
+        EXPECT_FLOAT_EQ(collector.getActionDistribution()[static_cast<int>(ActionType::Rest)], 1.0f);
+        collector.stopCollection();
+        collector.flushPendingWrites();
+    }
+    std::filesystem::remove_all(directory);
+}
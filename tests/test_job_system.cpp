@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include "JobSystem.hpp"
+
+#include <atomic>
+#include <vector>
+
+// Every index is visited exactly once, also when a chunk starts its own parallelFor
+TEST(JobSystemTest, ParallelForCoversRangeOnce) {
+    JobSystem jobs(3);
+    std::vector<std::atomic<int>> visits(5000);
+    jobs.parallelFor(0, visits.size(), 7, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) visits[i].fetch_add(1);
+    });
+    for (const auto& v : visits) ASSERT_EQ(v.load(), 1);
+
+    std::vector<std::atomic<int>> nested(40 * 100);
+    jobs.parallelFor(0, 40, 1, [&](size_t first, size_t last) {
+        for (size_t row = first; row < last; ++row) {
+            jobs.parallelFor(0, 100, 8, [&](size_t a, size_t b) {
+                for (size_t i = a; i < b; ++i) nested[row * 100 + i].fetch_add(1);
+            });
+        }
+    });
+    for (const auto& v : nested) ASSERT_EQ(v.load(), 1);
+
+    // a range smaller than the grain runs inline on the caller
+    int sum = 0;
+    JobSystem(1).parallelFor(0, 10, 100, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) sum += static_cast<int>(i);
+    });
+    EXPECT_EQ(sum, 45);
+}
+
+// Jobs start only after their dependencies, and scratch memory is handed back after each job
+TEST(JobSystemTest, TaskGraphRespectsDependencies) {
+    JobSystem jobs(2);
+    std::atomic<int> stage{0};
+    std::atomic<bool> ordered{true};
+
+    auto a = jobs.submit([&] { stage.fetch_add(1); });
+    auto b = jobs.submit([&] { stage.fetch_add(1); });
+    auto c = jobs.submit([&] {
+        if (stage.load() != 2) ordered = false;
+        stage.store(10);
+    }, {a, b});
+    auto d = jobs.submit([&] {
+        if (stage.load() != 10) ordered = false;
+        int* scratch = ScratchArena::local().allocate<int>(1000);
+        for (int i = 0; i < 1000; ++i) scratch[i] = i;
+        stage.store(scratch[999]);
+    }, {c});
+    jobs.wait(d);
+    EXPECT_TRUE(ordered.load());
+    EXPECT_EQ(stage.load(), 999);
+    // a finished dependency doesn't hold anything back
+    jobs.wait(jobs.submit([&] { stage.store(-1); }, {a, d}));
+    EXPECT_EQ(stage.load(), -1);
+
+    ScratchArena arena;
+    const ScratchArena::Mark start = arena.mark();
+    void* first = arena.allocate<double>(16);
+    arena.rewind(start);
+    EXPECT_EQ(arena.allocate<double>(16), first);
+    const size_t capacity = arena.capacity();
+    arena.rewind(start);
+    arena.allocate<char>(100);
+    EXPECT_EQ(arena.capacity(), capacity); // reused, not grown
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include "MapGenerator.hpp"
+#include "JobSystem.hpp"
+#include "FastNoiseLite.h"
+
+#include <set>
+
+// Batched rows reproduce FastNoiseLite's per-tile Perlin noise, negative seeds included
+TEST(MapGeneratorTest, RowsMatchFastNoiseLite) {
+    for (int seed : {1337, -94211, 1700000000}) {
+        FastNoiseLite noise;
+        noise.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
+        noise.SetFrequency(0.1f);
+        noise.SetSeed(seed);
+
+        const PerlinRows rows(seed, 0.1f, 157);
+        std::vector<float> row(157);
+        for (int y = 0; y < 60; ++y) {
+            rows.row(y, row.data());
+            for (int x = 0; x < 157; ++x) {
+                ASSERT_NEAR(row[x], noise.GetNoise(static_cast<float>(y), static_cast<float>(x)), 1e-5f)
+                    << "seed " << seed << " at (" << x << ", " << y << ")";
+            }
+        }
+    }
+}
+
+// The same settings give the same map whatever the thread count; buildings land on distinct
+// free tiles and resources only on their biome
+TEST(MapGeneratorTest, DeterministicAndConsistent) {
+    MapGenerator::Settings settings;
+    settings.width = 300;
+    settings.height = 211;
+    settings.seed = 77;
+    settings.houseCount = 40;
+    settings.marketCount = 3;
+
+    JobSystem serial(1);
+    JobSystem wide(4);
+    const MapGenerator generator;
+    const MapLayout a = generator.generate(settings, serial);
+    const MapLayout b = generator.generate(settings, wide);
+    EXPECT_EQ(a.noise, b.noise);
+    EXPECT_EQ(a.objects, b.objects);
+    EXPECT_EQ(a.terrainVariant, b.terrainVariant);
+    EXPECT_EQ(a.houses, b.houses);
+    EXPECT_EQ(a.markets, b.markets);
+
+    ASSERT_EQ(a.houses.size(), 40u);
+    ASSERT_EQ(a.markets.size(), 3u);
+    std::set<uint32_t> buildings(a.houses.begin(), a.houses.end());
+    buildings.insert(a.markets.begin(), a.markets.end());
+    EXPECT_EQ(buildings.size(), 43u);
+
+    size_t trees = 0, houses = 0;
+    for (size_t i = 0; i < a.objects.size(); ++i) {
+        EXPECT_EQ(a.terrain[i], MapGenerator::terrainFor(a.noise[i]));
+        switch (a.objects[i]) {
+            case ObjectType::Tree:
+            case ObjectType::Bush: EXPECT_EQ(a.terrain[i], Terrain::Grass); ++trees; break;
+            case ObjectType::Rock: EXPECT_EQ(a.terrain[i], Terrain::Stone); break;
+            case ObjectType::House: ++houses; EXPECT_LT(a.objectVariant[i], 3); break;
+            default: break;
+        }
+    }
+    EXPECT_GT(trees, 0u);
+    EXPECT_EQ(houses, 40u);
+
+    // the buildings alone, without keeping the map, land exactly where generate() puts them
+    const std::vector<MapGenerator::Building> sites = generator.placeBuildings(settings, wide);
+    ASSERT_EQ(sites.size(), 43u);
+    for (size_t i = 0; i < sites.size(); ++i) {
+        const bool isHouse = i < a.houses.size();
+        EXPECT_EQ(sites[i].tile, isHouse ? a.houses[i] : a.markets[i - a.houses.size()]);
+        EXPECT_EQ(sites[i].type, a.objects[sites[i].tile]);
+        EXPECT_EQ(sites[i].variant, a.objectVariant[sites[i].tile]);
+    }
+
+    settings.seed = 78;
+    EXPECT_NE(generator.generate(settings, wide).objects, a.objects);
+}
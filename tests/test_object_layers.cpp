@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "ObjectLayers.hpp"
+#include "Tile.hpp"
+
+#include <random>
+
+namespace {
+    // 70 columns so neighbourhoods straddle the 64-bit word boundary
+    TileGrid makeGrid(int width, int height) {
+        TileGrid grid(height);
+        for (auto& row : grid) {
+            for (int x = 0; x < width; ++x) row.push_back(std::make_unique<Tile>());
+        }
+        return grid;
+    }
+
+    std::unique_ptr<Object> makeObject(int kind, const sf::Texture& texture) {
+        switch (kind) {
+            case 0: return std::make_unique<Tree>(texture);
+            case 1: return std::make_unique<Rock>(texture);
+            default: return std::make_unique<Bush>(texture);
+        }
+    }
+}
+
+// Bitboard counts match a tile walk while objects are placed, replaced and removed
+TEST(ObjectLayersTest, MatchesTileWalkUnderEdits) {
+    sf::Texture texture;
+    TileGrid attached = makeGrid(70, 9);
+    TileGrid plain = makeGrid(70, 9);
+    ObjectLayers layers;
+    attached[2][3]->placeObject(std::make_unique<Tree>(texture)); // placed before attaching
+    plain[2][3]->placeObject(std::make_unique<Tree>(texture));
+    layers.attach(attached);
+    EXPECT_TRUE(layers.test(ObjectType::Tree, 3, 2));
+
+    std::mt19937 rng(11);
+    for (int step = 0; step < 3000; ++step) {
+        const int x = static_cast<int>(rng() % 70);
+        const int y = static_cast<int>(rng() % 9);
+        if (rng() % 3 == 0) {
+            attached[y][x]->removeObject();
+            plain[y][x]->removeObject();
+        } else {
+            const int kind = static_cast<int>(rng() % 3);
+            attached[y][x]->placeObject(makeObject(kind, texture));
+            plain[y][x]->placeObject(makeObject(kind, texture));
+        }
+    }
+
+    for (int y = -1; y <= 9; ++y) {
+        for (int x = -1; x <= 70; ++x) {
+            const NeighborhoodCounts fast = ObjectLayers::neighborhood(attached, x, y);
+            const NeighborhoodCounts walked = ObjectLayers::neighborhood(plain, x, y);
+            if (x < 0 || y < 0 || x >= 70 || y >= 9) continue; // off-map: no tile to find the layers through
+            ASSERT_EQ(fast.counts, walked.counts) << "at " << x << "," << y;
+        }
+    }
+    // windows wider than a word still count every row word
+    EXPECT_EQ(layers.countAround(ObjectType::Tree, 0, 0, 100), layers.countAround(ObjectType::Tree, 35, 4, 40));
+}
+
+TEST(ObjectLayersTest, CountsClipAtMapEdges) {
+    ObjectLayers layers;
+    layers.resize(130, 3);
+    for (int x = 60; x < 70; ++x) layers.set(ObjectType::Rock, x, 1);
+    layers.set(ObjectType::Rock, 129, 2);
+    layers.set(ObjectType::Rock, 200, 1); // outside: ignored
+
+    EXPECT_EQ(layers.countAround(ObjectType::Rock, 63, 1), 3);
+    EXPECT_EQ(layers.countAround(ObjectType::Rock, 64, 0), 3);
+    EXPECT_EQ(layers.countAround(ObjectType::Rock, 129, 2), 1);
+    EXPECT_EQ(layers.countAround(ObjectType::Rock, 64, 1, 5), 10);
+    EXPECT_EQ(layers.neighborhood(63, 1).total(), 3);
+
+    layers.reset(ObjectType::Rock, 63, 1);
+    EXPECT_EQ(layers.countAround(ObjectType::Rock, 63, 1), 2);
+    EXPECT_EQ(layers.countAround(ObjectType::Tree, 63, 1), 0);
+}
+
+// Fenwick trees answer wide windows exactly like the popcount path
+TEST(ObjectLayersTest, AreaSumsMatchPopcountUnderEdits) {
+    ObjectLayers sums;
+    ObjectLayers bits;
+    sums.resize(90, 40);
+    bits.resize(90, 40);
+    std::mt19937 rng(5);
+    for (int i = 0; i < 600; ++i) { // loaded before enabling
+        const auto type = static_cast<ObjectType>(1 + rng() % 3);
+        const int x = static_cast<int>(rng() % 90);
+        const int y = static_cast<int>(rng() % 40);
+        sums.set(type, x, y);
+        bits.set(type, x, y);
+    }
+    sums.enableAreaSums();
+    ASSERT_TRUE(sums.hasAreaSums());
+
+    for (int step = 0; step < 4000; ++step) {
+        const auto type = static_cast<ObjectType>(1 + rng() % 3);
+        const int x = static_cast<int>(rng() % 90);
+        const int y = static_cast<int>(rng() % 40);
+        if (rng() % 3 == 0) {
+            sums.reset(type, x, y);
+            bits.reset(type, x, y);
+        } else {
+            sums.set(type, x, y); // setting a set bit must not count twice
+            bits.set(type, x, y);
+        }
+    }
+
+    for (int radius : {1, 2, 4, 8, 40}) {
+        for (int y = -2; y < 42; y += 3) {
+            for (int x = -2; x < 92; x += 5) {
+                for (ObjectType type : {ObjectType::Tree, ObjectType::Rock, ObjectType::Bush}) {
+                    ASSERT_EQ(sums.countAround(type, x, y, radius), bits.countAround(type, x, y, radius))
+                        << "radius " << radius << " at " << x << "," << y;
+                }
+            }
+        }
+    }
+}
+
+TEST(ObjectLayersTest, DensityLevels) {
+    EXPECT_EQ(ObjectLayers::densityLevel(0, 2), 0);
+    EXPECT_EQ(ObjectLayers::densityLevel(1, 2), 1);  // 1 of 25
+    EXPECT_EQ(ObjectLayers::densityLevel(6, 2), 2);
+    EXPECT_EQ(ObjectLayers::densityLevel(7, 2), 3);
+    EXPECT_EQ(ObjectLayers::densityLevel(18, 8), 1); // 18 of 289
+    EXPECT_EQ(ObjectLayers::densityLevel(73, 8), 3);
+
+    // attached grids and plain ones agree
+    sf::Texture texture;
+    TileGrid attached = makeGrid(20, 20);
+    TileGrid plain = makeGrid(20, 20);
+    for (int i = 0; i < 8; ++i) {
+        attached[10][3 + i]->placeObject(std::make_unique<Rock>(texture));
+        plain[10][3 + i]->placeObject(std::make_unique<Rock>(texture));
+    }
+    ObjectLayers layers;
+    layers.attach(attached);
+    layers.enableAreaSums();
+    for (int radius : {2, 4, 8}) {
+        EXPECT_EQ(ObjectLayers::densityLevel(attached, ObjectType::Rock, 6, 12, radius),
+                  ObjectLayers::densityLevel(plain, ObjectType::Rock, 6, 12, radius));
+    }
+    EXPECT_EQ(ObjectLayers::densityLevel(attached, ObjectType::Rock, 6, 12, 2), 2); // 5 of 25
+    EXPECT_EQ(ObjectLayers::densityLevel(attached, ObjectType::Rock, 6, 10, 1), 3); // 3 of 9
+    EXPECT_EQ(ObjectLayers::densityLevel(attached, ObjectType::Rock, 6, 2, 2), 0);
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include "ObservationBuilder.hpp"
+#include "NPCEntity.hpp"
+#include "Market.hpp"
+#include "TFWrapper.hpp"
+#include "DataCollector.hpp"
+#include "Configuration.hpp"
+
+#include <filesystem>
+
+namespace {
+    // grass everywhere, a water column at x = 4
+    TileGrid makeGrid(int width, int height, const sf::Texture& texture) {
+        TileGrid grid(height);
+        for (auto& row : grid) {
+            for (int x = 0; x < width; ++x) {
+                if (x == 4) row.push_back(std::make_unique<WaterTile>(texture));
+                else row.push_back(std::make_unique<GrassTile>(texture));
+            }
+        }
+        return grid;
+    }
+
+    const float* cellChannels(const ObservationBatch& batch, int row, int cell) {
+        return batch.row(row) + ObservationBuilder::kScalarCount + cell * ObservationBuilder::kCellChannels;
+    }
+}
+
+TEST(ObservationBuilderTest, PatchesFollowTheGrid) {
+    sf::Texture texture;
+    TileGrid grid = makeGrid(12, 10, texture);
+    grid[3][5]->placeObject(std::make_unique<Tree>(texture));
+
+    ObservationBuilder builder(1);
+    builder.attach(grid);
+    Market market;
+
+    NPCEntity inside("Inside", 100, 50, 80, 1.5f, 15, 10);
+    inside.setPosition(5 * GameConfig::tileSize + 3.0f, 4 * GameConfig::tileSize + 3.0f); // tile (5, 4)
+    NPCEntity corner("Corner", 100, 50, 80, 1.5f, 15, 10);
+    corner.setPosition(0.0f, 0.0f);
+    const NPCEntity* npcs[] = {&inside, &corner};
+
+    ObservationBatch batch;
+    builder.build(npcs, 2, market, batch);
+    ASSERT_EQ(batch.count, 2);
+    EXPECT_EQ(batch.side, 3);
+    EXPECT_EQ(batch.featureCount, builder.getFeatureCount());
+    EXPECT_EQ(ObservationBuilder::radiusForFeatureCount(batch.featureCount), 1);
+
+    // row above the NPC: water, tree on grass, grass
+    const uint8_t* patch = batch.patch(0);
+    EXPECT_EQ(patch[0], ObservationBuilder::cellCode(TileKind::Water, ObjectType::None));
+    EXPECT_EQ(patch[1], ObservationBuilder::cellCode(TileKind::Grass, ObjectType::Tree));
+    EXPECT_EQ(patch[4], ObservationBuilder::cellCode(TileKind::Grass, ObjectType::None));
+    EXPECT_FLOAT_EQ(cellChannels(batch, 0, 1)[static_cast<int>(ObjectType::Tree) - 1], 1.0f);
+    EXPECT_FLOAT_EQ(batch.row(0)[3], 0.8f);  // energy
+    EXPECT_FLOAT_EQ(batch.row(0)[10], market.getPrice("wood") / 100.0f);
+
+    // off-map cells are zero, in both views
+    EXPECT_EQ(batch.patch(1)[0], 0);
+    EXPECT_EQ(batch.patch(1)[4], ObservationBuilder::cellCode(TileKind::Grass, ObjectType::None));
+    for (int c = 0; c < ObservationBuilder::kCellChannels; ++c) EXPECT_FLOAT_EQ(cellChannels(batch, 1, 0)[c], 0.0f);
+
+    // objects are picked up on refresh
+    grid[3][5]->removeObject();
+    grid[5][6]->placeObject(std::make_unique<Rock>(texture));
+    builder.refresh();
+    builder.build(npcs, 1, market, batch);
+    EXPECT_EQ(batch.count, 1);
+    EXPECT_EQ(batch.patch(0)[1], ObservationBuilder::cellCode(TileKind::Grass, ObjectType::None));
+    EXPECT_EQ(batch.patch(0)[8], ObservationBuilder::cellCode(TileKind::Grass, ObjectType::Rock));
+}
+
+// Observation-sized policies run on the batch buffer; the collector keeps a row with the NPC's
+// next ingested experience and exports the rows to .npz
+TEST(ObservationBuilderTest, PolicyAndCollectorConsumeTheBuffer) {
+    sf::Texture texture;
+    TileGrid grid = makeGrid(8, 8, texture);
+    ObservationBuilder builder(1);
+    builder.attach(grid);
+    Market market;
+
+    NPCEntity npc("Npc", 100, 50, 80, 1.5f, 15, 10);
+    npc.setPosition(3 * GameConfig::tileSize, 3 * GameConfig::tileSize);
+    const NPCEntity* npcs[] = {&npc, &npc, &npc};
+    ObservationBatch batch;
+    builder.build(npcs, 3, market, batch);
+
+    // output 2 reads the energy feature, so it wins
+    DenseLayer layer;
+    layer.inputs = builder.getFeatureCount();
+    layer.outputs = 4;
+    layer.weights.assign(layer.inputs * layer.outputs, 0.0f);
+    layer.bias.assign(layer.outputs, 0.0f);
+    layer.weights[3 * layer.outputs + 2] = 1.0f;
+    PolicyNetwork policy;
+    policy.setLayers({layer});
+
+    TensorFlowWrapper wrapper;
+    ASSERT_TRUE(wrapper.setNativePolicy(policy));
+    EXPECT_TRUE(wrapper.usesObservations());
+    EXPECT_EQ(wrapper.getObservationRadius(), 1);
+    ActionType actions[3];
+    ASSERT_TRUE(wrapper.predictActions(batch, actions));
+    for (ActionType action : actions) EXPECT_EQ(action, TensorFlowWrapper::actionFromIndex(2));
+
+    ObservationBatch wrongSize;
+    ObservationBuilder(2).build(npcs, 1, market, wrongSize);
+    EXPECT_FALSE(wrapper.predictActions(wrongSize, actions));
+
+    const std::string dir = (std::filesystem::temp_directory_path() / "microsociety_observations").string();
+    std::filesystem::remove_all(dir);
+    {
+        DataCollector collector(dir);
+        const uint16_t ids[] = {collector.registerNpc("A"), collector.registerNpc("B"), collector.registerNpc("C")};
+        collector.recordObservations(batch, ids); // not collecting: nothing staged
+        collector.startCollection();
+        collector.setMaxObservationRows(2);
+        auto record = [&](int posX, uint16_t id) {
+            State state;
+            state.posX = posX;
+            collector.recordExperience(state, ActionType::Rest, static_cast<float>(posX), state, false, id);
+        };
+        record(1, ids[1]);
+        collector.advanceTick();
+        EXPECT_EQ(collector.getObservationCount(), 0u);
+
+        collector.recordObservations(batch, ids);
+        record(2, ids[1]);
+        record(3, ids[1]); // B's row is already used
+        collector.advanceTick();
+        EXPECT_EQ(collector.getObservationCount(), 1u);
+
+        record(4, ids[0]);
+        record(5, ids[2]); // past the row limit
+        collector.advanceTick();
+        EXPECT_EQ(collector.getObservationCount(), 2u);
+        ASSERT_TRUE(collector.exportObservations("obs"));
+        collector.stopCollection();
+    }
+    EXPECT_TRUE(std::filesystem::exists(dir + "/exports/obs.npz"));
+    std::filesystem::remove_all(dir);
+}
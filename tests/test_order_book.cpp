@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include "OrderBook.hpp"
+#include "Market.hpp"
+#include "NPCEntity.hpp"
+#include "SimulationSnapshot.hpp"
+
+#include <memory>
+
+// The call auction clears at the price that executes the most units, fills by price then time
+// priority, leaves partial orders resting and releases them when they expire or are cancelled
+TEST(OrderBookTest, ClearsAtTheMaximumVolumePrice) {
+    OrderBook book(2);
+    std::vector<OrderBook::Settlement> settlements;
+    ASSERT_TRUE(book.post(OrderBook::Side::Ask, 1, 100, 5));
+    ASSERT_TRUE(book.post(OrderBook::Side::Ask, 2, 100, 5));
+    ASSERT_TRUE(book.post(OrderBook::Side::Ask, 3, 120, 10));
+    ASSERT_TRUE(book.post(OrderBook::Side::Bid, 4, 110, 8));
+    ASSERT_TRUE(book.post(OrderBook::Side::Bid, 5, 130, 4));
+    EXPECT_FALSE(book.post(OrderBook::Side::Bid, 6, 0, 4));
+    EXPECT_FALSE(book.post(OrderBook::Side::Bid, 6, 90, 0));
+
+    // 100 and 110 both trade 10 units with the same imbalance; 110 is closer to the reference
+    OrderBook::AuctionResult result = book.auction(108, settlements);
+    EXPECT_EQ(result.price, 110);
+    EXPECT_EQ(result.volume, 10);
+    ASSERT_EQ(settlements.size(), 4u);
+    EXPECT_EQ(settlements[0].trader, 5u); // highest bid first
+    EXPECT_EQ(settlements[0].filled, 4);
+    EXPECT_EQ(settlements[1].trader, 4u);
+    EXPECT_EQ(settlements[1].filled, 6);
+    EXPECT_EQ(settlements[2].trader, 1u); // earlier ask first at equal limits
+    EXPECT_EQ(settlements[2].filled, 5);
+    EXPECT_EQ(settlements[3].trader, 2u);
+    EXPECT_EQ(book.getBidCount(), 1u);
+    EXPECT_EQ(book.getAskCount(), 1u);
+    EXPECT_EQ(book.bestBid(), 110);
+    EXPECT_EQ(book.bestAsk(), 120);
+
+    // nothing crosses; both leftovers reach their age limit
+    settlements.clear();
+    result = book.auction(108, settlements);
+    EXPECT_EQ(result.volume, 0);
+    EXPECT_EQ(result.price, 0);
+    ASSERT_EQ(settlements.size(), 2u);
+    EXPECT_EQ(settlements[0].trader, 4u);
+    EXPECT_EQ(settlements[0].released, 2);
+    EXPECT_EQ(settlements[1].trader, 3u);
+    EXPECT_EQ(settlements[1].released, 10);
+    EXPECT_TRUE(book.empty());
+
+    settlements.clear();
+    book.post(OrderBook::Side::Bid, 7, 90, 3);
+    book.post(OrderBook::Side::Ask, 8, 95, 1);
+    book.cancel(7, settlements);
+    ASSERT_EQ(settlements.size(), 1u);
+    EXPECT_EQ(settlements[0].released, 3);
+    EXPECT_EQ(settlements[0].limit, 90);
+    EXPECT_EQ(book.getBidCount(), 0u);
+    EXPECT_EQ(book.getAskCount(), 1u);
+}
+
+// Many NPCs trading through one market: escrow is taken when posting, every buyer pays the same
+// clearing price, units only change hands, and the market price follows the auction
+TEST(OrderBookTest, MarketSettlesManyTraders) {
+    sf::Texture texture;
+    Market market(texture); // no random starting prices
+    market.setPrice("wood", 10.0f);
+
+    constexpr int kPairs = 500;
+    std::vector<std::unique_ptr<NPCEntity>> npcs;
+    Market::TraderTable traders;
+    for (int i = 0; i < 2 * kPairs; ++i) {
+        npcs.push_back(std::make_unique<NPCEntity>("Trader" + std::to_string(i), 100, 50, 50, 1.0f, 10, 100.0f));
+        traders[i] = npcs.back().get();
+    }
+    for (int i = 0; i < kPairs; ++i) {
+        NPCEntity& seller = *npcs[i];
+        ASSERT_TRUE(seller.addToInventory("wood", 1));
+        ASSERT_TRUE(market.postAsk(seller, i, "wood", 1, 8.0f));
+        EXPECT_EQ(seller.getInventoryItemCount("wood"), 0);
+
+        NPCEntity& buyer = *npcs[kPairs + i];
+        ASSERT_TRUE(market.postBid(buyer, kPairs + i, "wood", 1, 12.0f));
+        EXPECT_FLOAT_EQ(buyer.getMoney(), 88.0f);
+    }
+    NPCEntity poor("Poor", 100, 50, 50, 1.0f, 10, 5.0f);
+    EXPECT_FALSE(market.postBid(poor, 2 * kPairs, "wood", 1, 12.0f));
+    EXPECT_FLOAT_EQ(poor.getMoney(), 5.0f);
+    EXPECT_FALSE(market.postAsk(poor, 2 * kPairs, "wood", 1, 8.0f));
+
+    // a cancelled bid gets its escrow back
+    NPCEntity undecided("Undecided", 100, 50, 50, 1.0f, 10, 50.0f);
+    ASSERT_TRUE(market.postBid(undecided, 2 * kPairs + 1, "wood", 2, 10.0f));
+    EXPECT_FLOAT_EQ(undecided.getMoney(), 30.0f);
+    market.cancelOrders(2 * kPairs + 1, &undecided);
+    EXPECT_FLOAT_EQ(undecided.getMoney(), 50.0f);
+
+    EXPECT_EQ(market.runAuctions(traders), kPairs);
+    EXPECT_EQ(market.getOpenOrderCount(), 0u);
+
+    const float clearingPrice = 100.0f - npcs[kPairs]->getMoney();
+    EXPECT_GE(clearingPrice, 8.0f);
+    EXPECT_LE(clearingPrice, 12.0f);
+    int units = 0;
+    for (int i = 0; i < kPairs; ++i) {
+        EXPECT_FLOAT_EQ(npcs[i]->getMoney(), 100.0f + clearingPrice);
+        EXPECT_FLOAT_EQ(npcs[kPairs + i]->getMoney(), 100.0f - clearingPrice);
+        EXPECT_EQ(npcs[kPairs + i]->getInventoryItemCount("wood"), 1);
+        units += npcs[i]->getInventoryItemCount("wood") + npcs[kPairs + i]->getInventoryItemCount("wood");
+    }
+    EXPECT_EQ(units, kPairs);
+    EXPECT_NEAR(market.getPrice("wood"), 10.0f + (clearingPrice - 10.0f) * 0.2f, 1e-4f);
+}
+
+// A trader's settlements in one auction are applied together; units that no longer fit go back
+// to the market with their cost refunded
+TEST(OrderBookTest, MarketSettlesEachTraderOnce) {
+    sf::Texture texture;
+    Market market(texture);
+    market.setPrice("stone", 10.0f);
+    NPCEntity seller("Seller", 100, 50, 50, 1.0f, 10, 100.0f);
+    NPCEntity buyer("Buyer", 100, 50, 50, 1.0f, 10, 100.0f);
+    ASSERT_TRUE(seller.addToInventory("stone", 3));
+    ASSERT_TRUE(market.postAsk(seller, 0, "stone", 3, 10.0f));
+    for (int i = 0; i < 3; ++i) ASSERT_TRUE(market.postBid(buyer, 1, "stone", 1, 10.0f));
+    ASSERT_TRUE(buyer.addToInventory("wood", buyer.getMaxInventorySize() - 2)); // room for two of the three
+
+    const Market::TraderTable traders = {{0, &seller}, {1, &buyer}};
+    EXPECT_EQ(market.runAuctions(traders), 3);
+    EXPECT_EQ(buyer.getInventoryItemCount("stone"), 2);
+    EXPECT_FLOAT_EQ(buyer.getMoney(), 80.0f);
+    EXPECT_FLOAT_EQ(seller.getMoney(), 130.0f);
+    EXPECT_EQ(market.getSellTransactions("stone"), 3);
+    EXPECT_EQ(market.getBuyTransactions("stone"), 2);
+}
+
+// NPCs sharing a name share their recorder id, but every NPC has its own handle, so trading by
+// handle pays the right one
+TEST(OrderBookTest, TradersAreKeyedByHandle) {
+    sf::Texture texture;
+    Market market(texture);
+    market.setPrice("bush", 10.0f);
+    NPCEntity seller("Twin", 100, 50, 50, 1.0f, 10, 100.0f);
+    NPCEntity buyer("Twin", 100, 50, 50, 1.0f, 10, 100.0f);
+    EXPECT_EQ(seller.getRecorderId(), buyer.getRecorderId());
+    ASSERT_NE(seller.getHandle(), buyer.getHandle());
+
+    ASSERT_TRUE(seller.addToInventory("bush", 1));
+    ASSERT_TRUE(market.postAsk(seller, seller.getHandle(), "bush", 1, 10.0f));
+    ASSERT_TRUE(market.postBid(buyer, buyer.getHandle(), "bush", 1, 10.0f));
+    const Market::TraderTable traders = {{seller.getHandle(), &seller}, {buyer.getHandle(), &buyer}};
+    EXPECT_EQ(market.runAuctions(traders), 1);
+    EXPECT_FLOAT_EQ(seller.getMoney(), 110.0f);
+    EXPECT_EQ(seller.getInventoryItemCount("bush"), 0);
+    EXPECT_FLOAT_EQ(buyer.getMoney(), 90.0f);
+    EXPECT_EQ(buyer.getInventoryItemCount("bush"), 1);
+}
+
+// Snapshots don't keep the books: open orders give their escrow back to the saved NPCs, the
+// running market keeps trading, and a restored market starts with no orders
+TEST(OrderBookTest, SnapshotsReturnOpenEscrow) {
+    sf::Texture texture;
+    Market market(texture);
+    market.setPrice("wood", 10.0f);
+    NPCEntity seller("Seller", 100, 50, 50, 1.0f, 10, 100.0f);
+    NPCEntity buyer("Buyer", 100, 50, 50, 1.0f, 10, 100.0f);
+    ASSERT_TRUE(seller.addToInventory("wood", 4));
+    ASSERT_TRUE(market.postAsk(seller, seller.getHandle(), "wood", 4, 30.0f));
+    ASSERT_TRUE(market.postBid(buyer, buyer.getHandle(), "wood", 2, 5.0f));
+    EXPECT_FLOAT_EQ(buyer.getMoney(), 90.0f);
+
+    NpcSnapshot savedSeller, savedBuyer;
+    seller.saveSnapshot(savedSeller);
+    buyer.saveSnapshot(savedBuyer);
+    MarketSnapshot savedMarket;
+    market.saveSnapshot(savedMarket);
+    market.returnEscrow(savedMarket, {{seller.getHandle(), &savedSeller}, {buyer.getHandle(), &savedBuyer}});
+    EXPECT_FLOAT_EQ(savedBuyer.money, 100.0f);
+    const SnapshotCounts wood = {{"wood", 4}};
+    EXPECT_EQ(savedSeller.inventory, wood);
+    EXPECT_EQ(market.getOpenOrderCount(), 2u);
+
+    market.restoreSnapshot(savedMarket);
+    EXPECT_EQ(market.getOpenOrderCount(), 0u);
+}
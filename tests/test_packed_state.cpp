@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include "QLearningAgent.hpp"
+#include "TFWrapper.hpp"
+
+#include <unordered_set>
+
+TEST(PackedStateTest, KeyAndFeaturesMatchState) {
+    const State state{731, 1999, 9, 4, 7, 2, 1};
+    const PackedState key = PackedState::pack(state);
+    EXPECT_EQ(key.unpack(), state);
+    EXPECT_EQ(key, PackedState::pack(state));
+    EXPECT_NE(key, PackedState::pack({731, 1999, 9, 4, 7, 2, 2}));
+
+    float fromKey[PackedState::kFeatureCount];
+    key.writeFeatures(fromKey);
+    const auto fromState = TensorFlowWrapper().stateToVector(state);
+    for (int i = 0; i < PackedState::kFeatureCount; ++i) EXPECT_FLOAT_EQ(fromKey[i], fromState[i]);
+    EXPECT_FLOAT_EQ(fromKey[1], 1999.0f);
+
+    // density levels ride in otherwise unused bits and extend the feature vector
+    State dense = state;
+    dense.treeDensity = 3;
+    dense.rockDensity = 1;
+    dense.bushDensity = 2;
+    const PackedState denseKey = PackedState::pack(dense);
+    EXPECT_EQ(denseKey.unpack(), dense);
+    EXPECT_EQ(denseKey.bits & PackedState::pack(state).bits, key.bits);
+    float extended[PackedState::kExtendedFeatureCount];
+    denseKey.writeFeatures(extended, PackedState::kExtendedFeatureCount);
+    EXPECT_FLOAT_EQ(extended[6], 1.0f);
+    EXPECT_FLOAT_EQ(extended[7], 3.0f);
+    EXPECT_FLOAT_EQ(extended[9], 2.0f);
+
+    // neighbouring grid states spread over the table instead of clustering
+    std::unordered_set<size_t> buckets;
+    for (int x = 0; x < 64; ++x) {
+        for (int y = 0; y < 64; ++y) {
+            buckets.insert(PackedStateHasher()(PackedState::pack({x, y, 1, 0, 0, 1, 0})) & 1023);
+        }
+    }
+    EXPECT_GT(buckets.size(), 1000u);
+    EXPECT_EQ(StateHasher()(state), PackedStateHasher()(key));
+}
+
+TEST(PackedStateTest, QLearningPrefersBestKnownAction) {
+    QLearningAgent agent(0.5f, 0.9f, 0.0f);
+    const State state{3, 4, 1, 0, 0, 2, 0};
+    const State next{4, 4, 1, 0, 0, 2, 0};
+
+    agent.updateQValue(state, ActionType::ChopTree, 10.0f, next);
+    agent.updateQValue(state, ActionType::Rest, -4.0f, next);
+    EXPECT_EQ(agent.getStateCount(), 1u);
+    EXPECT_FLOAT_EQ(agent.getQValue(state, ActionType::ChopTree), 5.0f);
+    EXPECT_FLOAT_EQ(agent.getQValue(state, ActionType::Rest), -2.5f); // negative rewards weigh 1.25x
+    EXPECT_EQ(agent.decideAction(state), ActionType::ChopTree);
+
+    // bootstraps from the best known action of the next state
+    agent.updateQValue(PackedState::pack(next), ActionType::Move, 0.0f, PackedState::pack(state));
+    EXPECT_FLOAT_EQ(agent.getQValue(next, ActionType::Move), 0.5f * 0.9f * 5.0f);
+    EXPECT_EQ(agent.getStateCount(), 2u);
+}
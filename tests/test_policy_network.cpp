@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "PolicyNetwork.hpp"
+#include "TFWrapper.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+namespace {
+    // Small random network with the same shape family as the DQN (ragged widths on purpose)
+    PolicyNetwork makeNetwork(std::mt19937& rng) {
+        std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+        const int widths[] = {7, 20, 13, 11};
+        std::vector<DenseLayer> layers;
+        for (int l = 0; l < 3; ++l) {
+            DenseLayer layer;
+            layer.inputs = widths[l];
+            layer.outputs = widths[l + 1];
+            layer.relu = l < 2;
+            layer.weights.resize(layer.inputs * layer.outputs);
+            layer.bias.resize(layer.outputs);
+            for (auto& w : layer.weights) w = dist(rng);
+            for (auto& b : layer.bias) b = dist(rng);
+            layers.push_back(std::move(layer));
+        }
+        PolicyNetwork network;
+        network.setScaler({1, 2, 0, 0, 0, 1, 1}, {2, 2, 1, 1, 1, 0.5f, 0.5f});
+        network.setLayers(std::move(layers));
+        return network;
+    }
+
+    // Straightforward reference forward pass
+    std::vector<float> referenceForward(const PolicyNetwork& network, const float* raw) {
+        std::vector<float> x(network.getInputSize());
+        network.normalize(raw, x.data(), network.getInputSize());
+        for (const auto& layer : network.getLayers()) {
+            std::vector<float> y(layer.bias);
+            for (int i = 0; i < layer.inputs; ++i)
+                for (int o = 0; o < layer.outputs; ++o)
+                    y[o] += x[i] * layer.weights[i * layer.outputs + o];
+            if (layer.relu) for (auto& v : y) v = std::max(v, 0.0f);
+            x = std::move(y);
+        }
+        return x;
+    }
+}
+
+// Batched SIMD kernels must match the naive reference for every row, including ragged tails
+TEST(PolicyNetworkTest, BatchForwardMatchesReference) {
+    std::mt19937 rng(42);
+    PolicyNetwork network = makeNetwork(rng);
+
+    const int batch = 11;
+    std::uniform_real_distribution<float> input(0.0f, 20.0f);
+    std::vector<float> states(batch * 7);
+    for (auto& v : states) v = input(rng);
+
+    std::vector<float> qValues(batch * network.getOutputSize());
+    PolicyNetwork::Workspace workspace;
+    network.forwardBatch(states.data(), batch, qValues.data(), workspace);
+
+    for (int b = 0; b < batch; ++b) {
+        auto expected = referenceForward(network, states.data() + b * 7);
+        for (int o = 0; o < network.getOutputSize(); ++o) {
+            EXPECT_NEAR(qValues[b * network.getOutputSize() + o], expected[o], 1e-4f);
+        }
+    }
+}
+
+TEST(PolicyNetworkTest, SaveLoadRoundTrip) {
+    std::mt19937 rng(7);
+    PolicyNetwork network = makeNetwork(rng);
+    const std::string path = "test_policy_roundtrip.bin";
+    ASSERT_TRUE(network.saveToFile(path));
+
+    PolicyNetwork loaded;
+    ASSERT_TRUE(loaded.loadFromFile(path));
+    std::remove(path.c_str());
+
+    float state[7] = {3, 4, 1, 0, 2, 1, 0};
+    std::vector<float> a(network.getOutputSize()), b(loaded.getOutputSize());
+    PolicyNetwork::Workspace workspace;
+    network.forward(state, a.data(), workspace);
+    loaded.forward(state, b.data(), workspace);
+    EXPECT_EQ(a, b);
+}
+
+TEST(PolicyNetworkTest, RejectsCorruptFile) {
+    const std::string path = "test_policy_corrupt.bin";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "NOPE";
+    }
+    PolicyNetwork network;
+    EXPECT_FALSE(network.loadFromFile(path));
+    EXPECT_FALSE(network.isLoaded());
+    std::remove(path.c_str());
+}
+
+TEST(PolicyNetworkTest, OutputIndexMapsToActionType) {
+    EXPECT_EQ(TensorFlowWrapper::actionFromIndex(0), ActionType::Move);
+    EXPECT_EQ(TensorFlowWrapper::actionFromIndex(10), ActionType::Rest);
+}
+
+// The per-tick batched pass must pick the same actions as individual calls
+TEST(PolicyNetworkTest, BatchedDecisionsMatchSingleCalls) {
+    std::mt19937 rng(3);
+    PolicyNetwork network = makeNetwork(rng);
+    const std::string path = "test_policy_batch.bin";
+    ASSERT_TRUE(network.saveToFile(path));
+
+    TensorFlowWrapper wrapper;
+    ASSERT_TRUE(wrapper.initialize(path));
+    std::remove(path.c_str());
+    ASSERT_TRUE(wrapper.isNativePolicy());
+
+    std::vector<State> states;
+    for (int i = 0; i < 37; ++i) {
+        states.push_back({i % 25, (i * 7) % 25, i % 4, i % 3, i % 5, i % 3, (i / 3) % 3});
+    }
+
+    std::vector<ActionType> batched(states.size());
+    wrapper.predictActions(states.data(), static_cast<int>(states.size()), batched.data());
+    for (size_t i = 0; i < states.size(); ++i) {
+        EXPECT_EQ(batched[i], wrapper.predictAction(states[i]));
+    }
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "QuantizedPolicyNetwork.hpp"
+#include "MLPKernels.hpp"
+#include "TFWrapper.hpp"
+
+#include <cmath>
+#include <random>
+
+namespace {
+    // DQN-shaped network (7 -> 128 -> 128 -> 64 -> 11) with Glorot-like random weights
+    PolicyNetwork makeDQNShapedNetwork(std::mt19937& rng) {
+        const int widths[] = {7, 128, 128, 64, 11};
+        std::vector<DenseLayer> layers;
+        for (int l = 0; l < 4; ++l) {
+            const float limit = std::sqrt(6.0f / (widths[l] + widths[l + 1]));
+            std::uniform_real_distribution<float> dist(-limit, limit);
+            DenseLayer layer;
+            layer.inputs = widths[l];
+            layer.outputs = widths[l + 1];
+            layer.relu = l < 3;
+            layer.weights.resize(layer.inputs * layer.outputs);
+            layer.bias.resize(layer.outputs);
+            for (auto& w : layer.weights) w = dist(rng);
+            for (auto& b : layer.bias) b = dist(rng) * 0.1f;
+            layers.push_back(std::move(layer));
+        }
+        PolicyNetwork network;
+        network.setScaler({12, 12, 2, 2, 2, 1, 1}, {7, 7, 2, 2, 2, 0.8f, 0.8f});
+        network.setLayers(std::move(layers));
+        return network;
+    }
+
+    // States shaped like the ones NPCs record
+    std::vector<State> recordedStates(std::mt19937& rng, int count) {
+        std::uniform_int_distribution<int> pos(0, 24), nearby(0, 5), level(0, 2);
+        std::vector<State> states;
+        for (int i = 0; i < count; ++i) {
+            states.push_back({pos(rng), pos(rng), nearby(rng), nearby(rng), nearby(rng), level(rng), level(rng)});
+        }
+        return states;
+    }
+
+    std::vector<float> toFeatures(const std::vector<State>& states) {
+        std::vector<float> features(states.size() * TensorFlowWrapper::kStateFeatureCount);
+        for (size_t i = 0; i < states.size(); ++i) {
+            TensorFlowWrapper::writeFeatures(states[i], features.data() + i * TensorFlowWrapper::kStateFeatureCount);
+        }
+        return features;
+    }
+}
+
+// The SIMD int8 kernel must reproduce exact integer dot products (ragged batch, several column groups)
+TEST(QuantizedPolicyTest, Int8KernelMatchesIntegerReference) {
+    std::mt19937 rng(21);
+    std::uniform_int_distribution<int> value(-127, 127);
+    const int batch = 7, inputs = 24, outputs = 24;
+
+    std::vector<int8_t> weights(inputs * outputs), packed(inputs * outputs);
+    for (auto& w : weights) w = static_cast<int8_t>(value(rng));
+    for (int i = 0; i < inputs; ++i)
+        for (int o = 0; o < outputs; ++o)
+            packed[((i / 2) * outputs + o) * 2 + i % 2] = weights[i * outputs + o];
+
+    std::vector<int8_t> x(batch * inputs);
+    for (auto& v : x) v = static_cast<int8_t>(value(rng));
+    std::vector<float> scales(outputs, 0.5f), bias(outputs, 1.0f), y(batch * outputs);
+
+    MLPKernels::denseForwardInt8(packed.data(), scales.data(), bias.data(), x.data(), inputs,
+                                 y.data(), outputs, batch, inputs, outputs, false);
+
+    for (int b = 0; b < batch; ++b) {
+        for (int o = 0; o < outputs; ++o) {
+            int32_t acc = 0;
+            for (int i = 0; i < inputs; ++i) acc += x[b * inputs + i] * weights[i * outputs + o];
+            EXPECT_FLOAT_EQ(y[b * outputs + o], acc * 0.5f + 1.0f);
+        }
+    }
+}
+
+TEST(QuantizedPolicyTest, TracksFloatPolicyOnRecordedStates) {
+    std::mt19937 rng(4);
+    PolicyNetwork network = makeDQNShapedNetwork(rng);
+    std::vector<float> calibration = toFeatures(recordedStates(rng, 512));
+    std::vector<float> evaluation = toFeatures(recordedStates(rng, 512));
+
+    QuantizedPolicyNetwork quantized;
+    ASSERT_TRUE(quantized.quantize(network, calibration.data(), 512));
+
+    size_t floatBytes = 0;
+    for (const auto& layer : network.getLayers()) floatBytes += layer.weights.size() * sizeof(float);
+    EXPECT_LE(quantized.getWeightBytes() * 3, floatBytes); // ~4x less weight traffic (padding aside)
+
+    auto report = QuantizedPolicyNetwork::compare(network, quantized, evaluation.data(), 512);
+    EXPECT_EQ(report.samples, 512);
+    EXPECT_GE(report.actionAgreement, 0.9f);
+    EXPECT_LT(report.meanAbsError, 0.02f);
+}
+
+TEST(QuantizedPolicyTest, WrapperKeepsFloatWhenAgreementTooLow) {
+    std::mt19937 rng(8);
+    PolicyNetwork network = makeDQNShapedNetwork(rng);
+    TensorFlowWrapper wrapper;
+    ASSERT_TRUE(wrapper.setNativePolicy(network));
+
+    std::vector<State> states = recordedStates(rng, 256);
+    EXPECT_FALSE(wrapper.enableQuantization(states, 1.01f));
+    EXPECT_FALSE(wrapper.isQuantized());
+
+    EXPECT_TRUE(wrapper.enableQuantization(states, 0.0f));
+    EXPECT_TRUE(wrapper.isQuantized());
+
+    // new weights are re-quantized automatically
+    EXPECT_TRUE(wrapper.setNativePolicy(makeDQNShapedNetwork(rng)));
+    EXPECT_TRUE(wrapper.isQuantized());
+
+    wrapper.disableQuantization();
+    EXPECT_FALSE(wrapper.isQuantized());
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include "ResourceRegrowth.hpp"
+#include "TimerWheel.hpp"
+#include "Tile.hpp"
+
+namespace {
+    constexpr uint32_t kRegrowthChannel = 77;
+
+    // left half grass, right half stone
+    TileGrid makeGrid(const sf::Texture& texture, int width, int height) {
+        TileGrid grid(height);
+        for (auto& row : grid) {
+            for (int x = 0; x < width; ++x) {
+                if (x < width / 2) row.push_back(std::make_unique<GrassTile>(texture));
+                else row.push_back(std::make_unique<StoneTile>(texture));
+            }
+        }
+        return grid;
+    }
+
+    // runs the regrowth wake-ups that come due in `seconds`; returns how many grew
+    int runTimers(ResourceRegrowth& regrowth, float seconds) {
+        std::vector<TimerWheel::Event> due;
+        getSimulationTimers().advance(seconds, due);
+        int grown = 0;
+        for (const auto& event : due) {
+            if (event.channel == kRegrowthChannel && regrowth.regrow(event.subject)) ++grown;
+        }
+        return grown;
+    }
+}
+
+// A harvested tree grows back on its own tile once the timer fires, and the free index follows
+TEST(ResourceRegrowthTest, HarvestSchedulesRegrowth) {
+    getSimulationTimers().clear();
+    sf::Texture texture;
+    TileGrid grid = makeGrid(texture, 8, 4);
+    grid[1][2]->placeObject(std::make_unique<Tree>(texture));
+    ObjectLayers layers;
+    layers.attach(grid);
+
+    ResourceRegrowth regrowth;
+    regrowth.attach(grid, std::vector<float>(32, 1.0f), kRegrowthChannel);
+    EXPECT_EQ(regrowth.getFreeTileCount(ResourceRegrowth::Biome::Grass), 15u);
+    EXPECT_EQ(regrowth.getFreeTileCount(ResourceRegrowth::Biome::Stone), 16u);
+
+    grid[1][2]->removeObject();
+    regrowth.harvested(*grid[1][2], ObjectType::Tree);
+    EXPECT_EQ(regrowth.getFreeTileCount(ResourceRegrowth::Biome::Grass), 16u);
+    EXPECT_EQ(regrowth.getPendingCount(), 1u);
+
+    EXPECT_EQ(runTimers(regrowth, 10.0f), 0); // too early (delays are at least 15 s for trees)
+    EXPECT_EQ(runTimers(regrowth, 20.0f), 1);
+    ASSERT_TRUE(grid[1][2]->hasObject());
+    EXPECT_EQ(grid[1][2]->getObject()->getType(), ObjectType::Tree);
+    EXPECT_TRUE(layers.test(ObjectType::Tree, 2, 1));
+    EXPECT_EQ(regrowth.getFreeTileCount(ResourceRegrowth::Biome::Grass), 15u);
+    EXPECT_EQ(regrowth.getPendingCount(), 0u);
+    EXPECT_EQ(regrowth.getSpawnedCount(), 1u);
+}
+
+// Rocks only come back on stone; zero spawn chance defers the regrowth instead of dropping it
+TEST(ResourceRegrowthTest, SpawnChanceAndBiomes) {
+    getSimulationTimers().clear();
+    sf::Texture texture;
+    TileGrid grid = makeGrid(texture, 8, 4);
+    ObjectLayers layers;
+    layers.attach(grid);
+
+    std::vector<float> chances(32, 0.0f);
+    ResourceRegrowth regrowth;
+    regrowth.attach(grid, chances, kRegrowthChannel);
+    regrowth.harvested(*grid[0][6], ObjectType::Rock);
+    EXPECT_EQ(runTimers(regrowth, 60.0f), 0);
+    EXPECT_EQ(regrowth.getPendingCount(), 1u); // rescheduled
+
+    // only one stone tile can take it, the harvested one is no longer free
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 4; x < 8; ++x) {
+            if (!(x == 5 && y == 3)) grid[y][x]->placeObject(std::make_unique<Tree>(texture));
+            chances[y * 8 + x] = 1.0f;
+        }
+    }
+    grid[0][6]->removeObject();
+    regrowth.attach(grid, chances, kRegrowthChannel);
+    getSimulationTimers().clear();
+    grid[0][6]->placeObject(std::make_unique<Rock>(texture));
+    regrowth.harvested(*grid[0][6], ObjectType::Rock); // still occupied: not indexed as free
+    int grown = 0;
+    for (int i = 0; i < 20 && grown == 0; ++i) grown += runTimers(regrowth, 60.0f);
+    EXPECT_EQ(grown, 1);
+    ASSERT_TRUE(grid[3][5]->hasObject());
+    EXPECT_EQ(grid[3][5]->getObject()->getType(), ObjectType::Rock);
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) EXPECT_FALSE(grid[y][x]->hasObject()); // never on grass
+    }
+
+    EXPECT_FLOAT_EQ(ResourceRegrowth::spawnChanceFor(0.05f), 0.0f);
+    EXPECT_FLOAT_EQ(ResourceRegrowth::spawnChanceFor(0.35f), 1.0f);
+    EXPECT_GT(ResourceRegrowth::spawnChanceFor(0.95f), ResourceRegrowth::spawnChanceFor(0.65f));
+}
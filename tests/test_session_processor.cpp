@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "SessionProcessor.hpp"
+#include "ExperienceDataset.hpp"
+#include "ExperienceFixtures.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace ExperienceFixtures;
+
+namespace {
+    void writeJsonBatch(const std::string& path, int first, int count) {
+        nlohmann::json batch;
+        batch["experiences"] = nlohmann::json::array();
+        for (int i = first; i < first + count; ++i) {
+            batch["experiences"].push_back(ExperienceData(makeState(i), fixtureAction(i),
+                                                          static_cast<float>(i), makeState(i + 1), false, "NPC", 0.0f).toJson());
+        }
+        std::ofstream(path) << batch.dump();
+    }
+}
+
+// .npz segments and legacy .json batches merge in file order; a .json with an .npz twin is skipped
+TEST(SessionProcessorTest, MergesFiltersAndDedups) {
+    const std::string directory = "test_session_processor";
+    std::filesystem::create_directories(directory);
+    ASSERT_TRUE(NumpyIO::writeExperienceNpz(directory + "/s_batch_0.npz", makeColumns(0, 40)));
+    writeJsonBatch(directory + "/s_batch_0.json", 0, 40);      // twin of batch 0, ignored
+    writeJsonBatch(directory + "/s_batch_1.json", 30, 30);     // rows 30..39 repeat batch 0
+    ASSERT_TRUE(NumpyIO::writeExperienceNpz(directory + "/s_batch_2.npz", makeColumns(60, 20)));
+
+    SessionProcessorOptions options;
+    options.inputs = {directory};
+    options.minReward = 5.0f;
+    options.maxReward = 69.0f;
+    options.threads = 3;
+
+    SessionProcessor processor(options);
+    EXPECT_EQ(processor.listInputFiles().size(), 3u);
+
+    NumpyIO::ExperienceColumns merged;
+    ASSERT_TRUE(processor.merge(merged));
+    const auto& report = processor.getReport();
+    EXPECT_EQ(report.files, 3u);
+    EXPECT_EQ(report.read, 90u);
+    EXPECT_EQ(report.filtered, 5u + 10u);  // rewards 0..4 and 70..79
+    EXPECT_EQ(report.duplicates, 10u);
+    ASSERT_EQ(merged.size(), 65u);         // rewards 5..69, each once, in file order
+    for (size_t i = 0; i < merged.size(); ++i) {
+        EXPECT_FLOAT_EQ(merged.rewards[i], 5.0f + i);
+    }
+    EXPECT_EQ(merged.states, makeColumns(5, 65).states);
+
+    // action filter
+    options.actions = {static_cast<int>(ActionType::ChopTree)};
+    SessionProcessor chopOnly(options);
+    ASSERT_TRUE(chopOnly.merge(merged));
+    for (int32_t action : merged.actions) EXPECT_EQ(action, static_cast<int32_t>(ActionType::ChopTree));
+    EXPECT_EQ(merged.size(), 6u);          // i % 11 == 1 for i in 5..69
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(SessionProcessorTest, ShufflesAndSplitsDeterministically) {
+    const std::string directory = "test_session_split";
+    std::filesystem::create_directories(directory);
+    ASSERT_TRUE(NumpyIO::writeExperienceNpz(directory + "/s_batch_0.npz", makeColumns(0, 100)));
+
+    SessionProcessorOptions options;
+    options.inputs = {directory};
+    options.outputPrefix = directory + "/out/merged";
+    options.validationFraction = 0.2f;
+    options.testFraction = 0.1f;
+
+    std::vector<float> firstRewards;
+    for (int run = 0; run < 2; ++run) {
+        SessionProcessor processor(options);
+        ASSERT_TRUE(processor.run());
+        EXPECT_EQ(processor.getReport().train, 70u);
+        EXPECT_EQ(processor.getReport().validation, 20u);
+        EXPECT_EQ(processor.getReport().test, 10u);
+
+        NumpyIO::ExperienceColumns train, validation, test;
+        ASSERT_TRUE(NumpyIO::readExperienceNpz(options.outputPrefix + "_train.npz", train));
+        ASSERT_TRUE(NumpyIO::readExperienceNpz(options.outputPrefix + "_val.npz", validation));
+        ASSERT_TRUE(NumpyIO::readExperienceNpz(options.outputPrefix + "_test.npz", test));
+        ASSERT_EQ(train.size() + validation.size() + test.size(), 100u);
+
+        // every row lands in exactly one split, shuffled with the same seed each run
+        std::vector<float> all = train.rewards;
+        all.insert(all.end(), validation.rewards.begin(), validation.rewards.end());
+        all.insert(all.end(), test.rewards.begin(), test.rewards.end());
+        if (run == 0) {
+            firstRewards = all;
+            EXPECT_FALSE(std::is_sorted(all.begin(), all.end()));
+        } else {
+            EXPECT_EQ(all, firstRewards);
+        }
+        std::sort(all.begin(), all.end());
+        for (size_t i = 0; i < all.size(); ++i) EXPECT_FLOAT_EQ(all[i], static_cast<float>(i));
+    }
+    std::filesystem::remove_all(directory);
+}
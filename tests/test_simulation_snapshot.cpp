@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include "SimulationSnapshot.hpp"
+#include "QLearningAgent.hpp"
+#include "TimerWheel.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <set>
+
+namespace {
+    State sampleState(int i) {
+        return State{i % 7, i % 5, i % 3, i % 4, i % 2, i % 3, i % 3};
+    }
+}
+
+// A snapshot written in the background maps back field for field, the learning agent resumes
+// with the same table and random stream, and damaged files are rejected
+TEST(SimulationSnapshotTest, RoundTripThroughWriter) {
+    QLearningAgent agent(0.1f, 0.9f, 0.3f);
+    for (int i = 0; i < 200; ++i) {
+        agent.updateQValue(sampleState(i), static_cast<ActionType>(i % QLearningAgent::kActionCount),
+                           static_cast<float>(i % 11) - 4.0f, sampleState(i + 1));
+    }
+
+    auto snapshot = std::make_shared<SimulationSnapshot>();
+    snapshot->worldWidth = 100;
+    snapshot->worldHeight = 60;
+    snapshot->worldSeed = 1234;
+    snapshot->chunks = {{0, 0, true, {1, 0, 2}}, {3, 1, false, {7, 7, 7, 7}}};
+    HouseSnapshot shared;
+    shared.level = 3;
+    shared.storage = {{"stone", 4}, {"wood", 9}};
+    shared.lastRegenTime = {{0, 12.5f}};
+    snapshot->houses.push_back(shared);
+    NpcSnapshot npc;
+    npc.name = "NPC1";
+    npc.health = 88.0f;
+    npc.x = 320.0f;
+    npc.wakeTimer = 17;
+    npc.inventory = {{"bush", 2}, {"wood", 5}};
+    npc.useQLearning = true;
+    agent.saveSnapshot(npc.agent);
+    snapshot->npcs.push_back(npc);
+    MarketItemSnapshot wood;
+    wood.item = "wood";
+    wood.price = 12.25f;
+    wood.history = {10.0f, 11.5f, 12.25f};
+    MarketSnapshot panel;
+    panel.items.push_back(wood);
+    snapshot->markets.push_back(panel);
+    MarketSnapshot placed;
+    placed.x = 12;
+    placed.y = 7;
+    placed.sellMargin = 0.8f;
+    snapshot->markets.push_back(placed);
+    snapshot->day = 4;
+    snapshot->timerTick = 90000;
+    snapshot->timers = {{90010, 1, 0, 3}, {90120, 3, 0, 17}};
+    snapshot->randSeed = 777;
+    snapshot->persistentStats = {1, 2, 3, 4, 5};
+
+    const std::string path = (std::filesystem::temp_directory_path() / "microsociety_snapshot_test" / "run.mss").string();
+    {
+        SnapshotWriter writer;
+        writer.submit(snapshot, path);
+        writer.flush();
+        EXPECT_EQ(writer.getWrittenCount(), 1u);
+        EXPECT_EQ(writer.getFailedCount(), 0u);
+    }
+    EXPECT_FALSE(std::filesystem::exists(path + ".tmp"));
+
+    SimulationSnapshot loaded;
+    ASSERT_TRUE(loaded.loadFromFile(path));
+    EXPECT_EQ(loaded.worldSeed, 1234);
+    ASSERT_EQ(loaded.chunks.size(), 2u);
+    EXPECT_TRUE(loaded.chunks[0].resident);
+    EXPECT_EQ(loaded.chunks[1].cx, 3);
+    EXPECT_FALSE(loaded.chunks[1].resident);
+    EXPECT_EQ(loaded.chunks[1].bytes, snapshot->chunks[1].bytes);
+    ASSERT_EQ(loaded.houses.size(), 1u);
+    EXPECT_EQ(loaded.houses[0].level, 3);
+    EXPECT_EQ(loaded.houses[0].storage, shared.storage);
+    EXPECT_EQ(loaded.houses[0].lastRegenTime, shared.lastRegenTime);
+    ASSERT_EQ(loaded.npcs.size(), 1u);
+    EXPECT_EQ(loaded.npcs[0].name, "NPC1");
+    EXPECT_FLOAT_EQ(loaded.npcs[0].health, 88.0f);
+    EXPECT_EQ(loaded.npcs[0].wakeTimer, 17u);
+    EXPECT_EQ(loaded.npcs[0].inventory, npc.inventory);
+    ASSERT_EQ(loaded.markets.size(), 2u);
+    EXPECT_EQ(loaded.markets[0].x, -1);
+    ASSERT_EQ(loaded.markets[0].items.size(), 1u);
+    EXPECT_EQ(loaded.markets[0].items[0].history, wood.history);
+    EXPECT_EQ(loaded.markets[1].x, 12);
+    EXPECT_EQ(loaded.markets[1].y, 7);
+    EXPECT_FLOAT_EQ(loaded.markets[1].sellMargin, 0.8f);
+    EXPECT_EQ(loaded.day, 4);
+    EXPECT_EQ(loaded.timerTick, 90000u);
+    ASSERT_EQ(loaded.timers.size(), 2u);
+    EXPECT_EQ(loaded.timers[1].due, 90120u);
+    EXPECT_EQ(loaded.timers[1].id, 17u);
+    EXPECT_EQ(loaded.randSeed, 777u);
+    EXPECT_EQ(loaded.persistentStats, snapshot->persistentStats);
+
+    QLearningAgent resumed(0.5f, 0.5f, 0.0f);
+    ASSERT_TRUE(resumed.restoreSnapshot(loaded.npcs[0].agent));
+    EXPECT_EQ(resumed.getStateCount(), agent.getStateCount());
+    for (int i = 0; i < 50; ++i) {
+        for (int a = 0; a < QLearningAgent::kActionCount; ++a) {
+            EXPECT_FLOAT_EQ(resumed.getQValue(sampleState(i), static_cast<ActionType>(a)),
+                            agent.getQValue(sampleState(i), static_cast<ActionType>(a)));
+        }
+        EXPECT_EQ(resumed.decideAction(sampleState(i)), agent.decideAction(sampleState(i))); // same exploration draws
+    }
+
+    const std::vector<uint8_t> bytes = snapshot->encode();
+    SimulationSnapshot damaged;
+    EXPECT_FALSE(damaged.decode(reinterpret_cast<const char*>(bytes.data()), bytes.size() - 9));
+    std::vector<uint8_t> wrongMagic = bytes;
+    wrongMagic[0] = 'X';
+    EXPECT_FALSE(damaged.decode(reinterpret_cast<const char*>(wrongMagic.data()), wrongMagic.size()));
+    std::vector<uint8_t> newerVersion = bytes;
+    newerVersion[4] = static_cast<uint8_t>(SimulationSnapshot::kVersion + 1);
+    EXPECT_FALSE(damaged.decode(reinterpret_cast<const char*>(newerVersion.data()), newerVersion.size()));
+    EXPECT_FALSE(damaged.loadFromFile(path + ".missing"));
+
+    std::filesystem::remove_all(std::filesystem::path(path).parent_path());
+}
+
+// Pending timers captured mid-run and re-created on a restarted wheel fire on the same ticks
+TEST(SimulationSnapshotTest, TimersResumeOnTheirTicks) {
+    TimerWheel original(1.0f);
+    for (uint32_t s = 0; s < 300; ++s) original.schedule(static_cast<float>(1 + (s * 37) % 5000), s % 4, s);
+    std::vector<TimerWheel::Event> due;
+    original.advance(1234.5f, due);
+
+    std::vector<TimerWheel::Pending> pending;
+    original.collectPending(pending);
+    EXPECT_EQ(pending.size(), original.pendingCount());
+    EXPECT_TRUE(std::is_sorted(pending.begin(), pending.end(),
+                               [](const auto& a, const auto& b) { return a.due < b.due; }));
+
+    TimerWheel resumed(1.0f);
+    resumed.schedule(3.0f, 9); // dropped by the restart
+    resumed.restart(original.getTick(), original.getCarry());
+    for (const auto& timer : pending) resumed.scheduleAt(timer.due, timer.channel, timer.subject);
+    EXPECT_EQ(resumed.getTick(), original.getTick());
+    EXPECT_EQ(resumed.pendingCount(), original.pendingCount());
+
+    std::vector<TimerWheel::Event> fromOriginal, fromResumed;
+    while (original.pendingCount() > 0) {
+        fromOriginal.clear();
+        fromResumed.clear();
+        original.advance(97.25f, fromOriginal);
+        resumed.advance(97.25f, fromResumed);
+        std::multiset<std::pair<uint32_t, uint32_t>> expected, actual;
+        for (const auto& event : fromOriginal) expected.emplace(event.channel, event.subject);
+        for (const auto& event : fromResumed) actual.emplace(event.channel, event.subject);
+        EXPECT_EQ(actual, expected);
+    }
+    EXPECT_EQ(resumed.pendingCount(), 0u);
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include "SpatialHash.hpp"
+
+#include <algorithm>
+#include <random>
+
+// Radius and k-nearest queries agree with a brute-force scan, including points off the world
+TEST(SpatialHashTest, QueriesMatchBruteForce) {
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<float> coord(-40.0f, 840.0f);
+    std::vector<sf::Vector2f> points(600);
+    for (auto& p : points) p = {coord(rng), coord(rng)};
+    for (int i = 0; i < 40; ++i) points[i] = {400.0f + i % 3, 400.0f}; // a crowd at a market
+
+    SpatialHash hash(64.0f, 800.0f, 800.0f);
+    hash.rebuild(points.data(), points.size());
+    ASSERT_EQ(hash.size(), points.size());
+
+    std::vector<uint32_t> found;
+    std::vector<uint32_t> kFound;
+    for (int q = 0; q < 200; ++q) {
+        const sf::Vector2f center = q < 5 ? points[q] : sf::Vector2f(coord(rng), coord(rng));
+        const float radius = 10.0f + static_cast<float>(q % 7) * 30.0f;
+
+        std::vector<std::pair<float, uint32_t>> expected;
+        for (uint32_t i = 0; i < points.size(); ++i) {
+            const float dx = points[i].x - center.x, dy = points[i].y - center.y;
+            if (dx * dx + dy * dy <= radius * radius && i != 3u) expected.emplace_back(dx * dx + dy * dy, i);
+        }
+        std::sort(expected.begin(), expected.end());
+
+        hash.queryRadius(center, radius, found, 3);
+        std::sort(found.begin(), found.end());
+        std::vector<uint32_t> expectedIndices;
+        for (const auto& e : expected) expectedIndices.push_back(e.second);
+        std::sort(expectedIndices.begin(), expectedIndices.end());
+        ASSERT_EQ(found, expectedIndices) << "query " << q;
+
+        hash.kNearest(center, 5, radius, kFound, 3);
+        ASSERT_EQ(kFound.size(), std::min<size_t>(5, expected.size()));
+        for (size_t i = 0; i < kFound.size(); ++i) {
+            const float dx = points[kFound[i]].x - center.x, dy = points[kFound[i]].y - center.y;
+            EXPECT_FLOAT_EQ(dx * dx + dy * dy, expected[i].first); // same distances (ties may swap indices)
+        }
+    }
+}
+
+TEST(SpatialHashTest, SeparationPushesNeighboursApart) {
+    const std::vector<sf::Vector2f> points = {{100, 100}, {110, 100}, {100, 100}, {300, 300}};
+    SpatialHash hash(64.0f, 800.0f, 800.0f);
+    hash.rebuild(points.data(), points.size());
+
+    const sf::Vector2f lonely = hash.separation(3, 32.0f, 6);
+    EXPECT_FLOAT_EQ(lonely.x, 0.0f);
+    EXPECT_FLOAT_EQ(lonely.y, 0.0f);
+
+    // the neighbour to the right pushes point 1 further right
+    EXPECT_GT(hash.separation(1, 32.0f, 6).x, 0.0f);
+
+    // exactly stacked points split in opposite directions
+    const SpatialHash pair = [] {
+        const sf::Vector2f stacked[] = {{50, 50}, {50, 50}};
+        SpatialHash h(64.0f, 800.0f, 800.0f);
+        h.rebuild(stacked, 2);
+        return h;
+    }();
+    const sf::Vector2f a = pair.separation(0, 32.0f, 6);
+    const sf::Vector2f b = pair.separation(1, 32.0f, 6);
+    EXPECT_NEAR(a.x, -b.x, 1e-5f);
+    EXPECT_NEAR(a.y, -b.y, 1e-5f);
+    EXPECT_NEAR(a.x * a.x + a.y * a.y, 1.0f, 1e-4f);
+}
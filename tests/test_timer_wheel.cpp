@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include "TimerWheel.hpp"
+
+#include <map>
+#include <random>
+
+// Every timer fires exactly on its tick, across all wheel levels and past the wheel's range
+TEST(TimerWheelTest, FiresOnTheScheduledTick) {
+    TimerWheel wheel(1.0f); // one tick per second keeps the arithmetic exact
+    std::mt19937 rng(44);
+    std::uniform_int_distribution<int> shortDelay(1, 70);
+    std::uniform_int_distribution<int> longDelay(1, 300000);
+
+    std::map<uint32_t, uint64_t> expected; // subject -> tick
+    for (uint32_t s = 0; s < 2000; ++s) {
+        const int delay = s % 4 == 0 ? longDelay(rng) : shortDelay(rng);
+        wheel.schedule(static_cast<float>(delay), 1, s);
+        expected[s] = static_cast<uint64_t>(delay);
+    }
+    const uint64_t farAway = (uint64_t{1} << 24) + 4321;
+    wheel.schedule(static_cast<float>(farAway), 2, 99999);
+    expected[99999] = farAway;
+    EXPECT_EQ(wheel.pendingCount(), expected.size());
+
+    std::vector<TimerWheel::Event> due;
+    size_t fired = 0;
+    uint64_t lastTick = 0;
+    while (wheel.pendingCount() > 0) {
+        due.clear();
+        // uneven steps, several ticks at a time, then big jumps towards the far timer
+        const float step = wheel.getTick() > 400000 ? 65536.0f : static_cast<float>(1 + wheel.getTick() % 5);
+        wheel.advance(step, due);
+        for (const auto& event : due) {
+            ASSERT_GT(expected.at(event.subject), lastTick);
+            ASSERT_LE(expected.at(event.subject), wheel.getTick());
+            ++fired;
+        }
+        // a single-tick step must deliver exactly that tick's timers
+        if (step == 1.0f) {
+            for (const auto& event : due) ASSERT_EQ(expected.at(event.subject), wheel.getTick());
+        }
+        lastTick = wheel.getTick();
+    }
+    EXPECT_EQ(fired, expected.size());
+}
+
+TEST(TimerWheelTest, CancelRetargetAndOrder) {
+    TimerWheel wheel(0.1f);
+    const auto a = wheel.schedule(0.5f, 7, 1);
+    const auto b = wheel.schedule(0.25f, 7, 2);
+    const auto c = wheel.schedule(100.0f, 8, 3);
+    EXPECT_TRUE(wheel.cancel(c));
+    EXPECT_FALSE(wheel.cancel(c));
+    EXPECT_TRUE(wheel.retarget(a, 42));
+    EXPECT_NEAR(wheel.remaining(a), 0.5f, 1e-4f);
+
+    std::vector<TimerWheel::Event> due;
+    wheel.advance(0.2f, due);
+    EXPECT_TRUE(due.empty());
+    wheel.advance(1.0f, due);
+    ASSERT_EQ(due.size(), 2u);
+    EXPECT_EQ(due[0].subject, 2u); // earlier tick first
+    EXPECT_EQ(due[1].subject, 42u);
+    EXPECT_EQ(due[1].id, a);
+    EXPECT_FALSE(wheel.isPending(a));
+    EXPECT_EQ(wheel.pendingCount(), 0u);
+
+    // a reused node must not answer to the old id
+    const auto d = wheel.schedule(0.0f, 9, 5); // at least one tick
+    EXPECT_NE(d, a);
+    EXPECT_NE(d, b);
+    EXPECT_FALSE(wheel.cancel(a));
+    due.clear();
+    wheel.advance(0.1f, due);
+    ASSERT_EQ(due.size(), 1u);
+    EXPECT_EQ(due[0].channel, 9u);
+    EXPECT_NEAR(wheel.now(), 1.3f, 1e-4f);
+}
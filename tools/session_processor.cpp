@@ -0,0 +1,101 @@
+#include "SessionProcessor.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Merges DataCollector session batches into train/validation/test .npz archives.
+//   session_processor [--input DIR_OR_FILE]... [--output PREFIX] [--min-reward R] [--max-reward R]
+//                     [--actions 2,3,4] [--no-dedup] [--no-shuffle] [--seed N]
+//                     [--val F] [--test F] [--threads N]
+
+namespace {
+    void printUsage() {
+        std::cout << "Usage: session_processor [options]\n"
+                  << "  --input PATH       session directory or batch file (repeatable, default training_data/sessions)\n"
+                  << "  --output PREFIX    output prefix (default training_data/exports/merged)\n"
+                  << "  --min-reward R     drop experiences with reward below R\n"
+                  << "  --max-reward R     drop experiences with reward above R\n"
+                  << "  --actions LIST     keep only these action ids, comma separated\n"
+                  << "  --no-dedup         keep repeated transitions\n"
+                  << "  --no-shuffle       keep recording order\n"
+                  << "  --seed N           shuffle seed (default 42)\n"
+                  << "  --val F            validation fraction (default 0.1)\n"
+                  << "  --test F           test fraction (default 0)\n"
+                  << "  --threads N        reader threads (default: all cores)\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    SessionProcessorOptions options;
+    bool customInputs = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << "\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--input") {
+            if (!customInputs) options.inputs.clear();
+            customInputs = true;
+            options.inputs.push_back(value());
+        } else if (arg == "--output") {
+            options.outputPrefix = value();
+        } else if (arg == "--min-reward") {
+            options.minReward = std::stof(value());
+        } else if (arg == "--max-reward") {
+            options.maxReward = std::stof(value());
+        } else if (arg == "--actions") {
+            std::stringstream list(value());
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                if (!item.empty()) options.actions.push_back(std::stoi(item));
+            }
+        } else if (arg == "--no-dedup") {
+            options.dedup = false;
+        } else if (arg == "--no-shuffle") {
+            options.shuffle = false;
+        } else if (arg == "--seed") {
+            options.seed = static_cast<unsigned>(std::stoul(value()));
+        } else if (arg == "--val") {
+            options.validationFraction = std::stof(value());
+        } else if (arg == "--test") {
+            options.testFraction = std::stof(value());
+        } else if (arg == "--threads") {
+            options.threads = static_cast<unsigned>(std::stoul(value()));
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printUsage();
+            return 2;
+        }
+    }
+
+    SessionProcessor processor(options);
+    const bool ok = processor.run();
+    const SessionProcessorReport& report = processor.getReport();
+
+    std::cout << "Files:       " << report.files << " (" << report.failedFiles << " failed)\n"
+              << "Read:        " << report.read << "\n"
+              << "Filtered:    " << report.filtered << "\n"
+              << "Duplicates:  " << report.duplicates << "\n"
+              << "Train:       " << report.train << "\n"
+              << "Validation:  " << report.validation << "\n"
+              << "Test:        " << report.test << "\n"
+              << "Reward mean: " << report.rewardMean << "\n";
+
+    if (!ok) {
+        std::cerr << "Session processing failed (see logs/)\n";
+        return 1;
+    }
+    std::cout << "Wrote " << options.outputPrefix << "_*.npz\n";
+    return 0;
+}